@@ -0,0 +1,559 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file tracebench.cpp
+ * @brief TraceBench times the small functions that TraceCollier calls for every trace line.
+ *
+ * Each function is run against a short input, a long one and a
+ * pathological one (10,000 binds, 4Kb of NCHAR hex and so on). For each
+ * we report the median nanoseconds per call, over a number of samples,
+ * and the heap allocations per call.
+ *
+ * It's built twice, once as normal and once with NO_REGEX defined, so
+ * that the regex and hand written versions can be compared:
+ *
+ * @code
+ * make -f makefile.gnu microbench
+ * bin/TraceBench --samples=11 --filter=extractHex
+ * @endcode
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+#include "gnu.h"
+#include "tmtracefile.h"
+#include "tmoptions.h"
+#include "tmbind.h"
+#include "tmcursor.h"
+#include "tmfingerprint.h"
+#include "tmwaits.h"
+#include "tmhistogram.h"
+#include "utilities.h"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::stringstream;
+using std::cout;
+using std::cerr;
+using std::endl;
+
+
+//----------------------------------------------------------------------
+// Every heap allocation made while a benchmark runs is counted here.
+// Replacing the global operator new is why this is a separate program
+// and not an option in TraceCollier itself.
+//----------------------------------------------------------------------
+static unsigned long long benchAllocs = 0;
+
+// GCC 11 and later see free() on memory from operator new, once these are
+// inlined, and warn. Here, operator new is malloc(), so they do match.
+#if defined (__GNUC__) && !defined (__clang__) && __GNUC__ >= 11
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif // defined
+
+void *operator new(size_t size) {
+    benchAllocs++;
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    benchAllocs++;
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+#if defined (__GNUC__) && !defined (__clang__) && __GNUC__ >= 11
+    #pragma GCC diagnostic pop
+#endif // defined
+
+
+// Results get added in here, so the compiler can't throw the work away.
+static volatile unsigned long long benchSink = 0;
+
+
+/** @brief Times a set of TraceCollier's parsing functions.
+ *
+ * A friend of tmTraceFileT, so that extractHex() and extractBindValue()
+ * can be called directly, without a trace file.
+ */
+class tmMicroBench
+{
+    public:
+        tmMicroBench(unsigned samples, const string &filter);
+        ~tmMicroBench();
+
+        void run();                 /**< Runs every benchmark that matches the filter. */
+
+    private:
+        /** @brief One line of results. */
+        struct benchResult {
+            string name;            /**< Function name. */
+            string input;           /**< Description of the input. */
+            double nsPerOp;         /**< Median nanoseconds per call. */
+            double minNsPerOp;      /**< Fastest sample's nanoseconds per call. */
+            double allocsPerOp;     /**< Heap allocations per call. */
+            unsigned long long ops; /**< Calls per sample. */
+        };
+
+        template <typename Func>
+        void bench(const string &name, const string &input, Func f);
+
+        void benchGetCursor();
+        void benchGetDigits();
+        void benchExtractBindName();
+        void benchBuildBindMap();
+        void benchExtractHex();
+        void benchExtractBindValue();
+        void benchReplaceBinds();
+        void benchClassifyLine();
+        void benchFingerprint();
+        void benchWaitNames();
+        void benchHistogram();
+        void report();
+
+        unsigned mSamples;                  /**< Number of timed samples per benchmark. */
+        string mFilter;                     /**< Only run benchmarks whose name contains this. */
+        vector<benchResult> mResults;       /**< Results so far. */
+        tmOptions mOptions;                 /**< Default options for the trace file object. */
+        tmTraceFileT<tmTextOutput, tmTerse> *mTraceFile;   /**< Owner of extractHex() etc. */
+};
+
+
+/** @brief Constructor.
+ *
+ * @param samples unsigned. How many timed samples to take of each benchmark.
+ * @param filter const string&. Only benchmarks with this in their name are run.
+ */
+tmMicroBench::tmMicroBench(unsigned samples, const string &filter) {
+    mSamples = samples;
+    mFilter = filter;
+    mTraceFile = new tmTraceFileT<tmTextOutput, tmTerse>(&mOptions);
+}
+
+
+/** @brief Destructor.
+ */
+tmMicroBench::~tmMicroBench() {
+    delete mTraceFile;
+}
+
+
+/** @brief Times one function against one input.
+ *
+ * @param name const string&. The function being timed.
+ * @param input const string&. A description of the input.
+ * @param f Func. Calls the function once, returning something to sink.
+ *
+ * The number of calls per sample is calibrated to take around 20ms,
+ * then mSamples samples are timed and the median taken.
+ */
+template <typename Func>
+void tmMicroBench::bench(const string &name, const string &input, Func f) {
+
+    if (!mFilter.empty() && name.find(mFilter) == string::npos) {
+        return;
+    }
+
+    typedef std::chrono::steady_clock benchClock;
+    const double target = 20e6;     // Nanoseconds per sample.
+
+    // Calibrate. Double up until a batch takes at least 1/10th of
+    // the target, then scale.
+    unsigned long long ops = 1;
+    double batchNs = 0;
+    while (true) {
+        benchClock::time_point start = benchClock::now();
+        for (unsigned long long x = 0; x < ops; x++) {
+            benchSink += f();
+        }
+        batchNs = std::chrono::duration<double, std::nano>(benchClock::now() - start).count();
+        if (batchNs >= target / 10 || ops >= (1ULL << 30)) {
+            break;
+        }
+        ops *= 2;
+    }
+    ops = std::max(1ULL, (unsigned long long)(ops * target / std::max(batchNs, 1.0)));
+
+    // Time it.
+    vector<double> times;
+    unsigned long long allocs = 0;
+    for (unsigned sample = 0; sample < mSamples; sample++) {
+        unsigned long long allocsBefore = benchAllocs;
+        benchClock::time_point start = benchClock::now();
+        for (unsigned long long x = 0; x < ops; x++) {
+            benchSink += f();
+        }
+        double ns = std::chrono::duration<double, std::nano>(benchClock::now() - start).count();
+        allocs += benchAllocs - allocsBefore;
+        times.push_back(ns / ops);
+    }
+
+    std::sort(times.begin(), times.end());
+
+    benchResult r;
+    r.name = name;
+    r.input = input;
+    r.nsPerOp = times[times.size() / 2];
+    r.minNsPerOp = times[0];
+    r.allocsPerOp = double(allocs) / (double(ops) * mSamples);
+    r.ops = ops;
+    mResults.push_back(r);
+
+    // Show progress, some of these take a while.
+    cerr << '.';
+}
+
+
+/** @brief Returns SQL with the requested number of binds, :1 to :N.
+ *
+ * @param binds unsigned. How many binds.
+ * @return string. An INSERT statement.
+ */
+static string bindSQL(unsigned binds) {
+    stringstream s;
+    s << "INSERT INTO BENCH_TABLE VALUES (";
+    for (unsigned x = 1; x <= binds; x++) {
+        s << (x > 1 ? ", " : "") << ':' << x;
+    }
+    s << ")";
+    return s.str();
+}
+
+
+/** @brief Returns a "value=" line holding bytes characters as NCHAR hex.
+ *
+ * @param bytes unsigned. How many characters to encode.
+ * @return string. The line, with the trailing space that Oracle writes.
+ */
+static string hexLine(unsigned bytes) {
+    static const char *hex = "0123456789abcdef";
+    string result = "  value=";
+    for (unsigned x = 0; x < bytes; x++) {
+        unsigned char c = 'A' + (x % 26);
+        result += "0 ";
+        result += hex[c >> 4];
+        result += hex[c & 15];
+        result += ' ';
+    }
+    return result;
+}
+
+
+void tmMicroBench::benchGetCursor() {
+    string shortLine = "EXEC #1:c=0,e=12,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=1,plh=0,tim=1234";
+    string longLine = "EXEC #139975473430296:c=1000,e=1234,p=0,cr=3,cu=0,mis=0,r=1,dep=0,og=1,plh=2882563468,tim=1516293872385127";
+    string noHash = "WAIT " + string(4096, 'x');
+    bool ok;
+
+    bench("getCursor", "short", [&]() { return getCursor(shortLine, &ok).size(); });
+    bench("getCursor", "long cursor id", [&]() { return getCursor(longLine, &ok).size(); });
+    bench("getCursor", "4Kb, no '#'", [&]() { return getCursor(noHash, &ok).size(); });
+}
+
+
+void tmMicroBench::benchGetDigits() {
+    string line = "EXEC #139975473430296:c=1000,e=1234,p=0,cr=3,cu=0,mis=0,r=1,dep=0,og=1,plh=2882563468,tim=1516293872385127";
+    string longLine = "STAT #139975473430296 id=1 cnt=0 pid=0 pos=1 obj=0 op='" + string(4000, 'X') + "' dep=3";
+    bool ok;
+
+    bench("getDigits", "c= (first)", [&]() { return getDigits(line, "c=", &ok); });
+    bench("getDigits", "dep= (late)", [&]() { return getDigits(line, "dep=", &ok); });
+    bench("getDigits", "4Kb, dep= at end", [&]() { return getDigits(longLine, "dep=", &ok); });
+    bench("getDigits", "4Kb, missing", [&]() { return getDigits(longLine, "xyz=", &ok); });
+}
+
+
+void tmMicroBench::benchExtractBindName() {
+    string shortSQL = "SELECT * FROM DUAL WHERE DUMMY = :b1";
+    string quotedSQL = "SELECT * FROM DUAL WHERE DUMMY = :\"A_Very_Long_Quoted_Bind_Name_Indeed\"";
+    string bigSQL = bindSQL(10000);
+    string::size_type shortPos = shortSQL.find(':');
+    string::size_type quotedPos = quotedSQL.find(':');
+    string::size_type lastPos = bigSQL.rfind(':');
+    string name;
+
+    bench("extractBindName", "short", [&]() { extractBindName(shortSQL, shortPos, name, cerr); return name.size(); });
+    bench("extractBindName", "quoted", [&]() { extractBindName(quotedSQL, quotedPos, name, cerr); return name.size(); });
+    bench("extractBindName", "last of 10,000", [&]() { extractBindName(bigSQL, lastPos, name, cerr); return name.size(); });
+}
+
+
+void tmMicroBench::benchBuildBindMap() {
+    string noBinds = "SELECT SYSDATE FROM DUAL";
+    string twoBinds = "SELECT * FROM EMP WHERE EMPNO = :b1 AND DEPTNO = :b2";
+    string literals = "SELECT ':not_a_bind', q'[:nor_me]' FROM DUAL -- :or_me\n WHERE X = :b1";
+    string hundred = bindSQL(100);
+    string tenThousand = bindSQL(10000);
+
+    // setSQLText() calls buildBindMap().
+    tmCursor cursor("1", 0, 1, cerr);
+    bench("buildBindMap", "no binds", [&]() { cursor.setSQLText(noBinds); return cursor.bindCount(); });
+    bench("buildBindMap", "2 binds", [&]() { cursor.setSQLText(twoBinds); return cursor.bindCount(); });
+    bench("buildBindMap", "literals and comments", [&]() { cursor.setSQLText(literals); return cursor.bindCount(); });
+    bench("buildBindMap", "100 binds", [&]() { cursor.setSQLText(hundred); return cursor.bindCount(); });
+    bench("buildBindMap", "10,000 binds", [&]() { cursor.setSQLText(tenThousand); return cursor.bindCount(); });
+}
+
+
+void tmMicroBench::benchExtractHex() {
+    vector<string> lines;
+    lines.push_back(hexLine(8));
+    lines.push_back(hexLine(100));
+    lines.push_back(hexLine(4096));
+    string result;
+
+    unsigned equalPos = lines[0].find('=');
+    vector<string>::const_iterator i = lines.begin();
+    bench("extractHex", "8 chars", [&]() { mTraceFile->extractHex(i, equalPos, result, 1); return result.size(); });
+    bench("extractHex", "100 chars", [&]() { mTraceFile->extractHex(i + 1, equalPos, result, 1); return result.size(); });
+    bench("extractHex", "4Kb NCHAR", [&]() { mTraceFile->extractHex(i + 2, equalPos, result, 1); return result.size(); });
+}
+
+
+void tmMicroBench::benchExtractBindValue() {
+    vector<string> lines;
+    lines.push_back("  value=42");
+    lines.push_back("  value=\"" + string(30, 'V') + "\"");
+    lines.push_back("  value=\"" + string(4000, 'V') + "\"");
+    lines.push_back(hexLine(4096));
+    lines.push_back("  value=18-jan-2018 16:44:32");
+
+    tmBind number(1, ":b1");
+    tmBind varchar(2, ":b2");
+    tmBind nchar(3, ":b3");
+    tmBind date(4, ":b4");
+    number.setBindType(2);
+    varchar.setBindType(1);
+    nchar.setBindType(96);
+    date.setBindType(12);
+
+    vector<string>::const_iterator i = lines.begin();
+    bench("extractBindValue", "NUMBER", [&]() { mTraceFile->extractBindValue(i, &number, 1); return number.bindId(); });
+    bench("extractBindValue", "VARCHAR2 30", [&]() { mTraceFile->extractBindValue(i + 1, &varchar, 1); return varchar.bindId(); });
+    bench("extractBindValue", "VARCHAR2 4000", [&]() { mTraceFile->extractBindValue(i + 2, &varchar, 1); return varchar.bindId(); });
+    bench("extractBindValue", "NCHAR 4Kb hex", [&]() { mTraceFile->extractBindValue(i + 3, &nchar, 1); return nchar.bindId(); });
+    bench("extractBindValue", "DATE", [&]() { mTraceFile->extractBindValue(i + 4, &date, 1); return date.bindId(); });
+}
+
+
+void tmMicroBench::benchReplaceBinds() {
+    vector<unsigned> sizes = { 2, 100, 10000 };
+    vector<string> labels = { "2 binds", "100 binds", "10,000 binds" };
+
+    for (unsigned x = 0; x < sizes.size(); x++) {
+        tmCursor cursor("1", 0, 1, cerr);
+        cursor.setSQLText(bindSQL(sizes[x]));
+        map<unsigned, tmBind *> *binds = cursor.binds();
+        for (map<unsigned, tmBind *>::iterator b = binds->begin(); b != binds->end(); b++) {
+            b->second->setBindValue("'Value'");
+        }
+
+        // This is what parseEXEC() does for every EXEC of a cursor with binds.
+        string sql = cursor.sqlText();
+        bench("replaceBinds", labels[x], [&]() {
+            string sqlText = sql;
+            return (unsigned long long)(cursor.replaceBinds(sqlText) == NULL) + sqlText.size();
+        });
+    }
+}
+
+
+void tmMicroBench::benchClassifyLine() {
+    string exec = "EXEC #139975473430296:c=1000,e=1234,p=0,cr=3,cu=0,mis=0,r=1,dep=0,og=1,plh=2882563468,tim=1516293872385127";
+    string wait = "WAIT #139975473430296: nam='db file sequential read' ela= 1234 file#=4 block#=1234 blocks=1 obj#=12345 tim=1516293872385127";
+    string parsing = "PARSING IN CURSOR #139975473430296 len=52 dep=0 uid=107 oct=3 lid=107 tim=1516293872385127 hv=1234567890 ad='7ff' sqlid='abcdefghijklm'";
+    string xctend = "XCTEND rlbk=0, rd_only=1, tim=1516293872385127";
+    string stars = "*** 2018-01-18 16:44:32.123";
+    string stat = "STAT #139975473430296 id=1 cnt=0 pid=0 pos=1 obj=0 op='" + string(4000, 'X') + "'";
+    string blank = "";
+
+    bench("classifyLine", "EXEC", [&]() { return (unsigned)classifyLine(exec); });
+    bench("classifyLine", "WAIT", [&]() { return (unsigned)classifyLine(wait); });
+    bench("classifyLine", "PARSING IN CURSOR", [&]() { return (unsigned)classifyLine(parsing); });
+    bench("classifyLine", "XCTEND", [&]() { return (unsigned)classifyLine(xctend); });
+    bench("classifyLine", "*** timestamp", [&]() { return (unsigned)classifyLine(stars); });
+    bench("classifyLine", "4Kb STAT", [&]() { return (unsigned)classifyLine(stat); });
+    bench("classifyLine", "blank", [&]() { return (unsigned)classifyLine(blank); });
+}
+
+
+void tmMicroBench::benchFingerprint() {
+    string simple = "SELECT * FROM EMP WHERE EMPNO = 7839 AND ENAME = 'KING'";
+    string hinted = "SELECT /*+ INDEX(e emp_pk) */ e.* FROM \"Emp\" e -- comment\n WHERE e.sal > 1.5e3 AND e.job = q'[it's]'";
+    string inList = "SELECT * FROM EMP WHERE EMPNO IN (";
+    for (unsigned x = 0; x < 1000; x++) {
+        inList += (x ? ", " : "") + std::to_string(7000 + x);
+    }
+    inList += ")";
+    string hundred = bindSQL(100);
+    tmSqlFingerprint fingerprint;
+
+    bench("fingerprint", "literals", [&]() { fingerprint.parse(simple); return fingerprint.fingerprint(); });
+    bench("fingerprint", "hint, comment, q-quote", [&]() { fingerprint.parse(hinted); return fingerprint.fingerprint(); });
+    bench("fingerprint", "1,000 item IN list", [&]() { fingerprint.parse(inList); return fingerprint.fingerprint(); });
+    bench("fingerprint", "100 binds", [&]() { fingerprint.parse(hundred); return fingerprint.fingerprint(); });
+    bench("oracleSqlId", "literals", [&]() { return tmSqlFingerprint::oracleSqlId(simple).size(); });
+    bench("oracleSqlId", "100 binds", [&]() { return tmSqlFingerprint::oracleSqlId(hundred).size(); });
+}
+
+
+void tmMicroBench::benchWaitNames() {
+    string wait = "WAIT #139975473430296: nam='db file sequential read' ela= 1234 file#=4 block#=1234 blocks=1 obj#=12345 tim=1516293872385127";
+    tmView name = valueView(wait, "nam=");
+    tmWaitNames names;
+    for (unsigned x = 0; x < 100; x++) {
+        names.intern(tmView("event " + std::to_string(x)));
+    }
+
+    // What tmSummary does for every WAIT, once the name has been seen.
+    names.intern(name);
+    bench("waitNames", "intern, 101 names", [&]() { return names.intern(name); });
+    bench("waitNames", "valueView and intern", [&]() { return names.intern(valueView(wait, "nam=")); });
+}
+
+
+void tmMicroBench::benchHistogram() {
+    tmHistogram histogram;
+    for (unsigned long long x = 1; x < 1000000; x += 997) {
+        histogram.record(x);
+    }
+
+    // What tmSummary does for every EXEC, FETCH and WAIT.
+    unsigned long long value = 0;
+    bench("histogram", "record", [&]() { histogram.record(value = (value + 7919) & 0xFFFFF); return histogram.count(); });
+    bench("histogram", "p99.9", [&]() { return histogram.percentile(99.9); });
+}
+
+
+/** @brief Runs all the benchmarks, then prints the results.
+ */
+void tmMicroBench::run() {
+    benchGetCursor();
+    benchGetDigits();
+    benchExtractBindName();
+    benchBuildBindMap();
+    benchExtractHex();
+    benchExtractBindValue();
+    benchReplaceBinds();
+    benchClassifyLine();
+    benchFingerprint();
+    benchWaitNames();
+    benchHistogram();
+    cerr << endl;
+
+    report();
+}
+
+
+/** @brief Prints the results table.
+ */
+void tmMicroBench::report() {
+#if defined (USE_REGEX)
+    const char *build = "REGEX";
+#else
+    const char *build = "NO_REGEX";
+#endif
+
+    printf("TraceBench: %s build, %u samples per benchmark.\n\n", build, mSamples);
+    printf("%-18s %-22s %14s %14s %12s %12s\n",
+           "Function", "Input", "Median ns/op", "Min ns/op", "Allocs/op", "Ops/sample");
+    printf("%-18s %-22s %14s %14s %12s %12s\n",
+           string(18, '-').c_str(), string(22, '-').c_str(), string(14, '-').c_str(),
+           string(14, '-').c_str(), string(12, '-').c_str(), string(12, '-').c_str());
+
+    for (vector<benchResult>::const_iterator r = mResults.begin(); r != mResults.end(); r++) {
+        printf("%-18s %-22s %14.1f %14.1f %12.2f %12llu\n",
+               r->name.c_str(), r->input.c_str(), r->nsPerOp, r->minNsPerOp,
+               r->allocsPerOp, r->ops);
+    }
+}
+
+
+/** @brief Usage.
+ */
+static void usage() {
+    cerr << "Usage: TraceBench [--samples=N] [--filter=name]" << endl << endl
+         << "--samples=N    Timed samples per benchmark, the median is reported. Default 5." << endl
+         << "--filter=name  Only run benchmarks for functions whose name contains 'name'." << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+    unsigned samples = 5;
+    string filter;
+
+    for (int x = 1; x < argc; x++) {
+        string arg = argv[x];
+        if (arg.compare(0, 10, "--samples=") == 0) {
+            samples = std::max(1, atoi(arg.c_str() + 10));
+        } else if (arg.compare(0, 9, "--filter=") == 0) {
+            filter = arg.substr(9);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    tmMicroBench bench(samples, filter);
+    bench.run();
+    return 0;
+}
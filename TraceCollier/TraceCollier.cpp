@@ -81,6 +81,20 @@
  * make -f makefile.gnu
  * @endcode
  *
+ * If sys/sdt.h is available, USDT probes are compiled in for bpftrace and
+ * friends. See tmprobes.h.
+ *
+ * Adding ALLOCSTATS=1 builds an instrumented executable which counts heap
+ * allocations per parser stage and lists them on stderr at exit.
+ *
+ * Adding NOREGEX=1 uses the hand written line scanning instead of std::regex.
+ * The "microbench" target times the per line functions with and without it.
+ *
+ * The "library" target builds bin/libtracecollier.a, the parser without
+ * main(), for programs which want the trace records through a
+ * tmEventHandler instead of a report. See tmevents.h, and TraceEvents for
+ * an example.
+ *
  * Once compiled, look here for your executable:
  *
  * @code
@@ -101,11 +115,17 @@
  *
  * If you choose to run in verbose mode, and you probably shouldn't, the output file for that
  * detail will be the same as the trace file name, but with the ".trc" extension replaced by
- * ".dbg". Once again, the output file will be in the same location as the trace file.
+ * ".dbg". Once again, the output file will be in the same location as the trace file. It is binary,
+ * see tmdebuglog.h, and "TraceCollier --decode" will turn it into text, with the extension ".dbg.txt".
  *
  * The optional parameters are as follows:
  *
  * @li --verbose or -v - indicates that you wish to generate lots of output for debugging purposes.
+ * @li --decode - decodes the debug file from an earlier --verbose run, instead of parsing the trace file.
+ * @li --stats - times each stage of the parse, and counts the records and lines of each type. The figures
+ * are written to stderr, and to a JSON file with the extension ".stats.json". See tmstats.h.
+ * @li --counters - as --stats, plus the CPU cycles, instructions, cache misses and branch misses of
+ * each stage, from the hardware performance counters. Linux only. See tmcounters.h.
  * @li --quiet or -q - indicates that you do not wish to see "Cursor: #cccc created at line: nnnn" messages.
  * on the screen while parsing is taking place. Any ERRORs or PARSE ERRORS will still be displayed.
  * @li --help -h or -? - indicates that you want help. The program will exit after displaying the
@@ -118,6 +138,37 @@
  * in the report. This meakes scrolling to the headings in long report files a lot easier!
  * @li --feedback=nn or -f=nn - indicates how often you want feedback on progress reading the trace file. Zero
  * disables feedback. The default is every 100,000 lines read. Useful on larger trace files.
+ * @li --columnar or -c - indicates that you also want every reported EXEC, and its binds, exported to
+ * an Apache Arrow IPC stream with the extension ".arrows". See tmcolumnar.h for the columns.
+ * @li --split=nn or -s=nn - splits the HTML report into parts of nn EXECs each, or nn megabytes each with
+ * --split=nnM. The report file becomes an index page listing each part's line range, time range and most
+ * expensive statements. The parts are named after the report, "trace_0001.html" and so on.
+ * @li --format=html|text|viewer|sqlite - chooses the report format. HTML is the default and "text" is the
+ * same as --text. The "viewer" format writes a static HTML page which only renders the visible rows, and
+ * can filter them, with the rows themselves in a compact data file with the extension ".data.js". The "sqlite" format writes an SQLite database, extension ".db", instead of a report
+ * and is only available when compiled with SQLite support, USE_SQLITE.
+ * @li --summary - writes a tkprof style summary instead of the detailed report, in the same pass. There
+ * is one row per SQL statement, most elapsed time first, with the PARSE, EXEC and FETCH counts, and the
+ * CPU, elapsed, disk, query, current, rows and misses totals. It's HTML, with the extension ".summary.html",
+ * unless the report format is text, when it's ".summary.txt". See tmsummary.h.
+ * @li --summary=both - writes the summary and the detailed report. Either way, the summary has each
+ * statement's wait events, and the totals for every wait event in the trace, and its execution plans,
+ * rebuilt from the STAT lines, one for each plan hash value, and the percentiles of its EXEC, FETCH and
+ * WAIT times.
+ * @li --top=nn - lists the nn slowest executions, EXEC plus FETCH elapsed time, with their binds and line
+ * numbers, instead of the detailed report. It's ".top.html", or ".top.txt" for a text report. See tmtop.h.
+ * @li --flamegraph or --flamegraph=file - writes folded stacks of every call and WAIT, at every depth,
+ * weighted by elapsed time, for flamegraph.pl, instead of the detailed report. It's ".folded" unless
+ * a file name is given. See tmflamegraph.h.
+ * @li --timeline or --timeline=file - writes every PARSE, EXEC, FETCH, WAIT and COMMIT, placed by tim=,
+ * in Chrome's trace event format, for chrome://tracing or ui.perfetto.dev, instead of the detailed report.
+ * It's ".timeline.json" unless a file name is given. --timeline-min=nn leaves out events shorter than nn
+ * microseconds. See tmtimeline.h.
+ * @li --report - writes the detailed report as well as the summary, the slowest executions, the flame
+ * graph or the timeline.
+ * @li --waits - adds a column to the HTML or text report with each EXEC's total WAIT time. With --fetches,
+ * that includes the WAITs of its FETCHes.
+ * @li --fetches - adds columns to the HTML or text report with each EXEC's FETCH calls, rows and times.
  *
  * @section sec-mit-licence MIT Licence
  *
@@ -151,7 +202,6 @@
 
 #include "TraceCollier.h"
 #include "utilities.h"
-#include "favicon.h"
 
 // Version number.
 const float version = 1.50;
@@ -168,6 +218,9 @@ int main(int argc, char *argv[])
     #else
         cout << " : with no REGEX support.";
     #endif // USE_REGEX
+    #ifdef USE_SQLITE
+        cout << " With SQLite support.";
+    #endif // USE_SQLITE
     cout << endl << endl;
 
     // Make sure that cout/cerr gets comma/dot separated thousands etc.
@@ -186,14 +239,33 @@ int main(int argc, char *argv[])
         return 0;
     }
 
-    if (options.html()) {
+    // Decode a debug file and exit requested?
+    if (options.decode()) {
+        ofstream decoded(options.decodedFile());
+        if (!decoded.good()) {
+            cerr << "TraceCollier: Cannot open decoded debug file " << options.decodedFile() << endl;
+            return 1;
+        }
+
+        allOk = tmDebugLog::decode(options.debugFile(), decoded, options.diagnostics());
+        if (allOk) {
+            cout << "TraceCollier: Debug file [" << options.debugFile() << "] decoded to ["
+                 << options.decodedFile() << "]." << endl;
+        }
+
+        return allOk ? 0 : 1;
+    }
+
+    // Only the HTML report, summary and slowest executions use them,
+    // not the flame graph or timeline files.
+    if (options.html() && (options.detailedReport() || options.summary() || options.top())) {
         // Create a (new) CSS file, if HTML requested and
         // there isn't one already.
         string cssFile = options.cssFileName();
         if (fileExists(cssFile)) {
             cout << "File exists: " << cssFile << endl;
         } else {
-            allOk = createCSSFile(cssFile);
+            allOk = createCSSFile(cssFile, options.messages(), options.diagnostics());
             if (!allOk) {
                 return 1;
             }
@@ -204,7 +276,7 @@ int main(int argc, char *argv[])
         if (fileExists(favIconFile)) {
             cout << "File exists: " << favIconFile << endl;
         } else {
-            allOk = createFaviconFile(favIconFile);
+            allOk = createFaviconFile(favIconFile, options.messages(), options.diagnostics());
             if (allOk) {
                 cout << "TraceCollier: 'favicon' file [" << favIconFile << "] created ok." << endl;
             } else {
@@ -216,14 +288,119 @@ int main(int argc, char *argv[])
 
 
 
+    // The summary, the slowest executions and the flame graph are
+    // totalled as the trace is parsed, with or without the detailed report.
+    // The timeline is written as it goes, so its file is opened first.
+    tmSummary *summary = NULL;
+    tmTopExecutions *top = NULL;
+    tmFlameGraph *flameGraph = NULL;
+    tmTimeline *timeline = NULL;
+    tmEventHandlers handlers;
+    tmTraceFile *traceFile;
+
+    if (options.timeline()) {
+        timeline = new tmTimeline(options.timelineFile(), options.timelineMin(), options.diagnostics());
+        if (!timeline->open(options.traceFile())) {
+            delete timeline;
+            return 1;
+        }
+
+        handlers.add(timeline);
+    }
+
+    if (options.summary()) {
+        summary = new tmSummary(options.depth());
+        handlers.add(summary);
+    }
+
+    if (options.top()) {
+        top = new tmTopExecutions(options.top());
+        handlers.add(top);
+    }
+
+    if (options.flameGraph()) {
+        flameGraph = new tmFlameGraph();
+        handlers.add(flameGraph);
+    }
+
+    // Only pass on the records when there's more than one handler.
+    tmEventHandler *events = NULL;
+    if (handlers.size() == 1) {
+        events = handlers.handler(0);
+    } else if (handlers.size() > 1) {
+        events = &handlers;
+    }
+
     // This is it, here is where we hit the big time! :)
-    tmTraceFile *traceFile = new tmTraceFile(&options);
+    if (!options.detailedReport()) {
+        traceFile = tmTraceFile::create(&options, events);
+    } else {
+        traceFile = tmTraceFile::create(&options);
+        traceFile->setEventHandler(events);
+    }
+
     allOk = traceFile->parse(version);
 
+    if (allOk && summary) {
+        allOk = summary->write(options.summaryFile(), options.html(), options.traceFile(), version, options.diagnostics());
+        if (allOk) {
+            cout << "TraceCollier: Summary [" << options.summaryFile() << "] written for "
+                 << summary->statements() << " statements." << endl;
+        }
+    }
+
+    if (allOk && top) {
+        allOk = top->write(options.topFile(), options.html(), options.traceFile(), version, options.diagnostics());
+        if (allOk) {
+            cout << "TraceCollier: Slowest executions [" << options.topFile() << "] written for "
+                 << top->size() << " executions." << endl;
+        }
+    }
+
+    if (allOk && flameGraph) {
+        allOk = flameGraph->write(options.flameGraphFile(), options.diagnostics());
+        if (allOk) {
+            cout << "TraceCollier: Flame graph [" << options.flameGraphFile() << "] written for "
+                 << flameGraph->stacks() << " stacks." << endl;
+        }
+    }
+
+    if (timeline) {
+        // Close it regardless, it's been written as the trace was parsed.
+        bool timelineOk = timeline->close();
+        if (allOk && timelineOk) {
+            cout << "TraceCollier: Timeline [" << options.timelineFile() << "] written for "
+                 << timeline->events() << " events";
+            if (timeline->skipped()) {
+                cout << ", " << timeline->skipped() << " left out";
+            }
+
+            cout << "." << endl;
+        }
+
+        allOk = allOk && timelineOk;
+    }
+
     // All done.
     if (traceFile) {
         delete traceFile;
     }
 
+    if (summary) {
+        delete summary;
+    }
+
+    if (top) {
+        delete top;
+    }
+
+    if (flameGraph) {
+        delete flameGraph;
+    }
+
+    if (timeline) {
+        delete timeline;
+    }
+
     return allOk ? 0 : 1;
 }
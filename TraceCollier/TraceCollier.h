@@ -30,29 +30,9 @@
  * @brief Header file for the TraceCollier application.
  */
 
-// Gnu c++ version 4.9.0 or above, is required to be able to use
-// the <regex> header and a working regex library. Versions less
-// than that core dump when defining the regex. Sigh.
-//
-// Use macros to calculate a GNU compiler version to see if we can
-// use regex or not.
-#if defined (USE_REGEX)
-    #undefine USE_REGEX
-#endif // defined
-
-#if defined (__GNUC__)
-        #define GCC_VERSION (__GNUC__ * 10000 \
-                           + __GNUC_MINOR__ * 100 \
-                           + __GNUC_PATCHLEVEL__)
-
-    // Test for GCC >= 4.9.0.
-    #if GCC_VERSION >= 40900
-        #define USE_REGEX
-    #endif // GCC_VERSION
-#else
-    // "Not using GNU compiler. Regex is ok."
-    #define USE_REGEX
-#endif // defined
+// Whether to use <regex>, from the compiler version, unless NO_REGEX
+// forces the scanning code. The same test the parsers use.
+#include "gnu.h"
 
 
 #include <iostream>
@@ -73,6 +53,10 @@ using std::exception;
 #include "tmcursor.h"
 #include "tmbind.h"
 #include "tmoptions.h"
+#include "tmsummary.h"
+#include "tmtop.h"
+#include "tmflamegraph.h"
+#include "tmtimeline.h"
 #include "utilities.h"
 
 
@@ -111,6 +111,14 @@ string cssText =
     + "    width: 3%;" + eol
     + "}" + eol
     + eol
+    + ".waittime {" + eol
+    + "    width: 5%;" + eol
+    + "}" + eol
+    + eol
+    + ".fetches {" + eol
+    + "    width: 5%;" + eol
+    + "}" + eol
+    + eol
     + ".exectime {" + eol
     + "    width: 14%;" + eol
     + "}" + eol
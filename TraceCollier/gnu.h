@@ -42,7 +42,12 @@
     #undef USE_REGEX
 #endif // defined
 
-#if defined (__GNUC__)
+//
+// Defining NO_REGEX forces the scanning code, whatever the compiler,
+// so that the two can be compared. "make -f makefile.gnu NOREGEX=1".
+#if defined (NO_REGEX)
+    // Scanning it is then.
+#elif defined (__GNUC__)
         #define GCC_VERSION (__GNUC__ * 10000 \
                            + __GNUC_MINOR__ * 100 \
                            + __GNUC_PATCHLEVEL__)
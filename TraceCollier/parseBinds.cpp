@@ -49,10 +49,17 @@ using std::find;
  * for the given cursor. The values are used to update
  * the binds map member of the appropriate tmCursor object.
  */
-bool tmTraceFile::parseBINDS(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseBINDS(const string &thisLine) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseBINDS(" << mLineNumber << "): Entry." << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_BINDS);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_BINDS);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_BINDS, mLineNumber, DBG_ENTRY);
     }
 
     // BINDS #5923197424:
@@ -77,11 +84,11 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
         stringstream s;
         s << "parseBINDS(" << mLineNumber << "): Cannot match against BINDS # at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseBINDS(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -93,10 +100,9 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
     map<string, tmCursor *>::iterator i = findCursor(cursorID);
     if (i == mCursors.end()) {
         // Ignore this one, depth != depth().
-        if (mOptions->verbose()) {
-            *mDbg << "parseBINDS(" << mLineNumber << "): Ignoring BINDS for cursor " << cursorID
-                  << ", which has an 'out of range' depth." << endl
-                  << "parseBINDS(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_IGNORE_CURSOR).span(cursorID);
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_EXIT);
         }
 
         return true;
@@ -105,16 +111,15 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
     // We have a valid cursor, but has it been closed?
     // This catches reuse of cursors with fewer binds, and at depth > depth().
     tmCursor *thisCursor = i->second;
-    if (mOptions->verbose()) {
-        *mDbg << "parseBINDS(" << mLineNumber << "): Found cursor: " << i->first << '.' << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_BINDS, mLineNumber, DBG_CURSOR_FOUND, thisCursor->sqlLineNumber()).span(i->first);
     }
 
     // Issue #15 Don't ignore binds for cached closed cursors.
     // Change debugging message.
     if (thisCursor->isClosed()) {
-        if (mOptions->verbose()) {
-            *mDbg << "parseBINDS(" << mLineNumber << "): Cursor " << i->first
-                  << " executing from cache, apparently." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_CURSOR_CACHED_EXEC).span(i->first);
         }
 
         //return true;
@@ -136,11 +141,11 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
           << " should have no binds, "
           << "but the trace file says otherwise at line: "
           << mLineNumber << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str() << endl
-                  << "parseBINDS(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -192,9 +197,8 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
         // Strip out those damned timestamp lines!
         if (bindLine.substr(0, 4) == "*** ")
         {
-            if (mOptions->verbose()) {
-                *mDbg << "parseBINDS(" << bindLineNumber << "): Ignoring timestamp/empty line ["
-                      << bindLine << ']' << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_BINDS, bindLineNumber, DBG_IGNORE_LINE).span(bindLine);
             }
 
             continue;
@@ -255,11 +259,26 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
     // line read in next time, as opposed to the desired one. The
     // rogue bears no resemblance to either the desired line, or the
     // one prior. This solution appears to work!
-    if (mOptions->verbose()) {
-        *mDbg << "parseBINDS(" << mLineNumber << "): Pushing back this line: [" << bindLine << ']' << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_BINDS, mLineNumber, DBG_PUSH_BACK).span(bindLine);
     }
     mUnprocessedLine = bindLine;
 
+    // Stats. The pushed back line belongs to the next record.
+    if (mStats) {
+        if (!bindLine.empty()) {
+            mStats->unreadLine();
+        }
+
+        unsigned bindBytes = 0;
+        for (vector<string>::iterator i = bindData.begin(); i != bindData.end(); ++i) {
+            bindBytes += i->length() + 1;
+        }
+        mStats->bindBlock(bindData.size(), bindBytes, thisCursor->bindsLine());
+    }
+
+    TCPROBE_BINDS(thisCursor->bindsLine(), cursorID.c_str(), bindCount, bindData.size());
+
     // We have binds in the cursor, and we've collected the data lines
     // from the trace file. Try to extract the appropriate values.
     for (map<unsigned, tmBind *>::iterator i = thisCursor->binds()->begin();
@@ -270,8 +289,8 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
         stringstream currentBind;
         currentBind << " Bind#" << i->first;
 
-        if (mOptions->verbose()) {
-            *mDbg << "parseBINDS(): Processing: [" << currentBind.str() << ']' << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_BIND_PROCESSING).span(currentBind.str());
         }
 
         // Find the first line of this bind's data and the first of the next bind's data.
@@ -287,11 +306,18 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
             // Issue #5 on GitHub.
             thisBind->setBindValue(thisBind->bindName());
 
-            if (mOptions->verbose()) {
-                *mDbg << "parseBINDS(" << mLineNumber << "): Cursor: " << thisCursor->cursorId() << ": "
-                      << "Bind #" << thisBind->bindId() << ": BindName: ["
-                      << thisBind->bindName() << "] has value ["
-                      << thisBind->bindValue() << ']' << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_BIND_VALUE, thisBind->bindId())
+                      .span(thisCursor->cursorId()).span(thisBind->bindName()).span(thisBind->bindValue());
+            }
+
+            // Any later binds keep their previous values, as ever.
+            if (mEvents) {
+                tmBindsEvent event;
+                event.line = thisCursor->bindsLine();
+                event.cursorId = cursorID;
+                event.cursor = thisCursor;
+                mEvents->onBinds(event);
             }
 
             return true;
@@ -302,11 +328,11 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
             stringstream s;
 
             s << "parseBINDS(" << mLineNumber << "): Cannot locate bind data for" << currentBind.str() << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "parseBINDS(" << mLineNumber << "): Exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_EXIT);
             }
 
             return false;
@@ -317,12 +343,12 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
         nextBind << " Bind#" << i->first + 1;
         vector<string>::iterator stop_i = find(start_i, bindData.end(), nextBind.str());
 
-        if (mOptions->verbose()) {
-            *mDbg << "parseBINDS(): start_i = [" << *start_i << ']' << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_BIND_START).span(*start_i);
             if (stop_i != bindData.end()) {
-                *mDbg << "parseBINDS(): stop_i = [" << *stop_i << ']' << endl;
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_BIND_STOP).span(*stop_i);
             } else {
-                *mDbg << "parseBINDS(): stop_i = [NO MORE BINDS]" << endl;
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_BIND_STOP).span("NO MORE BINDS");
             }
         }
 
@@ -331,28 +357,35 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
         if (!extractBindData(start_i, stop_i, thisCursor, thisBind, bindLineNumbers[startLineNumber])) {
             stringstream s;
             s << "parseBINDS(): Failed to extract bind data for" << currentBind.str() << '.' << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "parseBINDS(): Exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_BINDS, mLineNumber, DBG_EXIT);
             }
 
             return false;
         }
 
         // We found the bind.
-        if (mOptions->verbose()) {
-            *mDbg << "parseBINDS(): Cursor: " << thisCursor->cursorId() << ": "
-                  << "Bind #" << thisBind->bindId() << ": BindName: ["
-                  << thisBind->bindName() << "] has value ["
-                  << thisBind->bindValue() << ']' << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_BINDS, mLineNumber, DBG_BIND_VALUE, thisBind->bindId())
+                  .span(thisCursor->cursorId()).span(thisBind->bindName()).span(thisBind->bindValue());
         }
     }
 
+    // The values are all in the cursor's binds now.
+    if (mEvents) {
+        tmBindsEvent event;
+        event.line = thisCursor->bindsLine();
+        event.cursorId = cursorID;
+        event.cursor = thisCursor;
+        mEvents->onBinds(event);
+    }
+
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parseBINDS(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_BINDS, mLineNumber, DBG_EXIT);
     }
 
     return true;
@@ -398,12 +431,12 @@ bool tmTraceFile::parseBINDS(const string &thisLine) {
  * Mxl = Maximum length, but is not reliable. It's the internal format's maximum length.
  *
  */
-bool tmTraceFile::extractBindData(const vector<string>::iterator start, const vector<string>::iterator stop, tmCursor *thisCursor, tmBind *thisBind, unsigned firstLineNumber) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::extractBindData(const vector<string>::iterator start, const vector<string>::iterator stop, tmCursor *thisCursor, tmBind *thisBind, unsigned firstLineNumber) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "extractBindData(" << firstLineNumber << "): Entry." << endl
-              << "extractBindData(" << firstLineNumber << "): Extracting data for Bind #"
-              << thisBind->bindId() << '.' << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_EXTRACT_BIND_DATA, firstLineNumber, DBG_ENTRY);
+        mDbg->log(DBG_EXTRACT_BIND_DATA, firstLineNumber, DBG_BIND_EXTRACTING, thisBind->bindId());
     }
 
     // Storage for the data we are extracting from the vector.
@@ -427,8 +460,8 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
         i++,
         currentLine++)
     {
-        if (mOptions->verbose()) {
-           *mDbg << "extractBindData(" << currentLine << "): Scanning line: [" << *i << ']' << endl;
+        if (Verbosity::enabled) {
+           mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_SCANNING).span(*i);
         }
 
         // Set the flags.
@@ -443,8 +476,8 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
         if (noOacdefPos != string::npos) {
            // Need to find and copy from a previous bind.
            // Then we are done.
-            if (mOptions->verbose()) {
-               *mDbg << "extractBindData(): 'No oacdef' found." << endl;
+            if (Verbosity::enabled) {
+               mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_NO_OACDEF);
             }
 
             // Get the cursor's bind map.
@@ -462,11 +495,10 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
                         // Update the tmBind object with the data type.
                         thisBind->setBindType(bi->second->bindType());
 
-                        if (mOptions->verbose()) {
-                            *mDbg << "extractBindData(): Bind#" << thisBind->bindId()
-                                  << " has same data as Bind#" << bi->second->bindId()
-                                  << " Bind name [" << bi->second->bindName() << "]." << endl
-                                  << "extractBindData(" << currentLine << "): Exit." << endl;
+                        if (Verbosity::enabled) {
+                            mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_SAME_DATA,
+                                      thisBind->bindId(), bi->second->bindId()).span(bi->second->bindName());
+                            mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
                         }
 
                         // We have the bind's value, we are done here.
@@ -484,11 +516,11 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
               << " is a copy of another bind variable. However"
               << " extractBindData() was unable to find it." << endl;
 
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "extractBindData(" << currentLine << "): Exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
             }
 
             return false;
@@ -502,8 +534,8 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
            // the actual value later.
            valueStartsHere = i;
 
-           if (mOptions->verbose()) {
-              *mDbg << "extractBindData(" << currentLine << "): 'Value=' found." << endl;
+           if (Verbosity::enabled) {
+              mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_FOUND).span("Value=");
            }
 
            // Save the line that the value is on.
@@ -517,25 +549,25 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
         //----------------------------------------------------------------
         if (oacdtyPos != string::npos) {
 
-           if (mOptions->verbose()) {
-              *mDbg << "extractBindData(" << currentLine << "): 'Oacdty=' found." << endl;
+           if (Verbosity::enabled) {
+              mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_FOUND).span("Oacdty=");
            }
 
            if (!extractNumber(i, oacdtyPos + 6, dataType, currentLine)) {
                 stringstream s;
                 s << "extractBindData(): Failed to extract Data Type (OACDTY) for bind." << endl;
-                cerr << s.str();
+                mOptions->diagnostics() << s.str();
 
-                if (mOptions->verbose()) {
-                    *mDbg << s.str()
-                          << "extractBindData(" << currentLine << "): Exit.";
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_MESSAGE).span(s.str());
+                    mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
                 }
 
                 return false;
            }
 
-           if (mOptions->verbose()) {
-              *mDbg << "extractBindData(" << currentLine << "): 'Data Type is " << dataType << '.' << endl;
+           if (Verbosity::enabled) {
+              mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_DATA_TYPE, dataType);
            }
 
            continue;
@@ -546,25 +578,25 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
         //----------------------------------------------------------------
         if (avlPos != string::npos) {
 
-           if (mOptions->verbose()) {
-              *mDbg << "extractBindData(" << currentLine << "): 'Avl=' found." << endl;
+           if (Verbosity::enabled) {
+              mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_FOUND).span("Avl=");
            }
 
            if (!extractNumber(i, avlPos + 3, averageLength, currentLine)) {
                 stringstream s;
                 s << "extractBindData(): Failed to extract Average Length (AVL) for bind." << endl;
-                cerr << s.str();
+                mOptions->diagnostics() << s.str();
 
-                if (mOptions->verbose()) {
-                    *mDbg << s.str()
-                          << "extractBindData(" << currentLine << "): Exit.";
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_MESSAGE).span(s.str());
+                    mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
                 }
 
                 return false;
            }
 
-           if (mOptions->verbose()) {
-              *mDbg << "extractBindData(" << currentLine << "): 'Average Length is " << averageLength << '.' << endl;
+           if (Verbosity::enabled) {
+              mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_AVERAGE_LENGTH, averageLength);
            }
 
            continue;
@@ -578,12 +610,10 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
     // PL/SQL or not, a data type 102 is definitely a REF_CURSOR.
     if (dataType == 102) {
         thisBind->setBindValue("REF_CURSOR");
-        if (mOptions->verbose()) {
-            *mDbg << "extractBindData(): Bind variable: " << thisBind->bindId()
-                  << "('" << thisBind->bindName() << "') for cursor: "
-                  << thisCursor->cursorId() << ", has dataType 102. "
-                  << "Setting value to 'REF_CURSOR'." << endl
-                  << "extractBindData(): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_BIND_REF_CURSOR, thisBind->bindId())
+                  .span(thisBind->bindName()).span(thisCursor->cursorId());
+            mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
         }
 
         // I am done here.
@@ -605,10 +635,9 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
                 thisBind->setBindValue(thisBind->bindName());
             }
 
-            if (mOptions->verbose()) {
-                *mDbg << "parseBindData(): Suspected OUT PL/SQL parameter found, or," << endl
-                      << "parseBindData(): NULL value for bind variable found." << endl
-                      << "parseBindData(): Exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_BIND_DATA, currentLine, DBG_BIND_NULL);
+                mDbg->log(DBG_BIND_DATA, currentLine, DBG_EXIT);
             }
 
             return true;
@@ -621,19 +650,19 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
         stringstream s;
         s << "extractBindData(): Call to extractBindValue() Failed to extract bind value for 'Bind#"
           << thisBind->bindId() << '\'' << endl;
-        cerr  << s.str();
+        mOptions->diagnostics()  << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "extractBindData(): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
         }
 
         return false;
     }
 
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "extractBindData(" << currentLine << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_EXTRACT_BIND_DATA, currentLine, DBG_EXIT);
     }
 
     return true;
@@ -648,10 +677,11 @@ bool tmTraceFile::extractBindData(const vector<string>::iterator start, const ve
  * @param currentLine unsigned. The current line number of the bind data for the cursor.
  * @return bool. True is success. False is otherwise.
  */
-bool tmTraceFile::extractNumber(vector<string>::const_iterator i, const unsigned equalPos, unsigned &result, unsigned currentLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::extractNumber(vector<string>::const_iterator i, const unsigned equalPos, unsigned &result, unsigned currentLine) {
 
-   if (mOptions->verbose()) {
-      *mDbg << "extractNumber(" << currentLine << "): Entry." << endl;
+   if (Verbosity::enabled) {
+      mDbg->log(DBG_EXTRACT_NUMBER, currentLine, DBG_ENTRY);
    }
 
    try {
@@ -662,20 +692,19 @@ bool tmTraceFile::extractNumber(vector<string>::const_iterator i, const unsigned
        stringstream s;
        s << "extractNumber(" << currentLine << "): Exception: " << e.what() << endl
          << "extractNumber(" << currentLine << "): Failed to extract numeric data for bind." << endl;
-       cerr << s.str();
+       mOptions->diagnostics() << s.str();
 
-       if (mOptions->verbose()) {
-           *mDbg << s.str()
-                 << "extractNumber(" << currentLine << "): Exit.";
+       if (Verbosity::enabled) {
+           mDbg->log(DBG_EXTRACT_NUMBER, currentLine, DBG_MESSAGE).span(s.str());
+           mDbg->log(DBG_EXTRACT_NUMBER, currentLine, DBG_EXIT);
        }
 
        return false;
    }
 
-   if (mOptions->verbose()) {
-      *mDbg << "extractNumber(" << currentLine << "): 'Result is "
-            << result << '.' << endl
-            << "extractNumber(" << currentLine << "): Exit." << endl;
+   if (Verbosity::enabled) {
+      mDbg->log(DBG_EXTRACT_NUMBER, currentLine, DBG_NUMBER_RESULT, result);
+      mDbg->log(DBG_EXTRACT_NUMBER, currentLine, DBG_EXIT);
    }
 
    return true;
@@ -691,11 +720,12 @@ bool tmTraceFile::extractNumber(vector<string>::const_iterator i, const unsigned
  * @param currentLine unsigned. The current line number of the bind data for the cursor.
  * @return bool. True is success. False is otherwise.
  */
-bool tmTraceFile::extractHex(vector<string>::const_iterator i, const unsigned equalPos, string &result, unsigned currentLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::extractHex(vector<string>::const_iterator i, const unsigned equalPos, string &result, unsigned currentLine) {
 
 
-    if (mOptions->verbose()) {
-       *mDbg << "extractHex(" << currentLine << "): Entry." << endl;
+    if (Verbosity::enabled) {
+       mDbg->log(DBG_EXTRACT_HEX, currentLine, DBG_ENTRY);
     }
 
     // Initialise result string.
@@ -712,8 +742,8 @@ bool tmTraceFile::extractHex(vector<string>::const_iterator i, const unsigned eq
     while (true) {
         // What are we looking at right now?
         // Handy if I need to debug stuff.
-        //if (mOptions->verbose()) {
-        //   *mDbg << "extractHex(): Extracting digits [" << temp << ']' << endl;
+        //if (Verbosity::enabled) {
+        //   mDbg->log(DBG_EXTRACT_HEX, currentLine, DBG_LINE).span(temp);
         //}
 
         // Done yet?
@@ -730,11 +760,11 @@ bool tmTraceFile::extractHex(vector<string>::const_iterator i, const unsigned eq
             stringstream s;
             s << "extractHex(" << currentLine << "): Exception: " << e.what() << endl
               << "extractHex(" << currentLine << "): Failed to extract hex data from '" << temp << '\'' << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "extractHex(" << currentLine << "): Exit.";
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXTRACT_HEX, currentLine, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_EXTRACT_HEX, currentLine, DBG_EXIT);
             }
 
             return false;
@@ -753,10 +783,9 @@ bool tmTraceFile::extractHex(vector<string>::const_iterator i, const unsigned eq
     // Terminate result string.
     result.push_back('\'');
 
-    if (mOptions->verbose()) {
-       *mDbg << "extractHex(" << currentLine << "): Result is "
-             << result << '.' << endl
-             << "extractHex(" << currentLine << "): Exit." << endl;
+    if (Verbosity::enabled) {
+       mDbg->log(DBG_EXTRACT_HEX, currentLine, DBG_TEXT_RESULT).span(result);
+       mDbg->log(DBG_EXTRACT_HEX, currentLine, DBG_EXIT);
     }
 
     return true;
@@ -799,12 +828,12 @@ bool tmTraceFile::extractHex(vector<string>::const_iterator i, const unsigned eq
  * 208 = UROWID.
  * 231 = TIMESTAMP WITH LOCAL TIME ZONE.
  */
-bool tmTraceFile::extractBindValue(vector<string>::const_iterator i, tmBind *thisBind, unsigned currentLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::extractBindValue(vector<string>::const_iterator i, tmBind *thisBind, unsigned currentLine) {
 
-   if (mOptions->verbose()) {
-      *mDbg << "extractBindValue(" << currentLine << "): Entry." << endl
-            << "extractBindValue(" << currentLine << "): Processing Bind#" << thisBind->bindId() << '.' << endl
-            << "extractBindValue(" << currentLine << "): Extracting value from [" << *i << ']' << endl;
+   if (Verbosity::enabled) {
+      mDbg->log(DBG_EXTRACT_BIND_VALUE, currentLine, DBG_ENTRY);
+      mDbg->log(DBG_EXTRACT_BIND_VALUE, currentLine, DBG_BIND_EXTRACT_VALUE, thisBind->bindId()).span(*i);
    }
 
    unsigned equalPos = i->find("=");
@@ -841,11 +870,11 @@ bool tmTraceFile::extractBindValue(vector<string>::const_iterator i, tmBind *thi
                } else {
                    stringstream s;
                    s << "extractBindValue(" << currentLine << "): Failed to extract Hex." << endl;
-                   cerr << s.str();
+                   mOptions->diagnostics() << s.str();
 
-                   if (mOptions->verbose()) {
-                       *mDbg << s.str()
-                             << "extractBindValue(" << currentLine << "): Exit." << endl;
+                   if (Verbosity::enabled) {
+                       mDbg->log(DBG_EXTRACT_BIND_VALUE, currentLine, DBG_MESSAGE).span(s.str());
+                       mDbg->log(DBG_EXTRACT_BIND_VALUE, currentLine, DBG_EXIT);
                    }
 
                    return false;
@@ -907,10 +936,18 @@ bool tmTraceFile::extractBindValue(vector<string>::const_iterator i, tmBind *thi
 
 
    // Looks like a good parse.
-   if (mOptions->verbose()) {
-      *mDbg << "extractBindValue(" << currentLine << "): Result = " << thisBind->bindValue() << endl
-            << "extractBindValue(" << currentLine << "): Exit." << endl;
+   if (Verbosity::enabled) {
+      mDbg->log(DBG_EXTRACT_BIND_VALUE, currentLine, DBG_TEXT_RESULT).span(thisBind->bindValue());
+      mDbg->log(DBG_EXTRACT_BIND_VALUE, currentLine, DBG_EXIT);
    }
 
     return true;
 }
+
+
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseBINDS(const string &));
+TMTRACEFILE_INSTANTIATE(bool, extractBindData(const vector<string>::iterator, const vector<string>::iterator, tmCursor *, tmBind *, unsigned));
+TMTRACEFILE_INSTANTIATE(bool, extractNumber(vector<string>::const_iterator, const unsigned, unsigned &, unsigned));
+TMTRACEFILE_INSTANTIATE(bool, extractHex(vector<string>::const_iterator, const unsigned, string &, unsigned));
+TMTRACEFILE_INSTANTIATE(bool, extractBindValue(vector<string>::const_iterator, tmBind *, unsigned));
@@ -44,10 +44,17 @@
  * The tmCursor associated with this CLOSE is found, and the closed flag updated.
  * Depth is ignored. A buig in Oracle, it seems, can PARSE at DEP=1 but CLOSE at DEP=0!
  */
-bool tmTraceFile::parseCLOSE(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseCLOSE(const string &thisLine) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseCLOSE(" << mLineNumber << "): Entry." << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_CLOSE);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_CLOSE);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_CLOSE, mLineNumber, DBG_ENTRY);
     }
 
     // CLOSE #4155332696:c=0,e=1,dep=0,type=3,tim=1039827725793
@@ -84,16 +91,26 @@ bool tmTraceFile::parseCLOSE(const string &thisLine) {
         stringstream s;
         s << "parseCLOSE(" << mLineNumber << "): Cannot match against CLOSE at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseCLOSE(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_CLOSE, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_CLOSE, mLineNumber, DBG_EXIT);
         }
 
         return false;
     }
 
+    // Every call, at any depth, goes to the call tree and onCall().
+    tmCallEvent call;
+    if (mEvents) {
+        call.type = CALL_CLOSE;
+        call.line = mLineNumber;
+        call.cursorId = cursorID;
+        call.stats.parse(thisLine);
+        addCall(call);
+    }
+
     // Find the existing cursor.
     map<string, tmCursor *>::iterator i = findCursor(cursorID);
 
@@ -103,9 +120,20 @@ bool tmTraceFile::parseCLOSE(const string &thisLine) {
         // i is an iterator to a pair<string, tmCursor *>
         // So i->first is the string.
         // And i->second is the tmCursor pointer.
+        // The CLOSE ends the cursor's last execution, FETCHes and all.
+        if (!finishExecution(i->second)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_CLOSE, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+
         i->second->setClosed(true);
         // Issue #11: Binds line not cleared on close.
         i->second->setBindsLine(0);
+        // Nor are WAITs after the last call part of the next one.
+        i->second->takeWaitTime();
     } else {
         // Not found. Oh dear! Flag it up if depth was zero.
         // Return true as if it worked to get
@@ -116,12 +144,12 @@ bool tmTraceFile::parseCLOSE(const string &thisLine) {
             s << "parseCLOSE(" << mLineNumber << "): Found CLOSE for cursor " << cursorID
               << " at line: " << mLineNumber
               << ", but not found in existing cursor list." << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
         }
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseCLOSE(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_CLOSE, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_CLOSE, mLineNumber, DBG_EXIT);
         }
 
         // We should be returning false if we don't find the cursor
@@ -131,22 +159,34 @@ bool tmTraceFile::parseCLOSE(const string &thisLine) {
     }
 
     // Looks like a good close.
-    if (mOptions->verbose()) {
-        *mDbg << "parseCLOSE(" << mLineNumber << "): Cursor " << i->first
-              << " has been " << (closeType == 0 ? " hard closed." : " closed and cached.")
-              << endl
-            << "parseCLOSE(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_CLOSE, mLineNumber, closeType == 0 ? DBG_CURSOR_HARD_CLOSED : DBG_CURSOR_CACHED).span(i->first);
+        mDbg->log(DBG_CLOSE, mLineNumber, DBG_EXIT);
+    }
+
+    TCPROBE_CURSOR_CLOSED(mLineNumber, i->first.c_str(), closeType);
+
+    if (mEvents) {
+        tmCloseEvent event;
+        event.line = mLineNumber;
+        event.cursorId = cursorID;
+        event.stats = call.stats;
+        event.closeType = closeType;
+        event.recursive = call.recursive;
+        event.cursor = i->second;
+        mEvents->onClose(event);
     }
 
     // One for the viewer.
-    if (!mOptions->quiet()) {
-        cout << "Cursor: " << i->first
-             << (closeType == 0 ? " hard closed" : " closed and cached")
-             << " at line: " << mLineNumber << endl;
+    if (Output::format != OUTPUT_EVENTS && !mOptions->quiet()) {
+        mOptions->messages() << "Cursor: " << i->first
+                             << (closeType == 0 ? " hard closed" : " closed and cached")
+                             << " at line: " << mLineNumber << endl;
     }
 
     return true;
 }
 
 
-
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseCLOSE(const string &));
@@ -29,9 +29,7 @@
 #include "tmtracefile.h"
 #include "gnu.h"
 
-#ifndef USE_REGEX
-    #include "utilities.h"
-#endif
+#include "utilities.h"
 
 
 /** @brief Parses a "DEADLOCK DETECTED" line.
@@ -39,16 +37,24 @@
  * Parses a line from the trace file. The line is expected
  * to be a DEADLOCK DETECTED line.
  */
-void tmTraceFile::parseDEADLOCK() {
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::parseDEADLOCK() {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseDEADLOCK(" << mLineNumber << "): Entry." << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_DEADLOCK);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_DEADLOCK);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_DEADLOCK, mLineNumber, DBG_ENTRY);
     }
 
     // DEADLOCK DETECTED ( ORA-00060 )
 
     // Stuff for the report.
     stringstream deadlockData;
+    stringstream deadlockGraph;
     string deadlockLine;
     unsigned currentLineNumber = mLineNumber;
 
@@ -61,8 +67,7 @@ void tmTraceFile::parseDEADLOCK() {
     }
 
     // Add to the deadlock stuff.
-    deadlockData << "<pre>" << endl
-                 << deadlockLine << endl;
+    deadlockGraph << deadlockLine << endl;
 
     // Scan and dump out the deadlock stuff.
     while (true) {
@@ -75,34 +80,74 @@ void tmTraceFile::parseDEADLOCK() {
             }
 
             // Keep going, add to the dump.
-            deadlockData << deadlockLine << endl;
+            deadlockGraph << deadlockLine << endl;
         }
     }
 
-    // Terminate the deadlock data.
-    deadlockData << "</pre>";
+    // Wrap up the deadlock data.
+    deadlockData << "<pre>" << endl
+                 << deadlockGraph.str()
+                 << "</pre>";
 
     // Report the error in the report file.
-    if (!mOptions->html()) {
-        *mOfs << setw(MAXLINENUMBER) << currentLineNumber << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << deadlockData.str() << endl;
-    } else {
-        *mOfs << "<tr><td class=\"number\">" << currentLineNumber << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td>" << "&nbsp;" << "</td><td class=\"error_text\">"
-              << deadlockData.str()
-              << "</td></tr>" << endl;
+    if (mEvents) {
+        string graph = deadlockGraph.str();
+        tmDeadlockEvent event;
+        event.line = currentLineNumber;
+        event.graph = graph;
+        mEvents->onDeadlock(event);
+    }
+
+    if (Output::format == OUTPUT_VIEWER) {
+        // Nothing we can do if this fails, but say so.
+        if (!mViewer->addRow(VIEWER_DEADLOCK, currentLineNumber, 0, 0, 0, -1, "", "", deadlockGraph.str())) {
+            mOptions->diagnostics() << "parseDEADLOCK(" << mLineNumber << "): Viewer write failed." << endl;
+        }
+    } else if (Output::format == OUTPUT_SQLITE) {
+        // Nothing we can do if this fails, but say so.
+        if (!mSQLite->addDeadlock(currentLineNumber, deadlockGraph.str())) {
+            mOptions->diagnostics() << "parseDEADLOCK(" << mLineNumber << "): Database insert failed." << endl;
+        }
+    } else if (Output::format == OUTPUT_TEXT) {
+        ostream &out = reportRowStream();
+        out << setw(MAXLINENUMBER) << currentLineNumber << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' ';
 
+        reportBlankColumns(out);
+
+        out << deadlockData.str() << endl;
+
+        // Nothing we can do if this fails, but say so.
+        if (!reportRowDone(false)) {
+            mOptions->diagnostics() << "parseDEADLOCK(" << mLineNumber << "): Report write failed." << endl;
+        }
+    } else if (Output::format == OUTPUT_HTML) {
+        ostream &out = reportRowStream();
+        out << "<tr><td class=\"number\">" << currentLineNumber << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td>" << "&nbsp;" << "</td>";
+
+        reportBlankColumns(out);
+
+        out << "<td class=\"error_text\"><pre>" << endl
+            << htmlEscaped(deadlockGraph.str())
+            << "</pre></td></tr>" << endl;
+
+        // Nothing we can do if this fails, but say so.
+        if (!reportRowDone(false)) {
+            mOptions->diagnostics() << "parseDEADLOCK(" << mLineNumber << "): Report write failed." << endl;
+        }
     }
 
     // And on the command line.
-    cout << "DEADLOCK detected at line: " << currentLineNumber << endl;
+    if (Output::format != OUTPUT_EVENTS) {
+        mOptions->messages() << "DEADLOCK detected at line: " << currentLineNumber << endl;
+    }
 
     // Scan the process state until the end.
     while (true) {
@@ -113,11 +158,11 @@ void tmTraceFile::parseDEADLOCK() {
     }
 
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parseDEADLOCK(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_DEADLOCK, mLineNumber, DBG_EXIT);
     }
 }
 
 
-
-
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(void, parseDEADLOCK());
@@ -29,9 +29,7 @@
 #include "tmtracefile.h"
 #include "gnu.h"
 
-#ifndef USE_REGEX
-    #include "utilities.h"
-#endif
+#include "utilities.h"
 
 
 /** @brief Parses an "ERROR" line.
@@ -42,10 +40,17 @@
  * Parses a line from the trace file. The line is expected
  * to be an ERROR \#cursor line.
  */
-bool tmTraceFile::parseERROR(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseERROR(const string &thisLine) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseERROR(" << mLineNumber << "): Entry." << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_ERROR);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_ERROR);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_ERROR, mLineNumber, DBG_ENTRY);
     }
 
     // ERROR #275452960:err=31013 tim=1075688943194
@@ -77,11 +82,11 @@ bool tmTraceFile::parseERROR(const string &thisLine) {
         stringstream s;
         s << "parseERROR(" << mLineNumber << "): Cannot match against ERROR at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseERROR(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_ERROR, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -97,6 +102,15 @@ bool tmTraceFile::parseERROR(const string &thisLine) {
     string oraError = "ORA-" + std::to_string(errorCode);
 
     if (i != mCursors.end()) {
+        // The failed EXEC's row goes before its ERROR's.
+        if (!finishExecution(i->second)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+
         unsigned temp = i->second->bindsLine();
         string bindsLine = std::to_string(temp);
         if (temp == 0) {
@@ -105,39 +119,93 @@ bool tmTraceFile::parseERROR(const string &thisLine) {
 
         // Report the error in the report file.
         // EXEC(ERROR) line numbers.
-        if (!mOptions->html()) {
-            *mOfs << setw(MAXLINENUMBER) << i->second->execLine() << '/' << mLineNumber << ' '
-                  << setw(MAXLINENUMBER) << i->second->sqlParseLine() << ' '
-                  << setw(MAXLINENUMBER) << bindsLine << ' '
-                  << setw(MAXLINENUMBER) << i->second->sqlLineNumber() << ' '
-                  << setw(MAXLINENUMBER) << ' ' << ' '
-                  << " ERROR: " << oraError << endl;
-        } else {
-            *mOfs << "<tr><td class=\"number\">" << i->second->execLine() << '/' << mLineNumber << "</td>"
-                  << "<td class=\"number\">" << i->second->sqlParseLine() << "</td>"
-                  << "<td class=\"number\">" << bindsLine << "</td>"
-                  << "<td class=\"number\">" << i->second->sqlLineNumber() << "</td>"
-                  << "<td>" << "&nbsp;" << "</td>"
-                  << "<td class=\"error_text\">"
-                  << " ERROR: " << oraError
-                  << "</td></tr>" << endl;
+        if (mEvents) {
+            tmErrorEvent event;
+            event.line = mLineNumber;
+            event.cursorId = cursorID;
+            event.error = errorCode;
+            event.tim = numberValue(thisLine, "tim=");
+            event.cursor = i->second;
+            mEvents->onError(event);
+        }
 
+        if (Output::format == OUTPUT_VIEWER) {
+            if (!mViewer->addRow(VIEWER_ERROR, mLineNumber, i->second->sqlParseLine(), temp,
+                                 i->second->sqlLineNumber(), -1, i->second->cursorId(), "",
+                                 oraError + " (EXEC at line " + std::to_string(i->second->execLine()) + ")")) {
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_ERROR, mLineNumber, DBG_VIEWER_FAILED);
+                    mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
+                }
+
+                return false;
+            }
+        } else if (Output::format == OUTPUT_SQLITE) {
+            if (!mSQLite->addError(mLineNumber, i->second, errorCode)) {
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_ERROR, mLineNumber, DBG_DATABASE_FAILED);
+                    mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
+                }
+
+                return false;
+            }
+        } else if (Output::format == OUTPUT_TEXT) {
+            ostream &out = reportRowStream();
+            out << setw(MAXLINENUMBER) << i->second->execLine() << '/' << mLineNumber << ' '
+                << setw(MAXLINENUMBER) << i->second->sqlParseLine() << ' '
+                << setw(MAXLINENUMBER) << bindsLine << ' '
+                << setw(MAXLINENUMBER) << i->second->sqlLineNumber() << ' '
+                << setw(MAXLINENUMBER) << ' ' << ' ';
+
+            reportBlankColumns(out);
+
+            out << " ERROR: " << oraError << endl;
+
+            if (!reportRowDone(false)) {
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
+                }
+
+                return false;
+            }
+        } else if (Output::format == OUTPUT_HTML) {
+            ostream &out = reportRowStream();
+            out << "<tr><td class=\"number\">" << i->second->execLine() << '/' << mLineNumber << "</td>"
+                << "<td class=\"number\">" << i->second->sqlParseLine() << "</td>"
+                << "<td class=\"number\">" << bindsLine << "</td>"
+                << "<td class=\"number\">" << i->second->sqlLineNumber() << "</td>"
+                << "<td>" << "&nbsp;" << "</td>";
+
+            reportBlankColumns(out);
+
+            out << "<td class=\"error_text\">"
+                << " ERROR: " << htmlEscaped(oraError)
+                << "</td></tr>" << endl;
+
+            if (!reportRowDone(false)) {
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
+                }
+
+                return false;
+            }
         }
 
         // And on the command line.
-        cout << "ERROR " << oraError << " in Cursor: " << i->second->cursorId()
-             << " detected at line: " << mLineNumber << endl;
-
+        if (Output::format != OUTPUT_EVENTS) {
+            mOptions->messages() << "ERROR " << oraError << " in Cursor: " << i->second->cursorId()
+                                 << " detected at line: " << mLineNumber << endl;
+        }
     }
 
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parseERROR(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_ERROR, mLineNumber, DBG_EXIT);
     }
 
     return true;
 }
 
 
-
-
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseERROR(const string &));
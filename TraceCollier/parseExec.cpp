@@ -29,9 +29,7 @@
 #include "tmtracefile.h"
 #include "gnu.h"
 
-#ifndef USE_REGEX
-    #include "utilities.h"
-#endif
+#include "utilities.h"
 
 /** @brief Parses a "EXEC" line.
  *
@@ -45,10 +43,18 @@
  * are extracted and merged into the SQL statement ready for output to
  * the report file.
  */
-bool tmTraceFile::parseEXEC(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseEXEC(const string &thisLine) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseEXEC(" << mLineNumber << "): Entry. EXEC Count so far: " << mExecCount << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_EXEC);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_EXEC);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_EXEC, mLineNumber, DBG_ENTRY);
+        mDbg->log(DBG_EXEC, mLineNumber, DBG_EXEC_COUNT, mExecCount);
     }
 
     // EXEC #5924310096:c=0,e=31,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=4,plh=1388734953,tim=526735705392 [ ...,local='yyyy Mon etc ']
@@ -92,24 +98,37 @@ bool tmTraceFile::parseEXEC(const string &thisLine) {
         stringstream s;
         s << "parseEXEC(" << mLineNumber << "): Cannot match against EXEC at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str() << endl
-                  << "parseEXEC(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
         }
 
-        cerr << "EXEC: Local = [" << local << "]" << endl;
+        mOptions->diagnostics() << "EXEC: Local = [" << local << "]" << endl;
 
         return false;
     }
 
+    // The c=, e=, p= etc figures, parsed once, for the events, the report
+    // or database, and the columnar file. Every call, at any depth, goes
+    // to the call tree and onCall().
+    tmCallEvent event;
+    tmCallStats &stats = event.stats;
+    if (mEvents) {
+        event.type = CALL_EXEC;
+        event.line = mLineNumber;
+        event.cursorId = cursorID;
+        stats.parse(thisLine);
+        addCall(event);
+    }
+
     // We only care about user level SQL, so only depth <= depth().
     if (depth > mOptions->depth()) {
         // Ignore this one.
-        if (mOptions->verbose()) {
-            *mDbg << "parseEXEC(" << mLineNumber << "): Ignoring EXEC with dep=" << depth << '.' << endl
-                  << "parseEXEC(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_IGNORE_DEPTH, depth);
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
         }
 
         return true;
@@ -120,28 +139,35 @@ bool tmTraceFile::parseEXEC(const string &thisLine) {
     if (i == mCursors.end()) {
         stringstream s;
         s << "parseEXEC(" << mLineNumber << "): Cursor " << cursorID << " not found." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str() << endl
-                  << "parseEXEC(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
         }
 
         return false;
     }
 
-
-    // We have a depth <= depth() EXEC with a valid cursor, increment the EXEC counter.
-    // And check if we need a fresh set of report headings?
-    if ((mExecCount > mOptions->maxExecs())) {
-        // Throw a new set of headings to make reading easier.
-        reportHeadings();
-        mExecCount = 0;
+    // Without events, only the EXECs at depth() or above need them, and
+    // the viewer doesn't, unless they're exported too.
+    if (!mEvents && (Output::format != OUTPUT_VIEWER || mColumnar)) {
+        stats.parse(thisLine);
     }
 
     // Get the SQL Statement & binds.
     tmCursor *thisCursor = i->second;
-    string sqlText = thisCursor->sqlText();
+
+    // This EXEC ends the cursor's previous execution, FETCHes and all.
+    if (!finishExecution(thisCursor)) {
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+        }
+
+        return false;
+    }
+
+    thisCursor->clearFetches();
 
     // Might as well save the local date/time.
     thisCursor->setLocal(local);
@@ -149,95 +175,371 @@ bool tmTraceFile::parseEXEC(const string &thisLine) {
     // Save the EXEC line too, for parseERROR().
     thisCursor->setExec(mLineNumber);
 
+    // The WAITs since the cursor's last call were this EXEC's.
+    unsigned long long waitTime = thisCursor->takeWaitTime();
+
+    // An event handler has the cursor and its binds, so can do its own
+    // bind substitution, if it wants to.
+    if (mEvents) {
+        event.local = local;
+        thisCursor->setPlanHash(stats.planHash());
+        mEvents->onExec(event);
+    }
+
+    // Nothing else to do without a report.
+    if (Output::format == OUTPUT_EVENTS) {
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+        }
+
+        TCPROBE_EXEC(mLineNumber, cursorID.c_str(), depth, thisCursor->sqlLineNumber());
+
+        mExecCount++;
+        return true;
+    }
+
+    string sqlText = thisCursor->sqlText();
+
     // Find the binds map for this cursor if there are any binds.
     if (thisCursor->bindsLine()) {
-    map<unsigned, tmBind *> *binds = thisCursor->binds();
-
-    // Replace all the bind names we find, with the bind value.
-    // I would love to be able to do this by finding the offset and
-    // length of the bind name, at parse time for the SQL, but it
-    // seems either that it is not possible, or my ability to use the STL
-    // is lacking in skill. I suspect the latter!
-    for (map<unsigned, tmBind *>::iterator i = binds->begin();
-         i != binds->end();
-         i++)
-    {
-        string::size_type bindPos = sqlText.find(i->second->bindName());
-        if (bindPos != string::npos) {
-            sqlText.replace(bindPos, i->second->bindName().length(), i->second->bindValue());
-            if (mOptions->verbose()) {
-                *mDbg << "parseEXEC(" << mLineNumber << "): Cursor: " << cursorID << ": Bind #"
-                      << i->second->bindId() << ": Replacing: ["
-                      << i->second->bindName() << "] with ["
-                      << i->second->bindValue() << ']' << endl;
+        // Replace all the bind names we find, with the bind value.
+        tmBind *missing = thisCursor->replaceBinds(sqlText);
+
+        // Log the ones which were replaced.
+        if (Verbosity::enabled) {
+            map<unsigned, tmBind *> *binds = thisCursor->binds();
+            for (map<unsigned, tmBind *>::iterator i = binds->begin();
+                 i != binds->end() && i->second != missing;
+                 i++)
+            {
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_BIND_REPLACING, i->second->bindId())
+                      .span(cursorID).span(i->second->bindName()).span(i->second->bindValue());
             }
-        } else {
+        }
+
+        if (missing) {
             // Hmm. This should never happen!
             stringstream s;
-            s << "parseEXEC(" << mLineNumber << "): Cannot find '" << i->second->bindName() << " in ["
+            s << "parseEXEC(" << mLineNumber << "): Cannot find '" << missing->bindName() << " in ["
               << sqlText << "]." << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
+
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    }
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "parseEXEC(" << mLineNumber << "): Exit." << endl;
+    // And write the replaced SQL to the report file.
+    if (Output::format == OUTPUT_VIEWER) {
+        if (!mViewer->addRow(VIEWER_EXEC, mLineNumber, thisCursor->sqlParseLine(), thisCursor->bindsLine(),
+                             thisCursor->sqlLineNumber(), depth, cursorID, local, sqlText)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_VIEWER_FAILED);
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_SQLITE) {
+        if (!mSQLite->addExec(mLineNumber, thisCursor, stats, local)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_DATABASE_FAILED);
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else {
+        tmExecution execution;
+        execution.line = mLineNumber;
+        execution.parseLine = thisCursor->sqlParseLine();
+        execution.bindsLine = thisCursor->bindsLine();
+        execution.sqlLine = thisCursor->sqlLineNumber();
+        execution.depth = depth;
+        execution.local = local;
+        execution.sqlText = sqlText;
+        execution.waitTime = waitTime;
+        execution.stats = stats;
+        execution.cursor = thisCursor;
+
+        // With --fetches, the row waits until the FETCHes are in, and
+        // the rows after it wait behind it.
+        if (mOptions->fetches()) {
+            mReportRows.push_back(tmReportRow());
+            tmReportRow &row = mReportRows.back();
+            row.isExecution = true;
+            row.waiting = true;
+            row.counted = true;
+            row.execution = execution;
+            mExecutions[thisCursor] = &row;
+
+            if (!writeOverdueRows()) {
+                if (Verbosity::enabled) {
+                    mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+                }
+
+                return false;
+            }
+        } else if (!reportExecution(execution)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
             }
 
             return false;
         }
     }
+
+    // Export to the columnar file too?
+    if (mColumnar) {
+        if (!mColumnar->addExec(mLineNumber, thisCursor, depth, stats)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_COLUMNAR_FAILED);
+                mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
     }
 
-    // And write the replaced SQL to the report file. If there are EXECs
-    // with no PARSE then they have been EXECuted from session cached cursors.
-    // The previous CLOSE for the cursor will be a TYP=1, 2 or 3. Only TYP=0
-    // get a PARSE line.
-    // Likewise, if there is a BINDS line of zero, it has no binds.
-    string parseLineText = std::to_string(thisCursor->sqlParseLine());
-    parseLineText = (parseLineText == "0") ? "From cache" : parseLineText;
+    // Looks like a good parse.
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_EXEC, mLineNumber, DBG_EXIT);
+    }
+
+    TCPROBE_EXEC(mLineNumber, cursorID.c_str(), depth, thisCursor->sqlLineNumber());
+
+    // The report's rows count when they're written, in reportExecution().
+    if (Output::format != OUTPUT_HTML && Output::format != OUTPUT_TEXT) {
+        mExecCount++;
+    }
+
+    return true;
+}
+
+
+/** @brief Writes an EXEC's row to the HTML or TEXT report.
+ *
+ * @param execution tmExecution&. The EXEC, and with --fetches, its FETCHes.
+ * @return bool. Returns true if all ok. False otherwise.
+ *
+ * Starts a new part of a split report, or a new set of headings, first,
+ * if it's time to.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::reportExecution(tmExecution &execution) {
+
+    // Split reports start a new part when this one is big enough.
+    if (mReportIndex && mReportIndex->partFull(mOfs->tellp())) {
+        closeReportPart(false);
+
+        if (!openReportPart()) {
+            return false;
+        }
+    }
 
-    string parseClass = (parseLineText == "From cache") ? "text" : "number" ;
+    // We have a depth <= depth() EXEC with a valid cursor.
+    // Check if we need a fresh set of report headings?
+    if (mExecCount > mOptions->maxExecs()) {
+        // Throw a new set of headings to make reading easier.
+        reportHeadings();
+        mExecCount = 0;
+    }
 
-    string bindsLineText = std::to_string(thisCursor->bindsLine());
-    bindsLineText = (bindsLineText == "0") ?  "No binds" : bindsLineText;
+    // If there are EXECs with no PARSE then they have been EXECuted from
+    // session cached cursors. The previous CLOSE for the cursor will be a
+    // TYP=1, 2 or 3. Only TYP=0 get a PARSE line.
+    // Likewise, if there is a BINDS line of zero, it has no binds.
+    string parseLineText = execution.parseLine ? std::to_string(execution.parseLine) : "From cache";
+    string parseClass = execution.parseLine ? "number" : "text";
 
-    string bindsClass = (bindsLineText == "No binds") ? "text" : "number" ;
+    string bindsLineText = execution.bindsLine ? std::to_string(execution.bindsLine) : "No binds";
+    string bindsClass = execution.bindsLine ? "number" : "text";
 
-    if (!mOptions->html()) {
-        *mOfs << setw(MAXLINENUMBER) << mLineNumber << ' '
+    const tmCallTotals &fetches = execution.fetches;
+
+    if (Output::format == OUTPUT_TEXT) {
+        *mOfs << setw(MAXLINENUMBER) << execution.line << ' '
               << setw(MAXLINENUMBER) << parseLineText << ' '
               << setw(MAXLINENUMBER) << bindsLineText << ' '
-              << setw(MAXLINENUMBER) << thisCursor->sqlLineNumber() << ' '
-              << setw(MAXLINENUMBER) << depth << ' ';
+              << setw(MAXLINENUMBER) << execution.sqlLine << ' '
+              << setw(MAXLINENUMBER) << execution.depth << ' ';
+
+        if (mOptions->waits()) {
+            *mOfs << setw(MAXLINENUMBER) << execution.waitTime << ' ';
+        }
+
+        if (mOptions->fetches()) {
+            *mOfs << setw(MAXLINENUMBER) << fetches.count << ' '
+                  << setw(MAXLINENUMBER) << fetches.rows << ' '
+                  << setw(MAXLINENUMBER) << fetches.elapsed << ' '
+                  << setw(MAXLINENUMBER) << fetches.cpu << ' ';
+        }
 
         if (mIsTraceAdjusted) {
-            *mOfs << setw(27) << local << ' ';
+            *mOfs << setw(27) << execution.local << ' ';
         }
 
-        *mOfs << sqlText << ' '
+        *mOfs << execution.sqlText << ' '
               << endl;
     } else {
-        *mOfs << "<tr><td class=\"number\">" << mLineNumber << "</td>"
+        *mOfs << "<tr><td class=\"number\">" << execution.line << "</td>"
               << "<td class=\"" << parseClass << "\">" << parseLineText << "</td>"
               << "<td class=\"" << bindsClass << "\">" << bindsLineText << "</td>"
-              << "<td class=\"number\">" << thisCursor->sqlLineNumber() << "</td>"
-              << "<td class=\"number\">" << depth << "</td>";
+              << "<td class=\"number\">" << execution.sqlLine << "</td>"
+              << "<td class=\"number\">" << execution.depth << "</td>";
+
+        if (mOptions->waits()) {
+            *mOfs << "<td class=\"number\">" << execution.waitTime << "</td>";
+        }
+
+        if (mOptions->fetches()) {
+            *mOfs << "<td class=\"number\">" << fetches.count << "</td>"
+                  << "<td class=\"number\">" << fetches.rows << "</td>"
+                  << "<td class=\"number\">" << fetches.elapsed << "</td>"
+                  << "<td class=\"number\">" << fetches.cpu << "</td>";
+        }
 
         if (mIsTraceAdjusted) {
             // Force a break between date and time.
-            *mOfs << "<td class=\"text\">" << local.substr(0, 10) << "<br>" << local.substr(12) << "</td>";
+            *mOfs << "<td class=\"text\">" << htmlEscaped(execution.local.substr(0, 10)) << "<br>" << htmlEscaped(execution.local.substr(12)) << "</td>";
         }
 
-        *mOfs << "<td class=\"text\"><pre>" << sqlText << "</pre></td></tr>"
+        *mOfs << "<td class=\"text\"><pre>" << htmlEscaped(execution.sqlText) << "</pre></td></tr>"
               << endl;
     }
 
-    // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parseEXEC(" << mLineNumber << "): Exit." << endl;
+    // Summarise for the split report index?
+    if (mReportIndex) {
+        mReportIndex->addExec(execution.cursor, execution.stats, execution.local);
     }
 
     mExecCount++;
     return true;
 }
 
+
+/** @brief Writes a cursor's EXEC row, if it's waiting for its FETCHes.
+ *
+ * @param cursor tmCursor*. The cursor.
+ * @return bool. Returns true if all ok, or there was nothing to write. False otherwise.
+ *
+ * Called when the cursor's next PARSE, EXEC, ERROR or CLOSE, or a new
+ * PARSING IN CURSOR for its id, finishes the execution. Without
+ * --fetches, there's never anything waiting. The row is written, with
+ * the rows behind it, once the rows in front of it are complete too.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::finishExecution(tmCursor *cursor) {
+
+    if (mExecutions.empty()) {
+        return true;
+    }
+
+    map<tmCursor *, tmReportRow *>::iterator i = mExecutions.find(cursor);
+    if (i == mExecutions.end()) {
+        return true;
+    }
+
+    i->second->execution.fetches = cursor->fetches();
+    i->second->waiting = false;
+    mExecutions.erase(i);
+
+    return writeReportRows();
+}
+
+
+/** @brief Writes every EXEC row still waiting for its FETCHes.
+ *
+ * @return bool. Returns true if all ok. False otherwise.
+ *
+ * At the end of the trace, the executions which are left are complete,
+ * and are written, with the rows behind them, in line order.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::finishExecutions() {
+
+    for (map<tmCursor *, tmReportRow *>::iterator i = mExecutions.begin(); i != mExecutions.end(); ++i) {
+        i->second->execution.fetches = i->first->fetches();
+        i->second->waiting = false;
+    }
+
+    mExecutions.clear();
+    return writeReportRows();
+}
+
+
+/** @brief Writes the waiting report rows, in line order.
+ *
+ * @return bool. Returns true if all ok. False otherwise.
+ *
+ * Rows are written from the front of the queue until one is found which
+ * is still waiting for its FETCHes, so no row is ever written before one
+ * from an earlier line.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::writeReportRows() {
+
+    while (!mReportRows.empty() && !mReportRows.front().waiting) {
+        tmReportRow &row = mReportRows.front();
+
+        if (row.isExecution) {
+            if (!reportExecution(row.execution)) {
+                return false;
+            }
+        } else {
+            *mOfs << row.text;
+            if (row.counted) {
+                mExecCount++;
+            }
+        }
+
+        mReportRows.pop_front();
+    }
+
+    return true;
+}
+
+
+/** @brief Writes the EXEC rows which have waited too long for their FETCHes.
+ *
+ * @return bool. Returns true if all ok, or there was nothing to write. False otherwise.
+ *
+ * Called as each row joins the queue. While more than
+ * FETCHES_MAX_WAITING_ROWS rows are waiting, or the EXEC at the front
+ * is more than FETCHES_MAX_WAITING_LINES lines back, it's written with
+ * the FETCHes so far, and the rows behind it follow. Its cursor's later
+ * FETCHes, and their WAITs, aren't in its row. Without this, a cursor
+ * which is never closed keeps the rest of the report in memory.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::writeOverdueRows() {
+
+    while (!mReportRows.empty() && mReportRows.front().waiting &&
+           (mReportRows.size() > FETCHES_MAX_WAITING_ROWS ||
+            mLineNumber - mReportRows.front().execution.line > FETCHES_MAX_WAITING_LINES)) {
+        tmReportRow &row = mReportRows.front();
+        tmCursor *cursor = row.execution.cursor;
+
+        row.execution.fetches = cursor->fetches();
+        row.waiting = false;
+        mExecutions.erase(cursor);
+
+        if (!writeReportRows()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseEXEC(const string &));
+TMTRACEFILE_INSTANTIATE(bool, reportExecution(tmExecution &));
+TMTRACEFILE_INSTANTIATE(bool, finishExecution(tmCursor *));
+TMTRACEFILE_INSTANTIATE(bool, finishExecutions());
+TMTRACEFILE_INSTANTIATE(bool, writeReportRows());
+TMTRACEFILE_INSTANTIATE(bool, writeOverdueRows());
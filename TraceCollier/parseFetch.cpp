@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file parseFetch.cpp
+ * @brief Implementation file for the tmTraceFile.parseFETCH() function.
+ */
+
+#include "tmtracefile.h"
+#include "gnu.h"
+
+/** @brief Parses a "FETCH" line.
+ *
+ * @param thisLine const string&. The line of text with "FETCH" in.
+ * @return bool. Returns true if all ok. False otherwise.
+ *
+ * Parses a line from the trace file. The line is expected
+ * to be the FETCH \#cursor line.
+ *
+ * FETCH lines are added up for the cursor's current execution, for the
+ * --fetches columns, and passed to a tmEventHandler. Without either, they
+ * are simply skipped over, as they always were, unless --waits needs the
+ * cursor's WAITs so far taken off its next EXEC.
+ * Recursive FETCHes deeper than the requested depth are ignored, as EXECs are.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseFETCH(const string &thisLine) {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_FETCH);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_FETCH);
+
+    if (!mEvents && !mOptions->waits() && !mOptions->fetches()) {
+        return true;
+    }
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_FETCH, mLineNumber, DBG_ENTRY);
+    }
+
+    // FETCH #4155332696:c=0,e=23,p=0,cr=3,cu=0,mis=0,r=1,dep=0,og=1,plh=2403765415,tim=1039827725793
+    tmCallEvent event;
+    event.type = CALL_FETCH;
+    event.line = mLineNumber;
+    event.cursorId = cursorView(thisLine);
+    event.stats.parse(thisLine);
+    event.cursor = NULL;
+
+    // Every call, at any depth, goes to the call tree and onCall().
+    if (mEvents) {
+        addCall(event);
+    }
+
+    if (event.stats.depth() > mOptions->depth()) {
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_FETCH, mLineNumber, DBG_IGNORE_CURSOR).span(event.cursorId.str());
+            mDbg->log(DBG_FETCH, mLineNumber, DBG_EXIT);
+        }
+
+        return true;
+    }
+
+    // The cursor might not have been parsed in this trace.
+    mLookupCursorId.assign(event.cursorId.data(), event.cursorId.length());
+    map<string, tmCursor *>::iterator i = findCursor(mLookupCursorId);
+    if (i != mCursors.end()) {
+        event.cursor = i->second;
+        event.cursor->addFetch(event.stats);
+
+        // The WAITs since the cursor's last call were this FETCH's. With
+        // --fetches, the EXEC's row is still waiting, so they go in its
+        // wait time too, and the fetch phase's reads aren't lost.
+        unsigned long long waitTime = event.cursor->takeWaitTime();
+        if (waitTime && !mExecutions.empty()) {
+            map<tmCursor *, tmReportRow *>::iterator e = mExecutions.find(event.cursor);
+            if (e != mExecutions.end()) {
+                e->second->execution.waitTime += waitTime;
+            }
+        }
+    }
+
+    if (mEvents) {
+        mEvents->onFetch(event);
+    }
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_FETCH, mLineNumber, DBG_EXIT);
+    }
+
+    return true;
+}
+
+
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseFETCH(const string &));
@@ -44,10 +44,17 @@
  * The tmCursor associated with this PARSE is found, and updated to the new
  * source file line number. Only the most recent PARSE is stored for each tmCursor.
  */
-bool tmTraceFile::parsePARSE(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parsePARSE(const string &thisLine) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parsePARSE(" << mLineNumber << "): Entry." << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_PARSE);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_PARSE);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_ENTRY);
     }
 
     // PARSE #5924310096:c=0,e=28,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=4,plh=1388734953,tim=526735705337
@@ -79,25 +86,35 @@ bool tmTraceFile::parsePARSE(const string &thisLine) {
         stringstream s;
         s << "parsePARSE(): Cannot match against PARSE at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parsePARSE(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_EXIT);
         }
 
         return false;
     }
 
+    // Every call, at any depth, goes to the call tree and onCall().
+    tmCallEvent event;
+    if (mEvents) {
+        event.type = CALL_PARSE;
+        event.line = mLineNumber;
+        event.cursorId = cursorID;
+        event.stats.parse(thisLine);
+        addCall(event);
+    }
+
     // We only care about user level SQL, so only depth <= depth().
     // # Issue #10 - we need ALL parsed cursors as they can be cached on
     // close and then exec'd again at a higher depth. Sigh.
     /*
     if (depth > mOptions->depth()) {
         // Ignore this one.
-        if (mOptions->verbose()) {
-            *mDbg << "parsePARSE(): Ignoring PARSE with dep=" << depth << '.' << endl
-                  << "parsePARSE(): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_IGNORE_DEPTH, depth);
+            mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_EXIT);
         }
 
         return true;
@@ -114,29 +131,48 @@ bool tmTraceFile::parsePARSE(const string &thisLine) {
         // i is an iterator to a pair<string, tmCursor *>
         // So i->first is the string.
         // And i->second is the tmCursor pointer.
+        // A new PARSE ends the cursor's previous execution.
+        if (!finishExecution(i->second)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+
         i->second->setSQLParseLine(mLineNumber);
         i->second->setClosed(false);
+
+        // The WAITs so far were this PARSE's, not the next EXEC's.
+        i->second->takeWaitTime();
+
+        if (mEvents) {
+            i->second->setPlanHash(event.stats.planHash());
+            mEvents->onParse(event);
+        }
     } else {
         // Not found. Oh dear!
         stringstream s;
         s << "parsePARSE(" << mLineNumber << "): Found PARSE for cursor " << cursorID
           << " but not found in existing cursor list." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parsePARSE(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_EXIT);
         }
 
         return false;
     }
 
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parsePARSE(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_PARSE, mLineNumber, DBG_EXIT);
     }
 
     return true;
 }
 
 
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parsePARSE(const string &));
@@ -38,12 +38,19 @@
  * Parses a line from the trace file. The line is expected
  * to be the PARSE ERROR \#cursor line.
  */
-bool tmTraceFile::parsePARSEERROR(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parsePARSEERROR(const string &thisLine) {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_PARSE_ERROR);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_PARSE_ERROR);
 
     // PARSE ERROR #4573797608:len=21 dep=0 uid=368 oct=3 lid=368 tim=39554896622951 err=923
 
-    if (mOptions->verbose()) {
-        *mDbg << "parsePARSEERROR(" << mLineNumber << "): Entry." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_ENTRY);
     }
 
     // Grab the first line of the failed SQL.
@@ -68,34 +75,92 @@ bool tmTraceFile::parsePARSEERROR(const string &thisLine) {
     }
 
     // Write the broken line to the report file.
-    if (!mOptions->html()) {
-        *mOfs << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << mLineNumber-1 << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << mLineNumber << ' '
-              << setw(MAXLINENUMBER) << depth << ' '
-              << thisLine << ' '
-              << endl;
-    } else {
-        *mOfs << "<tr><td class=\"number\">" << "&nbsp;" << "</td>"
-              << "<td class=\"number\">" << "&nbsp;" << mLineNumber-1 << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td class=\"number\">" << "&nbsp;" << mLineNumber << "</td>"
-              << "<td class=\"number\">" << depth << "</td>"
-              << "<td class=\"error_text\">" << errorStuff << "<br>"
-              << nextLine << "</td></tr>" << endl;
+    if (mEvents) {
+        tmParseErrorEvent event;
+        event.line = mLineNumber - 1;
+        event.cursorId = cursorView(thisLine);
+        event.depth = depth;
+        event.error = numberValue(thisLine, "err=");
+        event.sqlText = nextLine;
+        mEvents->onParseError(event);
+    }
+
+    if (Output::format == OUTPUT_VIEWER) {
+        if (!mViewer->addRow(VIEWER_PARSE_ERROR, mLineNumber - 1, 0, 0, mLineNumber, depth, "", "",
+                             errorStuff + "\n" + nextLine)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_VIEWER_FAILED);
+                mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_SQLITE) {
+        unsigned errorCode = getDigits(thisLine, "err=", &ok);
+        if (!mSQLite->addParseError(mLineNumber - 1, depth, errorCode, nextLine)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_DATABASE_FAILED);
+                mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_TEXT) {
+        ostream &out = reportRowStream();
+        out << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << mLineNumber-1 << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << mLineNumber << ' '
+            << setw(MAXLINENUMBER) << depth << ' ';
+
+        reportBlankColumns(out);
+
+        out << thisLine << ' '
+            << endl;
+
+        if (!reportRowDone(false)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_HTML) {
+        ostream &out = reportRowStream();
+        out << "<tr><td class=\"number\">" << "&nbsp;" << "</td>"
+            << "<td class=\"number\">" << "&nbsp;" << mLineNumber-1 << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td class=\"number\">" << "&nbsp;" << mLineNumber << "</td>"
+            << "<td class=\"number\">" << depth << "</td>";
+
+        reportBlankColumns(out);
+
+        out << "<td class=\"error_text\">" << htmlEscaped(errorStuff) << "<br>"
+            << htmlEscaped(nextLine) << "</td></tr>" << endl;
+
+        if (!reportRowDone(false)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
     }
 
     // And on the command line.
-    cout << "PARSE ERROR detected at line: " << mLineNumber << endl;
+    if (Output::format != OUTPUT_EVENTS) {
+        mOptions->messages() << "PARSE ERROR detected at line: " << mLineNumber << endl;
+    }
 
 
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parsePARSEERROR(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_ERROR, mLineNumber, DBG_EXIT);
     }
 
     return true;
 }
 
 
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parsePARSEERROR(const string &));
@@ -28,10 +28,7 @@
 
 #include "tmtracefile.h"
 #include "gnu.h"
-
-#ifndef USE_REGEX
-    #include "utilities.h"
-#endif
+#include "utilities.h"
 
 
 /** @brief Parses a "PARSING IN CURSOR" line.
@@ -49,10 +46,17 @@
  *
  * Returns true if all ok. False otherwise.
  */
-bool tmTraceFile::parsePARSING(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parsePARSING(const string &thisLine) {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_PARSING);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_PARSING);
 
-    if (mOptions->verbose()) {
-        *mDbg << "parsePARSING(" << mLineNumber << "): Entry." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSING, mLineNumber, DBG_ENTRY);
     }
 
     // PARSING IN CURSOR #4572676384 len=229 dep=1 ...
@@ -60,7 +64,7 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
     bool matchOk = true;
     string cursorID = "";
     unsigned sqlLength = 0;
-    //unsigned depth = 0;       // Removed for Issue 10.
+    unsigned depth = 0;         // Removed for Issue 10. Back for the SQLite cursors table.
     unsigned commandType = 0;
 
     // The SQL starts on the following line, not this one!
@@ -74,7 +78,7 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
     if (regex_match(thisLine, match, reg)) {
         cursorID = match[1];
         sqlLength = stoul(match[2], NULL, 10);
-        //depth = stoul(match[3], NULL, 10);        // Removed for Issue 10.
+        depth = stoul(match[3], NULL, 10);
         commandType = stoul(match[4], NULL, 10);
     } else {
         matchOk = false;
@@ -84,10 +88,10 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
     if (matchOk) {
         sqlLength = getDigits(thisLine, "len=", &matchOk);
         if (matchOk) {
-            //depth = getDigits(thisLine, "dep=", &matchOk);  // Removed - Issue 10
-            //if (matchOk) {
+            depth = getDigits(thisLine, "dep=", &matchOk);
+            if (matchOk) {
                 commandType = getDigits(thisLine, "oct=", &matchOk);
-            //}
+            }
         }
     }
 #endif // USE_REGEX
@@ -97,11 +101,11 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
         stringstream s;
         s << "parsePARSING(): Cannot match against PARSING IN CURSOR at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str() << endl
-                  << "parsePARSING(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSING, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_PARSING, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -112,24 +116,24 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
     /*
     if (depth > mOptions->depth()) {
         // Ignore this one.
-        if (mOptions->verbose()) {
-            *mDbg << "parsePARSING(): Ignoring PARSING IN CURSOR with dep=" << depth << '.' << endl
-                  << "parsePARSING(): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSING, mLineNumber, DBG_IGNORE_DEPTH, depth);
+            mDbg->log(DBG_PARSING, mLineNumber, DBG_EXIT);
         }
 
         return true;
     }
     */
 
-    tmCursor *thisCursor = new tmCursor(cursorID, sqlLength, sqlLine);
+    tmCursor *thisCursor = new tmCursor(cursorID, sqlLength, sqlLine, mOptions->diagnostics());
     if (!thisCursor) {
         stringstream s;
         s << "parsePARSING(): Cannot allocate a new tmCursor." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parsePARSING(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSING, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_PARSING, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -138,10 +142,13 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
     // Set the command type for later use.
     thisCursor->setCommandType(commandType);
 
-    // Tell the world, unless we are running quietly.
-    if (!mOptions->quiet()) {
-        cout << "Cursor: " << thisCursor->cursorId()
-             << " created at line: " << thisCursor->sqlLineNumber() << endl;
+    // 11g onwards tells us the sqlid too.
+    string sqlId = getSqlId(thisLine);
+
+    // Tell the world, unless we are running quietly, or for a handler.
+    if (Output::format != OUTPUT_EVENTS && !mOptions->quiet()) {
+        mOptions->messages() << "Cursor: " << thisCursor->cursorId()
+                             << " created at line: " << thisCursor->sqlLineNumber() << endl;
     }
 
     // Extract the SQL Text into a stream. This handles end of line for us.
@@ -185,6 +192,17 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
         // Update existing cursor details. Only the
         // SQL details will have changed. At the moment.
         // And we have not yet parsed this SQL text.
+        // The old statement's last execution is over too.
+        if (!finishExecution(exists.first->second)) {
+            delete thisCursor;
+
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSING, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+
         exists.first->second->setSQLLineNumber(sqlLine);
         exists.first->second->setSQLLength(sqlLength);
         exists.first->second->setSQLParseLine(0);
@@ -195,21 +213,61 @@ bool tmTraceFile::parsePARSING(const string &thisLine) {
         delete thisCursor;
     }
 
+    if (exists.second) {
+        TCPROBE_CURSOR_CREATED(mLineNumber, cursorID.c_str(), sqlLength, sqlLine);
+    } else {
+        TCPROBE_CURSOR_REPARSED(mLineNumber, cursorID.c_str(), sqlLength, sqlLine);
+    }
+
+    if (mStats) {
+        mStats->sqlBlock(sqlLength, sqlLine);
+        mStats->cursors(mCursors.size());
+    }
+
     // Then set the SQL Text, regardless.
     // ISSUE 5: This will now only scan for binds up to any
     // RETURNING clause.
     exists.first->second->setSQLText(ss.str());
+    exists.first->second->setSQLId(sqlId);
+
+    // The event handler gets every cursor too.
+    if (mEvents) {
+        tmCursorParsedEvent event;
+        event.line = sqlLine - 1;
+        event.cursorId = cursorID;
+        event.depth = depth;
+        event.sqlLength = sqlLength;
+        event.commandType = commandType;
+        event.sqlId = sqlId;
+        event.cursor = exists.first->second;
+        mEvents->onCursorParsed(event);
+    }
+
+    // Database output needs every cursor.
+    if (Output::format == OUTPUT_SQLITE) {
+        if (!mSQLite->addCursor(exists.first->second, depth)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSING, mLineNumber, DBG_DATABASE_FAILED);
+                mDbg->log(DBG_PARSING, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    }
 
     // Verbose?
-    if (mOptions->verbose()) {
-        *mDbg << endl << "parsePARSING(" << mLineNumber << "): "
-              << (exists.second ? "Creating" : "ReCreating") << " Cursor: "
-              << exists.first->first << endl
-              << *(exists.first->second)
-              << "parsePARSING(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        tmCursor *cursor = exists.first->second;
+        mDbg->log(DBG_PARSING, mLineNumber, exists.second ? DBG_CURSOR_CREATED : DBG_CURSOR_RECREATED,
+                  cursor->sqlLineNumber(), cursor->sqlLength(), cursor->bindCount())
+            .span(exists.first->first);
+        mDbg->log(DBG_PARSING, mLineNumber, DBG_EXIT);
     }
 
     return true;
 
 }
 
+
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parsePARSING(const string &));
@@ -43,11 +43,21 @@
  *
  * The tmCursor associated with this STAT is found, and the closed flag updated.
  * This is done because some cursors don't have a CLOSE after the various STATs.
+ *
+ * An event handler gets the row source's figures, and the plh= of the
+ * cursor's latest PARSE or EXEC, as the STAT lines don't have it.
  */
-bool tmTraceFile::parseSTAT(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseSTAT(const string &thisLine) {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_STAT);
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseSTAT(" << mLineNumber << "): Entry." << endl;
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_STAT);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_STAT, mLineNumber, DBG_ENTRY);
     }
 
     // STAT #3074753576 id=1 ...
@@ -73,11 +83,11 @@ bool tmTraceFile::parseSTAT(const string &thisLine) {
         stringstream s;
         s << "parseSTAT(): Cannot match against STAT at line: "
           <<  mLineNumber << "." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseSTAT(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_STAT, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_STAT, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -88,8 +98,9 @@ bool tmTraceFile::parseSTAT(const string &thisLine) {
 
     // Not found? Don't care.
     if (i == mCursors.end()) {
-        if (mOptions->verbose()) {
-            *mDbg << "parseSTAT(" << mLineNumber << "): CursorID: " << cursorID << " - Not found. Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_STAT, mLineNumber, DBG_CURSOR_NOT_FOUND).span(cursorID);
+            mDbg->log(DBG_STAT, mLineNumber, DBG_EXIT);
         }
 
         return true;
@@ -100,16 +111,37 @@ bool tmTraceFile::parseSTAT(const string &thisLine) {
         i->second->setClosed(true);
     }
 
+    if (mEvents) {
+        tmStatEvent event;
+        event.line = mLineNumber;
+        event.cursorId = cursorID;
+        event.id = numberValue(thisLine, " id=");
+        event.rows = numberValue(thisLine, " cnt=");
+        event.parentId = numberValue(thisLine, " pid=");
+        event.position = numberValue(thisLine, " pos=");
+        event.objectId = numberValue(thisLine, " obj=");
+        event.operation = valueView(thisLine, " op=");
+        event.consistentReads = numberValue(thisLine, "(cr=");
+        event.physicalReads = numberValue(thisLine, " pr=");
+        event.physicalWrites = numberValue(thisLine, " pw=");
+        event.time = numberValue(thisLine, " time=");
+        event.cost = numberValue(thisLine, " cost=");
+        event.size = numberValue(thisLine, " size=");
+        event.cardinality = numberValue(thisLine, " card=");
+        event.planHash = i->second->planHash();
+        event.cursor = i->second;
+        mEvents->onStat(event);
+    }
+
     // Looks like a good stat.
-    if (mOptions->verbose()) {
-        *mDbg << "parseSTAT(" << mLineNumber << "): CursorID: "
-              << cursorID << " - now/already closed." << endl
-              << "parseSTAT(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_STAT, mLineNumber, DBG_CURSOR_CLOSED).span(cursorID);
+        mDbg->log(DBG_STAT, mLineNumber, DBG_EXIT);
     }
 
     return true;
 }
 
 
-
-
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseSTAT(const string &));
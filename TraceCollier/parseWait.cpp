@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file parseWait.cpp
+ * @brief Implementation file for the tmTraceFile.parseWAIT() function.
+ */
+
+#include "tmtracefile.h"
+#include "gnu.h"
+
+/** @brief Parses a "WAIT" line.
+ *
+ * @param thisLine const string&. The line of text with "WAIT" in.
+ * @return bool. Returns true if all ok. False otherwise.
+ *
+ * Parses a line from the trace file. The line is expected
+ * to be the WAIT \#cursor line.
+ *
+ * WAIT lines are only needed by a tmEventHandler, or for the wait column
+ * of --waits. Without either, they are simply skipped over, as they always
+ * were. WAITs have no dep=, so they are passed on whatever the depth.
+ *
+ * Nothing is allocated for a WAIT. The name and parameters are views of
+ * the line, and the cursor id is looked up with a string kept for it.
+ * A cursor's waits are added up until its next PARSE, EXEC or FETCH, as
+ * Oracle writes a call's WAITs before the call itself.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseWAIT(const string &thisLine) {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_WAIT);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_WAIT);
+
+    if (!mEvents && !mOptions->waits()) {
+        return true;
+    }
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_WAIT, mLineNumber, DBG_ENTRY);
+    }
+
+    // WAIT #4155332696: nam='db file sequential read' ela= 301 file#=4 block#=1234 blocks=1 obj#=5678 tim=1039827725793
+    tmWaitEvent event;
+    event.line = mLineNumber;
+    event.cursorId = cursorView(thisLine);
+    event.name = valueView(thisLine, "nam=");
+    event.elapsed = numberValue(thisLine, "ela=");
+    event.tim = 0;
+    event.object = -1;
+    event.cursor = NULL;
+
+    // The parameters are whatever lies between the ela= value and the tim=.
+    // Oracle 9i has p1=, p2= and p3= instead. Both are passed on as is.
+    string::size_type elaPos = thisLine.find("ela=");
+    if (elaPos != string::npos) {
+        string::size_type startPos = thisLine.find_first_not_of(' ', elaPos + 4);
+        if (startPos != string::npos) {
+            startPos = thisLine.find(' ', startPos);
+        }
+
+        if (startPos != string::npos) {
+            startPos++;
+            string::size_type timPos = thisLine.find(" tim=", startPos - 1);
+            string::size_type stopPos = (timPos == string::npos) ? thisLine.length() : timPos;
+            if (timPos != string::npos) {
+                event.tim = numberValue(thisLine, " tim=");
+            }
+
+            if (stopPos > startPos) {
+                event.parameters = tmView(thisLine.data() + startPos, stopPos - startPos);
+            }
+        }
+    }
+
+    // obj#= is -1 when the wait isn't for an object.
+    string::size_type objPos = thisLine.find(" obj#=");
+    if (objPos != string::npos && thisLine[objPos + 6] != '-') {
+        event.object = numberValue(thisLine, " obj#=");
+    }
+
+    // Waits on cursor #0 belong to no cursor at all. The id's string
+    // keeps its capacity, so isn't reallocated for every WAIT.
+    mLookupCursorId.assign(event.cursorId.data(), event.cursorId.length());
+    map<string, tmCursor *>::iterator i = findCursor(mLookupCursorId);
+    if (i != mCursors.end()) {
+        event.cursor = i->second;
+        event.cursor->addWaitTime(event.elapsed);
+    }
+
+    if (mEvents) {
+        mEvents->onWait(event);
+    }
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_WAIT, mLineNumber, DBG_EXIT);
+    }
+
+    return true;
+}
+
+
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseWAIT(const string &));
@@ -42,10 +42,17 @@
  * to be the XCTEND line indicating COMMIT or ROLLBACK.
  * It should be noted that this line has no cursor ID.
  */
-bool tmTraceFile::parseXCTEND(const string &thisLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseXCTEND(const string &thisLine) {
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseXCTEND(" << mLineNumber << "): Entry." << endl;
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_XCTEND);
+
+    // For any USDT tracer.
+    TCPROBE_RECORD(mLineNumber, STAGE_XCTEND);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_XCTEND, mLineNumber, DBG_ENTRY);
     }
 
     // XCTEND rlbk=0, rd_only=0, tim=524545341395
@@ -79,42 +86,101 @@ bool tmTraceFile::parseXCTEND(const string &thisLine) {
         stringstream s;
         s << "parseXCTEND(): Cannot match XCTEND at line: "
           <<  mLineNumber << " - Trace file corrupt?" << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseXCTEND(" << mLineNumber << "): Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_XCTEND, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_XCTEND, mLineNumber, DBG_EXIT);
         }
 
         return false;
     }
 
-    if (!mOptions->html()) {
-        *mOfs << setw(MAXLINENUMBER) << mLineNumber << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << setw(MAXLINENUMBER) << ' ' << ' '
-              << (rollBack ? "ROLLBACK " : "COMMIT ")
-              << (readOnly ? "(Read Only)" : "(Read Write)") << endl;
-    } else {
-        *mOfs << "<tr><td class=\"number\">" << mLineNumber << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td>" << "&nbsp;" << "</td>"
-              << "<td>" << "&nbsp;" << "</td><td class=\"text\"><pre>"
-              << (rollBack ? "ROLLBACK " : "COMMIT ")
-              << (readOnly ? "(Read Only)" : "(Read Write)")
-              << "</pre></td></tr>" << endl;
+    if (mEvents) {
+        tmXctendEvent event;
+        event.line = mLineNumber;
+        event.rollback = rollBack != 0;
+        event.readOnly = readOnly != 0;
+        event.tim = numberValue(thisLine, "tim=");
+        mEvents->onXctend(event);
+    }
+
+    if (Output::format == OUTPUT_VIEWER) {
+        string xctend = string(rollBack ? "ROLLBACK " : "COMMIT ") + (readOnly ? "(Read Only)" : "(Read Write)");
+        if (!mViewer->addRow(VIEWER_XCTEND, mLineNumber, 0, 0, 0, -1, "", "", xctend)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_XCTEND, mLineNumber, DBG_VIEWER_FAILED);
+                mDbg->log(DBG_XCTEND, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_SQLITE) {
+        if (!mSQLite->addTransaction(mLineNumber, rollBack, readOnly)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_XCTEND, mLineNumber, DBG_DATABASE_FAILED);
+                mDbg->log(DBG_XCTEND, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_TEXT) {
+        ostream &out = reportRowStream();
+        out << setw(MAXLINENUMBER) << mLineNumber << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' '
+            << setw(MAXLINENUMBER) << ' ' << ' ';
+
+        reportBlankColumns(out);
+
+        out << (rollBack ? "ROLLBACK " : "COMMIT ")
+            << (readOnly ? "(Read Only)" : "(Read Write)") << endl;
+
+        if (!reportRowDone(true)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_XCTEND, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
+    } else if (Output::format == OUTPUT_HTML) {
+        ostream &out = reportRowStream();
+        out << "<tr><td class=\"number\">" << mLineNumber << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td>" << "&nbsp;" << "</td>"
+            << "<td>" << "&nbsp;" << "</td>";
+
+        reportBlankColumns(out);
+
+        out << "<td class=\"text\"><pre>"
+            << (rollBack ? "ROLLBACK " : "COMMIT ")
+            << (readOnly ? "(Read Only)" : "(Read Write)")
+            << "</pre></td></tr>" << endl;
+
+        if (!reportRowDone(true)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_XCTEND, mLineNumber, DBG_EXIT);
+            }
+
+            return false;
+        }
     }
 
     // Looks like a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parseXCTEND(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_XCTEND, mLineNumber, DBG_EXIT);
     }
 
-    // Increment  the EXEC count for a COMMIT or ROLLBACK.
-    mExecCount++;
+    // Increment  the EXEC count for a COMMIT or ROLLBACK. A report row
+    // counts when it's written, in reportRowDone(), as it might wait.
+    if (Output::format != OUTPUT_HTML && Output::format != OUTPUT_TEXT) {
+        mExecCount++;
+    }
     return true;
 }
 
+
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(bool, parseXCTEND(const string &));
@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file tmallocstats.cpp
+ * @brief Replacement global operator new and delete, which count heap
+ * allocations per parser stage.
+ *
+ * Only built in when compiled with USE_ALLOC_STATS, which is what
+ * "make -f makefile.gnu ALLOCSTATS=1" does. Every allocation, and its size,
+ * is charged to the stage that tmStageTimer last made current, using the
+ * same stages as --stats. Frees are charged to the stage doing the freeing.
+ * At exit, the stages are listed on stderr, most allocations first.
+ *
+ * The counters are not thread safe, nor do they need to be, yet.
+ */
+
+#ifdef USE_ALLOC_STATS
+
+#include "tmstats.h"
+
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+
+
+// Allocations before the first tmStageTimer are start up costs.
+tmStage allocStage = STAGE_SETUP;
+uint64_t allocStageCalls[STAGE_COUNT];
+
+// Internal use only. The counters, per stage.
+static uint64_t allocCount[STAGE_COUNT];
+static uint64_t allocBytes[STAGE_COUNT];
+static uint64_t allocLargest[STAGE_COUNT];
+static uint64_t freeCount[STAGE_COUNT];
+
+
+// Internal use only. All the flavours of new come here.
+static void *allocate(size_t size) {
+    // Zero byte allocations must still return a unique pointer.
+    void *p = malloc(size ? size : 1);
+
+    if (p) {
+        allocCount[allocStage]++;
+        allocBytes[allocStage] += size;
+        if (size > allocLargest[allocStage]) {
+            allocLargest[allocStage] = size;
+        }
+    }
+
+    return p;
+}
+
+
+// Internal use only. All the flavours of delete come here.
+static void deallocate(void *p) {
+    if (p) {
+        freeCount[allocStage]++;
+        free(p);
+    }
+}
+
+
+void *operator new(size_t size) {
+    void *p = allocate(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void *p) noexcept {
+    deallocate(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    deallocate(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    deallocate(p);
+}
+
+
+/** @brief Writes the allocation figures to stderr at exit.
+ *
+ * A static object, so its destructor runs after main() returns. It uses
+ * stdio, not iostreams, as cerr may have gone by then, and so that writing
+ * the report doesn't allocate anything itself.
+ */
+static class tmAllocReport
+{
+    public:
+        ~tmAllocReport() {
+            // Sort the stages, most allocations first. There are only
+            // a handful, so an insertion sort will do.
+            int order[STAGE_COUNT];
+            int used = 0;
+            for (int stage = 0; stage < STAGE_COUNT; stage++) {
+                if (!allocCount[stage] && !freeCount[stage]) {
+                    continue;
+                }
+
+                int i = used++;
+                while (i > 0 && allocCount[order[i - 1]] < allocCount[stage]) {
+                    order[i] = order[i - 1];
+                    i--;
+                }
+                order[i] = stage;
+            }
+
+            uint64_t totalCount = 0;
+            uint64_t totalBytes = 0;
+            uint64_t totalFrees = 0;
+
+            fprintf(stderr, "\nHeap allocations by stage:\n\n");
+            fprintf(stderr, "%-12s %10s %12s %10s %14s %10s %10s %12s\n",
+                    "Stage", "Calls", "Allocs", "Per call",
+                    "Bytes", "Per call", "Largest", "Frees");
+
+            for (int i = 0; i < used; i++) {
+                int stage = order[i];
+                uint64_t calls = allocStageCalls[stage];
+
+                fprintf(stderr, "%-12s %10llu %12llu %10.1f %14llu %10.1f %10llu %12llu\n",
+                        stageName(tmStage(stage)),
+                        (unsigned long long)calls,
+                        (unsigned long long)allocCount[stage],
+                        calls ? double(allocCount[stage]) / calls : 0.0,
+                        (unsigned long long)allocBytes[stage],
+                        calls ? double(allocBytes[stage]) / calls : 0.0,
+                        (unsigned long long)allocLargest[stage],
+                        (unsigned long long)freeCount[stage]);
+
+                totalCount += allocCount[stage];
+                totalBytes += allocBytes[stage];
+                totalFrees += freeCount[stage];
+            }
+
+            fprintf(stderr, "%-12s %10s %12llu %10s %14llu %10s %10s %12llu\n",
+                    "Total", "",
+                    (unsigned long long)totalCount, "",
+                    (unsigned long long)totalBytes, "", "",
+                    (unsigned long long)totalFrees);
+
+            // Static objects destroyed after us may still free things.
+            fprintf(stderr, "\nNot yet freed at exit: %llu allocations.\n",
+                    (unsigned long long)(totalCount - totalFrees));
+        }
+} allocReport;
+
+#endif // USE_ALLOC_STATS
@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmcallstats.h"
+
+/** @file tmcallstats.cpp
+ * @brief Implementation file for the tmCallStats object.
+ */
+
+
+/** @brief Constructor for a tmCallStats object.
+ */
+tmCallStats::tmCallStats()
+{
+    clear();
+}
+
+
+/** @brief Resets all the figures to zero.
+ */
+void tmCallStats::clear()
+{
+    mCpu = 0;
+    mElapsed = 0;
+    mPhysicalReads = 0;
+    mConsistentReads = 0;
+    mCurrentReads = 0;
+    mMisses = 0;
+    mRows = 0;
+    mDepth = 0;
+    mOptimizerGoal = 0;
+    mPlanHash = 0;
+    mTim = 0;
+}
+
+
+/** @brief Extracts the resource usage figures from a trace line.
+ *
+ * @param thisLine const string&. A PARSE, EXEC, FETCH or CLOSE line from the trace file.
+ * @return bool. True if the line had a colon, and so, some figures. False otherwise.
+ *
+ * This is a single pass over the line, no substr() and no stoul(), as it gets
+ * called for every EXEC (and later, every FETCH) in the trace. Unknown names are
+ * skipped, so CLOSE's "type=" and TraceAdjust's "local='...'" do no harm. We stop
+ * at the first value not followed by a comma.
+ */
+bool tmCallStats::parse(const string &thisLine)
+{
+    clear();
+
+    string::size_type colonPos = thisLine.find(':');
+    if (colonPos == string::npos) {
+        return false;
+    }
+
+    const char *p = thisLine.c_str() + colonPos + 1;
+
+    while (*p) {
+        // The name runs up to the '='.
+        const char *name = p;
+        while (*p && *p != '=') {
+            p++;
+        }
+
+        if (!*p) {
+            break;
+        }
+
+        string::size_type nameLength = p - name;
+        p++;
+
+        // Then we have the digits.
+        unsigned long long value = 0;
+        while (*p >= '0' && *p <= '9') {
+            value = (value * 10) + (*p - '0');
+            p++;
+        }
+
+        // Which one did we get?
+        switch (nameLength) {
+            case 1:
+                switch (name[0]) {
+                    case 'c': mCpu = value; break;
+                    case 'e': mElapsed = value; break;
+                    case 'p': mPhysicalReads = value; break;
+                    case 'r': mRows = value; break;
+                }
+                break;
+
+            case 2:
+                if (name[0] == 'c' && name[1] == 'r') {
+                    mConsistentReads = value;
+                } else if (name[0] == 'c' && name[1] == 'u') {
+                    mCurrentReads = value;
+                } else if (name[0] == 'o' && name[1] == 'g') {
+                    mOptimizerGoal = value;
+                }
+                break;
+
+            case 3:
+                if (name[0] == 'm' && name[1] == 'i' && name[2] == 's') {
+                    mMisses = value;
+                } else if (name[0] == 'd' && name[1] == 'e' && name[2] == 'p') {
+                    mDepth = value;
+                } else if (name[0] == 'p' && name[1] == 'l' && name[2] == 'h') {
+                    mPlanHash = value;
+                } else if (name[0] == 't' && name[1] == 'i' && name[2] == 'm') {
+                    mTim = value;
+                }
+                break;
+        }
+
+        // Another one?
+        if (*p != ',') {
+            break;
+        }
+
+        p++;
+    }
+
+    return true;
+}
+
+
+/** @brief Adds one call's figures to the totals.
+ *
+ * @param stats const tmCallStats&. The PARSE, EXEC or FETCH figures.
+ */
+void tmCallTotals::add(const tmCallStats &stats)
+{
+    count++;
+    cpu += stats.cpu();
+    elapsed += stats.elapsed();
+    disk += stats.physicalReads();
+    query += stats.consistentReads();
+    current += stats.currentReads();
+    rows += stats.rows();
+    misses += stats.misses();
+}
+
+
+/** @brief Adds another set of totals to these.
+ *
+ * @param totals const tmCallTotals&. The totals to add.
+ */
+void tmCallTotals::add(const tmCallTotals &totals)
+{
+    count += totals.count;
+    cpu += totals.cpu;
+    elapsed += totals.elapsed;
+    disk += totals.disk;
+    query += totals.query;
+    current += totals.current;
+    rows += totals.rows;
+    misses += totals.misses;
+}
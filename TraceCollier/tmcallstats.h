@@ -0,0 +1,107 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMCALLSTATS_H
+#define TMCALLSTATS_H
+
+/** @file tmcallstats.h
+ * @brief Header file for the tmCallStats object.
+ */
+
+#include <string>
+
+using std::string;
+
+/** @brief A class representing the resource usage figures on a PARSE, EXEC,
+ *         FETCH or CLOSE line in an Oracle trace file.
+ *
+ * Oracle writes these as a comma separated list of "name=value" pairs, after
+ * the colon which follows the cursor id:
+ *
+ * @code
+ * EXEC #5924310096:c=0,e=31,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=4,plh=1388734953,tim=526735705392
+ * @endcode
+ *
+ * Anything not present on the line is left at zero.
+ */
+class tmCallStats
+{
+    public:
+        tmCallStats();
+
+        // Getters.
+        unsigned long long cpu() const { return mCpu; }                     /**< Returns the CPU time, c=, in microseconds. */
+        unsigned long long elapsed() const { return mElapsed; }             /**< Returns the elapsed time, e=, in microseconds. */
+        unsigned long long physicalReads() const { return mPhysicalReads; } /**< Returns the physical reads, p=. */
+        unsigned long long consistentReads() const { return mConsistentReads; } /**< Returns the consistent mode gets, cr=. */
+        unsigned long long currentReads() const { return mCurrentReads; }   /**< Returns the current mode gets, cu=. */
+        unsigned long long misses() const { return mMisses; }               /**< Returns the library cache misses, mis=. */
+        unsigned long long rows() const { return mRows; }                   /**< Returns the rows processed, r=. */
+        unsigned depth() const { return mDepth; }                           /**< Returns the recursive depth, dep=. */
+        unsigned optimizerGoal() const { return mOptimizerGoal; }           /**< Returns the optimizer goal, og=. */
+        unsigned long long planHash() const { return mPlanHash; }           /**< Returns the plan hash value, plh=. */
+        unsigned long long tim() const { return mTim; }                     /**< Returns the timestamp, tim=, in microseconds. */
+
+        // Other useful stuff.
+        bool parse(const string &thisLine);     /**< Extracts the figures from a trace line. */
+        void clear();                           /**< Resets all the figures to zero. */
+
+    protected:
+
+    private:
+        unsigned long long mCpu;                /**< CPU time used, c=. */
+        unsigned long long mElapsed;            /**< Elapsed time, e=. */
+        unsigned long long mPhysicalReads;      /**< Physical reads, p=. */
+        unsigned long long mConsistentReads;    /**< Consistent mode gets, cr=. */
+        unsigned long long mCurrentReads;       /**< Current mode gets, cu=. */
+        unsigned long long mMisses;             /**< Library cache misses, mis=. */
+        unsigned long long mRows;               /**< Rows processed, r=. */
+        unsigned mDepth;                        /**< Recursive depth, dep=. */
+        unsigned mOptimizerGoal;                /**< Optimizer goal, og=. */
+        unsigned long long mPlanHash;           /**< Plan hash value, plh=. */
+        unsigned long long mTim;                /**< Timestamp, tim=. */
+};
+
+/** @brief Totals for one type of call, PARSE, EXEC or FETCH, of a statement
+ *         or an execution.
+ */
+struct tmCallTotals
+{
+    unsigned long long count;           /**< How many calls. */
+    unsigned long long cpu;             /**< Total c=. */
+    unsigned long long elapsed;         /**< Total e=. */
+    unsigned long long disk;            /**< Total p=. */
+    unsigned long long query;           /**< Total cr=. */
+    unsigned long long current;         /**< Total cu=. */
+    unsigned long long rows;            /**< Total r=. */
+    unsigned long long misses;          /**< Total mis=. */
+
+    tmCallTotals() : count(0), cpu(0), elapsed(0), disk(0), query(0),
+                     current(0), rows(0), misses(0) {}
+
+    void add(const tmCallStats &stats);         /**< Adds one call's figures. */
+    void add(const tmCallTotals &totals);       /**< Adds another set of totals. */
+};
+
+#endif // TMCALLSTATS_H
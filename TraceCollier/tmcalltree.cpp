@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmcalltree.h"
+
+/** @file tmcalltree.cpp
+ * @brief Implementation file for the tmCallTree object.
+ */
+
+/** @brief Constructor for a tmCallTree object.
+ */
+tmCallTree::tmCallTree()
+{
+}
+
+
+/** @brief Adds a PARSE, EXEC, FETCH or CLOSE, of any depth.
+ *
+ * @param stats const tmCallStats&. The call's figures.
+ * @param recursive tmCallTotals&. Set to the totals of the calls, one depth
+ *        down, which this call made. They're already included in its own
+ *        figures, so its exclusive time is its e= less their e=.
+ *
+ * Calls must be added in the order they are in the trace. The call itself
+ * then waits for the next call at the depth above to end, unless it's at
+ * dep=0.
+ */
+void tmCallTree::call(const tmCallStats &stats, tmCallTotals &recursive)
+{
+    unsigned depth = stats.depth();
+    recursive = tmCallTotals();
+
+    if (mLevels.size() < depth + 2) {
+        mLevels.resize(depth + 2);
+    }
+
+    // The calls waiting one depth down are this call's, if they ended
+    // after it started. Traces without tim= have no start times, so they
+    // are always this call's.
+    vector<tmCallRun> &below = mLevels[depth + 1];
+    if (!below.empty()) {
+        unsigned long long started = 0;
+        if (stats.tim() > stats.elapsed()) {
+            started = stats.tim() - stats.elapsed();
+        }
+
+        for (vector<tmCallRun>::const_iterator r = below.begin(); r != below.end(); ++r) {
+            if (r->lastTim >= started) {
+                recursive.add(r->totals);
+            }
+        }
+
+        below.clear();
+    }
+
+    // Anything deeper missed the call which made it.
+    for (unsigned x = depth + 2; x < mLevels.size(); x++) {
+        mLevels[x].clear();
+    }
+
+    if (!depth) {
+        return;
+    }
+
+    // Too many waiting? Keep the newer half as one.
+    vector<tmCallRun> &runs = mLevels[depth];
+    if (runs.size() >= maxRuns) {
+        vector<tmCallRun>::iterator half = runs.begin() + maxRuns / 2;
+        for (vector<tmCallRun>::iterator r = half + 1; r != runs.end(); ++r) {
+            half->totals.add(r->totals);
+        }
+
+        half->lastTim = runs.back().lastTim;
+        runs.erase(half + 1, runs.end());
+    }
+
+    tmCallRun run;
+    run.totals.add(stats);
+    run.lastTim = stats.tim();
+    runs.push_back(run);
+}
+
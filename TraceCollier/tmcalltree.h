@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMCALLTREE_H
+#define TMCALLTREE_H
+
+/** @file tmcalltree.h
+ * @brief Header file for the tmCallTree object.
+ */
+
+#include <vector>
+
+#include "tmcallstats.h"
+
+using std::vector;
+
+/** @brief Works out which recursive calls were made by which call.
+ *
+ * Oracle writes a call's line when the call ends, so the recursive SQL
+ * run by a dep=0 EXEC, at dep=1, is in the trace before the EXEC itself,
+ * and the dep=2 SQL run by that before the dep=1 calls, and so on. Each
+ * call's c=, e=, p=, cr= and cu= already include those of its recursive
+ * calls, but nothing says which calls they were.
+ *
+ * So the calls at each depth wait until the next call at the depth
+ * above ends, and those which ended after it started become its
+ * recursive calls. A call runs from tim= less e= to tim=, so any which
+ * ended before it started weren't made by it. They were made outside any
+ * call in the trace, by a trigger on logon, say, or by a call which
+ * started before the trace did, and are left out. So are deeper calls
+ * left over when the depth above theirs has ended without them.
+ *
+ * Once maxRuns calls are waiting at one depth, all but the oldest half
+ * are added together and kept as one, so a PL/SQL call which runs
+ * millions of statements uses no more memory than one which runs a few
+ * hundred. The calls left over from before a call started are the oldest
+ * waiting, so only with hundreds of them could it be given some.
+ */
+class tmCallTree
+{
+    public:
+        tmCallTree();
+
+        // Other useful stuff.
+        void call(const tmCallStats &stats, tmCallTotals &recursive);   /**< Adds a call, and returns the totals of its recursive calls. */
+
+    protected:
+
+    private:
+        /** @brief One or more calls at one depth, waiting for the call above them to end. */
+        struct tmCallRun {
+            tmCallTotals totals;                /**< Their figures, added up. */
+            unsigned long long lastTim;         /**< tim= of the latest one. */
+        };
+
+        static const unsigned maxRuns = 1024;   /**< Most calls kept apart at one depth. */
+
+        vector<vector<tmCallRun> > mLevels;     /**< The calls waiting at each depth, by dep=, oldest first. */
+};
+
+#endif // TMCALLTREE_H
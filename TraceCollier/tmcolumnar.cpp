@@ -0,0 +1,692 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmcolumnar.h"
+
+#include <iostream>
+#include <utility>
+
+using std::endl;
+using std::pair;
+using std::make_pair;
+
+/** @file tmcolumnar.cpp
+ * @brief Implementation file for the tmColumnar object.
+ */
+
+
+// Internal use only. Append little endian values to a message body.
+static void putU32(string &buffer, unsigned value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        buffer.push_back((value >> shift) & 0xff);
+    }
+}
+
+static void putU64(string &buffer, unsigned long long value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        buffer.push_back((value >> shift) & 0xff);
+    }
+}
+
+
+// Internal use only. The Arrow type and message header numbers we need,
+// from Schema.fbs and Message.fbs.
+const unsigned char ARROW_TYPE_INT = 2;
+const unsigned char ARROW_TYPE_UTF8 = 5;
+const unsigned char ARROW_TYPE_LIST = 12;
+const unsigned char ARROW_TYPE_STRUCT = 13;
+const unsigned char ARROW_HEADER_SCHEMA = 1;
+const unsigned char ARROW_HEADER_DICTIONARY = 2;
+const unsigned char ARROW_HEADER_RECORD_BATCH = 3;
+const unsigned short ARROW_METADATA_V5 = 4;
+
+
+/** @brief Just enough of a FlatBuffers builder for Arrow's IPC metadata.
+ *
+ * Like the real one, it builds from the back of the buffer to the front,
+ * so a table's strings, vectors and tables are built before it is, and
+ * everything is known by its distance from the end of the buffer.
+ * Internal use only.
+ */
+class tmFlatBuilder
+{
+    public:
+        tmFlatBuilder() { mTableStart = 0; }
+
+        unsigned createString(const string &value);                         /**< Adds a string. */
+        unsigned createOffsets(const vector<unsigned> &targets);            /**< Adds a vector of tables. */
+        unsigned createLongPairs(const vector<unsigned long long> &values); /**< Adds a vector of two long structs. */
+        void startTable();                                                  /**< Starts a table. */
+        void addField(unsigned id, unsigned long long value, unsigned bytes);   /**< Adds a scalar field to the table. */
+        void addOffset(unsigned id, unsigned target);                       /**< Adds a string, vector or table field to the table. */
+        unsigned endTable();                                                /**< Ends the table, and adds its vtable. */
+        string finish(unsigned root);                                       /**< Adds the root table's offset, returns the buffer. */
+
+    private:
+        string mBuf;                                    /**< The buffer, so far. */
+        unsigned mTableStart;                           /**< Buffer size when the table was started. */
+        vector<pair<unsigned, unsigned> > mFields;      /**< The table's field ids, and where they are. */
+
+        void align(unsigned size, unsigned extra = 0);  /**< Pads so that the next 'extra' bytes end aligned. */
+        void prepend(unsigned long long value, unsigned bytes);     /**< Adds a little endian scalar. */
+        void prependOffset(unsigned target);            /**< Adds an offset to something already added. */
+};
+
+
+void tmFlatBuilder::align(unsigned size, unsigned extra) {
+    while ((mBuf.size() + extra) % size) {
+        mBuf.insert(mBuf.begin(), '\0');
+    }
+}
+
+
+void tmFlatBuilder::prepend(unsigned long long value, unsigned bytes) {
+    align(bytes);
+
+    string scalar;
+    for (unsigned x = 0; x < bytes; x++) {
+        scalar.push_back((value >> (8 * x)) & 0xff);
+    }
+
+    mBuf.insert(0, scalar);
+}
+
+
+// Offsets are from where they are, to what they point at, further on.
+void tmFlatBuilder::prependOffset(unsigned target) {
+    align(4);
+    prepend(mBuf.size() + 4 - target, 4);
+}
+
+
+unsigned tmFlatBuilder::createString(const string &value) {
+    align(4, value.length() + 1);
+    mBuf.insert(mBuf.begin(), '\0');
+    mBuf.insert(0, value);
+    prepend(value.length(), 4);
+    return mBuf.size();
+}
+
+
+unsigned tmFlatBuilder::createOffsets(const vector<unsigned> &targets) {
+    align(4, targets.size() * 4);
+    for (vector<unsigned>::const_reverse_iterator i = targets.rbegin(); i != targets.rend(); ++i) {
+        prependOffset(*i);
+    }
+
+    prepend(targets.size(), 4);
+    return mBuf.size();
+}
+
+
+// FieldNode and Buffer are both structs of two longs.
+unsigned tmFlatBuilder::createLongPairs(const vector<unsigned long long> &values) {
+    align(4, values.size() * 8);
+    align(8, values.size() * 8);
+    for (vector<unsigned long long>::const_reverse_iterator i = values.rbegin(); i != values.rend(); ++i) {
+        prepend(*i, 8);
+    }
+
+    prepend(values.size() / 2, 4);
+    return mBuf.size();
+}
+
+
+void tmFlatBuilder::startTable() {
+    mFields.clear();
+    mTableStart = mBuf.size();
+}
+
+
+void tmFlatBuilder::addField(unsigned id, unsigned long long value, unsigned bytes) {
+    prepend(value, bytes);
+    mFields.push_back(make_pair(id, mBuf.size()));
+}
+
+
+void tmFlatBuilder::addOffset(unsigned id, unsigned target) {
+    prependOffset(target);
+    mFields.push_back(make_pair(id, mBuf.size()));
+}
+
+
+// The table starts with the distance back to its vtable, which says where
+// each field is, from the start of the table, or zero if it's absent.
+unsigned tmFlatBuilder::endTable() {
+    prepend(0, 4);
+    unsigned table = mBuf.size();
+
+    unsigned slots = 0;
+    for (vector<pair<unsigned, unsigned> >::iterator i = mFields.begin(); i != mFields.end(); ++i) {
+        if (i->first + 1 > slots) {
+            slots = i->first + 1;
+        }
+    }
+
+    vector<unsigned> where(slots, 0);
+    for (vector<pair<unsigned, unsigned> >::iterator i = mFields.begin(); i != mFields.end(); ++i) {
+        where[i->first] = table - i->second;
+    }
+
+    for (vector<unsigned>::reverse_iterator i = where.rbegin(); i != where.rend(); ++i) {
+        prepend(*i, 2);
+    }
+
+    prepend(table - mTableStart, 2);
+    prepend(4 + 2 * slots, 2);
+
+    unsigned vtable = mBuf.size() - table;
+    for (unsigned x = 0; x < 4; x++) {
+        mBuf[mBuf.size() - table + x] = (vtable >> (8 * x)) & 0xff;
+    }
+
+    return table;
+}
+
+
+// Arrow wants the metadata a multiple of 8 bytes long.
+string tmFlatBuilder::finish(unsigned root) {
+    align(8, 4);
+    prependOffset(root);
+    return mBuf;
+}
+
+
+// Internal use only. Arrow's Int type, Utf8, List and Struct_ have no fields.
+static unsigned arrowInt(tmFlatBuilder &builder, unsigned bits, bool isSigned) {
+    builder.startTable();
+    builder.addField(0, bits, 4);
+    builder.addField(1, isSigned, 1);
+    return builder.endTable();
+}
+
+static unsigned arrowEmpty(tmFlatBuilder &builder) {
+    builder.startTable();
+    return builder.endTable();
+}
+
+
+// Internal use only. A Field, a utf8 one dictionary encoded with int32
+// indices if dictionaryId isn't -1.
+static unsigned arrowField(tmFlatBuilder &builder, const string &name, unsigned char typeType,
+                           unsigned type, int dictionaryId = -1,
+                           const vector<unsigned> &children = vector<unsigned>()) {
+    unsigned dictionary = 0;
+    if (dictionaryId >= 0) {
+        unsigned indexType = arrowInt(builder, 32, true);
+        builder.startTable();
+        builder.addField(0, dictionaryId, 8);
+        builder.addOffset(1, indexType);
+        dictionary = builder.endTable();
+    }
+
+    unsigned nameOffset = builder.createString(name);
+    unsigned childrenOffset = builder.createOffsets(children);
+
+    builder.startTable();
+    builder.addOffset(0, nameOffset);
+    builder.addOffset(3, type);
+    if (dictionary) {
+        builder.addOffset(4, dictionary);
+    }
+    builder.addOffset(5, childrenOffset);
+    builder.addField(2, typeType, 1);
+    return builder.endTable();
+}
+
+static unsigned arrowUInt(tmFlatBuilder &builder, const string &name, unsigned bits) {
+    return arrowField(builder, name, ARROW_TYPE_INT, arrowInt(builder, bits, false));
+}
+
+static unsigned arrowString(tmFlatBuilder &builder, const string &name, int dictionaryId) {
+    return arrowField(builder, name, ARROW_TYPE_UTF8, arrowEmpty(builder), dictionaryId);
+}
+
+
+// Internal use only. A RecordBatch table, for a record or dictionary batch.
+static unsigned arrowRecordBatch(tmFlatBuilder &builder, unsigned long long length,
+                                 const vector<unsigned long long> &nodes,
+                                 const vector<unsigned long long> &buffers) {
+    unsigned nodesOffset = builder.createLongPairs(nodes);
+    unsigned buffersOffset = builder.createLongPairs(buffers);
+
+    builder.startTable();
+    builder.addField(0, length, 8);
+    builder.addOffset(1, nodesOffset);
+    builder.addOffset(2, buffersOffset);
+    return builder.endTable();
+}
+
+
+// Internal use only. The Message around a header, and the metadata.
+static string arrowMessage(tmFlatBuilder &builder, unsigned char headerType,
+                           unsigned header, unsigned long long bodyLength) {
+    builder.startTable();
+    builder.addField(3, bodyLength, 8);
+    builder.addOffset(2, header);
+    builder.addField(0, ARROW_METADATA_V5, 2);
+    builder.addField(1, headerType, 1);
+    return builder.finish(builder.endTable());
+}
+
+
+/** @brief A record batch's body, and the nodes and buffers describing it.
+ *
+ * Internal use only. Every column is added in the schema's order, depth
+ * first. Nothing is ever null, so every validity buffer is empty.
+ */
+struct tmArrowBody
+{
+    string data;                            /**< The buffers, each padded to 8 bytes. */
+    vector<unsigned long long> nodes;       /**< Length and null count of each column. */
+    vector<unsigned long long> buffers;     /**< Offset and length of each buffer. */
+
+    void node(unsigned long long length) {
+        nodes.push_back(length);
+        nodes.push_back(0);
+        buffer(string());
+    }
+
+    void buffer(const string &bytes) {
+        buffers.push_back(data.length());
+        buffers.push_back(bytes.length());
+        data.append(bytes);
+        data.append((8 - data.length() % 8) % 8, '\0');
+    }
+
+    void column(const vector<unsigned> &values) {
+        string bytes;
+        for (vector<unsigned>::const_iterator i = values.begin(); i != values.end(); ++i) {
+            putU32(bytes, *i);
+        }
+
+        node(values.size());
+        buffer(bytes);
+    }
+
+    void column(const vector<unsigned long long> &values) {
+        string bytes;
+        for (vector<unsigned long long>::const_iterator i = values.begin(); i != values.end(); ++i) {
+            putU64(bytes, *i);
+        }
+
+        node(values.size());
+        buffer(bytes);
+    }
+
+    void column(const vector<string> &values) {
+        string offsets;
+        string bytes;
+        putU32(offsets, 0);
+        for (vector<string>::const_iterator i = values.begin(); i != values.end(); ++i) {
+            bytes.append(*i);
+            putU32(offsets, bytes.length());
+        }
+
+        node(values.size());
+        buffer(offsets);
+        buffer(bytes);
+    }
+};
+
+
+/** @brief Returns the index for a string, adding it to the dictionary if it is new.
+ *
+ * @param value const string&. The string to look up.
+ * @return unsigned. The string's index.
+ */
+unsigned tmColumnDictionary::lookup(const string &value) {
+
+    unordered_map<string, unsigned>::iterator i = mIndex.find(value);
+    if (i != mIndex.end()) {
+        return i->second;
+    }
+
+    unsigned index = mValues.size();
+    mIndex.insert(make_pair(value, index));
+    mValues.push_back(value);
+    return index;
+}
+
+
+/** @brief Empties the dictionary, once its batch has been written.
+ */
+void tmColumnDictionary::clear() {
+    mIndex.clear();
+    mValues.clear();
+}
+
+
+/** @brief Constructor for a tmColumnar object.
+ *
+ * @param fileName const string&. The columnar file to be created.
+ * @param batchSize unsigned. How many EXECs to buffer before writing a batch.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ */
+tmColumnar::tmColumnar(const string &fileName, unsigned batchSize, ostream &diagnostics)
+{
+    mFileName = fileName;
+    mDiagnostics = &diagnostics;
+    mBatchSize = batchSize ? batchSize : 1;
+    mOfs = NULL;
+    mExecRows = 0;
+    mBindRows = 0;
+}
+
+
+/** @brief Destructor for a tmColumnar object.
+ *
+ * If close() wasn't called, whatever is buffered is lost, and the stream
+ * has no end marker. That's how readers can tell it's incomplete.
+ */
+tmColumnar::~tmColumnar()
+{
+    if (mOfs) {
+        if (mOfs->is_open()) {
+            mOfs->close();
+        }
+
+        delete mOfs;
+        mOfs = NULL;
+    }
+}
+
+
+/** @brief Creates the columnar file and writes the schema.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmColumnar::open() {
+
+    mOfs = new ofstream(mFileName, std::ofstream::out | std::ofstream::binary);
+
+    if (!mOfs->good()) {
+        *mDiagnostics << "TraceCollier: Cannot open columnar file " << mFileName << endl;
+        return false;
+    }
+
+    // Reserve space for one batch.
+    mExecLine.reserve(mBatchSize);
+    mParseLine.reserve(mBatchSize);
+    mBindsLine.reserve(mBatchSize);
+    mSQLLine.reserve(mBatchSize);
+    mCursor.reserve(mBatchSize);
+    mSQLId.reserve(mBatchSize);
+    mSQLText.reserve(mBatchSize);
+    mDepth.reserve(mBatchSize);
+    mTim.reserve(mBatchSize);
+    mElapsed.reserve(mBatchSize);
+    mCpu.reserve(mBatchSize);
+    mRows.reserve(mBatchSize);
+    mBindOffset.reserve(mBatchSize + 1);
+    mBindOffset.push_back(0);
+
+    return writeSchema();
+}
+
+
+/** @brief Buffers a single EXEC, and its current bind values.
+ *
+ * @param execLine unsigned. The EXEC line number.
+ * @param cursor tmCursor*. The cursor being executed.
+ * @param depth unsigned. The EXEC's recursive depth.
+ * @param stats const tmCallStats&. The figures from the EXEC line.
+ * @return bool. True if all ok, false if a batch write failed.
+ *
+ * When mBatchSize EXECs have been buffered, they are written out.
+ */
+bool tmColumnar::addExec(unsigned execLine, tmCursor *cursor, unsigned depth, const tmCallStats &stats) {
+
+    mExecLine.push_back(execLine);
+    mParseLine.push_back(cursor->sqlParseLine());
+    mBindsLine.push_back(cursor->bindsLine());
+    mSQLLine.push_back(cursor->sqlLineNumber());
+    mCursor.push_back(mCursorIds.lookup(cursor->cursorId()));
+    mSQLId.push_back(mSQLIds.lookup(cursor->sqlId()));
+    mSQLText.push_back(mSQLTexts.lookup(cursor->sqlText()));
+    mDepth.push_back(depth);
+    mTim.push_back(stats.tim());
+    mElapsed.push_back(stats.elapsed());
+    mCpu.push_back(stats.cpu());
+    mRows.push_back(stats.rows());
+
+    // The binds are only current if the cursor has a BINDS line.
+    if (cursor->bindsLine()) {
+        map<unsigned, tmBind *> *binds = cursor->binds();
+        for (map<unsigned, tmBind *>::iterator i = binds->begin(); i != binds->end(); ++i) {
+            mBindId.push_back(i->second->bindId());
+            mBindName.push_back(mBindNames.lookup(i->second->bindName()));
+            mBindType.push_back(i->second->bindType());
+            mBindValue.push_back(mBindValues.lookup(i->second->bindValue()));
+        }
+    }
+
+    mBindOffset.push_back(mBindId.size());
+
+    if (mExecLine.size() >= mBatchSize) {
+        return writeBatch();
+    }
+
+    return true;
+}
+
+
+/** @brief Writes out whatever is still buffered, then the end of stream, and closes the file.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmColumnar::close() {
+
+    if (!mOfs) {
+        return false;
+    }
+
+    bool ok = writeBatch();
+
+    if (ok) {
+        string eos;
+        putU32(eos, 0xffffffff);
+        putU32(eos, 0);
+        mOfs->write(eos.data(), eos.length());
+        ok = mOfs->good();
+    }
+
+    mOfs->close();
+    delete mOfs;
+    mOfs = NULL;
+
+    return ok;
+}
+
+
+/** @brief Writes the schema message, with every column.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmColumnar::writeSchema() {
+
+    tmFlatBuilder builder;
+
+    // The binds list's struct.
+    vector<unsigned> bindFields;
+    bindFields.push_back(arrowUInt(builder, "bind_id", 32));
+    bindFields.push_back(arrowString(builder, "bind_name", 3));
+    bindFields.push_back(arrowUInt(builder, "bind_type", 32));
+    bindFields.push_back(arrowString(builder, "bind_value", 4));
+
+    vector<unsigned> bindStruct;
+    bindStruct.push_back(arrowField(builder, "item", ARROW_TYPE_STRUCT, arrowEmpty(builder), -1, bindFields));
+
+    vector<unsigned> fields;
+    fields.push_back(arrowUInt(builder, "exec_line", 32));
+    fields.push_back(arrowUInt(builder, "parse_line", 32));
+    fields.push_back(arrowUInt(builder, "binds_line", 32));
+    fields.push_back(arrowUInt(builder, "sql_line", 32));
+    fields.push_back(arrowString(builder, "cursor_id", 0));
+    fields.push_back(arrowString(builder, "sql_id", 2));
+    fields.push_back(arrowString(builder, "sql_text", 1));
+    fields.push_back(arrowUInt(builder, "depth", 32));
+    fields.push_back(arrowUInt(builder, "tim", 64));
+    fields.push_back(arrowUInt(builder, "elapsed", 64));
+    fields.push_back(arrowUInt(builder, "cpu", 64));
+    fields.push_back(arrowUInt(builder, "rows", 64));
+    fields.push_back(arrowField(builder, "binds", ARROW_TYPE_LIST, arrowEmpty(builder), -1, bindStruct));
+
+    // Little endian is zero, the default.
+    unsigned fieldsOffset = builder.createOffsets(fields);
+    builder.startTable();
+    builder.addOffset(1, fieldsOffset);
+    unsigned schema = builder.endTable();
+
+    return writeMessage(arrowMessage(builder, ARROW_HEADER_SCHEMA, schema, 0), string());
+}
+
+
+/** @brief Writes a dictionary batch, replacing the last batch's, and clears the dictionary.
+ *
+ * @param id unsigned. The dictionary id, as used in the schema.
+ * @param dictionary tmColumnDictionary&. The dictionary to write.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmColumnar::writeDictionary(unsigned id, tmColumnDictionary &dictionary) {
+
+    tmArrowBody body;
+    body.column(dictionary.values());
+
+    tmFlatBuilder builder;
+    unsigned data = arrowRecordBatch(builder, dictionary.size(), body.nodes, body.buffers);
+    builder.startTable();
+    builder.addField(0, id, 8);
+    builder.addOffset(1, data);
+    unsigned batch = builder.endTable();
+
+    dictionary.clear();
+    return writeMessage(arrowMessage(builder, ARROW_HEADER_DICTIONARY, batch, body.data.length()), body.data);
+}
+
+
+/** @brief Writes the buffered rows, preceded by their dictionaries.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmColumnar::writeBatch() {
+
+    if (mExecLine.empty()) {
+        return true;
+    }
+
+    // Dictionaries first, the batch refers to them.
+    if (!writeDictionary(0, mCursorIds) ||
+        !writeDictionary(1, mSQLTexts) ||
+        !writeDictionary(2, mSQLIds) ||
+        !writeDictionary(3, mBindNames) ||
+        !writeDictionary(4, mBindValues)) {
+        return false;
+    }
+
+    tmArrowBody body;
+    body.column(mExecLine);
+    body.column(mParseLine);
+    body.column(mBindsLine);
+    body.column(mSQLLine);
+    body.column(mCursor);
+    body.column(mSQLId);
+    body.column(mSQLText);
+    body.column(mDepth);
+    body.column(mTim);
+    body.column(mElapsed);
+    body.column(mCpu);
+    body.column(mRows);
+
+    // The binds list's offsets, then the struct, then its columns.
+    string offsets;
+    for (vector<unsigned>::iterator i = mBindOffset.begin(); i != mBindOffset.end(); ++i) {
+        putU32(offsets, *i);
+    }
+
+    body.node(mExecLine.size());
+    body.buffer(offsets);
+    body.node(mBindId.size());
+    body.column(mBindId);
+    body.column(mBindName);
+    body.column(mBindType);
+    body.column(mBindValue);
+
+    tmFlatBuilder builder;
+    unsigned batch = arrowRecordBatch(builder, mExecLine.size(), body.nodes, body.buffers);
+    if (!writeMessage(arrowMessage(builder, ARROW_HEADER_RECORD_BATCH, batch, body.data.length()), body.data)) {
+        return false;
+    }
+
+    mExecRows += mExecLine.size();
+    mBindRows += mBindId.size();
+
+    // Empty the buffers, but keep the memory.
+    mExecLine.clear();
+    mParseLine.clear();
+    mBindsLine.clear();
+    mSQLLine.clear();
+    mCursor.clear();
+    mSQLId.clear();
+    mSQLText.clear();
+    mDepth.clear();
+    mTim.clear();
+    mElapsed.clear();
+    mCpu.clear();
+    mRows.clear();
+    mBindOffset.clear();
+    mBindOffset.push_back(0);
+
+    mBindId.clear();
+    mBindName.clear();
+    mBindType.clear();
+    mBindValue.clear();
+
+    return true;
+}
+
+
+/** @brief Writes a single message, its metadata and body.
+ *
+ * @param metadata const string&. The Message flatbuffer, a multiple of 8 bytes.
+ * @param body const string&. The buffers, if any.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmColumnar::writeMessage(const string &metadata, const string &body) {
+
+    string header;
+    putU32(header, 0xffffffff);
+    putU32(header, metadata.length());
+
+    mOfs->write(header.data(), header.length());
+    mOfs->write(metadata.data(), metadata.length());
+    mOfs->write(body.data(), body.length());
+
+    if (!mOfs->good()) {
+        *mDiagnostics << "TraceCollier: Failed writing to columnar file " << mFileName << endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMCOLUMNAR_H
+#define TMCOLUMNAR_H
+
+/** @file tmcolumnar.h
+ * @brief Header file for the tmColumnar object.
+ */
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+
+using std::string;
+using std::ostream;
+using std::ofstream;
+using std::vector;
+using std::unordered_map;
+
+#include "tmcursor.h"
+#include "tmcallstats.h"
+
+// How many EXECs do we buffer before writing them out?
+const unsigned COLUMNAR_BATCH_SIZE = 65536;
+
+/** @brief A string dictionary for a dictionary encoded column.
+ *
+ * Every distinct string gets the next index. The dictionary only lasts for
+ * one batch, it's written out with it and then cleared, so its size depends
+ * on the batch size, not on the size of the trace.
+ */
+class tmColumnDictionary
+{
+    public:
+        unsigned lookup(const string &value);               /**< Returns the index for a string, adding it if new. */
+        unsigned size() { return mValues.size(); }          /**< Returns the number of distinct strings. */
+        const vector<string> &values() { return mValues; }  /**< Returns the strings, in index order. */
+        void clear();                                       /**< Empties the dictionary, for the next batch. */
+
+    private:
+        unordered_map<string, unsigned> mIndex;     /**< String to index lookup. */
+        vector<string> mValues;                     /**< The strings, in index order. */
+};
+
+/** @brief A class which writes executions and their bind values to an
+ *         Apache Arrow IPC stream.
+ *
+ * The file is in Arrow's IPC streaming format, version 5, as read by
+ * pyarrow.ipc.open_stream(), polars.read_ipc_stream(), R's
+ * arrow::read_ipc_stream(), DuckDB and the like. The extension is
+ * ".arrows", as Arrow suggests for streams. The flatbuffer metadata is
+ * written by hand, so there's no dependency on the Arrow libraries.
+ *
+ * There's one row per reported EXEC, with these columns, none of them null:
+ *
+ * @li exec_line, parse_line, binds_line, sql_line - uint32. The EXEC's line,
+ * the most recent PARSE line, zero if it was from the cache, the BINDS line,
+ * zero if none, and the line where the SQL text starts.
+ * @li cursor_id, sql_id, sql_text - dictionary encoded utf8, int32 indices.
+ * @li depth - uint32. The EXEC's dep=.
+ * @li tim, elapsed, cpu, rows - uint64. The EXEC's tim=, e=, c= and r=.
+ * @li binds - list of struct, the bind values the EXEC used, if the cursor
+ * had a BINDS line. Each has bind_id, uint32, bind_name, dictionary encoded
+ * utf8, bind_type, uint32, the oacdty=, and bind_value, dictionary encoded utf8.
+ *
+ * The schema is followed by a record batch for every COLUMNAR_BATCH_SIZE
+ * EXECs, each preceded by a fresh dictionary, not a delta, for each of the
+ * dictionary encoded columns, with only the strings in that batch. The
+ * stream ends with Arrow's end of stream marker, which is missing if
+ * TraceCollier died.
+ */
+class tmColumnar
+{
+    public:
+        tmColumnar(const string &fileName, unsigned batchSize, ostream &diagnostics);
+        ~tmColumnar();
+
+        // Getters.
+        string fileName() { return mFileName; }                 /**< Returns the output file name. */
+        unsigned long long execRows() { return mExecRows; }     /**< Returns how many EXECs have been written. */
+        unsigned long long bindRows() { return mBindRows; }     /**< Returns how many bind values have been written. */
+
+        // Other useful stuff.
+        bool open();                /**< Creates the file and writes the schema. */
+        bool addExec(unsigned execLine, tmCursor *cursor, unsigned depth, const tmCallStats &stats);     /**< Buffers one EXEC and its binds. */
+        bool close();               /**< Writes any part batch and the end of stream, then closes the file. */
+
+    protected:
+
+    private:
+        string mFileName;                   /**< Where we are writing to. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+        ofstream *mOfs;                     /**< The file itself. */
+        unsigned mBatchSize;                /**< EXECs per batch. */
+        unsigned long long mExecRows;       /**< EXEC rows written so far. */
+        unsigned long long mBindRows;       /**< Bind rows written so far. */
+
+        // Dictionaries, for this batch.
+        tmColumnDictionary mCursorIds;      /**< Dictionary 0. Cursor ids. */
+        tmColumnDictionary mSQLTexts;       /**< Dictionary 1. SQL statements, as parsed. */
+        tmColumnDictionary mSQLIds;         /**< Dictionary 2. Oracle sqlids. */
+        tmColumnDictionary mBindNames;      /**< Dictionary 3. Bind variable names. */
+        tmColumnDictionary mBindValues;     /**< Dictionary 4. Bind values. */
+
+        // The EXEC columns.
+        vector<unsigned> mExecLine;             /**< EXEC line number. */
+        vector<unsigned> mParseLine;            /**< Most recent PARSE line number. Zero = from cache. */
+        vector<unsigned> mBindsLine;            /**< BINDS line number. Zero = no binds. */
+        vector<unsigned> mSQLLine;              /**< Line where the SQL text starts. */
+        vector<unsigned> mCursor;               /**< Cursor id, dictionary index. */
+        vector<unsigned> mSQLId;                /**< Sqlid, dictionary index. */
+        vector<unsigned> mSQLText;              /**< SQL Text, dictionary index. */
+        vector<unsigned> mDepth;                /**< Recursive depth. */
+        vector<unsigned long long> mTim;        /**< EXEC tim= */
+        vector<unsigned long long> mElapsed;    /**< EXEC e= */
+        vector<unsigned long long> mCpu;        /**< EXEC c= */
+        vector<unsigned long long> mRows;       /**< EXEC r= */
+        vector<unsigned> mBindOffset;           /**< Where each EXEC's binds start, and one past the last. */
+
+        // The bind columns, inside the binds list.
+        vector<unsigned> mBindId;               /**< Bind position. */
+        vector<unsigned> mBindName;             /**< Bind name, dictionary index. */
+        vector<unsigned> mBindType;             /**< Bind data type (oacdty). */
+        vector<unsigned> mBindValue;            /**< Bind value, dictionary index. */
+
+        bool writeSchema();                                                 /**< Writes the schema message. */
+        bool writeDictionary(unsigned id, tmColumnDictionary &dictionary);  /**< Writes a dictionary batch, and clears the dictionary. */
+        bool writeBatch();                                                  /**< Writes the buffered rows as a record batch. */
+        bool writeMessage(const string &metadata, const string &body);      /**< Writes any message. */
+};
+
+#endif // TMCOLUMNAR_H
@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmcounters.h"
+
+#include <iostream>
+
+#ifdef __linux__
+    #define USE_PERF_EVENTS
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <cstring>
+    #include <cerrno>
+#endif // __linux__
+
+using std::endl;
+
+/** @file tmcounters.cpp
+ * @brief Implementation file for the tmCounters object.
+ */
+
+
+// Counter names, in tmCounter order.
+static const char *counterNames[COUNTER_COUNT] = {
+    "cycles", "instructions", "cache misses", "branch misses"
+};
+
+
+/** @brief Returns the name of a counter, for reports.
+ *
+ * @param counter tmCounter. The counter.
+ * @return const char*. Its name.
+ */
+const char *counterName(tmCounter counter) {
+    return counter < COUNTER_COUNT ? counterNames[counter] : "unknown";
+}
+
+
+/** @brief Constructor for a tmCounters object.
+ *
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ *
+ * Nothing is opened until open() is called.
+ */
+tmCounters::tmCounters(ostream &diagnostics)
+{
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        mFd[i] = -1;
+        mSlot[i] = -1;
+    }
+
+    mLeader = -1;
+    mOpened = 0;
+    mDiagnostics = &diagnostics;
+}
+
+
+/** @brief Destructor for a tmCounters object.
+ */
+tmCounters::~tmCounters()
+{
+    close();
+}
+
+
+/** @brief Opens and starts the counters for this thread.
+ *
+ * @return bool. True if at least one counter opened, false otherwise.
+ *
+ * Only user space is counted, as that is all most systems allow without
+ * privileges, and the kernel's share is mostly the reads anyway.
+ */
+bool tmCounters::open() {
+#ifdef USE_PERF_EVENTS
+    static const uint64_t configs[COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        // The leader starts disabled, so the whole group starts together.
+        attr.disabled = (mLeader < 0) ? 1 : 0;
+
+        // This thread, on any CPU.
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, mLeader, 0);
+        if (fd < 0) {
+            *mDiagnostics << "TraceCollier: Cannot open the " << counterNames[i]
+                          << " counter: " << strerror(errno) << endl;
+            continue;
+        }
+
+        if (mLeader < 0) {
+            mLeader = fd;
+        }
+
+        mFd[i] = fd;
+        mSlot[i] = mOpened++;
+    }
+
+    if (mLeader < 0) {
+        return false;
+    }
+
+    ioctl(mLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    *mDiagnostics << "TraceCollier: Hardware counters are only available on Linux." << endl;
+    return false;
+#endif // USE_PERF_EVENTS
+}
+
+
+/** @brief Closes the counters.
+ */
+void tmCounters::close() {
+#ifdef USE_PERF_EVENTS
+    // Members first, then the leader.
+    for (int i = COUNTER_COUNT - 1; i >= 0; i--) {
+        if (mFd[i] >= 0 && mFd[i] != mLeader) {
+            ::close(mFd[i]);
+        }
+    }
+
+    if (mLeader >= 0) {
+        ::close(mLeader);
+    }
+#endif // USE_PERF_EVENTS
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        mFd[i] = -1;
+        mSlot[i] = -1;
+    }
+
+    mLeader = -1;
+    mOpened = 0;
+}
+
+
+/** @brief Reads the running totals of all the counters.
+ *
+ * @param values uint64_t[]. Where to put them, in tmCounter order.
+ * Counters which didn't open are set to zero.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmCounters::read(uint64_t values[COUNTER_COUNT]) {
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        values[i] = 0;
+    }
+
+#ifdef USE_PERF_EVENTS
+    if (mLeader < 0) {
+        return false;
+    }
+
+    // A group read gives the number of counters, then each value.
+    uint64_t buffer[1 + COUNTER_COUNT];
+    ssize_t wanted = (1 + mOpened) * sizeof(uint64_t);
+    if (::read(mLeader, buffer, wanted) != wanted) {
+        return false;
+    }
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (mSlot[i] >= 0) {
+            values[i] = buffer[1 + mSlot[i]];
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif // USE_PERF_EVENTS
+}
@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMCOUNTERS_H
+#define TMCOUNTERS_H
+
+/** @file tmcounters.h
+ * @brief Header file for the tmCounters object.
+ */
+
+#include <stdint.h>
+#include <ostream>
+
+using std::ostream;
+
+// The hardware counters we read, in the order we read them.
+enum tmCounter {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_COUNT
+};
+
+const char *counterName(tmCounter counter);     /**< Returns a counter's name for reports. */
+
+/** @brief A class which reads this thread's hardware performance counters.
+ *
+ * Linux only, using perf_event_open(). The counters are opened as one group,
+ * so they are scheduled together and read with a single system call. Any
+ * counter which the CPU, or the kernel's perf_event_paranoid setting, won't
+ * let us have is left out, and reads as zero. Elsewhere, nothing opens.
+ */
+class tmCounters
+{
+    public:
+        tmCounters(ostream &diagnostics);
+        ~tmCounters();
+
+        // Getters.
+        bool isOpen() { return mLeader >= 0; }                  /**< Did any counter open? */
+        bool available(tmCounter counter) { return mFd[counter] >= 0; }    /**< Did this counter open? */
+
+        bool open();                                /**< Opens and starts the counters. */
+        void close();                               /**< Closes the counters. */
+        bool read(uint64_t values[COUNTER_COUNT]);  /**< Reads every counter's running total. */
+
+    private:
+        int mFd[COUNTER_COUNT];             /**< File descriptor per counter, or -1. */
+        int mLeader;                        /**< The group leader's descriptor, or -1. */
+        int mOpened;                        /**< How many counters are in the group. */
+        int mSlot[COUNTER_COUNT];           /**< Where each counter is in a group read, or -1. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+};
+
+#endif // TMCOUNTERS_H
@@ -39,10 +39,12 @@
  * @param	id std::string. The cursorID including leading '#'.
  * @param	sqlSize unsigned. The length of the SQL text.
  * @param	sqlLine unsigned. The line in the trace file where the SQL statement begins.
+ * @param	diagnostics ostream&. Where to write warnings and errors. Usually cerr.
  * @return	None.
  */
- tmCursor::tmCursor(string id, unsigned sqlSize, unsigned sqlLine) {
+ tmCursor::tmCursor(string id, unsigned sqlSize, unsigned sqlLine, ostream &diagnostics) {
     mCursorId = id;
+    mDiagnostics = &diagnostics;
     mSQLLineNumber = sqlLine;
     mSQLSize = sqlSize;
     mSQLText = "";
@@ -54,6 +56,11 @@
     mReturning = false;
     mStopScanningHere = 0;
     mLocal = "";
+    mExecLine = 0;
+    mSQLId = "";
+    mFingerprinted = false;
+    mWaitTime = 0;
+    mPlanHash = 0;
 }
 
 /** @brief Destructor for tmCursor object.
@@ -110,6 +117,7 @@ ostream &operator<<(ostream &out, const tmCursor &cursor) {
         << "Bind Count: " << cursor.mBindCount << endl
         << "Final \"BINDS " << cursor.mCursorId << ":\" Line for this cursor: " << cursor.mBindsLine << endl
         << "Command Type: " << cursor.mCommandType << endl
+        << "SQL ID: " << cursor.mSQLId << endl
         << "SQL Text = [" << cursor.mSQLText << "]" << endl
         << "Returning? " << cursor.mReturning << endl
         << "Closed? " << cursor.mClosed << endl;
@@ -144,6 +152,7 @@ void tmCursor::setSQLText(string val) {
     // Assign the (new) SQL statement.
     mSQLText = val;
     mStopScanningHere = mSQLText.length();
+    mFingerprinted = false;
 
     // Build the binds list.
     buildBindMap(val);
@@ -151,6 +160,68 @@ void tmCursor::setSQLText(string val) {
 }
 
 
+/** @brief Returns the normalised SQL text and its fingerprint.
+ *
+ * @return const tmSqlFingerprint&. The fingerprint of this cursor's SQL.
+ *
+ * Only worked out when first asked for, and again after the SQL changes,
+ * so that cursors nobody groups don't pay for it.
+ */
+const tmSqlFingerprint &tmCursor::fingerprint() {
+    if (!mFingerprinted) {
+        mFingerprint.parse(mSQLText);
+        mFingerprinted = true;
+    }
+
+    return mFingerprint;
+}
+
+
+/** @brief Returns Oracle's sqlid for this cursor's SQL.
+ *
+ * @return string. The sqlid from the PARSING IN CURSOR line if there was
+ * one, otherwise one worked out from the SQL text, as Oracle would.
+ */
+string tmCursor::oracleSqlId() {
+    if (!mSQLId.empty()) {
+        return mSQLId;
+    }
+
+    return tmSqlFingerprint::oracleSqlId(mSQLText);
+}
+
+
+/** @brief Replaces each bind name in the SQL with that bind's value.
+ *
+ * @param sqlText string&. A copy of this cursor's SQL, which gets the values.
+ * @return tmBind*. NULL if all ok, else the first bind whose name wasn't found.
+ *
+ * Binds are replaced in bind number order, the first occurrence of each
+ * name, so a repeated name gets each bind's value in turn.
+ */
+tmBind *tmCursor::replaceBinds(string &sqlText) {
+
+    // I would love to be able to do this by finding the offset and
+    // length of the bind name, at parse time for the SQL, but it
+    // seems either that it is not possible, or my ability to use the STL
+    // is lacking in skill. I suspect the latter!
+    for (map<unsigned, tmBind *>::iterator i = mBinds.begin();
+         i != mBinds.end();
+         i++)
+    {
+        string::size_type bindPos = sqlText.find(i->second->bindName());
+        if (bindPos == string::npos) {
+            // Hmm. This should never happen!
+            return i->second;
+        }
+
+        sqlText.replace(bindPos, i->second->bindName().length(), i->second->bindValue());
+    }
+
+    return NULL;
+}
+
+
 /** @brief Initialises the list of Bind objects when the SQL changes.
  *
  * @param sql const string&. The full text of the SQL statement we are extracting binds from.
@@ -183,7 +254,12 @@ bool tmCursor::buildBindMap(const string &sql) {
     // ISSUE #9. The above regex finds incorrect binds if there is not a space,
     // tab or newline etc prior to the colon. Eg. TO_DATE('dd:mm:yy'...) has
     // two binds :mm and :yy when it doesn't have any!
-    regex reg("[:space: (=,+-/*>](:\"?\\w+\"?)");
+    //
+    // The characters allowed before the colon are the same as those the
+    // non-regex code checks for below. (Not "[:space:]", which in here is
+    // just the letters of "space" and a colon, and missed binds at the
+    // start of a line.)
+    regex reg("[ \\t\\n(=,+\\-/*<>](:\"?\\w+\"?)");
     smatch match;
 
     // Issue #5, RETURNING binds get NULL as their name.
@@ -277,6 +353,11 @@ bool tmCursor::buildBindMap(const string &sql) {
             break;
         }
 
+        // A colon at the very end is not a bind variable either.
+        if (colonPos + 1 >= thisSQL.length()) {
+            break;
+        }
+
         // Don't consider PL/SQL assignment as a bind variable.
         if (thisSQL.at(colonPos + 1) == '=') {
             colonPos += 2;
@@ -284,8 +365,10 @@ bool tmCursor::buildBindMap(const string &sql) {
         }
 
         // Don't consider anything as a bind variable unless the
-        // colon is followed by a letter, digit or underscore.
+        // colon is followed by a letter, digit, underscore or the
+        // double quote of a quoted name.
         if ((thisSQL.at(colonPos + 1) != '_') &&
+            (thisSQL.at(colonPos + 1) != '"') &&
             (!isdigit(thisSQL.at(colonPos + 1))) &&
             (!isalpha(thisSQL.at(colonPos + 1))))
         {
@@ -311,16 +394,16 @@ bool tmCursor::buildBindMap(const string &sql) {
                (thisSQL.at(colonPos - 1) != '<') && // Less than
                (thisSQL.at(colonPos - 1) != '*') )
         {
-                cerr << "Bind at position " << colonPos << " is not a bind." << endl;
-                cerr << "It  is preceeded by a '" << thisSQL.at(colonPos - 1) << "'" << endl;
+                *mDiagnostics << "Bind at position " << colonPos << " is not a bind." << endl;
+                *mDiagnostics << "It  is preceeded by a '" << thisSQL.at(colonPos - 1) << "'" << endl;
                 colonPos++;
                 continue;
             }
         }
 
         // Ok, extract a bind variable name.
-        if (!extractBindName(thisSQL, colonPos, bindName)) {
-            cerr << "buildBindMap(): extractBindName() failed." << endl;
+        if (!extractBindName(thisSQL, colonPos, bindName, *mDiagnostics)) {
+            *mDiagnostics << "buildBindMap(): extractBindName() failed." << endl;
             return false;
         }
 #endif // USE_REGEX
@@ -349,8 +432,8 @@ bool tmCursor::buildBindMap(const string &sql) {
         // So, after all that, did we insert or find our bind?
         if (!exists.second) {
             // This should never happen!
-            cerr << "Already exists: " << bindName << " with bind id "
-                 << bindID << endl;
+            *mDiagnostics << "Already exists: " << bindName << " with bind id "
+                          << bindID << endl;
             delete thisBind;
             return false;
         }
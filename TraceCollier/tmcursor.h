@@ -44,13 +44,15 @@ using std::smatch;
 using std::ostream;
 
 #include "tmbind.h"
+#include "tmfingerprint.h"
+#include "tmcallstats.h"
 
 /** @brief A class representing a cursor variable in an Oracle trace file.
  */
 class tmCursor
 {
     public:
-        tmCursor(string id, unsigned sqlSize, unsigned sqlLine);
+        tmCursor(string id, unsigned sqlSize, unsigned sqlLine, ostream &diagnostics);
         ~tmCursor();
         friend ostream &operator<<(ostream &out, const tmCursor &cursor);
 
@@ -68,6 +70,15 @@ class tmCursor
         bool isReturning() { return mReturning; }               /**< Returns whether or not the cursor has a RETURNING clause. */
         string getLocal() { return mLocal; }                    /**< Returns the local date/time of the cursor */
         unsigned execLine() { return mExecLine; }                    /**< Returns the last EXEC line for the cursor. */
+        string sqlId() { return mSQLId; }                       /**< Returns Oracle's sqlid for the statement, if the trace has one. */
+        const tmCallTotals &fetches() { return mFetches; }      /**< Returns the FETCH totals since the last EXEC. */
+        unsigned long long planHash() { return mPlanHash; }     /**< Returns the plh= of the latest PARSE or EXEC. Only kept for an event handler. */
+        unsigned long long takeWaitTime() { unsigned long long w = mWaitTime; mWaitTime = 0; return w; }  /**< Returns the WAIT time since the last call, and starts again. */
+
+        const tmSqlFingerprint &fingerprint();                  /**< Returns the normalised SQL and its fingerprint, worked out when first asked for. */
+        string oracleSqlId();                                   /**< Returns the trace's sqlid, or else works out Oracle's from the SQL text. */
+
+        tmBind *replaceBinds(string &sqlText);                  /**< Replaces the bind names in SQL text with their values. */
 
         // Setters.
         void setSQLText(string val);                            /**< Changes the SQL statement for this cursor. */
@@ -81,11 +92,17 @@ class tmCursor
         void setReturning(bool val) { mReturning = val; }               /**< Changes the RETURNING state of the cursor. */
         void setLocal(string val) { mLocal = val; }                     /**< Changes the local date.time of the cursor. */
         void setExec(unsigned val) { mExecLine = val; }                /**< Changes the EXEC line of the cursor. */
+        void setSQLId(string val) { mSQLId = val; }                     /**< Changes the sqlid of the statement. */
+        void setPlanHash(unsigned long long val) { mPlanHash = val; }   /**< Changes the plan hash value of the statement. */
+        void addWaitTime(unsigned long long val) { mWaitTime += val; }  /**< Adds a WAIT's elapsed time. */
+        void addFetch(const tmCallStats &stats) { mFetches.add(stats); }    /**< Adds a FETCH to the current execution. */
+        void clearFetches() { mFetches = tmCallTotals(); }              /**< Starts a new execution's FETCH totals. */
 
     protected:
 
     private:
         string mCursorId;                   /**< Cursor ID including the # prefix. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
         unsigned mSQLLineNumber;            /**< Line in the trace where the SQL can be found. */
         unsigned mSQLSize;                  /**< What Oracle reports the size of the SQL statement to be. */
         string mSQLText;                    /**< The actual SQL text, extracted from the trace file. */
@@ -99,6 +116,12 @@ class tmCursor
         unsigned mStopScanningHere;         /**< Where to stop looking for bind variables in the string. */
         string mLocal;                       /**< Local date/time for this exec */
         unsigned mExecLine;                 /**< Line number of previous EXEC - for parseERROR() */
+        string mSQLId;                      /**< Oracle's sqlid, from the PARSING IN CURSOR line. 11g onwards. */
+        tmSqlFingerprint mFingerprint;      /**< The normalised SQL text and its fingerprint. */
+        bool mFingerprinted;                /**< Is mFingerprint up to date with mSQLText? */
+        unsigned long long mWaitTime;       /**< Total WAIT ela= since the last PARSE, EXEC or FETCH. */
+        tmCallTotals mFetches;              /**< FETCH totals for the current execution. */
+        unsigned long long mPlanHash;       /**< Plan hash value, plh=, of the latest PARSE or EXEC. */
 
         bool buildBindMap(const string &sql);
         void cleanUp();
@@ -0,0 +1,290 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmdebuglog.h"
+#include "gnu.h"
+
+#include <iostream>
+
+using std::ifstream;
+using std::endl;
+
+/** @file tmdebuglog.cpp
+ * @brief Implementation file for the tmDebugLog object.
+ */
+
+
+// The decoder's names for functions and events.
+#define TMDEBUG_FUNCTION(id, name) name,
+static const char *functionNames[] = { TMDEBUG_FUNCTIONS };
+#undef TMDEBUG_FUNCTION
+
+#define TMDEBUG_EVENT(id, text) text,
+static const char *eventTexts[] = { TMDEBUG_EVENTS };
+#undef TMDEBUG_EVENT
+
+// Debug file header.
+static const char debugMagic[] = "TCDEBUG1";
+static const uint32_t debugByteOrder = 0x01020304;
+static const uint32_t DEBUG_FLAG_REGEX = 1;
+
+
+/** @brief Constructor for a tmDebugLog object.
+ *
+ * @param fileName const string&. The debug file to be created.
+ * @param bufferSize unsigned. How many records to buffer before writing them out.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ */
+tmDebugLog::tmDebugLog(const string &fileName, unsigned bufferSize, ostream &diagnostics)
+{
+    mFileName = fileName;
+    mDiagnostics = &diagnostics;
+    mOfs = NULL;
+    mBuffer.resize(bufferSize ? bufferSize : 1);
+    mUsed = 0;
+}
+
+
+/** @brief Destructor for a tmDebugLog object.
+ */
+tmDebugLog::~tmDebugLog()
+{
+    close();
+}
+
+
+/** @brief Creates the debug file and writes the header.
+ *
+ * @return bool. True if all ok, false otherwise.
+ *
+ * If this fails, events are still accepted, but are thrown away.
+ */
+bool tmDebugLog::open()
+{
+    mOfs = new ofstream(mFileName, std::ios::binary);
+
+    if (!mOfs->good()) {
+        *mDiagnostics << "TraceCollier: Cannot open debug file "
+                      << mFileName << endl;
+        return false;
+    }
+
+    // For my own benefit, note whether or not we are using REGEXes
+    // It helps when testing, to know what's what.
+    uint32_t flags = 0;
+    #ifdef USE_REGEX
+        flags |= DEBUG_FLAG_REGEX;
+    #endif // USE_REGEX
+
+    uint32_t recordSize = sizeof(tmDebugRecord);
+    mOfs->write(debugMagic, 8);
+    mOfs->write(reinterpret_cast<const char *>(&recordSize), sizeof(recordSize));
+    mOfs->write(reinterpret_cast<const char *>(&debugByteOrder), sizeof(debugByteOrder));
+    mOfs->write(reinterpret_cast<const char *>(&flags), sizeof(flags));
+
+    return mOfs->good();
+}
+
+
+/** @brief Writes out anything still buffered and closes the debug file.
+ */
+void tmDebugLog::close()
+{
+    if (mOfs) {
+        flush();
+
+        if (mOfs->is_open()) {
+            mOfs->close();
+        }
+
+        delete mOfs;
+        mOfs = NULL;
+    }
+}
+
+
+/** @brief Writes out the buffered records and empties the buffer.
+ */
+void tmDebugLog::flush()
+{
+    if (mOfs && mOfs->good()) {
+        mOfs->write(reinterpret_cast<const char *>(&mBuffer[0]), mUsed * sizeof(tmDebugRecord));
+    }
+
+    mUsed = 0;
+}
+
+
+/** @brief Adds the next %s span to the event just logged.
+ *
+ * @param text const char*. The span's bytes.
+ * @param length size_t. How many of them.
+ * @return tmDebugLog&. To allow further spans to be chained on.
+ */
+tmDebugLog &tmDebugLog::span(const char *text, size_t length)
+{
+    tmDebugRecord *r = next();
+    memset(r, 0, sizeof(tmDebugRecord));
+    r->mEvent = DBG_SPAN;
+    r->mArgs[0] = length;
+
+    while (length) {
+        r = next();
+        size_t chunk = length < sizeof(tmDebugRecord) ? length : sizeof(tmDebugRecord);
+        if (chunk < sizeof(tmDebugRecord)) {
+            memset(r, 0, sizeof(tmDebugRecord));
+        }
+        memcpy(r, text, chunk);
+        text += chunk;
+        length -= chunk;
+    }
+
+    return *this;
+}
+
+
+/** @brief Reads the next span from a debug file.
+ *
+ * @param ifs ifstream&. The debug file, positioned at a span record.
+ * @param result string&. Where to put the span.
+ * @return bool. False if there isn't a (complete) span there.
+ */
+static bool readSpan(ifstream &ifs, string &result)
+{
+    tmDebugRecord r;
+    if (!ifs.read(reinterpret_cast<char *>(&r), sizeof(r)) ||
+        r.mEvent != DBG_SPAN) {
+        return false;
+    }
+
+    uint64_t length = r.mArgs[0];
+    uint64_t padded = (length + sizeof(r) - 1) / sizeof(r) * sizeof(r);
+    result.resize(padded);
+    if (padded && !ifs.read(&result[0], padded)) {
+        return false;
+    }
+
+    result.resize(length);
+    return true;
+}
+
+
+/** @brief Writes a binary debug file out as text.
+ *
+ * @param debugFileName const string&. The debug file to decode.
+ * @param out ostream&. Where to write the text.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * Each event is written as "function(line): text", as the old text debug
+ * files were.
+ */
+bool tmDebugLog::decode(const string &debugFileName, ostream &out, ostream &diagnostics)
+{
+    ifstream ifs(debugFileName, std::ios::binary);
+
+    if (!ifs.good()) {
+        diagnostics << "TraceCollier: Cannot open debug file "
+                    << debugFileName << endl;
+        return false;
+    }
+
+    char magic[8];
+    uint32_t recordSize = 0;
+    uint32_t byteOrder = 0;
+    uint32_t flags = 0;
+
+    ifs.read(magic, 8);
+    ifs.read(reinterpret_cast<char *>(&recordSize), sizeof(recordSize));
+    ifs.read(reinterpret_cast<char *>(&byteOrder), sizeof(byteOrder));
+    ifs.read(reinterpret_cast<char *>(&flags), sizeof(flags));
+
+    if (!ifs.good() || memcmp(magic, debugMagic, 8) != 0) {
+        diagnostics << "TraceCollier: " << debugFileName
+                    << " is not a TraceCollier debug file." << endl;
+        return false;
+    }
+
+    if (recordSize != sizeof(tmDebugRecord) || byteOrder != debugByteOrder) {
+        diagnostics << "TraceCollier: " << debugFileName
+                    << " was written on a different type of machine, and cannot be decoded here." << endl;
+        return false;
+    }
+
+    out << "TraceCollier - ";
+    if (flags & DEBUG_FLAG_REGEX) {
+        out << " with REGEX support.";
+    } else {
+        out << " with no REGEX support.";
+    }
+    out << endl << endl;
+
+    tmDebugRecord r;
+    string text;
+
+    while (ifs.read(reinterpret_cast<char *>(&r), sizeof(r))) {
+        // A stray span. Skip it.
+        if (r.mEvent == DBG_SPAN) {
+            ifs.seekg((r.mArgs[0] + sizeof(r) - 1) / sizeof(r) * sizeof(r), std::ios::cur);
+            continue;
+        }
+
+        if (r.mFunction < DBG_FUNCTION_COUNT) {
+            out << functionNames[r.mFunction];
+        } else {
+            out << "function#" << r.mFunction;
+        }
+        out << '(' << r.mLine << "): ";
+
+        if (r.mEvent >= DBG_EVENT_COUNT) {
+            out << "Unknown event #" << r.mEvent << '.' << endl;
+            continue;
+        }
+
+        unsigned nextArg = 0;
+        for (const char *c = eventTexts[r.mEvent]; *c; c++) {
+            if (*c == '%' && c[1] == 'u') {
+                out << (nextArg < 3 ? r.mArgs[nextArg++] : 0);
+                c++;
+            } else if (*c == '%' && c[1] == 's') {
+                if (readSpan(ifs, text)) {
+                    // Error messages come with their own newline.
+                    if (r.mEvent == DBG_MESSAGE &&
+                        !text.empty() && text[text.length() - 1] == '\n') {
+                        text.erase(text.length() - 1);
+                    }
+                    out << text;
+                } else {
+                    out << "<missing>";
+                }
+                c++;
+            } else {
+                out << *c;
+            }
+        }
+        out << endl;
+    }
+
+    return true;
+}
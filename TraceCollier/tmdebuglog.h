@@ -0,0 +1,228 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMDEBUGLOG_H
+#define TMDEBUGLOG_H
+
+/** @file tmdebuglog.h
+ * @brief Header file for the tmDebugLog object.
+ */
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+
+using std::string;
+using std::ofstream;
+using std::ostream;
+using std::vector;
+
+// Which TraceCollier function logged an event. The decoder prints the name.
+// Add new ones at the end, the numbers are in the debug files.
+#define TMDEBUG_FUNCTIONS \
+    TMDEBUG_FUNCTION(DBG_PARSE, "parse") \
+    TMDEBUG_FUNCTION(DBG_PARSE_TRACE_FILE, "parseTraceFile") \
+    TMDEBUG_FUNCTION(DBG_PARSE_HEADER, "parseHeader") \
+    TMDEBUG_FUNCTION(DBG_OPEN_TRACE_FILE, "openTraceFile") \
+    TMDEBUG_FUNCTION(DBG_OPEN_REPORT_FILE, "openReportFile") \
+    TMDEBUG_FUNCTION(DBG_OPEN_REPORT_PART, "openReportPart") \
+    TMDEBUG_FUNCTION(DBG_CLOSE_REPORT_PART, "closeReportPart") \
+    TMDEBUG_FUNCTION(DBG_OPEN_COLUMNAR_FILE, "openColumnarFile") \
+    TMDEBUG_FUNCTION(DBG_REPORT_HEADINGS, "reportHeadings") \
+    TMDEBUG_FUNCTION(DBG_READ_TRACE_LINE, "readTraceLine") \
+    TMDEBUG_FUNCTION(DBG_FIND_CURSOR, "findCursor") \
+    TMDEBUG_FUNCTION(DBG_CLEANUP, "cleanUp") \
+    TMDEBUG_FUNCTION(DBG_PARSING, "parsePARSING") \
+    TMDEBUG_FUNCTION(DBG_PARSE_PARSE, "parsePARSE") \
+    TMDEBUG_FUNCTION(DBG_EXEC, "parseEXEC") \
+    TMDEBUG_FUNCTION(DBG_PARSE_ERROR, "parsePARSEERROR") \
+    TMDEBUG_FUNCTION(DBG_XCTEND, "parseXCTEND") \
+    TMDEBUG_FUNCTION(DBG_ERROR, "parseERROR") \
+    TMDEBUG_FUNCTION(DBG_BINDS, "parseBINDS") \
+    TMDEBUG_FUNCTION(DBG_BIND_DATA, "parseBindData") \
+    TMDEBUG_FUNCTION(DBG_CLOSE, "parseCLOSE") \
+    TMDEBUG_FUNCTION(DBG_STAT, "parseSTAT") \
+    TMDEBUG_FUNCTION(DBG_DEADLOCK, "parseDEADLOCK") \
+    TMDEBUG_FUNCTION(DBG_EXTRACT_BIND_DATA, "extractBindData") \
+    TMDEBUG_FUNCTION(DBG_EXTRACT_NUMBER, "extractNumber") \
+    TMDEBUG_FUNCTION(DBG_EXTRACT_HEX, "extractHex") \
+    TMDEBUG_FUNCTION(DBG_EXTRACT_BIND_VALUE, "extractBindValue") \
+    TMDEBUG_FUNCTION(DBG_FETCH, "parseFETCH") \
+    TMDEBUG_FUNCTION(DBG_WAIT, "parseWAIT")
+
+// What happened. The text is how the decoder prints it: each %u is replaced
+// by the next number argument, each %s by the next span.
+// Add new ones at the end, the numbers are in the debug files.
+#define TMDEBUG_EVENTS \
+    TMDEBUG_EVENT(DBG_ENTRY, "Entry.") \
+    TMDEBUG_EVENT(DBG_EXIT, "Exit.") \
+    TMDEBUG_EVENT(DBG_ERROR_EXIT, "Error exit.") \
+    TMDEBUG_EVENT(DBG_MESSAGE, "%s") \
+    TMDEBUG_EVENT(DBG_FILE_NAME, "File: [%s]") \
+    TMDEBUG_EVENT(DBG_LINE, "[%s]") \
+    TMDEBUG_EVENT(DBG_IGNORE_LINE, "Ignoring timestamp/empty line [%s]") \
+    TMDEBUG_EVENT(DBG_EXEC_COUNT, "EXEC count so far: %u.") \
+    TMDEBUG_EVENT(DBG_IGNORE_DEPTH, "Ignoring, dep=%u is out of range.") \
+    TMDEBUG_EVENT(DBG_IGNORE_CURSOR, "Ignoring cursor %s, which has an 'out of range' depth.") \
+    TMDEBUG_EVENT(DBG_CURSOR_FOUND, "Cursor: %s found. (SQL on line: %u)") \
+    TMDEBUG_EVENT(DBG_CURSOR_NOT_FOUND, "Cursor: %s not found.") \
+    TMDEBUG_EVENT(DBG_CURSOR_CREATED, "Creating Cursor: %s, SQL on line %u, length %u, %u binds.") \
+    TMDEBUG_EVENT(DBG_CURSOR_RECREATED, "ReCreating Cursor: %s, SQL on line %u, length %u, %u binds.") \
+    TMDEBUG_EVENT(DBG_CURSOR_FREED, "Freeing cursor: %s, with %u binds.") \
+    TMDEBUG_EVENT(DBG_CURSOR_CACHED_EXEC, "Cursor %s executing from cache, apparently.") \
+    TMDEBUG_EVENT(DBG_CURSOR_HARD_CLOSED, "Cursor %s has been hard closed.") \
+    TMDEBUG_EVENT(DBG_CURSOR_CACHED, "Cursor %s has been closed and cached.") \
+    TMDEBUG_EVENT(DBG_CURSOR_CLOSED, "Cursor %s now/already closed.") \
+    TMDEBUG_EVENT(DBG_PUSH_BACK, "Pushing back this line: [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_PROCESSING, "Processing: [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_START, "start_i = [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_STOP, "stop_i = [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_VALUE, "Cursor: %s: Bind #%u: BindName: [%s] has value [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_REPLACING, "Cursor: %s: Bind #%u: Replacing: [%s] with [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_EXTRACTING, "Extracting data for Bind #%u.") \
+    TMDEBUG_EVENT(DBG_BIND_SCANNING, "Scanning line: [%s]") \
+    TMDEBUG_EVENT(DBG_BIND_NO_OACDEF, "'No oacdef' found.") \
+    TMDEBUG_EVENT(DBG_BIND_SAME_DATA, "Bind#%u has same data as Bind#%u Bind name [%s].") \
+    TMDEBUG_EVENT(DBG_BIND_FOUND, "'%s' found.") \
+    TMDEBUG_EVENT(DBG_BIND_DATA_TYPE, "Data Type is %u.") \
+    TMDEBUG_EVENT(DBG_BIND_AVERAGE_LENGTH, "Average Length is %u.") \
+    TMDEBUG_EVENT(DBG_BIND_REF_CURSOR, "Bind variable: %u ('%s') for cursor: %s, has dataType 102. Setting value to 'REF_CURSOR'.") \
+    TMDEBUG_EVENT(DBG_BIND_NULL, "Suspected OUT PL/SQL parameter found, or, NULL value for bind variable found.") \
+    TMDEBUG_EVENT(DBG_BIND_EXTRACT_VALUE, "Processing Bind#%u. Extracting value from [%s]") \
+    TMDEBUG_EVENT(DBG_NUMBER_RESULT, "Result is %u.") \
+    TMDEBUG_EVENT(DBG_TEXT_RESULT, "Result is [%s].") \
+    TMDEBUG_EVENT(DBG_VIEWER_FAILED, "Viewer write failed.") \
+    TMDEBUG_EVENT(DBG_DATABASE_FAILED, "Database insert failed.") \
+    TMDEBUG_EVENT(DBG_COLUMNAR_FAILED, "Columnar export failed.")
+
+#define TMDEBUG_FUNCTION(id, name) id,
+enum tmDebugFunction { TMDEBUG_FUNCTIONS DBG_FUNCTION_COUNT };
+#undef TMDEBUG_FUNCTION
+
+#define TMDEBUG_EVENT(id, text) id,
+enum tmDebugEvent { TMDEBUG_EVENTS DBG_EVENT_COUNT };
+#undef TMDEBUG_EVENT
+
+// How many records do we buffer before writing them out? 2Mb worth.
+const unsigned DEBUGLOG_BUFFER_SIZE = 65536;
+
+/** @brief One fixed size debug record.
+ *
+ * A span record has event DBG_SPAN and the span length in mArgs[0]. The span's
+ * bytes follow it, in as many records as it takes, padded with zeros.
+ */
+struct tmDebugRecord
+{
+    uint16_t mEvent;        /**< A tmDebugEvent, or DBG_SPAN. */
+    uint16_t mFunction;     /**< A tmDebugFunction. */
+    uint32_t mLine;         /**< Trace file line number. */
+    uint64_t mArgs[3];      /**< Number arguments, in order. */
+};
+
+// The event number of a span record.
+const uint16_t DBG_SPAN = 0xffff;
+
+/** @brief A class which writes the --verbose debug file.
+ *
+ * Rather than formatting text, every event is one tmDebugRecord, naming the
+ * function, the trace line, what happened and up to three numbers. Strings,
+ * cursor ids and bind values for example, follow their event as spans. Records
+ * are copied into a fixed buffer, which is written out in one go whenever it
+ * fills up, then reused from the start. Nothing is flushed in between, so if
+ * TraceCollier dies, up to DEBUGLOG_BUFFER_SIZE records are lost.
+ *
+ * The file is the magic number "TCDEBUG1", a 32 bit record size, a 32 bit byte
+ * order check of 0x01020304 and 32 bit flags, all in the machine's own byte
+ * order, then the records. "TraceCollier --decode" turns it back into text.
+ */
+class tmDebugLog
+{
+    public:
+        tmDebugLog(const string &fileName, unsigned bufferSize, ostream &diagnostics);
+        ~tmDebugLog();
+
+        // Getters.
+        string fileName() { return mFileName; }     /**< Returns the debug file name. */
+
+        // Other useful stuff.
+        bool open();                /**< Creates the debug file and writes the header. */
+        void close();               /**< Writes out the buffer and closes the file. */
+
+        /** @brief Logs one event.
+         *
+         * @param function tmDebugFunction. Who is logging.
+         * @param line unsigned. The trace file line number.
+         * @param event tmDebugEvent. What happened.
+         * @param arg0 uint64_t. The first %u in the event's text, if any.
+         * @param arg1 uint64_t. The second %u.
+         * @param arg2 uint64_t. The third %u.
+         * @return tmDebugLog&. To allow the event's spans to be chained on.
+         */
+        tmDebugLog &log(tmDebugFunction function, unsigned line, tmDebugEvent event,
+                        uint64_t arg0 = 0, uint64_t arg1 = 0, uint64_t arg2 = 0) {
+            tmDebugRecord *r = next();
+            r->mEvent = event;
+            r->mFunction = function;
+            r->mLine = line;
+            r->mArgs[0] = arg0;
+            r->mArgs[1] = arg1;
+            r->mArgs[2] = arg2;
+            return *this;
+        }
+
+        /** @brief Adds the next %s span to the event just logged.
+         *
+         * @param text const string&. The span.
+         * @return tmDebugLog&. To allow further spans to be chained on.
+         */
+        tmDebugLog &span(const string &text) { return span(text.data(), text.length()); }
+
+        tmDebugLog &span(const char *text) { return span(text, strlen(text)); }   /**< Adds the next %s span to the event just logged. */
+        tmDebugLog &span(const char *text, size_t length);     /**< Adds the next %s span to the event just logged. */
+
+        static bool decode(const string &debugFileName, ostream &out, ostream &diagnostics);     /**< Writes a debug file out as text. */
+
+    protected:
+
+    private:
+        string mFileName;                   /**< Where we are writing to. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+        ofstream *mOfs;                     /**< The file itself. */
+        vector<tmDebugRecord> mBuffer;      /**< Records not yet written out. */
+        unsigned mUsed;                     /**< How many of mBuffer are in use. */
+
+        /** @brief Returns the next free record, writing the buffer out first if it is full. */
+        tmDebugRecord *next() {
+            if (mUsed == mBuffer.size()) {
+                flush();
+            }
+            return &mBuffer[mUsed++];
+        }
+
+        void flush();                       /**< Writes out the buffered records. */
+};
+
+#endif // TMDEBUGLOG_H
@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmevents.h"
+
+/** @file tmevents.cpp
+ * @brief Implementation file for the tmEventHandler helpers.
+ *
+ * These find things on a trace line without copying anything, for the
+ * tmView members of the events.
+ */
+
+
+/** @brief Returns the cursor id on a trace line.
+ *
+ * @param thisLine const string&. A trace line with "#nnnn" on it.
+ * @return tmView. The '#' and the digits after it, or empty if there's no '#'.
+ */
+tmView cursorView(const string &thisLine)
+{
+    string::size_type hashPos = thisLine.find('#');
+    if (hashPos == string::npos) {
+        return tmView();
+    }
+
+    string::size_type endPos = hashPos + 1;
+    while (endPos < thisLine.length() &&
+           thisLine[endPos] >= '0' && thisLine[endPos] <= '9') {
+        endPos++;
+    }
+
+    return tmView(thisLine.data() + hashPos, endPos - hashPos);
+}
+
+
+/** @brief Returns the value after a name on a trace line.
+ *
+ * @param thisLine const string&. The trace line.
+ * @param lookFor const char*. The name, with its '=', "nam=" for example.
+ * @return tmView. The value, or empty if the name isn't there.
+ *
+ * A quoted value, nam='db file sequential read' for example, is returned
+ * without its quotes. Otherwise the value ends at a space or a comma.
+ */
+tmView valueView(const string &thisLine, const char *lookFor)
+{
+    string::size_type pos = thisLine.find(lookFor);
+    if (pos == string::npos) {
+        return tmView();
+    }
+
+    pos += strlen(lookFor);
+    if (pos < thisLine.length() && thisLine[pos] == '\'') {
+        string::size_type closePos = thisLine.find('\'', pos + 1);
+        if (closePos == string::npos) {
+            closePos = thisLine.length();
+        }
+
+        return tmView(thisLine.data() + pos + 1, closePos - pos - 1);
+    }
+
+    string::size_type endPos = thisLine.find_first_of(" ,", pos);
+    if (endPos == string::npos) {
+        endPos = thisLine.length();
+    }
+
+    return tmView(thisLine.data() + pos, endPos - pos);
+}
+
+
+/** @brief Returns the number after a name on a trace line.
+ *
+ * @param thisLine const string&. The trace line.
+ * @param lookFor const char*. The name, with its '=', "ela=" for example.
+ * @return unsigned long long. The number, or zero if the name isn't there.
+ *
+ * Spaces after the '=' are skipped, WAIT lines have "ela= 123".
+ */
+unsigned long long numberValue(const string &thisLine, const char *lookFor)
+{
+    string::size_type pos = thisLine.find(lookFor);
+    if (pos == string::npos) {
+        return 0;
+    }
+
+    const char *p = thisLine.c_str() + pos + strlen(lookFor);
+    while (*p == ' ') {
+        p++;
+    }
+
+    unsigned long long value = 0;
+    while (*p >= '0' && *p <= '9') {
+        value = (value * 10) + (*p - '0');
+        p++;
+    }
+
+    return value;
+}
+
+
+void tmEventHandlers::onCursorParsed(const tmCursorParsedEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onCursorParsed(event);
+    }
+}
+
+
+void tmEventHandlers::onCall(const tmCallEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onCall(event);
+    }
+}
+
+
+void tmEventHandlers::onParse(const tmCallEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onParse(event);
+    }
+}
+
+
+void tmEventHandlers::onBinds(const tmBindsEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onBinds(event);
+    }
+}
+
+
+void tmEventHandlers::onExec(const tmCallEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onExec(event);
+    }
+}
+
+
+void tmEventHandlers::onFetch(const tmCallEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onFetch(event);
+    }
+}
+
+
+void tmEventHandlers::onWait(const tmWaitEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onWait(event);
+    }
+}
+
+
+void tmEventHandlers::onClose(const tmCloseEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onClose(event);
+    }
+}
+
+
+void tmEventHandlers::onStat(const tmStatEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onStat(event);
+    }
+}
+
+
+void tmEventHandlers::onXctend(const tmXctendEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onXctend(event);
+    }
+}
+
+
+void tmEventHandlers::onError(const tmErrorEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onError(event);
+    }
+}
+
+
+void tmEventHandlers::onParseError(const tmParseErrorEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onParseError(event);
+    }
+}
+
+
+void tmEventHandlers::onDeadlock(const tmDeadlockEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onDeadlock(event);
+    }
+}
+
+
+void tmEventHandlers::onSession(const tmSessionEvent &event)
+{
+    for (vector<tmEventHandler *>::iterator i = mHandlers.begin(); i != mHandlers.end(); ++i) {
+        (*i)->onSession(event);
+    }
+}
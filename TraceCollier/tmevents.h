@@ -0,0 +1,289 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMEVENTS_H
+#define TMEVENTS_H
+
+/** @file tmevents.h
+ * @brief Header file for the events passed to a tmEventHandler.
+ *
+ * A program which links with libtracecollier, rather than running
+ * TraceCollier, passes its own tmEventHandler to tmTraceFile::create(). It
+ * then gets one call per trace record, and no report is written at all.
+ * A handler can also be given to a parser which is writing a report, with
+ * tmTraceFile::setEventHandler(), and is called as the report is written.
+ *
+ * @code
+ * class myHandler : public tmEventHandler {
+ *     public:
+ *         void onExec(const tmCallEvent &event) { elapsed += event.stats.elapsed(); }
+ *         unsigned long long elapsed = 0;
+ * };
+ *
+ * tmOptions options;
+ * options.setTraceFile("orcl_ora_1234.trc");
+ * myHandler handler;
+ * tmTraceFile *traceFile = tmTraceFile::create(&options, &handler);
+ * bool ok = traceFile->parse(0);
+ * delete traceFile;
+ * @endcode
+ *
+ * The tmView members point into the line just read, or into the cursor.
+ * They are only valid during the call, so copy them, with str(), if they
+ * are needed afterwards.
+ */
+
+#include <string>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include "tmcallstats.h"
+
+using std::string;
+using std::ostream;
+using std::vector;
+
+class tmCursor;
+
+/** @brief Part of a trace line, without a copy of it.
+ */
+class tmView
+{
+    public:
+        tmView() : mData(""), mLength(0) {}
+        tmView(const char *data, size_t length) : mData(data), mLength(length) {}
+        tmView(const string &text) : mData(text.data()), mLength(text.length()) {}
+
+        // Getters.
+        const char *data() const { return mData; }      /**< Returns the first character. Not NUL terminated. */
+        size_t length() const { return mLength; }       /**< Returns the number of characters. */
+        bool empty() const { return mLength == 0; }     /**< Returns true if there are no characters. */
+        string str() const { return string(mData, mLength); }  /**< Returns a copy, as a string. */
+
+        /** @brief Compares with a C string.
+         *
+         * @param text const char*. The string to compare with.
+         * @return bool. True if they are the same.
+         */
+        bool operator==(const char *text) const {
+            return strncmp(mData, text, mLength) == 0 && text[mLength] == '\0';
+        }
+
+    private:
+        const char *mData;      /**< The first character. */
+        size_t mLength;         /**< How many characters. */
+};
+
+/** @brief Writes a tmView to a stream. */
+inline ostream &operator<<(ostream &out, const tmView &view) {
+    return out.write(view.data(), view.length());
+}
+
+/** @brief A PARSING IN CURSOR, once the SQL text has been read. */
+struct tmCursorParsedEvent {
+    unsigned line;              /**< Line number of the PARSING IN CURSOR. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    unsigned depth;             /**< Recursive depth, dep=. */
+    unsigned sqlLength;         /**< SQL length, len=. */
+    unsigned commandType;       /**< Oracle command type, oct=. */
+    tmView sqlId;               /**< Oracle's sqlid=, 11g onwards. Otherwise empty. */
+    tmCursor *cursor;           /**< The cursor, with its SQL text and (empty) binds. */
+};
+
+/** @brief Which database call a tmCallEvent is for. */
+enum tmCallType {
+    CALL_PARSE,                 /**< A PARSE. */
+    CALL_EXEC,                  /**< An EXEC. */
+    CALL_FETCH,                 /**< A FETCH. */
+    CALL_CLOSE                  /**< A CLOSE. Only for onCall(). */
+};
+
+/** @brief A PARSE, EXEC or FETCH line, or for onCall(), a CLOSE line. */
+struct tmCallEvent {
+    tmCallType type;            /**< Which call. */
+    unsigned line;              /**< Line number. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    tmCallStats stats;          /**< The c=, e=, p= etc figures. */
+    tmView local;               /**< Local date/time if the trace was TraceAdjusted. Otherwise empty. */
+    tmCallTotals recursive;     /**< The recursive calls it made, one depth down. Already included in stats. */
+    tmCursor *cursor;           /**< The cursor. Its binds are those of the latest BINDS. NULL, for a FETCH or onCall(), if it wasn't parsed in the trace. */
+};
+
+/** @brief A BINDS line, once the bind values have been extracted. */
+struct tmBindsEvent {
+    unsigned line;              /**< Line number of the BINDS line. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    tmCursor *cursor;           /**< The cursor, with the new bind values. */
+};
+
+/** @brief A WAIT line. */
+struct tmWaitEvent {
+    unsigned line;              /**< Line number. */
+    tmView cursorId;            /**< Cursor id, with its '#'. Oracle uses #0 outside any cursor. */
+    tmView name;                /**< Wait event name, nam=, without the quotes. */
+    unsigned long long elapsed; /**< Elapsed time, ela=, in microseconds. */
+    unsigned long long tim;     /**< Timestamp, tim=, in microseconds. */
+    tmView parameters;          /**< Everything between ela= and tim=. p1, p2, p3, obj# etc. */
+    long long object;           /**< obj#=, the object waited on. -1 if none, or not known. */
+    tmCursor *cursor;           /**< The cursor, or NULL if there isn't one. */
+};
+
+/** @brief A CLOSE line. */
+struct tmCloseEvent {
+    unsigned line;              /**< Line number. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    tmCallStats stats;          /**< The c=, e= and dep= figures. */
+    unsigned closeType;         /**< type=. 0 is a hard close, 1 to 3 are cached. */
+    tmCallTotals recursive;     /**< The recursive calls it made, one depth down. Already included in stats. */
+    tmCursor *cursor;           /**< The cursor, or NULL if there isn't one. */
+};
+
+/** @brief A STAT line, one row of an execution plan. */
+struct tmStatEvent {
+    unsigned line;              /**< Line number. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    unsigned id;                /**< Row source id, id=. */
+    unsigned long long rows;    /**< Rows produced, cnt=. */
+    unsigned parentId;          /**< Parent row source id, pid=. */
+    unsigned position;          /**< Position under the parent, pos=. */
+    unsigned long long objectId;    /**< Object id, obj=. */
+    tmView operation;           /**< The operation, op=, without the quotes. From 10g, the figures below follow it in brackets. */
+    unsigned long long consistentReads; /**< Consistent reads, cr=. */
+    unsigned long long physicalReads;   /**< Physical reads, pr=. */
+    unsigned long long physicalWrites;  /**< Physical writes, pw=. */
+    unsigned long long time;    /**< Elapsed time, time=, in microseconds. */
+    unsigned long long cost;    /**< Optimizer cost, cost=. 11g onwards. */
+    unsigned long long size;    /**< Optimizer estimated bytes, size=. 11g onwards. */
+    unsigned long long cardinality; /**< Optimizer estimated rows, card=. 11g onwards. */
+    unsigned long long planHash;    /**< The cursor's plan hash value, plh=, from its latest PARSE or EXEC. */
+    tmCursor *cursor;           /**< The cursor, or NULL if there isn't one. */
+};
+
+/** @brief An XCTEND line, a COMMIT or ROLLBACK. */
+struct tmXctendEvent {
+    unsigned line;              /**< Line number. */
+    bool rollback;              /**< True for a ROLLBACK, rlbk=1. */
+    bool readOnly;              /**< True if nothing was changed, rd_only=1. */
+    unsigned long long tim;     /**< Timestamp, tim=, in microseconds. */
+};
+
+/** @brief An ERROR line. */
+struct tmErrorEvent {
+    unsigned line;              /**< Line number. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    unsigned error;             /**< The ORA- error number, err=. */
+    unsigned long long tim;     /**< Timestamp, tim=, in microseconds. */
+    tmCursor *cursor;           /**< The cursor, or NULL if there isn't one. */
+};
+
+/** @brief A PARSE ERROR line. */
+struct tmParseErrorEvent {
+    unsigned line;              /**< Line number. */
+    tmView cursorId;            /**< Cursor id, with its '#'. */
+    unsigned depth;             /**< Recursive depth, dep=. */
+    unsigned error;             /**< The ORA- error number, err=. */
+    tmView sqlText;             /**< The first line of the SQL which failed. */
+};
+
+/** @brief A deadlock graph. */
+struct tmDeadlockEvent {
+    unsigned line;              /**< Line number of the DEADLOCK DETECTED line. */
+    tmView graph;               /**< The deadlock graph, one line per trace line. */
+};
+
+/** @brief A *** SESSION ID line. The records after it are that session's.
+ *
+ * A trace from a shared server, or put together by trcsess, has several.
+ */
+struct tmSessionEvent {
+    unsigned line;              /**< Line number. */
+    tmView sessionId;           /**< The SID and serial number, "42.4242", without the brackets. */
+    tmView timestamp;           /**< The date and time after it. */
+};
+
+/** @brief Receives the trace records as they are parsed.
+ *
+ * Override the ones you want, the others do nothing.
+ */
+class tmEventHandler
+{
+    public:
+        virtual ~tmEventHandler() {}
+
+        virtual void onCursorParsed(const tmCursorParsedEvent &) {}  /**< Called for a PARSING IN CURSOR. */
+        virtual void onCall(const tmCallEvent &) {}                 /**< Called for every PARSE, EXEC, FETCH and CLOSE, at any depth, first. */
+        virtual void onParse(const tmCallEvent &) {}                /**< Called for a PARSE. */
+        virtual void onBinds(const tmBindsEvent &) {}               /**< Called for a BINDS. */
+        virtual void onExec(const tmCallEvent &) {}                 /**< Called for an EXEC at dep <= tmOptions::depth(). */
+        virtual void onFetch(const tmCallEvent &) {}                /**< Called for a FETCH at dep <= tmOptions::depth(). */
+        virtual void onWait(const tmWaitEvent &) {}                 /**< Called for a WAIT. */
+        virtual void onClose(const tmCloseEvent &) {}               /**< Called for a CLOSE. */
+        virtual void onStat(const tmStatEvent &) {}                 /**< Called for a STAT. */
+        virtual void onXctend(const tmXctendEvent &) {}             /**< Called for an XCTEND. */
+        virtual void onError(const tmErrorEvent &) {}               /**< Called for an ERROR. */
+        virtual void onParseError(const tmParseErrorEvent &) {}     /**< Called for a PARSE ERROR. */
+        virtual void onDeadlock(const tmDeadlockEvent &) {}         /**< Called for a deadlock graph. */
+        virtual void onSession(const tmSessionEvent &) {}           /**< Called for a *** SESSION ID. The first is in the header. */
+};
+
+/** @brief Passes every record on to several handlers, in the order they were added.
+ *
+ * A parser only has one handler, so this lets the summary, the slowest
+ * executions and so on all see the same records in the one pass.
+ */
+class tmEventHandlers : public tmEventHandler
+{
+    public:
+        // Getters.
+        size_t size() const { return mHandlers.size(); }    /**< Returns how many handlers. */
+        tmEventHandler *handler(size_t x) { return mHandlers[x]; }     /**< Returns a handler. */
+
+        // Setters.
+        void add(tmEventHandler *handler) { mHandlers.push_back(handler); }    /**< Adds a handler. It isn't deleted. */
+
+        void onCursorParsed(const tmCursorParsedEvent &event);
+        void onCall(const tmCallEvent &event);
+        void onParse(const tmCallEvent &event);
+        void onBinds(const tmBindsEvent &event);
+        void onExec(const tmCallEvent &event);
+        void onFetch(const tmCallEvent &event);
+        void onWait(const tmWaitEvent &event);
+        void onClose(const tmCloseEvent &event);
+        void onStat(const tmStatEvent &event);
+        void onXctend(const tmXctendEvent &event);
+        void onError(const tmErrorEvent &event);
+        void onParseError(const tmParseErrorEvent &event);
+        void onDeadlock(const tmDeadlockEvent &event);
+        void onSession(const tmSessionEvent &event);
+
+    private:
+        vector<tmEventHandler *> mHandlers;     /**< The handlers. */
+};
+
+tmView cursorView(const string &thisLine);                         /**< Returns the cursor id on a trace line. */
+tmView valueView(const string &thisLine, const char *lookFor);     /**< Returns the value after 'name=' on a trace line. */
+unsigned long long numberValue(const string &thisLine, const char *lookFor);   /**< Returns the number after 'name=' on a trace line. */
+
+#endif // TMEVENTS_H
@@ -0,0 +1,633 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <cctype>
+#include <stdint.h>
+
+#include "tmfingerprint.h"
+
+/** @file tmfingerprint.cpp
+ * @brief Implementation file for the tmSqlFingerprint object.
+ */
+
+// FNV-1a, 64 bit.
+const unsigned long long FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const unsigned long long FNV_PRIME = 1099511628211ULL;
+
+// Longest label, in characters. Longer SQL is cut short.
+const string::size_type LABEL_LENGTH = 80;
+
+// Oracle's sql_id alphabet. No 'e', 'i', 'l' or 'o'.
+static const char *sqlIdAlphabet = "0123456789abcdfghjkmnpqrstuvwxyz";
+
+
+/** @brief Is this a character which can be part of a word? */
+static inline bool isWordChar(unsigned char c)
+{
+    return isalnum(c) || c == '_' || c == '$' || c == '#' || c >= 0x80;
+}
+
+
+/** @brief Is this a character which can be part of an operator? */
+static inline bool isOperatorChar(unsigned char c)
+{
+    return strchr("<>=!|^~+-*/%@&:", c) != NULL && c != '\0';
+}
+
+
+/** @brief Returns the position after a quoted string, Oracle style.
+ *
+ * @param sqlText const string&. The SQL text.
+ * @param pos string::size_type. Where the opening quote is.
+ * @return string::size_type. Just after the closing quote. Doubled quotes
+ * are part of the string. An unterminated string runs to the end.
+ */
+static string::size_type quotedEnd(const string &sqlText, string::size_type pos)
+{
+    string::size_type len = sqlText.length();
+    pos++;
+
+    while (pos < len) {
+        if (sqlText[pos] == '\'') {
+            if (pos + 1 < len && sqlText[pos + 1] == '\'') {
+                pos += 2;
+                continue;
+            }
+
+            return pos + 1;
+        }
+
+        pos++;
+    }
+
+    return len;
+}
+
+
+/** @brief Returns the position after an alternative quoted string, q'[...]'.
+ *
+ * @param sqlText const string&. The SQL text.
+ * @param pos string::size_type. Where the opening quote, after the q, is.
+ * @return string::size_type. Just after the closing quote.
+ */
+static string::size_type qQuotedEnd(const string &sqlText, string::size_type pos)
+{
+    string::size_type len = sqlText.length();
+    if (pos + 1 >= len) {
+        return len;
+    }
+
+    char open = sqlText[pos + 1];
+    char close = open;
+    switch (open) {
+        case '[': close = ']'; break;
+        case '{': close = '}'; break;
+        case '(': close = ')'; break;
+        case '<': close = '>'; break;
+    }
+
+    for (pos += 2; pos + 1 < len; pos++) {
+        if (sqlText[pos] == close && sqlText[pos + 1] == '\'') {
+            return pos + 2;
+        }
+    }
+
+    return len;
+}
+
+
+/** @brief Returns the position after a literal, if there's one here.
+ *
+ * @param sqlText const string&. The SQL text.
+ * @param pos string::size_type. The start of a token.
+ * @return string::size_type. Just after the literal, or string::npos if
+ * there isn't one. Strings, N'...', q'[...]', Nq'[...]' and numbers
+ * such as 42, 3.14, .5, 1e-3 and 2.5f are all literals.
+ */
+static string::size_type literalEnd(const string &sqlText, string::size_type pos)
+{
+    string::size_type len = sqlText.length();
+    char c = sqlText[pos];
+    char next = (pos + 1 < len) ? sqlText[pos + 1] : '\0';
+
+    if (c == '\'') {
+        return quotedEnd(sqlText, pos);
+    }
+
+    if ((c == 'n' || c == 'N') && next == '\'') {
+        return quotedEnd(sqlText, pos + 1);
+    }
+
+    if ((c == 'q' || c == 'Q') && next == '\'') {
+        return qQuotedEnd(sqlText, pos + 1);
+    }
+
+    if ((c == 'n' || c == 'N') && (next == 'q' || next == 'Q') &&
+        pos + 2 < len && sqlText[pos + 2] == '\'') {
+        return qQuotedEnd(sqlText, pos + 2);
+    }
+
+    // Numbers. A second dot is PL/SQL's "1..10", so not ours.
+    if (!isdigit((unsigned char)c) && !(c == '.' && isdigit((unsigned char)next))) {
+        return string::npos;
+    }
+
+    while (pos < len && isdigit((unsigned char)sqlText[pos])) {
+        pos++;
+    }
+
+    if (pos < len && sqlText[pos] == '.' && !(pos + 1 < len && sqlText[pos + 1] == '.')) {
+        pos++;
+        while (pos < len && isdigit((unsigned char)sqlText[pos])) {
+            pos++;
+        }
+    }
+
+    if (pos + 1 < len && (sqlText[pos] == 'e' || sqlText[pos] == 'E')) {
+        string::size_type exponent = pos + 1;
+        if (sqlText[exponent] == '+' || sqlText[exponent] == '-') {
+            exponent++;
+        }
+
+        if (exponent < len && isdigit((unsigned char)sqlText[exponent])) {
+            pos = exponent;
+            while (pos < len && isdigit((unsigned char)sqlText[pos])) {
+                pos++;
+            }
+        }
+    }
+
+    if (pos < len && strchr("fFdD", sqlText[pos]) && sqlText[pos] != '\0' &&
+        !(pos + 1 < len && isWordChar(sqlText[pos + 1]))) {
+        pos++;
+    }
+
+    return pos;
+}
+
+
+/** @brief Returns the position after a bind, if there's one here.
+ *
+ * @param sqlText const string&. The SQL text.
+ * @param pos string::size_type. Where the colon is.
+ * @return string::size_type. Just after the bind's name, or string::npos
+ * if this isn't a bind. PL/SQL's ":=" isn't.
+ */
+static string::size_type bindEnd(const string &sqlText, string::size_type pos)
+{
+    string::size_type len = sqlText.length();
+    if (sqlText[pos] != ':' || pos + 1 >= len) {
+        return string::npos;
+    }
+
+    pos++;
+    if (sqlText[pos] == '"') {
+        string::size_type close = sqlText.find('"', pos + 1);
+        return (close == string::npos) ? len : close + 1;
+    }
+
+    if (!isWordChar(sqlText[pos])) {
+        return string::npos;
+    }
+
+    while (pos < len && isWordChar(sqlText[pos])) {
+        pos++;
+    }
+
+    return pos;
+}
+
+
+/** @brief Is there an IN list of literals and binds here?
+ *
+ * @param sqlText const string&. The SQL text.
+ * @param pos string::size_type. Where the opening bracket is.
+ * @return string::size_type. Just after the closing bracket, or string::npos
+ * if the list has anything else in it, a sub-query for example.
+ */
+static string::size_type inListEnd(const string &sqlText, string::size_type pos)
+{
+    string::size_type len = sqlText.length();
+    pos++;
+
+    while (true) {
+        while (pos < len && isspace((unsigned char)sqlText[pos])) {
+            pos++;
+        }
+
+        if (pos < len && (sqlText[pos] == '-' || sqlText[pos] == '+')) {
+            pos++;
+        }
+
+        if (pos >= len) {
+            return string::npos;
+        }
+
+        string::size_type end = (sqlText[pos] == ':') ? bindEnd(sqlText, pos) : literalEnd(sqlText, pos);
+        if (end == string::npos) {
+            return string::npos;
+        }
+
+        pos = end;
+        while (pos < len && isspace((unsigned char)sqlText[pos])) {
+            pos++;
+        }
+
+        if (pos >= len) {
+            return string::npos;
+        }
+
+        if (sqlText[pos] == ')') {
+            return pos + 1;
+        }
+
+        if (sqlText[pos] != ',') {
+            return string::npos;
+        }
+
+        pos++;
+    }
+}
+
+
+/** @brief Constructor for a tmSqlFingerprint object.
+ */
+tmSqlFingerprint::tmSqlFingerprint()
+{
+    mFingerprint = FNV_OFFSET_BASIS;
+}
+
+
+/** @brief Appends a character to the normalised text, and hashes it.
+ *
+ * @param c char. The character.
+ */
+void tmSqlFingerprint::emit(char c)
+{
+    mNormalised.push_back(c);
+    mFingerprint = (mFingerprint ^ (unsigned char)c) * FNV_PRIME;
+}
+
+
+/** @brief Appends some characters to the normalised text, and hashes them.
+ *
+ * @param text const char*. The characters.
+ */
+void tmSqlFingerprint::emit(const char *text)
+{
+    while (*text) {
+        emit(*text++);
+    }
+}
+
+
+/** @brief Writes a space before the next token, unless it's next to a
+ *         bracket, comma or dot.
+ *
+ * @param first char. The next token's first character.
+ */
+void tmSqlFingerprint::separate(char first)
+{
+    if (mNormalised.empty() || strchr("(),.;", first)) {
+        return;
+    }
+
+    char last = mNormalised[mNormalised.length() - 1];
+    if (last != '(' && last != '.') {
+        emit(' ');
+    }
+}
+
+
+/** @brief Normalises some SQL text, and fingerprints it.
+ *
+ * @param sqlText const string&. The SQL text, from a PARSING IN CURSOR.
+ *
+ * One pass over the text, writing the normalised text, and hashing it,
+ * a token at a time.
+ */
+void tmSqlFingerprint::parse(const string &sqlText)
+{
+    mNormalised.clear();
+    mNormalised.reserve(sqlText.length());
+    mFingerprint = FNV_OFFSET_BASIS;
+
+    string::size_type len = sqlText.length();
+    string::size_type pos = 0;
+
+    while (pos < len) {
+        unsigned char c = sqlText[pos];
+        unsigned char next = (pos + 1 < len) ? sqlText[pos + 1] : '\0';
+
+        // White space only separates tokens.
+        if (isspace(c)) {
+            pos++;
+            continue;
+        }
+
+        // Comments go, but hints stay.
+        if (c == '-' && next == '-') {
+            pos = sqlText.find('\n', pos);
+            if (pos == string::npos) {
+                pos = len;
+            }
+            continue;
+        }
+
+        if (c == '/' && next == '*') {
+            string::size_type close = sqlText.find("*/", pos + 2);
+            string::size_type end = (close == string::npos) ? len : close;
+
+            if (pos + 2 < len && sqlText[pos + 2] == '+') {
+                separate('/');
+                emit("/*+");
+
+                bool space = false;
+                for (string::size_type p = pos + 3; p < end; p++) {
+                    if (isspace((unsigned char)sqlText[p])) {
+                        space = true;
+                        continue;
+                    }
+
+                    if (space) {
+                        emit(' ');
+                        space = false;
+                    }
+
+                    emit(tolower((unsigned char)sqlText[p]));
+                }
+
+                emit(" */");
+            }
+
+            pos = (close == string::npos) ? len : close + 2;
+            continue;
+        }
+
+        // PL/SQL's range, "1..10", before ".10" looks like a number.
+        if (c == '.' && next == '.') {
+            emit("..");
+            pos += 2;
+            continue;
+        }
+
+        // Literals, of all kinds, become a '?'.
+        string::size_type end = literalEnd(sqlText, pos);
+        if (end != string::npos) {
+            separate('?');
+            emit('?');
+            pos = end;
+            continue;
+        }
+
+        // Quoted identifiers are case sensitive.
+        if (c == '"') {
+            end = sqlText.find('"', pos + 1);
+            end = (end == string::npos) ? len : end + 1;
+
+            separate('"');
+            for (; pos < end; pos++) {
+                emit(sqlText[pos]);
+            }
+            continue;
+        }
+
+        // Binds keep their names.
+        if (c == ':') {
+            end = bindEnd(sqlText, pos);
+            if (end != string::npos) {
+                separate(':');
+                for (; pos < end; pos++) {
+                    emit(sqlText[pos] == '"' ? '"' : tolower((unsigned char)sqlText[pos]));
+                }
+                continue;
+            }
+        }
+
+        // Keywords and names. An IN list of literals or binds, however
+        // long, becomes "(?+)".
+        if (isWordChar(c)) {
+            end = pos;
+            while (end < len && isWordChar(sqlText[end])) {
+                end++;
+            }
+
+            separate(c);
+            for (string::size_type p = pos; p < end; p++) {
+                emit(tolower((unsigned char)sqlText[p]));
+            }
+
+            if (end - pos == 2 && tolower(c) == 'i' && tolower(next) == 'n') {
+                string::size_type bracket = end;
+                while (bracket < len && isspace((unsigned char)sqlText[bracket])) {
+                    bracket++;
+                }
+
+                if (bracket < len && sqlText[bracket] == '(') {
+                    string::size_type listEnd = inListEnd(sqlText, bracket);
+                    if (listEnd != string::npos) {
+                        emit("(?+)");
+                        end = listEnd;
+                    }
+                }
+            }
+
+            pos = end;
+            continue;
+        }
+
+        // Operators, "<=", "||" and so on, are one token.
+        if (isOperatorChar(c)) {
+            separate(c);
+            while (pos < len && isOperatorChar(sqlText[pos]) &&
+                   !(sqlText[pos] == '-' && pos + 1 < len && sqlText[pos + 1] == '-') &&
+                   !(sqlText[pos] == '/' && pos + 1 < len && sqlText[pos + 1] == '*') &&
+                   !(sqlText[pos] == ':' && bindEnd(sqlText, pos) != string::npos)) {
+                emit(sqlText[pos]);
+                pos++;
+            }
+            continue;
+        }
+
+        // Anything else, brackets, commas and so on.
+        separate(c);
+        emit(c);
+        pos++;
+    }
+
+    makeLabel();
+}
+
+
+/** @brief Works out a short label for the SQL, from the normalised text.
+ *
+ * The normalised text up to its first semicolon, so "begin pkg.proc; end;"
+ * is "begin pkg.proc". A SELECT's column list is left out, as it's the
+ * tables which tell one query from another, and anything longer than
+ * LABEL_LENGTH ends with "...".
+ */
+void tmSqlFingerprint::makeLabel()
+{
+    mLabel.assign(mNormalised, 0, mNormalised.find(';'));
+
+    while (!mLabel.empty() && mLabel[mLabel.length() - 1] == ' ') {
+        mLabel.erase(mLabel.length() - 1);
+    }
+
+    if (mLabel.compare(0, 7, "select ") == 0) {
+        string::size_type from = mLabel.find(" from ");
+        if (from != string::npos && from > 7) {
+            mLabel.replace(7, from - 7, "...");
+        }
+    }
+
+    if (mLabel.length() > LABEL_LENGTH) {
+        mLabel.erase(LABEL_LENGTH - 3);
+        mLabel += "...";
+    }
+}
+
+
+// MD5, as RFC 1321, for Oracle's sql_id. Not for anything secure.
+static const uint32_t md5K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+static const unsigned md5Shift[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+
+/** @brief Computes the MD5 digest of some bytes.
+ *
+ * @param message const string&. The bytes.
+ * @param digest uint32_t*. The four little endian words of the digest.
+ */
+static void md5(const string &message, uint32_t digest[4])
+{
+    // Pad to 56 bytes mod 64, then the bit length, little endian.
+    string padded(message);
+    unsigned long long bits = (unsigned long long)message.length() * 8;
+    padded.push_back((char)0x80);
+    while (padded.length() % 64 != 56) {
+        padded.push_back('\0');
+    }
+
+    for (int i = 0; i < 8; i++) {
+        padded.push_back((char)(bits >> (i * 8)));
+    }
+
+    digest[0] = 0x67452301;
+    digest[1] = 0xefcdab89;
+    digest[2] = 0x98badcfe;
+    digest[3] = 0x10325476;
+
+    for (string::size_type block = 0; block < padded.length(); block += 64) {
+        uint32_t m[16];
+        for (int i = 0; i < 16; i++) {
+            const unsigned char *p = (const unsigned char *)padded.data() + block + i * 4;
+            m[i] = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        uint32_t a = digest[0], b = digest[1], c = digest[2], d = digest[3];
+        for (unsigned i = 0; i < 64; i++) {
+            uint32_t f;
+            unsigned g;
+            if (i < 16) {
+                f = (b & c) | (~b & d);
+                g = i;
+            } else if (i < 32) {
+                f = (d & b) | (~d & c);
+                g = (5 * i + 1) % 16;
+            } else if (i < 48) {
+                f = b ^ c ^ d;
+                g = (3 * i + 5) % 16;
+            } else {
+                f = c ^ (b | ~d);
+                g = (7 * i) % 16;
+            }
+
+            uint32_t temp = d;
+            d = c;
+            c = b;
+            f += a + md5K[i] + m[g];
+            b += (f << md5Shift[i]) | (f >> (32 - md5Shift[i]));
+            a = temp;
+        }
+
+        digest[0] += a;
+        digest[1] += b;
+        digest[2] += c;
+        digest[3] += d;
+    }
+}
+
+
+/** @brief Returns Oracle's sql_id for some SQL text.
+ *
+ * @param sqlText const string&. The exact SQL text.
+ * @return string. The 13 character sql_id.
+ *
+ * Oracle takes the MD5 of the text with its trailing NUL, and the last
+ * 64 bits of that, written in base 32, is the sql_id.
+ */
+string tmSqlFingerprint::oracleSqlId(const string &sqlText)
+{
+    uint32_t digest[4];
+    md5(sqlText + '\0', digest);
+
+    unsigned long long n = ((unsigned long long)digest[2] << 32) | digest[3];
+    char sqlId[14];
+    sqlId[13] = '\0';
+    for (int i = 12; i >= 0; i--) {
+        sqlId[i] = sqlIdAlphabet[n & 0x1f];
+        n >>= 5;
+    }
+
+    return string(sqlId);
+}
+
+
+/** @brief Returns Oracle's hash_value for some SQL text.
+ *
+ * @param sqlText const string&. The exact SQL text.
+ * @return unsigned. The hash_value, the low 32 bits of the sql_id.
+ */
+unsigned tmSqlFingerprint::oracleHashValue(const string &sqlText)
+{
+    uint32_t digest[4];
+    md5(sqlText + '\0', digest);
+    return digest[3];
+}
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMFINGERPRINT_H
+#define TMFINGERPRINT_H
+
+/** @file tmfingerprint.h
+ * @brief Header file for the tmSqlFingerprint object.
+ */
+
+#include <string>
+
+using std::string;
+
+/** @brief A class which normalises SQL text, so that statements which only
+ *         differ in their literals can be grouped together.
+ *
+ * Applications which build their SQL with literals, rather than binds,
+ * produce a different SQL text for every execution. In one pass over the
+ * text, parse():
+ *
+ * @li replaces numeric and string literals, including N'...' and q'[...]', with '?'.
+ * @li replaces IN lists of literals and binds, of any length, with "(?+)".
+ * @li removes comments, but keeps hints.
+ * @li lays the tokens out the same way, whatever the white space was. One
+ * space between tokens, except next to brackets, commas and dots.
+ * @li folds everything outside quoted identifiers to lower case.
+ *
+ * and computes a 64 bit FNV-1a hash, the fingerprint, of the result as it
+ * goes. For example, these two:
+ *
+ * @code
+ * SELECT * FROM emp WHERE deptno IN (10, 20)  AND ename = 'KING'
+ * select *
+ *   from EMP where DEPTNO in (30) and ename='SMITH' -- the boss
+ * @endcode
+ *
+ * are both "select * from emp where deptno in(?+) and ename = ?" with
+ * the same fingerprint.
+ *
+ * oracleSqlId() and oracleHashValue() are Oracle's own sql_id and
+ * hash_value, from the MD5 of the exact text, for joining to V$SQL or AWR.
+ * They only match if the trace has the text exactly as Oracle saw it.
+ */
+class tmSqlFingerprint
+{
+    public:
+        tmSqlFingerprint();
+
+        // Getters.
+        unsigned long long fingerprint() const { return mFingerprint; }     /**< Returns the 64 bit fingerprint. */
+        const string &normalised() const { return mNormalised; }            /**< Returns the normalised SQL text. */
+        const string &label() const { return mLabel; }                      /**< Returns a short label for the normalised SQL text. No semicolons. */
+
+        // Other useful stuff.
+        void parse(const string &sqlText);      /**< Normalises SQL text, and fingerprints it. */
+
+        static string oracleSqlId(const string &sqlText);           /**< Returns Oracle's 13 character sql_id for some SQL text. */
+        static unsigned oracleHashValue(const string &sqlText);     /**< Returns Oracle's hash_value for some SQL text. */
+
+    protected:
+
+    private:
+        void separate(char first);              /**< Writes a space before the next token, if it needs one. */
+        void emit(char c);                      /**< Appends a character to the normalised text. */
+        void emit(const char *text);            /**< Appends some characters to the normalised text. */
+        void makeLabel();                       /**< Works out mLabel from mNormalised. */
+
+        string mNormalised;                     /**< The normalised SQL text. */
+        string mLabel;                          /**< A short label for the normalised SQL text. */
+        unsigned long long mFingerprint;        /**< FNV-1a hash of mNormalised. */
+};
+
+#endif // TMFINGERPRINT_H
@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "tmflamegraph.h"
+
+using std::ofstream;
+using std::endl;
+using std::sort;
+using std::min;
+using std::pair;
+
+/** @file tmflamegraph.cpp
+ * @brief Implementation file for the tmFlameGraph object.
+ */
+
+/** @brief Constructor for a tmFlameGraph object.
+ */
+tmFlameGraph::tmFlameGraph()
+{
+}
+
+
+/** @brief Returns a call's frame, its statement's label.
+ *
+ * @param event const tmCallEvent&. The call.
+ * @return const string&. The frame. Without semicolons, which separate frames.
+ */
+const string &tmFlameGraph::frame(const tmCallEvent &event)
+{
+    static const string unknown = "unknown cursor";
+
+    if (!event.cursor || event.cursor->fingerprint().label().empty()) {
+        return unknown;
+    }
+
+    return event.cursor->fingerprint().label();
+}
+
+
+/** @brief Moves stacks from one set to another, with a prefix.
+ *
+ * @param to tmStacks&. Where they go. Added to any the same already there.
+ * @param prefix const string&. The frames to put in front of each stack.
+ * @param from tmStacks&. The stacks. Emptied.
+ */
+void tmFlameGraph::moveStacks(tmStacks &to, const string &prefix, tmStacks &from)
+{
+    for (tmStacks::iterator i = from.begin(); i != from.end(); ++i) {
+        mStack.assign(prefix);
+        mStack += i->first;
+        to[mStack] += i->second;
+    }
+
+    from.clear();
+}
+
+
+void tmFlameGraph::onCall(const tmCallEvent &event)
+{
+    unsigned depth = event.stats.depth();
+    if (mLevels.size() < depth + 2) {
+        mLevels.resize(depth + 2);
+    }
+
+    const string &name = frame(event);
+    mPrefix.assign(name);
+    mPrefix += ';';
+
+    unsigned long long started = 0;
+    if (event.stats.tim() > event.stats.elapsed()) {
+        started = event.stats.tim() - event.stats.elapsed();
+    }
+
+    // This call's stacks wait for the call above it, unless it's at dep=0.
+    // Too many waiting? Keep the newer half as one.
+    tmStacks *stacks = &mStacks;
+    if (depth) {
+        vector<tmStackRun> &runs = mLevels[depth];
+        if (runs.size() >= maxRuns) {
+            vector<tmStackRun>::iterator half = runs.begin() + maxRuns / 2;
+            for (vector<tmStackRun>::iterator r = half + 1; r != runs.end(); ++r) {
+                moveStacks(half->stacks, string(), r->stacks);
+            }
+
+            half->lastTim = runs.back().lastTim;
+            runs.erase(half + 1, runs.end());
+        }
+
+        runs.push_back(tmStackRun());
+        runs.back().lastTim = event.stats.tim();
+        stacks = &runs.back().stacks;
+    }
+
+    // The recursive calls one depth down are under this call, if they
+    // ended after it started, as the call tree found. If not, nothing in
+    // the trace made them, and neither did anything deeper still waiting.
+    vector<tmStackRun> &below = mLevels[depth + 1];
+    for (vector<tmStackRun>::iterator r = below.begin(); r != below.end(); ++r) {
+        if (r->lastTim >= started) {
+            moveStacks(*stacks, mPrefix, r->stacks);
+        } else {
+            moveStacks(mStacks, string(), r->stacks);
+        }
+    }
+
+    below.clear();
+
+    for (unsigned x = depth + 2; x < mLevels.size(); x++) {
+        for (vector<tmStackRun>::iterator r = mLevels[x].begin(); r != mLevels[x].end(); ++r) {
+            moveStacks(mStacks, string(), r->stacks);
+        }
+
+        mLevels[x].clear();
+    }
+
+    unsigned long long self = event.stats.elapsed();
+    self -= min(self, event.recursive.elapsed);
+
+    // The cursor's WAITs since its last call are in this call's e=, if
+    // they ended after it started. The others were between calls.
+    unordered_map<tmCursor *, vector<tmWaitRun> >::iterator w = mWaits.end();
+    if (event.cursor) {
+        w = mWaits.find(event.cursor);
+    }
+
+    if (w != mWaits.end()) {
+        for (vector<tmWaitRun>::iterator r = w->second.begin(); r != w->second.end(); ++r) {
+            if (r->lastTim >= started) {
+                mStack.assign(mPrefix);
+                mStack += mWaitNames.name(r->event);
+                (*stacks)[mStack] += r->elapsed;
+                self -= min(self, r->elapsed);
+            } else {
+                mStacks[mWaitNames.name(r->event)] += r->elapsed;
+            }
+        }
+
+        w->second.clear();
+    }
+
+    if (self) {
+        (*stacks)[name] += self;
+    }
+}
+
+
+void tmFlameGraph::onWait(const tmWaitEvent &event)
+{
+    unsigned id = mWaitNames.intern(event.name);
+
+    // Waits on cursor #0 belong to no call.
+    if (!event.cursor) {
+        mStacks[mWaitNames.name(id)] += event.elapsed;
+        return;
+    }
+
+    vector<tmWaitRun> &runs = mWaits[event.cursor];
+    if (!runs.empty() && runs.back().event == id) {
+        runs.back().elapsed += event.elapsed;
+        runs.back().lastTim = event.tim;
+        return;
+    }
+
+    tmWaitRun run;
+    run.event = id;
+    run.elapsed = event.elapsed;
+    run.lastTim = event.tim;
+    runs.push_back(run);
+}
+
+
+/** @brief Writes the folded stacks file.
+ *
+ * @param fileName const string&. The file to write.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * Any recursive calls and WAITs with no call after them, at the end of
+ * the trace, are stacks of their own. The stacks are sorted, which is
+ * how the flame graph tools like them, and makes the file easy to diff.
+ */
+bool tmFlameGraph::write(const string &fileName, ostream &diagnostics)
+{
+    for (unsigned x = 1; x < mLevels.size(); x++) {
+        for (vector<tmStackRun>::iterator r = mLevels[x].begin(); r != mLevels[x].end(); ++r) {
+            moveStacks(mStacks, string(), r->stacks);
+        }
+
+        mLevels[x].clear();
+    }
+
+    for (unordered_map<tmCursor *, vector<tmWaitRun> >::iterator w = mWaits.begin(); w != mWaits.end(); ++w) {
+        for (vector<tmWaitRun>::iterator r = w->second.begin(); r != w->second.end(); ++r) {
+            mStacks[mWaitNames.name(r->event)] += r->elapsed;
+        }
+
+        w->second.clear();
+    }
+
+    ofstream ofs(fileName);
+
+    if (!ofs.good()) {
+        diagnostics << "TraceCollier: Cannot open flame graph file " << fileName << endl;
+        return false;
+    }
+
+    vector<const pair<const string, unsigned long long> *> sorted;
+    sorted.reserve(mStacks.size());
+    for (tmStacks::const_iterator i = mStacks.begin(); i != mStacks.end(); ++i) {
+        if (i->second) {
+            sorted.push_back(&*i);
+        }
+    }
+
+    sort(sorted.begin(), sorted.end(), [](const pair<const string, unsigned long long> *a,
+                                          const pair<const string, unsigned long long> *b) {
+        return a->first < b->first;
+    });
+
+    for (vector<const pair<const string, unsigned long long> *>::iterator i = sorted.begin(); i != sorted.end(); ++i) {
+        ofs << (*i)->first << ' ' << (*i)->second << '\n';
+    }
+
+    ofs.close();
+    return ofs.good();
+}
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMFLAMEGRAPH_H
+#define TMFLAMEGRAPH_H
+
+/** @file tmflamegraph.h
+ * @brief Header file for the tmFlameGraph object.
+ */
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::unordered_map;
+
+#include "tmcursor.h"
+#include "tmevents.h"
+#include "tmwaits.h"
+
+/** @brief The time in a trace, as folded stacks for a flame graph.
+ *
+ * Each line of the file is a stack of frames, separated by semicolons,
+ * and the microseconds spent in it, as Brendan Gregg's flamegraph.pl and
+ * the other flame graph tools read them:
+ *
+ * @code
+ * begin pkg.proc;select ... from orders where id = :b1;db file sequential read 150
+ * @endcode
+ *
+ * The frames are the statements, as their tmSqlFingerprint::label(),
+ * from dep=0 down, and a WAIT's event name under the statement which
+ * waited. A call's own microseconds are its e= less those of its WAITs
+ * and its recursive calls, which have stacks of their own, so the width
+ * of each frame in the graph is its whole e=. WAITs which ended before
+ * the call started, the time between calls, SQL*Net message from client
+ * and the like, are stacks of their own, as are WAITs on cursor #0.
+ *
+ * Oracle writes a call after its recursive calls, so their stacks wait,
+ * one hash map per call, for the call above them to end, just as the
+ * tmCallTree totals do. Those which ended after it started are added to
+ * the stacks, with its frame in front, when it does, and the others are
+ * stacks of their own. Identical stacks are added together as they go,
+ * and all but the oldest half of the calls waiting at a depth are kept
+ * as one once there are maxRuns, as tmCallTree does, so memory use
+ * depends on the number of different stacks, not on the number of calls.
+ */
+class tmFlameGraph : public tmEventHandler
+{
+    public:
+        tmFlameGraph();
+
+        // Getters.
+        size_t stacks() const { return mStacks.size(); }    /**< Returns how many different stacks so far. */
+
+        // Events.
+        void onCall(const tmCallEvent &event);      /**< Adds a call, with its WAITs and recursive calls under it. */
+        void onWait(const tmWaitEvent &event);      /**< Keeps a WAIT until its cursor's next call. */
+
+        // Other useful stuff.
+        bool write(const string &fileName, ostream &diagnostics);   /**< Writes the folded stacks file. */
+
+    protected:
+
+    private:
+        /** @brief A cursor's WAITs on one event, one after the other. */
+        struct tmWaitRun {
+            unsigned event;                     /**< The wait event's number, from mWaitNames. */
+            unsigned long long elapsed;         /**< Their ela=, added up. */
+            unsigned long long lastTim;         /**< tim= of the latest. */
+        };
+
+        // A stack, and its microseconds.
+        typedef unordered_map<string, unsigned long long> tmStacks;
+
+        /** @brief The stacks of one or more calls at one depth, waiting for the call above them. */
+        struct tmStackRun {
+            tmStacks stacks;                    /**< Their stacks, from this depth down. */
+            unsigned long long lastTim;         /**< tim= of the latest call. */
+        };
+
+        static const unsigned maxRuns = 1024;   /**< Most calls kept apart at one depth. */
+
+        const string &frame(const tmCallEvent &event);  /**< Returns a call's frame. */
+        void moveStacks(tmStacks &to, const string &prefix, tmStacks &from);  /**< Moves stacks, with a prefix, to another set. */
+
+        tmStacks mStacks;                   /**< The complete stacks, from dep=0. */
+        vector<vector<tmStackRun> > mLevels;    /**< Stacks waiting for the call above them, by dep=, oldest first. */
+        unordered_map<tmCursor *, vector<tmWaitRun> > mWaits;  /**< Each cursor's WAITs since its last call. */
+        tmWaitNames mWaitNames;             /**< Wait event names, by number. */
+        string mPrefix;                     /**< The current call's frame and a semicolon, reused for every call. */
+        string mStack;                      /**< A stack being looked up, reused for every call. */
+};
+
+#endif // TMFLAMEGRAPH_H
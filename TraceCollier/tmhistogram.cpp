@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cmath>
+
+#include "tmhistogram.h"
+
+/** @file tmhistogram.cpp
+ * @brief Implementation file for the tmHistogram object.
+ */
+
+// Each power of two is split into 2^HISTOGRAM_SUB_BITS buckets.
+const unsigned HISTOGRAM_SUB_BITS = 4;
+const unsigned HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BITS;
+
+// Values of 2^HISTOGRAM_MAX_BITS and over share the last bucket.
+const unsigned HISTOGRAM_MAX_BITS = 36;
+const unsigned HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS;
+
+
+/** @brief Constructor for a tmHistogram object.
+ */
+tmHistogram::tmHistogram()
+{
+    mCount = 0;
+    mTotal = 0;
+    mMin = 0;
+    mMax = 0;
+}
+
+
+/** @brief Returns the bucket that a value is counted in.
+ *
+ * @param value unsigned long long. The value.
+ * @return unsigned. The bucket.
+ *
+ * Values below HISTOGRAM_SUB_BUCKETS have a bucket each. After that,
+ * the top bit picks the power of two, and the next HISTOGRAM_SUB_BITS
+ * bits pick the bucket within it.
+ */
+unsigned tmHistogram::bucketOf(unsigned long long value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+
+    if (value >> HISTOGRAM_MAX_BITS) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+
+#if defined(__GNUC__)
+    unsigned topBit = 63 - __builtin_clzll(value);
+#else
+    unsigned topBit = HISTOGRAM_SUB_BITS;
+    while (value >> (topBit + 1)) {
+        topBit++;
+    }
+#endif
+
+    unsigned shift = topBit - HISTOGRAM_SUB_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (value >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+
+/** @brief Returns the smallest value in a bucket.
+ *
+ * @param bucket unsigned. The bucket.
+ * @return unsigned long long. The smallest value counted in it.
+ */
+unsigned long long tmHistogram::bucketLow(unsigned bucket)
+{
+    if (bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    unsigned shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    return (unsigned long long)(HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS) << shift;
+}
+
+
+/** @brief Returns the largest value in a bucket.
+ *
+ * @param bucket unsigned. The bucket.
+ * @return unsigned long long. The largest value counted in it. The last
+ * bucket has no limit.
+ */
+unsigned long long tmHistogram::bucketHigh(unsigned bucket)
+{
+    if (bucket >= HISTOGRAM_BUCKETS - 1) {
+        return ~0ULL;
+    }
+
+    return bucketLow(bucket + 1) - 1;
+}
+
+
+/** @brief Counts a value.
+ *
+ * @param value unsigned long long. The value, in microseconds.
+ *
+ * The buckets are allocated by the first value, and never again.
+ */
+void tmHistogram::record(unsigned long long value)
+{
+    if (mCounts.empty()) {
+        mCounts.assign(HISTOGRAM_BUCKETS, 0);
+        mMin = value;
+    }
+
+    mCounts[bucketOf(value)]++;
+    mCount++;
+    mTotal += value;
+
+    if (value < mMin) {
+        mMin = value;
+    }
+
+    if (value > mMax) {
+        mMax = value;
+    }
+}
+
+
+/** @brief Adds another histogram's counts to this one.
+ *
+ * @param other const tmHistogram&. The other histogram.
+ */
+void tmHistogram::merge(const tmHistogram &other)
+{
+    if (other.empty()) {
+        return;
+    }
+
+    if (mCounts.empty()) {
+        *this = other;
+        return;
+    }
+
+    for (unsigned x = 0; x < HISTOGRAM_BUCKETS; x++) {
+        mCounts[x] += other.mCounts[x];
+    }
+
+    mCount += other.mCount;
+    mTotal += other.mTotal;
+
+    if (other.mMin < mMin) {
+        mMin = other.mMin;
+    }
+
+    if (other.mMax > mMax) {
+        mMax = other.mMax;
+    }
+}
+
+
+/** @brief Returns a percentile.
+ *
+ * @param percent double. The percentile wanted, 50 for the median, 99.9 etc.
+ * @return unsigned long long. The value which that percentage of the values
+ * are at or below. That's the top of the bucket it's in, so it's never too
+ * low, and never more than the largest value. Zero if nothing was recorded.
+ */
+unsigned long long tmHistogram::percentile(double percent) const
+{
+    if (mCount == 0) {
+        return 0;
+    }
+
+    // How many values must be at or below the answer. At least one. The
+    // tiny bit off stops 99.9% of 1000 rounding up to 1000, not 999.
+    unsigned long long wanted = (unsigned long long)std::ceil(percent / 100.0 * mCount - 1e-9);
+    if (wanted < 1) {
+        wanted = 1;
+    }
+
+    unsigned long long seen = 0;
+    for (unsigned x = 0; x < HISTOGRAM_BUCKETS; x++) {
+        seen += mCounts[x];
+        if (seen >= wanted) {
+            unsigned long long high = bucketHigh(x);
+            return high < mMax ? high : mMax;
+        }
+    }
+
+    return mMax;
+}
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMHISTOGRAM_H
+#define TMHISTOGRAM_H
+
+/** @file tmhistogram.h
+ * @brief Header file for the tmHistogram object.
+ */
+
+#include <vector>
+
+using std::vector;
+
+/** @brief A latency histogram, in the style of HdrHistogram.
+ *
+ * Values, in microseconds, are counted in log-linear buckets. Each power
+ * of two is split into HISTOGRAM_SUB_BUCKETS equal buckets, so every
+ * value is within 1/16th, about 6%, of its bucket's bounds, however big
+ * it is. Values below 16 microseconds are exact.
+ *
+ * There's a fixed number of buckets, up to 2^36 microseconds, about 19
+ * hours, which is longer than any call or wait. Bigger values go in the
+ * last bucket, but max() is always exact. So the memory used is the same
+ * whether a statement is executed once or a million times, and nothing
+ * is allocated at all until the first value is recorded.
+ *
+ * Histograms with the same buckets can be merged, so histograms kept for
+ * separate trace files, or by separate threads, can be added together.
+ */
+class tmHistogram
+{
+    public:
+        tmHistogram();
+
+        // Getters.
+        unsigned long long count() const { return mCount; }     /**< Returns how many values were recorded. */
+        unsigned long long total() const { return mTotal; }     /**< Returns the total of the values. */
+        unsigned long long min() const { return mMin; }         /**< Returns the smallest value. Zero if none. */
+        unsigned long long max() const { return mMax; }         /**< Returns the largest value. */
+        bool empty() const { return mCount == 0; }              /**< Returns true if nothing was recorded. */
+        unsigned buckets() const { return mCounts.size(); }     /**< Returns the number of buckets. Zero until something is recorded. */
+        unsigned bucketCount(unsigned bucket) const { return mCounts[bucket]; }    /**< Returns how many values are in a bucket. */
+
+        // Other useful stuff.
+        void record(unsigned long long value);                  /**< Counts a value. */
+        void merge(const tmHistogram &other);                   /**< Adds another histogram's counts. */
+        unsigned long long percentile(double percent) const;    /**< Returns the value which this percentage of values are at or below. */
+
+        static unsigned bucketOf(unsigned long long value);     /**< Returns the bucket that a value is counted in. */
+        static unsigned long long bucketLow(unsigned bucket);   /**< Returns the smallest value in a bucket. */
+        static unsigned long long bucketHigh(unsigned bucket);  /**< Returns the largest value in a bucket. */
+
+    protected:
+
+    private:
+        vector<unsigned> mCounts;           /**< How many values in each bucket. */
+        unsigned long long mCount;          /**< How many values. */
+        unsigned long long mTotal;          /**< Total of the values. */
+        unsigned long long mMin;            /**< Smallest value. */
+        unsigned long long mMax;            /**< Largest value. */
+};
+
+#endif // TMHISTOGRAM_H
@@ -35,16 +35,43 @@
 tmOptions::tmOptions()
 {
     mHelp = false;
+    mDecode = false;
     mVerbose = false;
     mHtml = true;
+    mSqlite = false;
+    mViewer = false;
     mMaxExecs = 25;     // One screen full on Firefox on Windows 7.
     mTraceFile = "";
     mReportFile = "";
     mDebugFile = "";
+    mColumnarFile = "";
+    mViewerDataFile = "";
+    mDecodedFile = "";
+    mStatsFile = "";
+    mSummaryFile = "";
     mCssFileName = "";
     mDepth = 0;
     mQuiet = false;
+    mColumnar = false;
+    mStats = false;
+    mCounters = false;
+    mSplitExecs = 0;
+    mSplitBytes = 0;
+    mSummary = false;
+    mSummaryOnly = false;
+    mWaits = false;
+    mFetches = false;
+    mTop = 0;
+    mFlameGraph = false;
+    mFlameGraphFile = "";
+    mTimeline = false;
+    mTimelineMin = 0;
+    mTimelineFile = "";
+    mReport = false;
+    mDetailedReport = true;
     mFeedback = 1e5;
+    mMessages = &cout;
+    mDiagnostics = &cerr;
 }
 
 /** @brief Destructor for a tmOptions object.
@@ -117,6 +144,39 @@ bool tmOptions::parseArgs(int argc, char *argv[]) {
             continue;
         }
 
+        // Maybe a FORMAT ...
+        if (thisArg.substr(0, 9) == "--format=") {
+            string format = thisArg.substr(9);
+
+            if (format == "html") {
+                mHtml = true;
+                mSqlite = false;
+                mViewer = false;
+            } else if (format == "text") {
+                mHtml = false;
+                mSqlite = false;
+                mViewer = false;
+            } else if (format == "viewer") {
+                mHtml = false;
+                mSqlite = false;
+                mViewer = true;
+            } else if (format == "sqlite") {
+#ifdef USE_SQLITE
+                mHtml = false;
+                mSqlite = true;
+                mViewer = false;
+#else
+                cerr << "TraceCollier: This TraceCollier was not compiled with SQLite support." << endl;
+                invalidArgs = true;
+#endif // USE_SQLITE
+            } else {
+                cerr << "TraceCollier: Invalid format '" << format << "'." << endl;
+                invalidArgs = true;
+            }
+
+            continue;
+        }
+
         // Nope? Try DEPTH then ...
         if ((thisArg.substr(0, 7) == "--depth") ||
             (thisArg.substr(0,2) == "-d")) {
@@ -163,6 +223,175 @@ bool tmOptions::parseArgs(int argc, char *argv[]) {
             continue;
         }
 
+        // Columnar export perhaps?
+        if ((thisArg == "--columnar") ||
+            (thisArg == "-c")) {
+            mColumnar = true;
+            continue;
+        }
+
+        // Split the report into parts? Either every 'nn' EXECs
+        // or every 'nn' megabytes, if there's an 'm' on the end.
+        if ((thisArg.substr(0, 7) == "--split") ||
+            (thisArg.substr(0, 2) == "-s")) {
+
+            // Only digits, not too many to fit, and perhaps the 'm'.
+            string::size_type equals = thisArg.find('=');
+            string prefix = (equals == string::npos) ? thisArg : thisArg.substr(0, equals + 1);
+            string size = (equals == string::npos) ? string() : thisArg.substr(equals + 1);
+            bool megabytes = (!size.empty() && size[size.length() - 1] == 'm');
+            if (megabytes) {
+                size.erase(size.length() - 1);
+            }
+
+            bool splitOk = ((prefix == "--split=" || prefix == "-s=") &&
+                            !size.empty() && size.length() <= 9 &&
+                            size.find_first_not_of("0123456789") == string::npos);
+            unsigned temp = 0;
+            if (splitOk) {
+                temp = getDigits(size, "", &splitOk);
+            }
+
+            if (!splitOk || !temp) {
+                cerr << "TraceCollier: Invalid split size '" << string(argv[arg]) << "'." << endl;
+                invalidArgs = true;
+                continue;
+            }
+
+            mSplitExecs = 0;
+            mSplitBytes = 0;
+            if (megabytes) {
+                mSplitBytes = temp * 1024ULL * 1024ULL;
+            } else {
+                mSplitExecs = temp;
+            }
+
+            continue;
+        }
+
+        // A tkprof style summary, per statement? Instead of the
+        // detailed report, or as well as it.
+        if (thisArg == "--summary") {
+            mSummary = true;
+            mSummaryOnly = true;
+            continue;
+        }
+
+        if (thisArg == "--summary=both") {
+            mSummary = true;
+            mSummaryOnly = false;
+            continue;
+        }
+
+        // The detailed report as well as the summary, the slowest
+        // executions, the flame graph or the timeline?
+        if (thisArg == "--report") {
+            mReport = true;
+            continue;
+        }
+
+        // The slowest executions? Also instead of the detailed report.
+        // stoul() takes '-1' as the largest number there is, so only
+        // digits will do, and not too many of them.
+        if (thisArg.substr(0, 6) == "--top=") {
+            bool topOk = (thisArg.find_first_not_of("0123456789", 6) == string::npos);
+            unsigned temp = 0;
+            if (topOk) {
+                temp = getDigits(thisArg, "--top=", &topOk);
+            }
+
+            if (!topOk || !temp || temp > mTopLimit) {
+                cerr << "TraceCollier: Invalid number of executions '" << string(argv[arg]) << "'." << endl;
+                invalidArgs = true;
+                continue;
+            }
+
+            mTop = temp;
+            continue;
+        }
+
+        // Folded stacks for a flame graph? Also instead of the detailed
+        // report. The file name keeps its case.
+        if (thisArg == "--flamegraph") {
+            mFlameGraph = true;
+            continue;
+        }
+
+        if (thisArg.substr(0, 13) == "--flamegraph=") {
+            mFlameGraphFile = string(argv[arg]).substr(13);
+            if (mFlameGraphFile.empty()) {
+                cerr << "TraceCollier: Invalid flame graph file '" << string(argv[arg]) << "'." << endl;
+                invalidArgs = true;
+                continue;
+            }
+
+            mFlameGraph = true;
+            continue;
+        }
+
+        // A trace event timeline? Also instead of the detailed report.
+        // Its shortest event, first, so that it isn't taken as a file name.
+        if (thisArg.substr(0, 15) == "--timeline-min=") {
+            bool minOk = true;
+            unsigned temp = getDigits(thisArg, "--timeline-min=", &minOk);
+            if (!minOk) {
+                cerr << "TraceCollier: Invalid timeline minimum '" << string(argv[arg]) << "'." << endl;
+                invalidArgs = true;
+                continue;
+            }
+
+            mTimelineMin = temp;
+            continue;
+        }
+
+        if (thisArg == "--timeline") {
+            mTimeline = true;
+            continue;
+        }
+
+        if (thisArg.substr(0, 11) == "--timeline=") {
+            mTimelineFile = string(argv[arg]).substr(11);
+            if (mTimelineFile.empty()) {
+                cerr << "TraceCollier: Invalid timeline file '" << string(argv[arg]) << "'." << endl;
+                invalidArgs = true;
+                continue;
+            }
+
+            mTimeline = true;
+            continue;
+        }
+
+        // Each EXEC's wait time, in the detailed report?
+        if (thisArg == "--waits") {
+            mWaits = true;
+            continue;
+        }
+
+        // And its FETCHes?
+        if (thisArg == "--fetches") {
+            mFetches = true;
+            continue;
+        }
+
+        // Time the stages of the parse?
+        if (thisArg == "--stats") {
+            mStats = true;
+            continue;
+        }
+
+        // Hardware counters for the stages too? That needs --stats.
+        if (thisArg == "--counters") {
+            mCounters = true;
+            mStats = true;
+            continue;
+        }
+
+        // Decode a debug file from an earlier --verbose run?
+        if (thisArg == "--decode") {
+            mDecode = true;
+            continue;
+        }
+
         // Nope? Try help then ...
         if ((thisArg == "--help") ||
             (thisArg == "-h")     ||
@@ -207,6 +436,34 @@ bool tmOptions::parseArgs(int argc, char *argv[]) {
         invalidArgs = true;
     }
 
+    // Only HTML reports can be split.
+    if ((mSplitExecs || mSplitBytes) && !mHtml) {
+        cerr << "TraceCollier: --split only applies to HTML reports." << endl;
+        invalidArgs = true;
+    }
+
+    // The summary, the slowest executions, the flame graph and the
+    // timeline replace the detailed report, unless --report or
+    // --summary=both asks for it too.
+    mDetailedReport = mReport || !(mSummaryOnly || ((mTop || mFlameGraph || mTimeline) && !mSummary));
+
+    if (mTimelineMin && !mTimeline) {
+        cerr << "TraceCollier: --timeline-min only applies to --timeline." << endl;
+        invalidArgs = true;
+    }
+
+    // Without the detailed report, there's nothing to split or export.
+    if (!mDetailedReport && (mSplitExecs || mSplitBytes || mColumnar)) {
+        cerr << "TraceCollier: --split and --columnar need the detailed report. Use --report." << endl;
+        invalidArgs = true;
+    }
+
+    // The wait and FETCH columns are only in the HTML and TEXT reports.
+    if ((mWaits || mFetches) && (!mDetailedReport || mSqlite || mViewer)) {
+        cerr << "TraceCollier: --waits and --fetches need an HTML or TEXT detailed report." << endl;
+        invalidArgs = true;
+    }
+
     // Did we barf?
     if (invalidArgs) {
         usage();
@@ -219,10 +476,26 @@ bool tmOptions::parseArgs(int argc, char *argv[]) {
     if (mHtml) {
         mReportFile = replaceFileExtension(mTraceFile, mHtmlExtension);
         mCssFileName = filePath(mTraceFile) + directorySeparator + "TraceCollier.css";
+    } else if (mViewer) {
+        mReportFile = replaceFileExtension(mTraceFile, mHtmlExtension);
+        mViewerDataFile = replaceFileExtension(mTraceFile, mViewerExtension);
+    } else if (mSqlite) {
+        mReportFile = replaceFileExtension(mTraceFile, mSqliteExtension);
     } else {
         mReportFile = replaceFileExtension(mTraceFile, mReportExtension);
     }
     mDebugFile = replaceFileExtension(mTraceFile, mDebugExtension);
+    mDecodedFile = replaceFileExtension(mTraceFile, mDecodedExtension);
+    mStatsFile = replaceFileExtension(mTraceFile, mStatsExtension);
+    mSummaryFile = replaceFileExtension(mTraceFile, mHtml ? mSummaryHtmlExtension : mSummaryExtension);
+    mTopFile = replaceFileExtension(mTraceFile, mHtml ? mTopHtmlExtension : mTopExtension);
+    if (mFlameGraph && mFlameGraphFile.empty()) {
+        mFlameGraphFile = replaceFileExtension(mTraceFile, mFlameGraphExtension);
+    }
+    if (mTimeline && mTimelineFile.empty()) {
+        mTimelineFile = replaceFileExtension(mTraceFile, mTimelineExtension);
+    }
+    mColumnarFile = replaceFileExtension(mTraceFile, mColumnarExtension);
 
     return true;
 }
@@ -253,13 +526,76 @@ void tmOptions::usage() {
     cerr << "There are no spaces permitted around the '=' sign." << endl << endl;
 
     cerr << "'-v' or '--verbose' Turn on verbose mode." << endl;
-    cerr << "Lots of text is written to the debugfile." << endl << endl;
+    cerr << "Lots of events are written to the debugfile, in binary. See '--decode'." << endl << endl;
+
+    cerr << "'--decode' Don't parse the trace file. Instead, turn its debug file from an earlier" << endl;
+    cerr << "'--verbose' run into text, in a file with the extension '" << mDecodedExtension << "'." << endl << endl;
 
     cerr << "'-t' or '--text' Turn off HTML mode. The report file will be in TEXT format." << endl;
     cerr << "The default is for the report to be in HTML format." << endl << endl;
 
+    cerr << "'--format=html', '--format=text', '--format=viewer' or '--format=sqlite' Choose the report format." << endl;
+    cerr << "HTML and TEXT are as above. VIEWER writes a single static HTML page, which shows only" << endl;
+    cerr << "the visible rows and can filter them, plus its data in a file with the extension '" << mViewerExtension << "'." << endl;
+    cerr << "SQLITE writes the cursors, executions, binds, errors," << endl;
+    cerr << "transactions and deadlocks to an SQLite database, with the file extension '" << mSqliteExtension << "'." << endl;
+#ifndef USE_SQLITE
+    cerr << "(This TraceCollier was not compiled with SQLite support.)" << endl;
+#endif // USE_SQLITE
+    cerr << endl;
+
     cerr << "'-q' or '--quiet' Turn off reporting of 'Cursor: #cccccccc created at line nnnn' messages." << endl << endl;
 
+    cerr << "'-c' or '--columnar' Also export every reported EXEC, and its bind values," << endl;
+    cerr << "to an Apache Arrow IPC stream, for loading into pandas, polars, DuckDB and the like." << endl << endl;
+
+    cerr << "'-s=nn' or '--split=nn' Split the HTML report into parts of 'nn' EXECs each," << endl;
+    cerr << "or 'nn' megabytes each with '-s=nnM' or '--split=nnM'. The report file becomes an" << endl;
+    cerr << "index page listing every part, with its line and time ranges and top statements." << endl;
+    cerr << "There are no spaces permitted around the '=' sign." << endl << endl;
+
+    cerr << "'--summary' Instead of the detailed report, write a tkprof style summary with one row per" << endl;
+    cerr << "SQL statement, most elapsed time first. It has the PARSE, EXEC and FETCH counts, and their" << endl;
+    cerr << "CPU, elapsed, disk, query, current, rows and misses totals. It's HTML, in a file with the" << endl;
+    cerr << "extension '" << mSummaryHtmlExtension << "', unless the report is TEXT, when it's '" << mSummaryExtension << "'." << endl;
+    cerr << "'--summary=both' writes the summary and the detailed report, as does '--summary --report'." << endl;
+    cerr << "The summary also has each statement's WAITs, and the totals of every wait event." << endl << endl;
+
+    cerr << "'--top=nn' Instead of the detailed report, list the 'nn' slowest executions, by EXEC plus" << endl;
+    cerr << "FETCH elapsed time, with their binds and line numbers. It's HTML, in a file with the extension" << endl;
+    cerr << "'" << mTopHtmlExtension << "', unless the report is TEXT, when it's '" << mTopExtension << "'. With '--report'" << endl;
+    cerr << "the detailed report is written too. 'nn' can be from 1 to " << mTopLimit << "." << endl << endl;
+
+    cerr << "'--flamegraph' or '--flamegraph=file' Instead of the detailed report, write the elapsed time" << endl;
+    cerr << "of every call and WAIT, at every depth, as folded stacks for flamegraph.pl and the like." << endl;
+    cerr << "The file has the extension '" << mFlameGraphExtension << "', unless a file name is given. With '--report'" << endl;
+    cerr << "the detailed report is written too." << endl << endl;
+    cerr << "'--timeline' or '--timeline=file' Instead of the detailed report, write every PARSE, EXEC," << endl;
+    cerr << "FETCH, WAIT and COMMIT, at every depth, placed by tim=, in Chrome's trace event format for" << endl;
+    cerr << "chrome://tracing or ui.perfetto.dev. Each session is a track of its own. The file has the" << endl;
+    cerr << "extension '" << mTimelineExtension << "', unless a file name is given. With '--report'" << endl;
+    cerr << "the detailed report is written too." << endl;
+    cerr << "'--timeline-min=nn' Leave out timeline events shorter than 'nn' microseconds." << endl << endl;
+
+    cerr << "'--report' Write the detailed report as well as the summary, the slowest executions," << endl;
+    cerr << "the flame graph or the timeline." << endl << endl;
+
+    cerr << "'--waits' Add a column to the HTML or TEXT report with each EXEC's total WAIT time," << endl;
+    cerr << "in microseconds. That's the WAITs for the cursor since its previous PARSE, EXEC or FETCH." << endl;
+    cerr << "With '--fetches', the WAITs before each of the EXEC's FETCHes are added in too." << endl << endl;
+
+    cerr << "'--fetches' Add columns to the HTML or TEXT report with each EXEC's FETCH calls, rows" << endl;
+    cerr << "fetched, and FETCH elapsed and CPU time. Each row is written once its FETCHes are in," << endl;
+    cerr << "and the rows after it wait for it, so the report stays in line order. A row which" << endl;
+    cerr << "has 1,000 rows waiting behind it, or is 100,000 lines back, is written with" << endl;
+    cerr << "the FETCHes so far." << endl << endl;
+
+    cerr << "'--stats' Time each stage of the parse, and count the lines and records of each type." << endl;
+    cerr << "The figures are shown on stderr at the end, and written to a file with the extension '" << mStatsExtension << "'." << endl << endl;
+
+    cerr << "'--counters' As '--stats', plus each stage's CPU cycles, instructions, cache misses" << endl;
+    cerr << "and branch misses, from the hardware performance counters. Linux only." << endl << endl;
+
     cerr << "'-?'. '-h' or '--help' Displays this help, and exits." << endl << endl;
 
     cerr << "OUTPUT FILES:" << endl << endl;
@@ -267,9 +603,13 @@ void tmOptions::usage() {
     cerr << "The file is written to the same location as the trace file." << endl;
     cerr << "and has the file extension '" << mReportExtension << "'." << endl << endl;
 
-    cerr << "'debug_file' is where very verbose information will be written." << endl;
+    cerr << "'debug_file' is where very verbose information will be written, in binary." << endl;
     cerr << "The file is written to the same location as the trace file." << endl;
     cerr << "and has the file extension '" << mDebugExtension << "'." << endl << endl;
+
+    cerr << "'columnar_file' is where the columnar export, if requested, will be written." << endl;
+    cerr << "The file is written to the same location as the trace file." << endl;
+    cerr << "and has the file extension '" << mColumnarExtension << "'." << endl << endl;
 }
 
 
@@ -33,6 +33,8 @@
 #include <iostream>
 
 using std::string;
+using std::ostream;
+using std::cout;
 using std::cerr;
 using std::endl;
 
@@ -47,23 +49,68 @@ class tmOptions
         // Getters.
         bool verbose() { return mVerbose; }             /**< Returns verbose mode flag. */
         bool html() { return mHtml; }                   /**< Returns HTML mode flag. */
+        bool sqlite() { return mSqlite; }               /**< Returns SQLite database mode flag. */
+        bool viewer() { return mViewer; }               /**< Returns viewer mode flag. */
         bool help() { return mHelp; }                   /**< Returns help mode flag. */
+        bool decode() { return mDecode; }               /**< Returns decode debug file mode flag. */
         int maxExecs() { return mMaxExecs; }            /**< Returns help mode flag. */
         unsigned depth() { return mDepth; }             /**< Returns max depth we care about. */
         bool quiet() { return mQuiet; }                 /**< Returns quiet mode flag. */
         unsigned feedBack() { return mFeedback; }       /**< Returns feedback interval. */
+        bool columnar() { return mColumnar; }           /**< Returns columnar export flag. */
+        bool stats() { return mStats; }                 /**< Returns statistics flag. */
+        bool counters() { return mCounters; }           /**< Returns hardware counters flag. */
+        unsigned splitExecs() { return mSplitExecs; }   /**< Returns EXECs per split report part. Zero = no limit. */
+        unsigned long long splitBytes() { return mSplitBytes; } /**< Returns bytes per split report part. Zero = no limit. */
+        bool summary() { return mSummary; }             /**< Returns summary report flag. */
+        bool summaryOnly() { return mSummaryOnly; }     /**< Returns true if the summary replaces the detailed report. */
+        bool waits() { return mWaits; }                 /**< Returns the per EXEC wait time column flag. */
+        bool fetches() { return mFetches; }             /**< Returns the per EXEC FETCH totals columns flag. */
+        unsigned top() { return mTop; }                 /**< Returns how many of the slowest executions to list. Zero = none. */
+        bool flameGraph() { return mFlameGraph; }       /**< Returns the folded stacks flag. */
+        bool timeline() { return mTimeline; }           /**< Returns the timeline flag. */
+        unsigned long long timelineMin() { return mTimelineMin; }   /**< Returns the shortest event, in microseconds, for the timeline. */
+        bool detailedReport() { return mDetailedReport; }   /**< Returns true if the detailed report is wanted. */
 
         string traceFile() { return mTraceFile; }       /**< Returns trace file name. */
         string reportFile() { return mReportFile; }     /**< Returns report file name. */
         string debugFile() { return mDebugFile; }       /**< Returns debug information file name. */
+        string columnarFile() { return mColumnarFile; } /**< Returns columnar export file name. */
+        string viewerDataFile() { return mViewerDataFile; } /**< Returns viewer data file name. */
+        string decodedFile() { return mDecodedFile; }   /**< Returns decoded debug file name. */
+        string statsFile() { return mStatsFile; }       /**< Returns statistics file name. */
+        string summaryFile() { return mSummaryFile; }   /**< Returns summary report file name. */
+        string topFile() { return mTopFile; }           /**< Returns slowest executions file name. */
+        string flameGraphFile() { return mFlameGraphFile; } /**< Returns folded stacks file name. */
+        string timelineFile() { return mTimelineFile; } /**< Returns timeline file name. */
 
         string htmlExtension() { return mHtmlExtension; }       /**< Returns HTML report file extension. */
         string reportExtension() { return mReportExtension; }   /**< Returns TEXT report file extension. */
         string debugExtension() { return mDebugExtension; }     /**< Returns debug information file extension. */
+        string columnarExtension() { return mColumnarExtension; }   /**< Returns columnar export file extension. */
+        string sqliteExtension() { return mSqliteExtension; }       /**< Returns SQLite database file extension. */
+        string viewerExtension() { return mViewerExtension; }       /**< Returns viewer data file extension. */
+        string decodedExtension() { return mDecodedExtension; }     /**< Returns decoded debug file extension. */
+        string statsExtension() { return mStatsExtension; }         /**< Returns statistics file extension. */
+        string summaryExtension() { return mSummaryExtension; }     /**< Returns TEXT summary file extension. */
+        string summaryHtmlExtension() { return mSummaryHtmlExtension; } /**< Returns HTML summary file extension. */
+        string topExtension() { return mTopExtension; }                 /**< Returns TEXT slowest executions file extension. */
+        string topHtmlExtension() { return mTopHtmlExtension; }         /**< Returns HTML slowest executions file extension. */
+        string flameGraphExtension() { return mFlameGraphExtension; }   /**< Returns folded stacks file extension. */
+        string timelineExtension() { return mTimelineExtension; }       /**< Returns timeline file extension. */
         string cssFileName() { return mCssFileName; }           /**< Returns default CSS filename. */
 
+        ostream &messages() { return *mMessages; }          /**< Returns where files written, cursors etc are announced. cout unless changed. */
+        ostream &diagnostics() { return *mDiagnostics; }    /**< Returns where warnings, errors and feedback go. cerr unless changed. */
+
         // Setters.
         void setVerbose(bool verbose) { mVerbose = verbose; }   /**< Sets the verbose flag, if required. */
+        void setTraceFile(const string &traceFile) { mTraceFile = traceFile; }  /**< Sets the trace file name, for library users. */
+        void setDepth(unsigned depth) { mDepth = depth; }       /**< Sets the max depth we care about. */
+        void setQuiet(bool quiet) { mQuiet = quiet; }           /**< Sets the quiet mode flag. */
+        void setFeedBack(unsigned feedBack) { mFeedback = feedBack; }   /**< Sets the feedback interval. */
+        void setMessages(ostream &messages) { mMessages = &messages; }  /**< Sends the announcements elsewhere, for library users. */
+        void setDiagnostics(ostream &diagnostics) { mDiagnostics = &diagnostics; }  /**< Sends warnings, errors and feedback elsewhere, for library users. */
 
         void usage();                               /**< Display usage and force an exit. */
         bool parseArgs(int argc, char *argv[]);     /**< Parses command line arguments and sets various flags etc. */
@@ -73,19 +120,59 @@ class tmOptions
     private:
         bool mVerbose;                      /**< Are we running in verbose mode? */
         bool mHtml;                         /**< Are we reporting in HTML? */
+        bool mSqlite;                       /**< Are we reporting to an SQLite database? */
+        bool mViewer;                       /**< Are we reporting to a viewer page and data file? */
         bool mHelp;                         /**< Did the user request help? */
+        bool mDecode;                       /**< Are we decoding a debug file instead? */
         unsigned mMaxExecs;                 /**< Report file page size. */
         unsigned mDepth;                    /**< Maximum depth which we care about */
         unsigned mFeedback;                 /**< Report to cerr every n lines read. */
         bool mQuiet;                        /**< Are we running in quiet mode? */
+        bool mColumnar;                     /**< Are we exporting EXECs to a columnar file? */
+        bool mStats;                        /**< Are we timing the stages of the parse? */
+        bool mCounters;                     /**< Are we reading hardware counters for the stages too? */
+        unsigned mSplitExecs;               /**< Split the HTML report every this many EXECs. */
+        unsigned long long mSplitBytes;     /**< Split the HTML report every this many bytes. */
+        bool mSummary;                      /**< Are we writing a per statement summary? */
+        bool mSummaryOnly;                  /**< Is the summary instead of the detailed report? */
+        bool mWaits;                        /**< Does the detailed report have a wait time column? */
+        bool mFetches;                      /**< Does the detailed report have FETCH totals columns? */
+        unsigned mTop;                      /**< How many of the slowest executions to list. */
+        bool mFlameGraph;                   /**< Are we writing folded stacks for a flame graph? */
+        bool mTimeline;                     /**< Are we writing a trace event timeline? */
+        unsigned long long mTimelineMin;    /**< Timeline events shorter than this, in microseconds, are left out. */
+        bool mReport;                       /**< Was the detailed report asked for, with --report? */
+        bool mDetailedReport;               /**< Is the detailed report wanted, or only the summary, top list etc? */
         string mTraceFile;                  /**< Name of the trace file being parsed. */
         string mReportFile;                 /**< Name of the report file. */
         string mDebugFile;                  /**< Name of the debug information file. */
+        string mColumnarFile;               /**< Name of the columnar export file. */
+        string mViewerDataFile;             /**< Name of the viewer data file. */
+        string mDecodedFile;                /**< Name of the decoded debug file. */
+        string mStatsFile;                  /**< Name of the statistics file. */
+        string mSummaryFile;                /**< Name of the summary report file. */
+        string mTopFile;                    /**< Name of the slowest executions file. */
+        string mFlameGraphFile;             /**< Name of the folded stacks file. */
+        string mTimelineFile;               /**< Name of the timeline file. */
         string mCssFileName;                /**< Full path & name of the actual CSS file. */
+        ostream *mMessages;                 /**< Where files written, cursors etc are announced. */
+        ostream *mDiagnostics;              /**< Where warnings, errors and feedback go. */
 
         string mReportExtension = "txt";    /**< Default extension for the text report file. */
         string mHtmlExtension = "html";     /**< Default extension for the HTML report file. */
         string mDebugExtension = "dbg";     /**< Default extension for the debug information file. */
+        string mColumnarExtension = "arrows";   /**< Default extension for the columnar export file. */
+        string mSqliteExtension = "db";     /**< Default extension for the SQLite database. */
+        string mViewerExtension = "data.js";    /**< Default extension for the viewer data file. */
+        string mDecodedExtension = "dbg.txt";   /**< Default extension for the decoded debug file. */
+        string mStatsExtension = "stats.json";  /**< Default extension for the statistics file. */
+        string mSummaryExtension = "summary.txt";   /**< Default extension for the text summary file. */
+        string mSummaryHtmlExtension = "summary.html";  /**< Default extension for the HTML summary file. */
+        string mTopExtension = "top.txt";   /**< Default extension for the text slowest executions file. */
+        string mTopHtmlExtension = "top.html";  /**< Default extension for the HTML slowest executions file. */
+        string mFlameGraphExtension = "folded"; /**< Default extension for the folded stacks file. */
+        string mTimelineExtension = "timeline.json";    /**< Default extension for the timeline file. */
+        unsigned mTopLimit = 100000;        /**< Most slowest executions '--top=nn' will list. */
 };
 
 #endif // TMOPTIONS_H
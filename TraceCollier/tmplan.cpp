@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+
+#include "tmplan.h"
+
+/** @file tmplan.cpp
+ * @brief Implementation file for the tmPlan object.
+ */
+
+
+/** @brief Adds some bytes to an FNV-1a hash.
+ *
+ * @param hash unsigned long long. The hash so far.
+ * @param data const void*. The bytes.
+ * @param length size_t. How many bytes.
+ * @return unsigned long long. The new hash.
+ */
+static unsigned long long hashBytes(unsigned long long hash, const void *data, size_t length)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    for (size_t x = 0; x < length; x++) {
+        hash = (hash ^ p[x]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+/** @brief Constructor for a tmPlan object.
+ */
+tmPlan::tmPlan()
+{
+    clear();
+}
+
+
+/** @brief Empties the plan, ready for the next dump.
+ *
+ * The steps' memory is kept, so collecting the next dump into the same
+ * plan allocates nothing but the operation names.
+ */
+void tmPlan::clear()
+{
+    mPlanHash = 0;
+    mShape = 14695981039346656037ULL;
+    mDumps = 0;
+    mFirstLine = 0;
+    mSteps.clear();
+}
+
+
+/** @brief Adds a STAT line to the dump being collected.
+ *
+ * @param event const tmStatEvent&. The STAT line.
+ * @return bool. True if it was added. False if it starts a new dump, as
+ * its id doesn't follow on from the last step's, in which case the plan
+ * is left as it was.
+ *
+ * The operation is split from the figures Oracle puts after it, from 10g
+ * onwards, "TABLE ACCESS FULL EMP (cr=7 pr=0 pw=0 time=92 us)".
+ */
+bool tmPlan::add(const tmStatEvent &event)
+{
+    if (!mSteps.empty() && event.id <= mSteps.back().id) {
+        return false;
+    }
+
+    tmPlanStep step;
+    step.id = event.id;
+    step.parentId = event.parentId;
+    step.position = event.position;
+    step.depth = 0;
+    step.objectId = event.objectId;
+    step.rows = event.rows;
+    step.consistentReads = event.consistentReads;
+    step.physicalReads = event.physicalReads;
+    step.physicalWrites = event.physicalWrites;
+    step.time = event.time;
+    step.cost = event.cost;
+    step.size = event.size;
+    step.cardinality = event.cardinality;
+
+    // The operation, without its figures, and without trailing spaces.
+    size_t length = event.operation.length();
+    const char *op = event.operation.data();
+    for (size_t x = 0; x + 4 <= length; x++) {
+        if (strncmp(op + x, "(cr=", 4) == 0) {
+            length = x;
+            break;
+        }
+    }
+
+    while (length && op[length - 1] == ' ') {
+        length--;
+    }
+
+    step.operation.assign(op, length);
+
+    // Parents come before their children. Usually just before.
+    if (step.parentId) {
+        for (vector<tmPlanStep>::reverse_iterator i = mSteps.rbegin(); i != mSteps.rend(); ++i) {
+            if (i->id == step.parentId) {
+                step.depth = i->depth + 1;
+                break;
+            }
+        }
+    }
+
+    if (mSteps.empty()) {
+        mPlanHash = event.planHash;
+        mDumps = 1;
+        mFirstLine = event.line;
+    }
+
+    mShape = hashBytes(mShape, &step.id, sizeof(step.id));
+    mShape = hashBytes(mShape, &step.parentId, sizeof(step.parentId));
+    mShape = hashBytes(mShape, &step.position, sizeof(step.position));
+    mShape = hashBytes(mShape, step.operation.data(), step.operation.length() + 1);
+
+    mSteps.push_back(step);
+    return true;
+}
+
+
+/** @brief Adds another dump of the same plan.
+ *
+ * @param dump const tmPlan&. The dump. It has the same key().
+ *
+ * The row source figures are added step by step. The optimizer's
+ * estimates are those of the first dump.
+ */
+void tmPlan::merge(const tmPlan &dump)
+{
+    mDumps += dump.mDumps;
+
+    for (size_t x = 0; x < mSteps.size() && x < dump.mSteps.size(); x++) {
+        tmPlanStep &step = mSteps[x];
+        const tmPlanStep &other = dump.mSteps[x];
+
+        // Same plh=, but a different shape? Add what lines up.
+        if (step.id != other.id) {
+            continue;
+        }
+
+        step.rows += other.rows;
+        step.consistentReads += other.consistentReads;
+        step.physicalReads += other.physicalReads;
+        step.physicalWrites += other.physicalWrites;
+        step.time += other.time;
+    }
+}
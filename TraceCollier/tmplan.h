@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMPLAN_H
+#define TMPLAN_H
+
+/** @file tmplan.h
+ * @brief Header file for the tmPlanStep and tmPlan objects.
+ */
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#include "tmevents.h"
+
+/** @brief One row source, or step, of an execution plan, from a STAT line.
+ */
+struct tmPlanStep
+{
+    unsigned id;                        /**< Row source id, id=. */
+    unsigned parentId;                  /**< Parent row source id, pid=. Zero for the top step. */
+    unsigned position;                  /**< Position under the parent, pos=. */
+    unsigned depth;                     /**< How far down the tree, for indenting. Zero for the top step. */
+    unsigned long long objectId;        /**< Object id, obj=. */
+    string operation;                   /**< The operation and object name, without the figures. */
+    unsigned long long rows;            /**< Total rows produced, cnt=. */
+    unsigned long long consistentReads; /**< Total consistent reads, cr=. */
+    unsigned long long physicalReads;   /**< Total physical reads, pr=. */
+    unsigned long long physicalWrites;  /**< Total physical writes, pw=. */
+    unsigned long long time;            /**< Total elapsed time, time=, in microseconds. */
+    unsigned long long cost;            /**< Optimizer cost, cost=, from the first STAT dump. */
+    unsigned long long size;            /**< Optimizer estimated bytes, size=, from the first STAT dump. */
+    unsigned long long cardinality;     /**< Optimizer estimated rows, card=, from the first STAT dump. */
+};
+
+/** @brief An execution plan, rebuilt from a cursor's STAT lines.
+ *
+ * Oracle writes a cursor's plan as a block of STAT lines, one per row
+ * source, in id order, with each step's parent. add() collects one such
+ * block, a STAT dump, and works out how deep each step is. merge() adds
+ * a dump's figures to a plan already seen, so each distinct plan of a
+ * statement is kept once, however often it's dumped.
+ *
+ * Plans are told apart by the plh= of the cursor's PARSE or EXEC, as the
+ * STAT lines don't have it. Traces without plh= use a hash of the plan's
+ * shape, the operations and how they fit together, instead.
+ */
+class tmPlan
+{
+    public:
+        tmPlan();
+
+        // Getters.
+        unsigned long long planHash() const { return mPlanHash; }  /**< Returns the plan hash value, plh=. Zero if the trace hasn't got it. */
+        unsigned long long key() const { return mPlanHash ? mPlanHash : mShape; }  /**< Returns what tells this plan apart from others. */
+        unsigned dumps() const { return mDumps; }                   /**< Returns how many STAT dumps were added together. */
+        unsigned firstLine() const { return mFirstLine; }           /**< Returns the line of the first STAT. */
+        bool empty() const { return mSteps.empty(); }               /**< Returns true if there are no steps yet. */
+        const vector<tmPlanStep> &steps() const { return mSteps; }  /**< Returns the steps, in id order. */
+
+        // Other useful stuff.
+        bool add(const tmStatEvent &event);     /**< Adds a STAT line to the dump being collected. */
+        void merge(const tmPlan &dump);         /**< Adds another dump of the same plan. */
+        void clear();                           /**< Empties the plan, ready for the next dump. */
+
+    protected:
+
+    private:
+        unsigned long long mPlanHash;           /**< Plan hash value, plh=. */
+        unsigned long long mShape;              /**< Hash of the operations and the shape of the tree. */
+        unsigned mDumps;                        /**< How many STAT dumps. */
+        unsigned mFirstLine;                    /**< Line of the first STAT. */
+        vector<tmPlanStep> mSteps;              /**< The row sources, in id order. */
+};
+
+#endif // TMPLAN_H
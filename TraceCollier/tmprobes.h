@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMPROBES_H
+#define TMPROBES_H
+
+/** @file tmprobes.h
+ * @brief USDT static probes, for bpftrace, SystemTap, perf etc.
+ *
+ * If the compiler can find sys/sdt.h (systemtap-sdt-dev on Debian and
+ * Ubuntu, systemtap-sdt-devel on Red Hat) each probe is a single nop
+ * instruction, plus a note in the executable saying where it is and where
+ * its arguments are. A tracer which attaches swaps the nop for a trap, so
+ * the probes cost nothing until somebody is watching. Build with
+ * -DNO_USDT to leave them out anyway.
+ *
+ * Without sys/sdt.h, the probes are empty and their arguments are not
+ * evaluated at all.
+ *
+ * The provider is "tracecollier". Cursor IDs are C strings, use str() in
+ * bpftrace. The probes are:
+ *
+ * @li line__read(line, bytes) - a trace line was read.
+ * @li record(line, stage, name) - a record handler was called. The stage is
+ * a tmStage, the name is its name as in --stats.
+ * @li cursor__created(line, cursorId, sqlLength, sqlLine) - PARSING IN CURSOR, new cursor ID.
+ * @li cursor__reparsed(line, cursorId, sqlLength, sqlLine) - PARSING IN CURSOR, cursor ID already known.
+ * @li cursor__closed(line, cursorId, closeType) - CLOSE of a known cursor.
+ * @li binds(line, cursorId, bindCount, dataLines) - a BINDS block was parsed.
+ * @li exec(line, cursorId, depth, sqlLine) - an EXEC was written to the report.
+ * @li report__flush(line, part) - the report, or a part of a split report
+ * when part is not zero, was finished.
+ *
+ * For example, EXECs per cursor:
+ *
+ * @code
+ * bpftrace -e 'usdt:./bin/TraceCollier:tracecollier:exec { @[str(arg1)] = count(); }'
+ * @endcode
+ */
+
+#if !defined(NO_USDT) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+        #define USE_USDT
+    #endif
+#endif
+
+#ifdef USE_USDT
+
+#include <sys/sdt.h>
+
+#define TCPROBE_LINE_READ(line, bytes) \
+    DTRACE_PROBE2(tracecollier, line__read, line, bytes)
+#define TCPROBE_RECORD(line, stage) \
+    DTRACE_PROBE3(tracecollier, record, line, stage, stageName(stage))
+#define TCPROBE_CURSOR_CREATED(line, cursorId, sqlLength, sqlLine) \
+    DTRACE_PROBE4(tracecollier, cursor__created, line, cursorId, sqlLength, sqlLine)
+#define TCPROBE_CURSOR_REPARSED(line, cursorId, sqlLength, sqlLine) \
+    DTRACE_PROBE4(tracecollier, cursor__reparsed, line, cursorId, sqlLength, sqlLine)
+#define TCPROBE_CURSOR_CLOSED(line, cursorId, closeType) \
+    DTRACE_PROBE3(tracecollier, cursor__closed, line, cursorId, closeType)
+#define TCPROBE_BINDS(line, cursorId, bindCount, dataLines) \
+    DTRACE_PROBE4(tracecollier, binds, line, cursorId, bindCount, dataLines)
+#define TCPROBE_EXEC(line, cursorId, depth, sqlLine) \
+    DTRACE_PROBE4(tracecollier, exec, line, cursorId, depth, sqlLine)
+#define TCPROBE_REPORT_FLUSH(line, part) \
+    DTRACE_PROBE2(tracecollier, report__flush, line, part)
+
+#else
+
+#define TCPROBE_LINE_READ(line, bytes) do {} while (0)
+#define TCPROBE_RECORD(line, stage) do {} while (0)
+#define TCPROBE_CURSOR_CREATED(line, cursorId, sqlLength, sqlLine) do {} while (0)
+#define TCPROBE_CURSOR_REPARSED(line, cursorId, sqlLength, sqlLine) do {} while (0)
+#define TCPROBE_CURSOR_CLOSED(line, cursorId, closeType) do {} while (0)
+#define TCPROBE_BINDS(line, cursorId, bindCount, dataLines) do {} while (0)
+#define TCPROBE_EXEC(line, cursorId, depth, sqlLine) do {} while (0)
+#define TCPROBE_REPORT_FLUSH(line, part) do {} while (0)
+
+#endif // USE_USDT
+
+#endif // TMPROBES_H
@@ -0,0 +1,275 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "tmreportindex.h"
+#include "utilities.h"
+
+using std::ofstream;
+using std::stringstream;
+using std::setw;
+using std::setfill;
+using std::sort;
+
+/** @file tmreportindex.cpp
+ * @brief Implementation file for the tmReportIndex object.
+ */
+
+/** @brief Constructor for a tmReportIndex object.
+ *
+ * @param fileName const string&. The index file name. Parts are named after it.
+ * @param maxExecs unsigned. Start a new part after this many EXECs. Zero = no limit.
+ * @param maxBytes unsigned long long. Start a new part after this many bytes. Zero = no limit.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ */
+tmReportIndex::tmReportIndex(const string &fileName, unsigned maxExecs, unsigned long long maxBytes, ostream &diagnostics)
+{
+    mFileName = fileName;
+    mDiagnostics = &diagnostics;
+    mMaxExecs = maxExecs;
+    mMaxBytes = maxBytes;
+
+    // "path/trace.html" -> "path/trace".
+    string::size_type dot = fileName.rfind('.');
+    mBaseName = (dot == string::npos) ? fileName : fileName.substr(0, dot);
+}
+
+
+/** @brief Returns the file name, without any path, of a part.
+ *
+ * @param part unsigned. The part number, starting from 1.
+ * @return string. The file name, "trace_nnnn.html".
+ */
+string tmReportIndex::partFileName(unsigned part) {
+
+    stringstream s;
+    s << ::fileName(mBaseName) << '_' << setw(4) << setfill('0') << part << ".html";
+    return s.str();
+}
+
+
+/** @brief Starts a new part.
+ *
+ * @param firstLine unsigned. The current trace line number.
+ * @return string. The full path of the new part file, for the caller to create.
+ */
+string tmReportIndex::startPart(unsigned firstLine) {
+
+    tmReportPart part;
+    part.fileName = partFileName(mParts.size() + 1);
+    part.firstLine = firstLine;
+    part.lastLine = firstLine;
+    part.execs = 0;
+    part.firstTim = 0;
+    part.lastTim = 0;
+
+    mParts.push_back(part);
+    mStatements.clear();
+
+    string path = filePath(mFileName);
+    return path.empty() ? part.fileName : path + directorySeparator + part.fileName;
+}
+
+
+/** @brief Adds an EXEC to the current part's summary.
+ *
+ * @param cursor tmCursor*. The cursor being executed.
+ * @param stats const tmCallStats&. The EXEC's statistics.
+ * @param local const string&. The local date/time, if trace adjusted.
+ */
+void tmReportIndex::addExec(tmCursor *cursor, const tmCallStats &stats, const string &local) {
+
+    tmReportPart &part = mParts.back();
+
+    if (!part.execs) {
+        part.firstTim = stats.tim();
+        part.firstLocal = local;
+    }
+
+    part.lastTim = stats.tim();
+    part.lastLocal = local;
+    part.execs++;
+
+    // Statements are the same if their sqlids are. Old traces don't
+    // have sqlids, so use the SQL text for those.
+    string key = cursor->sqlId();
+    if (key.empty()) {
+        key = cursor->sqlText();
+    }
+
+    unordered_map<string, tmPartStatement>::iterator i = mStatements.find(key);
+    if (i == mStatements.end()) {
+        tmPartStatement statement;
+        statement.sqlText = cursor->sqlText().substr(0, REPORTINDEX_SQL_LENGTH);
+        statement.sqlLine = cursor->sqlLineNumber();
+        statement.execs = 0;
+        statement.elapsed = 0;
+        i = mStatements.insert(make_pair(key, statement)).first;
+    }
+
+    i->second.execs++;
+    i->second.elapsed += stats.elapsed();
+}
+
+
+/** @brief Is the current part full?
+ *
+ * @param bytesWritten unsigned long long. Size of the current part file so far.
+ * @return bool. True if a new part should be started before the next EXEC.
+ */
+bool tmReportIndex::partFull(unsigned long long bytesWritten) {
+
+    if (mParts.empty()) {
+        return false;
+    }
+
+    if (mMaxExecs && (mParts.back().execs >= mMaxExecs)) {
+        return true;
+    }
+
+    return (mMaxBytes && (bytesWritten >= mMaxBytes));
+}
+
+
+/** @brief Finishes off the current part.
+ *
+ * @param lastLine unsigned. The current trace line number.
+ *
+ * Keeps only the most expensive statements, by elapsed time, for the index.
+ */
+void tmReportIndex::endPart(unsigned lastLine) {
+
+    tmReportPart &part = mParts.back();
+    part.lastLine = lastLine;
+
+    vector<tmPartStatement> all;
+    all.reserve(mStatements.size());
+    for (unordered_map<string, tmPartStatement>::iterator i = mStatements.begin();
+         i != mStatements.end();
+         ++i) {
+        all.push_back(i->second);
+    }
+
+    // Most elapsed time first, then most EXECs, then first seen.
+    sort(all.begin(), all.end(), [](const tmPartStatement &a, const tmPartStatement &b) {
+        if (a.elapsed != b.elapsed) return a.elapsed > b.elapsed;
+        if (a.execs != b.execs) return a.execs > b.execs;
+        return a.sqlLine < b.sqlLine;
+    });
+
+    if (all.size() > REPORTINDEX_TOP_STATEMENTS) {
+        all.resize(REPORTINDEX_TOP_STATEMENTS);
+    }
+
+    part.top.swap(all);
+    mStatements.clear();
+}
+
+
+/** @brief Writes the index page.
+ *
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param adjusted bool. True if the trace was processed by TraceAdjust.
+ * @param version float. TraceCollier version, for the footer.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * One row per part, with its line and time ranges, and its most expensive
+ * statements. If the trace was adjusted, local times are shown, otherwise
+ * the raw tim values are.
+ */
+bool tmReportIndex::write(const string &traceFile, bool adjusted, float version) {
+
+    ofstream ofs(mFileName);
+
+    if (!ofs.good()) {
+        *mDiagnostics << "TraceCollier: Cannot open report index file " << mFileName << endl;
+        return false;
+    }
+
+    ofs << "<html lang=\"en\"><head>" << endl
+        << "<title>Trace Collier</title>" << endl
+        << "<meta charset=\"UTF-8\" />" << endl
+        << "<meta name=\"generator\" content=\"TraceCollier\" />" << endl
+        << "<link rel=\"stylesheet\" href=\"TraceCollier.css\" />" << endl
+        << "<link rel=\"icon\" href=\"favicon.ico\" type=\"image/x-icon\" />"
+        << "</head>" << endl
+        << "<body>" << endl
+        << "<H1>Trace Collier</H1>" << endl
+        << "<p><strong>Processing Trace File:</strong> " << htmlEscape(traceFile);
+
+    if (adjusted) {
+        ofs << " (Preprocessed by '<strong>TraceAdjust</strong>') ";
+    }
+
+    ofs << "</p>" << endl
+        << "<p>The report has been split into " << mParts.size() << " parts.</p>" << endl << endl;
+
+    ofs << "<table class=\"tm2table\">" << endl
+        << "<tr><th>Part</th>"
+        << "<th>First Line</th>"
+        << "<th>Last Line</th>"
+        << "<th>EXECs</th>"
+        << "<th>" << (adjusted ? "First EXEC Date/Time" : "First EXEC tim") << "</th>"
+        << "<th>" << (adjusted ? "Last EXEC Date/Time" : "Last EXEC tim") << "</th>"
+        << "<th>Top Statements (EXECs, Elapsed &micro;s, SQL Line, SQL Text)</th></tr>"
+        << endl;
+
+    for (unsigned p = 0; p < mParts.size(); p++) {
+        tmReportPart &part = mParts[p];
+
+        ofs << "<tr><td class=\"text\"><a href=\"" << part.fileName << "\">"
+            << "Part " << p + 1 << "</a></td>"
+            << "<td class=\"number\">" << part.firstLine << "</td>"
+            << "<td class=\"number\">" << part.lastLine << "</td>"
+            << "<td class=\"number\">" << part.execs << "</td>";
+
+        if (adjusted) {
+            ofs << "<td class=\"text\">" << htmlEscape(part.firstLocal) << "</td>"
+                << "<td class=\"text\">" << htmlEscape(part.lastLocal) << "</td>";
+        } else {
+            ofs << "<td class=\"number\">" << part.firstTim << "</td>"
+                << "<td class=\"number\">" << part.lastTim << "</td>";
+        }
+
+        ofs << "<td class=\"text\">";
+        for (vector<tmPartStatement>::iterator s = part.top.begin(); s != part.top.end(); ++s) {
+            ofs << s->execs << ", " << s->elapsed << ", " << s->sqlLine << ": "
+                << "<code>" << htmlEscape(s->sqlText)
+                << ((s->sqlText.length() == REPORTINDEX_SQL_LENGTH) ? " ..." : "")
+                << "</code><br>";
+        }
+
+        ofs << "</td></tr>" << endl;
+    }
+
+    ofs << "</table>" << endl
+        << htmlFooter(version);
+
+    ofs.close();
+    return ofs.good();
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMREPORTINDEX_H
+#define TMREPORTINDEX_H
+
+/** @file tmreportindex.h
+ * @brief Header file for the tmReportIndex object.
+ */
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+
+using std::string;
+using std::ostream;
+using std::vector;
+using std::unordered_map;
+
+#include "tmcursor.h"
+#include "tmcallstats.h"
+
+// How many statements do we list for each part on the index page?
+const unsigned REPORTINDEX_TOP_STATEMENTS = 5;
+
+// How much SQL text do we show on the index page?
+const unsigned REPORTINDEX_SQL_LENGTH = 120;
+
+/** @brief Execution totals for one statement within one report part.
+ */
+struct tmPartStatement
+{
+    string sqlText;                     /**< The SQL, as parsed. No bind values. */
+    unsigned sqlLine;                   /**< First line where this SQL was parsed. */
+    unsigned long long execs;           /**< How many EXECs in this part? */
+    unsigned long long elapsed;         /**< Total EXEC e= in this part. */
+};
+
+/** @brief Summary details for one report part file.
+ */
+struct tmReportPart
+{
+    string fileName;                    /**< Part file name, no path. */
+    unsigned firstLine;                 /**< First trace line in this part. */
+    unsigned lastLine;                  /**< Last trace line in this part. */
+    unsigned long long execs;           /**< EXECs reported in this part. */
+    unsigned long long firstTim;        /**< First EXEC tim= in this part. */
+    unsigned long long lastTim;         /**< Last EXEC tim= in this part. */
+    string firstLocal;                  /**< First EXEC local time, if trace adjusted. */
+    string lastLocal;                   /**< Last EXEC local time, if trace adjusted. */
+    vector<tmPartStatement> top;        /**< Most expensive statements in this part. */
+};
+
+/** @brief A class which keeps track of the parts of a split HTML report
+ *         and writes the index page which links them together.
+ *
+ * The index page is written to the usual report file name, and the parts
+ * are named after it, "trace_0001.html", "trace_0002.html" and so on. Only
+ * the summary for each part is kept once the part is finished, so memory
+ * use does not grow with the size of the trace.
+ */
+class tmReportIndex
+{
+    public:
+        tmReportIndex(const string &fileName, unsigned maxExecs, unsigned long long maxBytes, ostream &diagnostics);
+
+        // Getters.
+        string fileName() { return mFileName; }                 /**< Returns the index file name. */
+        unsigned parts() { return mParts.size(); }              /**< Returns how many parts have been started. */
+        string partFileName(unsigned part);                     /**< Returns a part's file name, no path. Parts start at 1. */
+
+        // Other useful stuff.
+        string startPart(unsigned firstLine);                   /**< Starts a new part. Returns its full file name. */
+        void addExec(tmCursor *cursor, const tmCallStats &stats, const string &local);     /**< Adds an EXEC to the current part. */
+        bool partFull(unsigned long long bytesWritten);         /**< Is it time to start a new part? */
+        void endPart(unsigned lastLine);                        /**< Finishes off the current part. */
+        bool write(const string &traceFile, bool adjusted, float version);     /**< Writes the index page. */
+
+    protected:
+
+    private:
+        string mFileName;                   /**< Index file name, with path. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+        string mBaseName;                   /**< Index file name, with path, less extension. */
+        unsigned mMaxExecs;                 /**< EXECs per part. Zero means no limit. */
+        unsigned long long mMaxBytes;       /**< Bytes per part. Zero means no limit. */
+        vector<tmReportPart> mParts;        /**< All the parts so far. */
+        unordered_map<string, tmPartStatement> mStatements;    /**< Statements in the current part. */
+};
+
+#endif // TMREPORTINDEX_H
@@ -0,0 +1,510 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmsqlite.h"
+
+#include <iostream>
+#include <cstdio>
+
+using std::endl;
+
+/** @file tmsqlite.cpp
+ * @brief Implementation file for the tmSQLite object.
+ */
+
+#ifdef USE_SQLITE
+
+#include <sqlite3.h>
+
+// The tables. No indexes yet, they are built once the load is complete.
+static const char *createTables =
+    "CREATE TABLE trace_file (trace_file TEXT, original_name TEXT, database_version TEXT, "
+    "instance_name TEXT, node_name TEXT, trace_adjusted INTEGER);"
+    "CREATE TABLE sql_texts (sql_text_id INTEGER PRIMARY KEY, sql_id TEXT, sql_text TEXT);"
+    "CREATE TABLE cursors (sql_line INTEGER PRIMARY KEY, cursor_id TEXT, sql_text_id INTEGER, "
+    "depth INTEGER, command_type INTEGER, bind_count INTEGER);"
+    "CREATE TABLE executions (exec_line INTEGER PRIMARY KEY, cursor_id TEXT, sql_line INTEGER, "
+    "sql_text_id INTEGER, parse_line INTEGER, binds_line INTEGER, depth INTEGER, "
+    "cpu INTEGER, elapsed INTEGER, physical_reads INTEGER, consistent_reads INTEGER, "
+    "current_reads INTEGER, misses INTEGER, rows_processed INTEGER, plan_hash INTEGER, "
+    "tim INTEGER, local_time TEXT);"
+    "CREATE TABLE binds (exec_line INTEGER, bind_id INTEGER, bind_name TEXT, "
+    "bind_type INTEGER, bind_value TEXT);"
+    "CREATE TABLE errors (error_line INTEGER, error_type TEXT, cursor_id TEXT, exec_line INTEGER, "
+    "sql_line INTEGER, depth INTEGER, error_code INTEGER, sql_text TEXT);"
+    "CREATE TABLE transactions (xctend_line INTEGER PRIMARY KEY, rolled_back INTEGER, read_only INTEGER);"
+    "CREATE TABLE deadlocks (deadlock_line INTEGER PRIMARY KEY, graph TEXT);";
+
+// And the indexes, built at the end.
+static const char *createIndexes =
+    "CREATE INDEX sql_texts_sql_id ON sql_texts(sql_id);"
+    "CREATE INDEX cursors_cursor_id ON cursors(cursor_id);"
+    "CREATE INDEX executions_sql_text_id ON executions(sql_text_id);"
+    "CREATE INDEX executions_cursor_id ON executions(cursor_id);"
+    "CREATE INDEX binds_exec_line ON binds(exec_line);"
+    "CREATE INDEX binds_name_value ON binds(bind_name, bind_value);"
+    "CREATE INDEX errors_error_line ON errors(error_line);";
+
+
+/** @brief Constructor for a tmSQLite object.
+ *
+ * @param fileName const string&. The database file to be created.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ */
+tmSQLite::tmSQLite(const string &fileName, ostream &diagnostics)
+{
+    mFileName = fileName;
+    mDiagnostics = &diagnostics;
+    mDb = NULL;
+    mInsertSQLText = NULL;
+    mInsertCursor = NULL;
+    mInsertExec = NULL;
+    mInsertBind = NULL;
+    mInsertError = NULL;
+    mInsertTransaction = NULL;
+    mInsertDeadlock = NULL;
+    mUncommitted = 0;
+    mExecRows = 0;
+}
+
+
+/** @brief Destructor for a tmSQLite object.
+ *
+ * If close() wasn't called, anything uncommitted is lost.
+ */
+tmSQLite::~tmSQLite()
+{
+    finalize();
+
+    if (mDb) {
+        sqlite3_close(mDb);
+        mDb = NULL;
+    }
+}
+
+
+/** @brief Creates a new database, the tables and the prepared INSERTs.
+ *
+ * @return bool. True if all ok, false otherwise.
+ *
+ * Any existing database of the same name is removed first.
+ */
+bool tmSQLite::open() {
+
+    std::remove(mFileName.c_str());
+
+    if (sqlite3_open(mFileName.c_str(), &mDb) != SQLITE_OK) {
+        *mDiagnostics << "TraceCollier: Cannot create SQLite database " << mFileName
+                      << ": " << sqlite3_errmsg(mDb) << endl;
+        return false;
+    }
+
+    // No journal and no syncs while loading. If we die, the
+    // database is useless anyway.
+    if (!execute("PRAGMA journal_mode = OFF;"
+                 "PRAGMA synchronous = OFF;"
+                 "PRAGMA locking_mode = EXCLUSIVE;")) {
+        return false;
+    }
+
+    if (!execute(createTables)) {
+        return false;
+    }
+
+    if (!prepare("INSERT INTO sql_texts VALUES (?, ?, ?)", &mInsertSQLText) ||
+        !prepare("INSERT INTO cursors VALUES (?, ?, ?, ?, ?, ?)", &mInsertCursor) ||
+        !prepare("INSERT INTO executions VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", &mInsertExec) ||
+        !prepare("INSERT INTO binds VALUES (?, ?, ?, ?, ?)", &mInsertBind) ||
+        !prepare("INSERT INTO errors VALUES (?, ?, ?, ?, ?, ?, ?, ?)", &mInsertError) ||
+        !prepare("INSERT INTO transactions VALUES (?, ?, ?)", &mInsertTransaction) ||
+        !prepare("INSERT INTO deadlocks VALUES (?, ?)", &mInsertDeadlock)) {
+        return false;
+    }
+
+    return execute("BEGIN;");
+}
+
+
+/** @brief Commits the load, builds the indexes and closes the database.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::close() {
+
+    if (!mDb) {
+        return false;
+    }
+
+    finalize();
+
+    bool ok = execute("COMMIT;") &&
+              execute(createIndexes) &&
+              execute("PRAGMA journal_mode = DELETE;"
+                      "ANALYZE;");
+
+    sqlite3_close(mDb);
+    mDb = NULL;
+
+    return ok;
+}
+
+
+/** @brief Saves the trace file header details.
+ *
+ * @param traceFile const string&. The trace file being processed.
+ * @param originalName const string&. The trace file name as created by the database.
+ * @param databaseVersion const string&. Oracle version.
+ * @param instanceName const string&. Instance name.
+ * @param nodeName const string&. Database server name.
+ * @param traceAdjusted bool. Has the file been through TraceAdjust?
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addTraceFile(const string &traceFile, const string &originalName,
+                            const string &databaseVersion, const string &instanceName,
+                            const string &nodeName, bool traceAdjusted) {
+
+    sqlite3_stmt *statement = NULL;
+    if (!prepare("INSERT INTO trace_file VALUES (?, ?, ?, ?, ?, ?)", &statement)) {
+        return false;
+    }
+
+    sqlite3_bind_text(statement, 1, traceFile.c_str(), traceFile.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 2, originalName.c_str(), originalName.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 3, databaseVersion.c_str(), databaseVersion.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 4, instanceName.c_str(), instanceName.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 5, nodeName.c_str(), nodeName.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 6, traceAdjusted ? 1 : 0);
+
+    bool ok = insert(statement);
+    sqlite3_finalize(statement);
+    return ok;
+}
+
+
+/** @brief Saves a newly parsed, or reparsed, cursor.
+ *
+ * @param cursor tmCursor*. The cursor, with its SQL text already set.
+ * @param depth unsigned. The depth it was parsed at.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addCursor(tmCursor *cursor, unsigned depth) {
+
+    unsigned textId = sqlTextId(cursor);
+    if (!textId) {
+        return false;
+    }
+
+    string cursorId = cursor->cursorId();
+    sqlite3_bind_int64(mInsertCursor, 1, cursor->sqlLineNumber());
+    sqlite3_bind_text(mInsertCursor, 2, cursorId.c_str(), cursorId.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_int64(mInsertCursor, 3, textId);
+    sqlite3_bind_int64(mInsertCursor, 4, depth);
+    sqlite3_bind_int64(mInsertCursor, 5, cursor->commandType());
+    sqlite3_bind_int64(mInsertCursor, 6, cursor->bindCount());
+
+    return insert(mInsertCursor);
+}
+
+
+/** @brief Saves an EXEC, and the bind values it used.
+ *
+ * @param execLine unsigned. The EXEC line number.
+ * @param cursor tmCursor*. The cursor being executed.
+ * @param stats const tmCallStats&. The figures from the EXEC line.
+ * @param local const string&. TraceAdjust local date/time, if any.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addExec(unsigned execLine, tmCursor *cursor, const tmCallStats &stats, const string &local) {
+
+    unsigned textId = sqlTextId(cursor);
+    if (!textId) {
+        return false;
+    }
+
+    string cursorId = cursor->cursorId();
+    sqlite3_bind_int64(mInsertExec, 1, execLine);
+    sqlite3_bind_text(mInsertExec, 2, cursorId.c_str(), cursorId.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_int64(mInsertExec, 3, cursor->sqlLineNumber());
+    sqlite3_bind_int64(mInsertExec, 4, textId);
+    sqlite3_bind_int64(mInsertExec, 5, cursor->sqlParseLine());
+    sqlite3_bind_int64(mInsertExec, 6, cursor->bindsLine());
+    sqlite3_bind_int64(mInsertExec, 7, stats.depth());
+    sqlite3_bind_int64(mInsertExec, 8, stats.cpu());
+    sqlite3_bind_int64(mInsertExec, 9, stats.elapsed());
+    sqlite3_bind_int64(mInsertExec, 10, stats.physicalReads());
+    sqlite3_bind_int64(mInsertExec, 11, stats.consistentReads());
+    sqlite3_bind_int64(mInsertExec, 12, stats.currentReads());
+    sqlite3_bind_int64(mInsertExec, 13, stats.misses());
+    sqlite3_bind_int64(mInsertExec, 14, stats.rows());
+    sqlite3_bind_int64(mInsertExec, 15, stats.planHash());
+    sqlite3_bind_int64(mInsertExec, 16, stats.tim());
+    if (local.empty()) {
+        sqlite3_bind_null(mInsertExec, 17);
+    } else {
+        sqlite3_bind_text(mInsertExec, 17, local.c_str(), local.length(), SQLITE_TRANSIENT);
+    }
+
+    if (!insert(mInsertExec)) {
+        return false;
+    }
+
+    mExecRows++;
+
+    // The binds are only current if the cursor has a BINDS line.
+    if (!cursor->bindsLine()) {
+        return true;
+    }
+
+    map<unsigned, tmBind *> *binds = cursor->binds();
+    for (map<unsigned, tmBind *>::iterator i = binds->begin(); i != binds->end(); ++i) {
+        string bindName = i->second->bindName();
+        string bindValue = i->second->bindValue();
+
+        sqlite3_bind_int64(mInsertBind, 1, execLine);
+        sqlite3_bind_int64(mInsertBind, 2, i->second->bindId());
+        sqlite3_bind_text(mInsertBind, 3, bindName.c_str(), bindName.length(), SQLITE_TRANSIENT);
+        sqlite3_bind_int64(mInsertBind, 4, i->second->bindType());
+        sqlite3_bind_text(mInsertBind, 5, bindValue.c_str(), bindValue.length(), SQLITE_TRANSIENT);
+
+        if (!insert(mInsertBind)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/** @brief Saves an ERROR against a cursor.
+ *
+ * @param errorLine unsigned. The ERROR line number.
+ * @param cursor tmCursor*. The cursor which failed.
+ * @param errorCode unsigned. The ORA- error number.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addError(unsigned errorLine, tmCursor *cursor, unsigned errorCode) {
+
+    string cursorId = cursor->cursorId();
+    sqlite3_bind_int64(mInsertError, 1, errorLine);
+    sqlite3_bind_text(mInsertError, 2, "ERROR", -1, SQLITE_STATIC);
+    sqlite3_bind_text(mInsertError, 3, cursorId.c_str(), cursorId.length(), SQLITE_TRANSIENT);
+    sqlite3_bind_int64(mInsertError, 4, cursor->execLine());
+    sqlite3_bind_int64(mInsertError, 5, cursor->sqlLineNumber());
+    sqlite3_bind_null(mInsertError, 6);
+    sqlite3_bind_int64(mInsertError, 7, errorCode);
+    sqlite3_bind_null(mInsertError, 8);
+
+    return insert(mInsertError);
+}
+
+
+/** @brief Saves a PARSE ERROR.
+ *
+ * @param errorLine unsigned. The PARSE ERROR line number.
+ * @param depth unsigned. The depth of the failed parse.
+ * @param errorCode unsigned. The ORA- error number.
+ * @param sqlText const string&. The first line of the failing SQL.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addParseError(unsigned errorLine, unsigned depth, unsigned errorCode, const string &sqlText) {
+
+    sqlite3_bind_int64(mInsertError, 1, errorLine);
+    sqlite3_bind_text(mInsertError, 2, "PARSE ERROR", -1, SQLITE_STATIC);
+    sqlite3_bind_null(mInsertError, 3);
+    sqlite3_bind_null(mInsertError, 4);
+    sqlite3_bind_int64(mInsertError, 5, errorLine + 1);
+    sqlite3_bind_int64(mInsertError, 6, depth);
+    sqlite3_bind_int64(mInsertError, 7, errorCode);
+    sqlite3_bind_text(mInsertError, 8, sqlText.c_str(), sqlText.length(), SQLITE_TRANSIENT);
+
+    return insert(mInsertError);
+}
+
+
+/** @brief Saves a COMMIT or ROLLBACK.
+ *
+ * @param xctendLine unsigned. The XCTEND line number.
+ * @param rollBack bool. True for a ROLLBACK.
+ * @param readOnly bool. True if the transaction changed nothing.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addTransaction(unsigned xctendLine, bool rollBack, bool readOnly) {
+
+    sqlite3_bind_int64(mInsertTransaction, 1, xctendLine);
+    sqlite3_bind_int(mInsertTransaction, 2, rollBack ? 1 : 0);
+    sqlite3_bind_int(mInsertTransaction, 3, readOnly ? 1 : 0);
+
+    return insert(mInsertTransaction);
+}
+
+
+/** @brief Saves a deadlock graph.
+ *
+ * @param deadlockLine unsigned. The DEADLOCK DETECTED line number.
+ * @param graph const string&. The deadlock graph, as it appears in the trace.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::addDeadlock(unsigned deadlockLine, const string &graph) {
+
+    sqlite3_bind_int64(mInsertDeadlock, 1, deadlockLine);
+    sqlite3_bind_text(mInsertDeadlock, 2, graph.c_str(), graph.length(), SQLITE_TRANSIENT);
+
+    return insert(mInsertDeadlock);
+}
+
+
+/** @brief Runs one or more SQL statements, no results expected.
+ *
+ * @param sql const char*. The SQL to run.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::execute(const char *sql) {
+
+    char *errorMessage = NULL;
+    if (sqlite3_exec(mDb, sql, NULL, NULL, &errorMessage) != SQLITE_OK) {
+        *mDiagnostics << "TraceCollier: SQLite error: " << errorMessage << endl;
+        sqlite3_free(errorMessage);
+        return false;
+    }
+
+    return true;
+}
+
+
+/** @brief Prepares a statement for repeated use.
+ *
+ * @param sql const char*. The SQL to prepare.
+ * @param statement sqlite3_stmt**. Receives the prepared statement.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmSQLite::prepare(const char *sql, sqlite3_stmt **statement) {
+
+    if (sqlite3_prepare_v2(mDb, sql, -1, statement, NULL) != SQLITE_OK) {
+        *mDiagnostics << "TraceCollier: SQLite cannot prepare [" << sql << "]: "
+                      << sqlite3_errmsg(mDb) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+/** @brief Executes a prepared INSERT, then resets it for next time.
+ *
+ * @param statement sqlite3_stmt*. The INSERT, with all values bound.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * Every SQLITE_ROWS_PER_COMMIT rows, we commit and start a new transaction.
+ */
+bool tmSQLite::insert(sqlite3_stmt *statement) {
+
+    int result = sqlite3_step(statement);
+    sqlite3_reset(statement);
+
+    if (result != SQLITE_DONE) {
+        *mDiagnostics << "TraceCollier: SQLite INSERT failed: " << sqlite3_errmsg(mDb) << endl;
+        return false;
+    }
+
+    if (++mUncommitted >= SQLITE_ROWS_PER_COMMIT) {
+        mUncommitted = 0;
+        return execute("COMMIT; BEGIN;");
+    }
+
+    return true;
+}
+
+
+/** @brief Returns the sql_texts id for a cursor's SQL, inserting it if new.
+ *
+ * @param cursor tmCursor*. The cursor whose SQL we want.
+ * @return unsigned. The sql_text_id, or zero on failure.
+ */
+unsigned tmSQLite::sqlTextId(tmCursor *cursor) {
+
+    string sqlText = cursor->sqlText();
+
+    unordered_map<string, unsigned>::iterator i = mSQLTextIds.find(sqlText);
+    if (i != mSQLTextIds.end()) {
+        return i->second;
+    }
+
+    unsigned textId = mSQLTextIds.size() + 1;
+    string sqlId = cursor->sqlId();
+
+    sqlite3_bind_int64(mInsertSQLText, 1, textId);
+    if (sqlId.empty()) {
+        sqlite3_bind_null(mInsertSQLText, 2);
+    } else {
+        sqlite3_bind_text(mInsertSQLText, 2, sqlId.c_str(), sqlId.length(), SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_text(mInsertSQLText, 3, sqlText.c_str(), sqlText.length(), SQLITE_TRANSIENT);
+
+    if (!insert(mInsertSQLText)) {
+        return 0;
+    }
+
+    mSQLTextIds.insert(std::make_pair(sqlText, textId));
+    return textId;
+}
+
+
+/** @brief Frees all the prepared statements.
+ */
+void tmSQLite::finalize() {
+
+    sqlite3_stmt **statements[] = { &mInsertSQLText, &mInsertCursor, &mInsertExec, &mInsertBind,
+                                    &mInsertError, &mInsertTransaction, &mInsertDeadlock };
+
+    for (unsigned i = 0; i < sizeof(statements) / sizeof(statements[0]); i++) {
+        if (*statements[i]) {
+            sqlite3_finalize(*statements[i]);
+            *statements[i] = NULL;
+        }
+    }
+}
+
+#else
+
+// Not compiled with SQLite. Everything fails, but tmOptions
+// shouldn't have let us get this far in the first place.
+
+tmSQLite::tmSQLite(const string &fileName, ostream &diagnostics) { mFileName = fileName; mDiagnostics = &diagnostics; mDb = NULL; mExecRows = 0; }
+tmSQLite::~tmSQLite() {}
+
+bool tmSQLite::open() {
+    *mDiagnostics << "TraceCollier: Not compiled with SQLite support. Rebuild with USE_SQLITE defined." << endl;
+    return false;
+}
+
+bool tmSQLite::close() { return false; }
+bool tmSQLite::addTraceFile(const string &, const string &, const string &, const string &, const string &, bool) { return false; }
+bool tmSQLite::addCursor(tmCursor *, unsigned) { return false; }
+bool tmSQLite::addExec(unsigned, tmCursor *, const tmCallStats &, const string &) { return false; }
+bool tmSQLite::addError(unsigned, tmCursor *, unsigned) { return false; }
+bool tmSQLite::addParseError(unsigned, unsigned, unsigned, const string &) { return false; }
+bool tmSQLite::addTransaction(unsigned, bool, bool) { return false; }
+bool tmSQLite::addDeadlock(unsigned, const string &) { return false; }
+
+#endif // USE_SQLITE
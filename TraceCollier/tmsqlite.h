@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMSQLITE_H
+#define TMSQLITE_H
+
+/** @file tmsqlite.h
+ * @brief Header file for the tmSQLite object.
+ */
+
+#include <string>
+#include <unordered_map>
+#include <ostream>
+
+using std::string;
+using std::ostream;
+using std::unordered_map;
+
+#include "tmcursor.h"
+#include "tmcallstats.h"
+
+// SQLite's own types. We only ever need pointers to these,
+// so sqlite3.h is only required when compiling tmsqlite.cpp.
+struct sqlite3;
+struct sqlite3_stmt;
+
+// How many rows do we insert per transaction?
+const unsigned SQLITE_ROWS_PER_COMMIT = 100000;
+
+/** @brief A class which writes the report to an SQLite database, rather
+ *         than to a text or HTML file.
+ *
+ * Only available when compiled with USE_SQLITE defined, and linked
+ * with -lsqlite3. See makefile.gnu. Otherwise open() will simply fail.
+ *
+ * The database is loaded with the journal and syncs turned off, using
+ * prepared statements and a commit every SQLITE_ROWS_PER_COMMIT rows.
+ * The indexes are only built by close(), when the load is complete.
+ *
+ * Tables created are:
+ *
+ * @li trace_file - one row of trace file header details.
+ * @li sql_texts - every distinct SQL statement, and its sqlid.
+ * @li cursors - one row per PARSING IN CURSOR, at any depth.
+ * @li executions - one row per EXEC reported, with all the c=, e= etc figures.
+ * @li binds - the bind values used by each execution. Join on exec_line.
+ * @li errors - ERROR and PARSE ERROR lines.
+ * @li transactions - XCTEND lines. COMMITs and ROLLBACKs.
+ * @li deadlocks - deadlock graphs.
+ */
+class tmSQLite
+{
+    public:
+        tmSQLite(const string &fileName, ostream &diagnostics);
+        ~tmSQLite();
+
+        // Getters.
+        string fileName() { return mFileName; }                         /**< Returns the database file name. */
+        unsigned long long execRows() { return mExecRows; }             /**< Returns how many executions were written. */
+
+        // Other useful stuff.
+        bool open();            /**< Creates the database, tables and prepared statements. */
+        bool close();           /**< Commits, builds the indexes and closes the database. */
+
+        bool addTraceFile(const string &traceFile, const string &originalName,
+                          const string &databaseVersion, const string &instanceName,
+                          const string &nodeName, bool traceAdjusted);      /**< Saves the trace file header details. */
+        bool addCursor(tmCursor *cursor, unsigned depth);                   /**< Saves a newly parsed cursor. */
+        bool addExec(unsigned execLine, tmCursor *cursor, const tmCallStats &stats, const string &local);  /**< Saves an EXEC and its binds. */
+        bool addError(unsigned errorLine, tmCursor *cursor, unsigned errorCode);   /**< Saves an ERROR. */
+        bool addParseError(unsigned errorLine, unsigned depth, unsigned errorCode, const string &sqlText);   /**< Saves a PARSE ERROR. */
+        bool addTransaction(unsigned xctendLine, bool rollBack, bool readOnly);    /**< Saves an XCTEND. */
+        bool addDeadlock(unsigned deadlockLine, const string &graph);              /**< Saves a deadlock graph. */
+
+    protected:
+
+    private:
+        string mFileName;                   /**< The database file name. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+        sqlite3 *mDb;                       /**< The open database. */
+        sqlite3_stmt *mInsertSQLText;       /**< Prepared INSERT into sql_texts. */
+        sqlite3_stmt *mInsertCursor;        /**< Prepared INSERT into cursors. */
+        sqlite3_stmt *mInsertExec;          /**< Prepared INSERT into executions. */
+        sqlite3_stmt *mInsertBind;          /**< Prepared INSERT into binds. */
+        sqlite3_stmt *mInsertError;         /**< Prepared INSERT into errors. */
+        sqlite3_stmt *mInsertTransaction;   /**< Prepared INSERT into transactions. */
+        sqlite3_stmt *mInsertDeadlock;      /**< Prepared INSERT into deadlocks. */
+        unordered_map<string, unsigned> mSQLTextIds;   /**< SQL text to sql_texts.sql_text_id lookup. */
+        unsigned mUncommitted;              /**< Rows inserted since the last COMMIT. */
+        unsigned long long mExecRows;       /**< Executions inserted. */
+
+        bool execute(const char *sql);                              /**< Runs a single SQL statement. */
+        bool prepare(const char *sql, sqlite3_stmt **statement);    /**< Prepares an INSERT. */
+        bool insert(sqlite3_stmt *statement);                       /**< Executes and resets a prepared INSERT. */
+        unsigned sqlTextId(tmCursor *cursor);                       /**< Returns the sql_texts id, inserting if new. */
+        void finalize();                                            /**< Frees the prepared statements. */
+};
+
+#endif // TMSQLITE_H
@@ -0,0 +1,539 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmstats.h"
+#include "utilities.h"
+
+#include <iomanip>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define USE_POSIX_CLOCKS
+    #include <time.h>
+    #include <sys/resource.h>
+#else
+    #include <chrono>
+    #include <ctime>
+#endif // __unix__
+
+using std::ofstream;
+using std::setw;
+using std::left;
+using std::right;
+using std::fixed;
+using std::setprecision;
+
+/** @file tmstats.cpp
+ * @brief Implementation file for the tmStats object.
+ */
+
+
+// Stage names, in tmStage order.
+static const char *stageNames[STAGE_COUNT] = {
+    "setup", "header", "read", "classify", "write",
+    "PARSING", "PARSE", "BINDS", "EXEC", "CLOSE", "STAT",
+    "XCTEND", "ERROR", "PARSE ERROR", "DEADLOCK", "FETCH", "WAIT",
+    "other"
+};
+
+
+/** @brief Returns the name of a stage, for reports.
+ *
+ * @param stage tmStage. The stage.
+ * @return const char*. Its name.
+ */
+const char *stageName(tmStage stage) {
+    return stage < STAGE_COUNT ? stageNames[stage] : "unknown";
+}
+
+
+// Internal use only. The clocks, in nanoseconds. On Linux, the wall clock
+// is read without a system call, in about 20ns, but the thread CPU clock
+// is a system call, about 350ns.
+static uint64_t wallNow() {
+#ifdef USE_POSIX_CLOCKS
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif // USE_POSIX_CLOCKS
+}
+
+static uint64_t cpuNow() {
+#ifdef USE_POSIX_CLOCKS
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#else
+    return std::clock() * (1000000000ULL / CLOCKS_PER_SEC);
+#endif // USE_POSIX_CLOCKS
+}
+
+// Internal use only. Peak resident set size in kilobytes, or -1.
+static long peakRSS() {
+#ifdef USE_POSIX_CLOCKS
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+
+    #ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+    #else
+        return usage.ru_maxrss;
+    #endif // __APPLE__
+#else
+    return -1;
+#endif // USE_POSIX_CLOCKS
+}
+
+// Internal use only. Nanoseconds to milliseconds.
+static double ms(uint64_t nanoseconds) {
+    return nanoseconds / 1e6;
+}
+
+
+/** @brief Constructor for a tmStats object.
+ *
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ *
+ * The clocks start now, in STAGE_SETUP.
+ */
+tmStats::tmStats(ostream &diagnostics)
+{
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        mWall[i] = 0;
+        mCpu[i] = 0;
+        mRecords[i] = 0;
+        mLines[i] = 0;
+        mSampleWall[i] = 0;
+
+        for (int j = 0; j < COUNTER_COUNT; j++) {
+            mEvents[i][j] = 0;
+        }
+    }
+
+    for (int j = 0; j < COUNTER_COUNT; j++) {
+        mLastEvents[j] = 0;
+    }
+
+    mCurrent = STAGE_SETUP;
+    mReadFor = STAGE_SETUP;
+    mStartWall = mLastWall = wallNow();
+    mStartCpu = mLastCpu = cpuNow();
+    mChanges = 0;
+    mTotalWall = 0;
+    mTotalCpu = 0;
+    mBytes = 0;
+    mLinesRead = 0;
+    mPeakCursors = 0;
+    mFinalCursors = 0;
+    mLargestSQL = 0;
+    mLargestSQLLine = 0;
+    mLargestBindLines = 0;
+    mLargestBindBytes = 0;
+    mLargestBindLine = 0;
+    mPeakRSS = -1;
+    mCounters = NULL;
+    mDiagnostics = &diagnostics;
+}
+
+
+/** @brief Destructor for a tmStats object.
+ */
+tmStats::~tmStats()
+{
+    if (mCounters) {
+        delete mCounters;
+        mCounters = NULL;
+    }
+}
+
+
+/** @brief Opens the hardware counters, and charges them to the stages from now on.
+ *
+ * @return bool. True if any counter opened, false otherwise.
+ *
+ * Reading them costs a system call at every change of stage, a microsecond
+ * or so, which is small beside the parsing, but shows in the READ stage.
+ */
+bool tmStats::useCounters() {
+    if (mCounters) {
+        return true;
+    }
+
+    mCounters = new tmCounters(*mDiagnostics);
+    if (!mCounters->open()) {
+        *mDiagnostics << "TraceCollier: No hardware counters, carrying on without them." << endl;
+        delete mCounters;
+        mCounters = NULL;
+        return false;
+    }
+
+    // Charge what went before, so the counters start from here too.
+    charge();
+    return true;
+}
+
+
+/** @brief Charges the time since the last change of stage to the current stage.
+ *
+ * The CPU time is charged every STATS_CPU_SAMPLE calls.
+ */
+void tmStats::charge() {
+    uint64_t wall = wallNow();
+
+    mWall[mCurrent] += wall - mLastWall;
+    mSampleWall[mCurrent] += wall - mLastWall;
+    mLastWall = wall;
+
+    if (++mChanges >= STATS_CPU_SAMPLE) {
+        chargeCpu();
+    }
+
+    if (mCounters) {
+        uint64_t events[COUNTER_COUNT];
+        if (mCounters->read(events)) {
+            for (int j = 0; j < COUNTER_COUNT; j++) {
+                mEvents[mCurrent][j] += events[j] - mLastEvents[j];
+                mLastEvents[j] = events[j];
+            }
+        }
+    }
+}
+
+
+/** @brief Shares the CPU time since the last reading between the stages.
+ *
+ * Each stage gets the share of it that it had of the wall time since
+ * then. Whatever rounding leaves over goes to the current stage.
+ */
+void tmStats::chargeCpu() {
+    uint64_t cpu = cpuNow();
+    uint64_t used = cpu - mLastCpu;
+
+    uint64_t wall = 0;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        wall += mSampleWall[i];
+    }
+
+    uint64_t shared = 0;
+    if (wall) {
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            uint64_t share = uint64_t(double(used) * mSampleWall[i] / wall);
+            mCpu[i] += share;
+            shared += share;
+            mSampleWall[i] = 0;
+        }
+    }
+
+    if (used > shared) {
+        mCpu[mCurrent] += used - shared;
+    }
+    mLastCpu = cpu;
+    mChanges = 0;
+}
+
+
+/** @brief Makes a stage current.
+ *
+ * @param stage tmStage. The new stage.
+ * @return tmStage. The previous stage, to go back to afterwards.
+ */
+tmStage tmStats::enter(tmStage stage) {
+    charge();
+
+    if (stage == STAGE_READ) {
+        mReadFor = mCurrent;
+    }
+
+    tmStage previous = mCurrent;
+    mCurrent = stage;
+    return previous;
+}
+
+
+/** @brief Counts a call of a stage.
+ *
+ * @param stage tmStage. The stage.
+ *
+ * For the record types, the line which started the record is counted too.
+ */
+void tmStats::record(tmStage stage) {
+    mRecords[stage]++;
+
+    if (stage >= STAGE_PARSING) {
+        mLines[stage]++;
+    }
+}
+
+
+/** @brief Counts a line read from the trace file.
+ *
+ * @param bytes unsigned. The line's length, including the newline.
+ *
+ * Lines read by a record handler, SQL text or bind data for example,
+ * are counted as that record type's lines. Likewise the header's lines.
+ */
+void tmStats::readLine(unsigned bytes) {
+    mBytes += bytes;
+    mLinesRead++;
+
+    if (mReadFor >= STAGE_PARSING || mReadFor == STAGE_HEADER) {
+        mLines[mReadFor]++;
+    }
+}
+
+
+/** @brief Notes the length of a SQL statement.
+ *
+ * @param length unsigned. The len= from PARSING IN CURSOR.
+ * @param line unsigned. The line it was on.
+ */
+void tmStats::sqlBlock(unsigned length, unsigned line) {
+    if (length > mLargestSQL) {
+        mLargestSQL = length;
+        mLargestSQLLine = line;
+    }
+}
+
+
+/** @brief Notes the size of a BINDS block.
+ *
+ * @param lines unsigned. How many bind data lines it had.
+ * @param bytes unsigned. How many bytes they came to.
+ * @param line unsigned. The BINDS line.
+ */
+void tmStats::bindBlock(unsigned lines, unsigned bytes, unsigned line) {
+    if (lines > mLargestBindLines) {
+        mLargestBindLines = lines;
+        mLargestBindLine = line;
+    }
+
+    if (bytes > mLargestBindBytes) {
+        mLargestBindBytes = bytes;
+    }
+}
+
+
+/** @brief Notes the size of the cursor table.
+ *
+ * @param count unsigned. How many cursors there are now.
+ */
+void tmStats::cursors(unsigned count) {
+    if (count > mPeakCursors) {
+        mPeakCursors = count;
+    }
+
+    mFinalCursors = count;
+}
+
+
+/** @brief Stops the clocks, and notes the peak RSS.
+ */
+void tmStats::finish() {
+    charge();
+    chargeCpu();
+    mTotalWall = mLastWall - mStartWall;
+    mTotalCpu = mLastCpu - mStartCpu;
+    mPeakRSS = peakRSS();
+}
+
+
+/** @brief Writes the figures as a table.
+ *
+ * @param out ostream&. Where to write them. Usually the diagnostics stream.
+ */
+void tmStats::report(ostream &out) {
+
+    double seconds = mTotalWall / 1e9;
+
+    out << endl << "TraceCollier statistics:" << endl << endl
+        << left << setw(12) << "Stage"
+        << right << setw(12) << "Calls"
+        << setw(12) << "Lines"
+        << setw(12) << "Wall ms"
+        << setw(12) << "CPU ms"
+        << setw(8) << "Wall %" << endl
+        << string(68, '-') << endl;
+
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (!mRecords[i] && !mWall[i]) {
+            continue;
+        }
+
+        out << left << setw(12) << stageNames[i]
+            << right << setw(12) << mRecords[i]
+            << setw(12) << mLines[i]
+            << fixed << setprecision(1)
+            << setw(12) << ms(mWall[i])
+            << setw(12) << ms(mCpu[i])
+            << setw(8) << (mTotalWall ? 100.0 * mWall[i] / mTotalWall : 0.0) << endl;
+    }
+
+    out << string(68, '-') << endl
+        << left << setw(12) << "Total"
+        << right << setw(12) << ""
+        << setw(12) << mLinesRead
+        << setw(12) << ms(mTotalWall)
+        << setw(12) << ms(mTotalCpu) << endl << endl;
+
+    out << setprecision(0)
+        << "Bytes read:     " << mBytes << " (" << (seconds > 0 ? mBytes / seconds : 0) << " bytes/sec)" << endl
+        << "Lines read:     " << mLinesRead << " (" << (seconds > 0 ? mLinesRead / seconds : 0) << " lines/sec)" << endl;
+
+    if (mPeakRSS >= 0) {
+        out << "Peak RSS:       " << mPeakRSS << " KB" << endl;
+    }
+
+    out << "Cursors:        " << mPeakCursors << " at peak, " << mFinalCursors << " at the end" << endl
+        << "Largest SQL:    " << mLargestSQL << " characters, at line " << mLargestSQLLine << endl
+        << "Largest BINDS:  " << mLargestBindLines << " lines, at line " << mLargestBindLine
+        << ". Most bytes: " << mLargestBindBytes << endl << endl;
+
+    if (mCounters) {
+        reportCounters(out);
+    }
+
+    out.unsetf(std::ios::floatfield);
+    out << setprecision(6);
+}
+
+
+/** @brief Writes the hardware counts as a table.
+ *
+ * @param out ostream&. Where to write them.
+ *
+ * IPC is instructions per cycle. The misses are per trace line, as that
+ * is what we parse, so the record types can be compared with each other.
+ */
+void tmStats::reportCounters(ostream &out) {
+
+    out << "Hardware counters:" << endl << endl
+        << left << setw(12) << "Stage"
+        << right << setw(14) << "Cycles"
+        << setw(14) << "Instructions"
+        << setw(7) << "IPC"
+        << setw(14) << "Cache misses"
+        << setw(14) << "Branch misses"
+        << setw(12) << "Cache/line"
+        << setw(12) << "Branch/line" << endl
+        << string(99, '-') << endl;
+
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        uint64_t *events = mEvents[i];
+        if (!events[COUNTER_CYCLES] && !events[COUNTER_INSTRUCTIONS]) {
+            continue;
+        }
+
+        out << left << setw(12) << stageNames[i]
+            << right << setw(14) << events[COUNTER_CYCLES]
+            << setw(14) << events[COUNTER_INSTRUCTIONS]
+            << fixed << setprecision(2)
+            << setw(7) << (events[COUNTER_CYCLES] ? double(events[COUNTER_INSTRUCTIONS]) / events[COUNTER_CYCLES] : 0.0)
+            << setw(14) << events[COUNTER_CACHE_MISSES]
+            << setw(14) << events[COUNTER_BRANCH_MISSES]
+            << setprecision(1);
+
+        if (mLines[i]) {
+            out << setw(12) << double(events[COUNTER_CACHE_MISSES]) / mLines[i]
+                << setw(12) << double(events[COUNTER_BRANCH_MISSES]) / mLines[i];
+        }
+
+        out << endl;
+    }
+
+    out << string(99, '-') << endl;
+
+    for (int j = 0; j < COUNTER_COUNT; j++) {
+        if (!mCounters->available(tmCounter(j))) {
+            out << "The " << counterName(tmCounter(j)) << " counter was not available, and shows as zero." << endl;
+        }
+    }
+
+    out << endl;
+}
+
+
+/** @brief Writes the figures as a JSON file.
+ *
+ * @param fileName const string&. The file to write.
+ * @param traceFile const string&. The trace file they are for.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmStats::writeJson(const string &fileName, const string &traceFile) {
+
+    ofstream ofs(fileName);
+
+    if (!ofs.good()) {
+        *mDiagnostics << "TraceCollier: Cannot open statistics file " << fileName << endl;
+        return false;
+    }
+
+    double seconds = mTotalWall / 1e9;
+    string name;
+    appendJsonString(name, traceFile);
+
+    ofs << fixed << setprecision(3)
+        << "{" << endl
+        << "  \"trace\": " << name << "," << endl
+        << "  \"wall_ms\": " << ms(mTotalWall) << "," << endl
+        << "  \"cpu_ms\": " << ms(mTotalCpu) << "," << endl
+        << "  \"bytes\": " << mBytes << "," << endl
+        << "  \"lines\": " << mLinesRead << "," << endl
+        << "  \"bytes_per_sec\": " << (seconds > 0 ? mBytes / seconds : 0) << "," << endl
+        << "  \"lines_per_sec\": " << (seconds > 0 ? mLinesRead / seconds : 0) << "," << endl
+        << "  \"peak_rss_kb\": " << mPeakRSS << "," << endl
+        << "  \"cursors\": {\"peak\": " << mPeakCursors << ", \"final\": " << mFinalCursors << "}," << endl
+        << "  \"largest_sql\": {\"length\": " << mLargestSQL << ", \"line\": " << mLargestSQLLine << "}," << endl
+        << "  \"largest_binds\": {\"lines\": " << mLargestBindLines << ", \"bytes\": " << mLargestBindBytes
+        << ", \"line\": " << mLargestBindLine << "}," << endl
+        << "  \"stages\": [";
+
+    bool first = true;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        ofs << (first ? "" : ",") << endl
+            << "    {\"stage\": \"" << stageNames[i] << "\""
+            << ", \"calls\": " << mRecords[i]
+            << ", \"lines\": " << mLines[i]
+            << ", \"wall_ms\": " << ms(mWall[i])
+            << ", \"cpu_ms\": " << ms(mCpu[i]);
+
+        if (mCounters) {
+            ofs << ", \"cycles\": " << mEvents[i][COUNTER_CYCLES]
+                << ", \"instructions\": " << mEvents[i][COUNTER_INSTRUCTIONS]
+                << ", \"cache_misses\": " << mEvents[i][COUNTER_CACHE_MISSES]
+                << ", \"branch_misses\": " << mEvents[i][COUNTER_BRANCH_MISSES];
+        }
+
+        ofs << "}";
+        first = false;
+    }
+
+    ofs << endl << "  ]" << endl << "}" << endl;
+
+    return ofs.good();
+}
@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMSTATS_H
+#define TMSTATS_H
+
+/** @file tmstats.h
+ * @brief Header file for the tmStats object.
+ */
+
+#include <string>
+#include <iostream>
+#include <stdint.h>
+
+#include "tmcounters.h"
+
+using std::string;
+using std::ostream;
+
+// Parser stages, which time and other costs are charged to.
+// STAGE_CLASSIFY is the main loop deciding what each line is.
+// STAGE_PARSING onwards are the trace record types. STAGE_OTHER is
+// lines with no handler, timestamps etc. It only has counts, its
+// time is part of STAGE_CLASSIFY.
+enum tmStage {
+    STAGE_SETUP,
+    STAGE_HEADER,
+    STAGE_READ,
+    STAGE_CLASSIFY,
+    STAGE_WRITE,
+    STAGE_PARSING,
+    STAGE_PARSE,
+    STAGE_BINDS,
+    STAGE_EXEC,
+    STAGE_CLOSE,
+    STAGE_STAT,
+    STAGE_XCTEND,
+    STAGE_ERROR,
+    STAGE_PARSE_ERROR,
+    STAGE_DEADLOCK,
+    STAGE_FETCH,
+    STAGE_WAIT,
+    STAGE_OTHER,
+    STAGE_COUNT
+};
+
+const char *stageName(tmStage stage);       /**< Returns a stage's name for reports. */
+
+#ifdef USE_ALLOC_STATS
+// Allocation counting, built in with ALLOCSTATS=1. See tmallocstats.cpp.
+// tmStageTimer keeps these up to date, with or without --stats.
+extern tmStage allocStage;                      /**< The stage which new allocations are charged to. */
+extern uint64_t allocStageCalls[STAGE_COUNT];   /**< Times each stage was entered. */
+#endif // USE_ALLOC_STATS
+
+// How many changes of stage between readings of the thread's CPU clock.
+const unsigned STATS_CPU_SAMPLE = 1024;
+
+/** @brief A class which collects the --stats figures for one trace file.
+ *
+ * Wall time is charged to whichever stage is current. Changing stage
+ * reads the wall clock once, and charges the time since the last change
+ * to the stage being left, so nested stages are not counted twice. Use
+ * tmStageTimer rather than calling enter() directly.
+ *
+ * There are a few changes of stage for every line, and the thread's CPU
+ * clock is a system call, several times the cost of the wall clock, so it
+ * is only read every STATS_CPU_SAMPLE changes. The CPU time since the last
+ * reading is shared between the stages by the wall time each had since
+ * then. The total CPU time is exact, each stage's is an estimate.
+ *
+ * With useCounters(), the hardware counters are charged the same way.
+ */
+class tmStats
+{
+    public:
+        tmStats(ostream &diagnostics);
+        ~tmStats();
+
+        // Getters.
+        tmStage current() { return mCurrent; }              /**< Returns the current stage. */
+
+        // Counting.
+        bool useCounters();                                 /**< Charges hardware counters to the stages too. */
+        tmStage enter(tmStage stage);                       /**< Makes a stage current, returns the previous one. */
+        void record(tmStage stage);                         /**< Counts a call, and for record types, its line. */
+        void readLine(unsigned bytes);                      /**< Counts a line read from the trace file. */
+        void unreadLine() { mLines[mCurrent]--; }           /**< Uncounts a line which was pushed back. */
+        void sqlBlock(unsigned length, unsigned line);      /**< Notes a PARSING IN CURSOR's SQL length. */
+        void bindBlock(unsigned lines, unsigned bytes, unsigned line);  /**< Notes the size of a BINDS block. */
+        void cursors(unsigned count);                       /**< Notes the size of the cursor table. */
+
+        // Reporting.
+        void finish();                                      /**< Stops the clocks. */
+        void report(ostream &out);                          /**< Writes the figures as a table. */
+        bool writeJson(const string &fileName, const string &traceFile);   /**< Writes the figures as JSON. */
+
+    private:
+        uint64_t mWall[STAGE_COUNT];        /**< Wall time per stage, nanoseconds. */
+        uint64_t mCpu[STAGE_COUNT];         /**< CPU time per stage, nanoseconds. */
+        uint64_t mRecords[STAGE_COUNT];     /**< Handler calls per stage. */
+        uint64_t mLines[STAGE_COUNT];       /**< Trace lines consumed per stage. */
+        uint64_t mEvents[STAGE_COUNT][COUNTER_COUNT];   /**< Hardware counts per stage. */
+        uint64_t mLastEvents[COUNTER_COUNT];            /**< Hardware counts at the last change of stage. */
+        tmCounters *mCounters;              /**< The hardware counters. NULL if not wanted. */
+        tmStage mCurrent;                   /**< The stage being charged now. */
+        tmStage mReadFor;                   /**< The stage which is reading lines. */
+        uint64_t mLastWall;                 /**< Wall clock at the last change of stage. */
+        uint64_t mLastCpu;                  /**< CPU clock at the last reading. */
+        uint64_t mSampleWall[STAGE_COUNT];  /**< Wall time per stage since the last CPU clock reading. */
+        unsigned mChanges;                  /**< Changes of stage since the last CPU clock reading. */
+        uint64_t mStartWall;                /**< Wall clock when we started. */
+        uint64_t mStartCpu;                 /**< CPU clock when we started. */
+        uint64_t mTotalWall;                /**< Wall time from start to finish(). */
+        uint64_t mTotalCpu;                 /**< CPU time from start to finish(). */
+        uint64_t mBytes;                    /**< Bytes read from the trace file. */
+        uint64_t mLinesRead;                /**< Lines read from the trace file. */
+        unsigned mPeakCursors;              /**< Largest cursor table seen. */
+        unsigned mFinalCursors;             /**< Cursor table size at the end. */
+        unsigned mLargestSQL;               /**< Longest SQL statement, len=. */
+        unsigned mLargestSQLLine;           /**< Line of the longest SQL statement. */
+        unsigned mLargestBindLines;         /**< Most lines in one BINDS block. */
+        unsigned mLargestBindBytes;         /**< Most bytes in one BINDS block. */
+        unsigned mLargestBindLine;          /**< Line of the BINDS block with the most lines. */
+        long mPeakRSS;                      /**< Peak resident set size, kilobytes. -1 if unknown. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+
+        void charge();                      /**< Charges the time since the last change to mCurrent. */
+        void chargeCpu();                   /**< Shares the CPU time since the last reading between the stages. */
+        void reportCounters(ostream &out);  /**< Writes the hardware counts as a table. */
+};
+
+/** @brief Makes a stage current for the lifetime of this object.
+ *
+ * Does nothing at all if stats is NULL, which it is without --stats.
+ * Counts a call of the stage too. In an ALLOCSTATS build, it also
+ * charges heap allocations to the stage, whether stats is NULL or not.
+ */
+class tmStageTimer
+{
+    public:
+        tmStageTimer(tmStats *stats, tmStage stage) : mStats(stats), mPrevious(STAGE_OTHER) {
+#ifdef USE_ALLOC_STATS
+            mPreviousAlloc = allocStage;
+            allocStage = stage;
+            allocStageCalls[stage]++;
+#endif // USE_ALLOC_STATS
+            if (mStats) {
+                mPrevious = mStats->enter(stage);
+                mStats->record(stage);
+            }
+        }
+
+        ~tmStageTimer() {
+            if (mStats) {
+                mStats->enter(mPrevious);
+            }
+#ifdef USE_ALLOC_STATS
+            allocStage = mPreviousAlloc;
+#endif // USE_ALLOC_STATS
+        }
+
+    private:
+        tmStats *mStats;            /**< Where to charge the time. NULL means don't bother. */
+        tmStage mPrevious;          /**< The stage to return to. */
+#ifdef USE_ALLOC_STATS
+        tmStage mPreviousAlloc;     /**< The stage to charge allocations to afterwards. */
+#endif // USE_ALLOC_STATS
+};
+
+#endif // TMSTATS_H
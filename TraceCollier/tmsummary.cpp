@@ -0,0 +1,989 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "tmsummary.h"
+#include "utilities.h"
+
+using std::ofstream;
+using std::endl;
+using std::setw;
+using std::setfill;
+using std::left;
+using std::right;
+using std::sort;
+using std::min;
+using std::hex;
+using std::dec;
+using std::make_pair;
+
+/** @file tmsummary.cpp
+ * @brief Implementation file for the tmSummary object.
+ */
+
+// Width of the figures in the text summary.
+const int SUMMARY_WIDTH = 12;
+
+// Width of the wait event names in the text summary.
+const int WAIT_NAME_WIDTH = 40;
+
+// The latency percentiles, and their headings.
+const double PERCENTILES[] = {50, 90, 99, 99.9};
+const char *PERCENTILE_NAMES[] = {"p50", "p90", "p99", "p99.9"};
+const unsigned PERCENTILE_COUNT = 4;
+
+// Size of the inline SVG histograms, in pixels.
+const unsigned HISTOGRAM_BAR_WIDTH = 5;
+const unsigned HISTOGRAM_HEIGHT = 24;
+
+
+/** @brief Returns the PARSE, EXEC and FETCH totals, added together.
+ *
+ * @return tmCallTotals. The totals for every call of the statement.
+ */
+tmCallTotals tmSqlSummary::total() const
+{
+    tmCallTotals totals;
+    totals.add(parse);
+    totals.add(exec);
+    totals.add(fetch);
+    return totals;
+}
+
+
+/** @brief Adds a WAIT to the statement's totals for its wait event.
+ *
+ * @param event unsigned. The wait event's number.
+ * @param ela unsigned long long. The WAIT's ela=.
+ *
+ * A statement only waits on a few different events, so a short list,
+ * searched in order, is quicker than a map.
+ */
+void tmSqlSummary::addWait(unsigned event, unsigned long long ela)
+{
+    for (tmWaitList::iterator i = waits.begin(); i != waits.end(); ++i) {
+        if (i->first == event) {
+            i->second.add(ela);
+            return;
+        }
+    }
+
+    waits.push_back(make_pair(event, tmWaitTotals()));
+    waits.back().second.add(ela);
+}
+
+
+/** @brief Adds a STAT dump to the statement's plan with the same key.
+ *
+ * @param dump const tmPlan&. The dump, one plan's worth of STAT lines.
+ *
+ * A plan not seen before is added to the end, so they are listed in the
+ * order the statement used them.
+ */
+void tmSqlSummary::addPlan(const tmPlan &dump)
+{
+    for (vector<tmPlan>::iterator i = plans.begin(); i != plans.end(); ++i) {
+        if (i->key() == dump.key()) {
+            i->merge(dump);
+            return;
+        }
+    }
+
+    plans.push_back(dump);
+}
+
+
+/** @brief Constructor for a tmSummary object.
+ *
+ * @param depth unsigned. The maximum depth which we care about.
+ *
+ * The parser already ignores EXECs and FETCHes deeper than this, but
+ * not PARSEs, as it needs every cursor.
+ */
+tmSummary::tmSummary(unsigned depth)
+{
+    mDepth = depth;
+}
+
+
+/** @brief Finds, or adds, the statement for a cursor.
+ *
+ * @param cursor tmCursor*. The cursor being called.
+ * @param depth unsigned. The cursor's depth, for a new statement.
+ * @return tmSqlSummary*. The statement's totals.
+ *
+ * The SQL text is only fingerprinted when a cursor is parsed, or the
+ * first time it's called, after that the cursor's statement is
+ * remembered. Pointers into an unordered_map stay valid as it grows.
+ */
+tmSqlSummary *tmSummary::statement(tmCursor *cursor, unsigned depth)
+{
+    unordered_map<tmCursor *, tmSqlSummary *>::iterator c = mCursors.find(cursor);
+    if (c != mCursors.end()) {
+        return c->second;
+    }
+
+    const tmSqlFingerprint &fingerprint = cursor->fingerprint();
+    unordered_map<unsigned long long, tmSqlSummary>::iterator i = mStatements.find(fingerprint.fingerprint());
+    if (i == mStatements.end()) {
+        tmSqlSummary statement;
+        statement.sqlText = fingerprint.normalised();
+        statement.sqlId = cursor->oracleSqlId();
+        statement.fingerprint = fingerprint.fingerprint();
+        statement.sqlLine = cursor->sqlLineNumber();
+        statement.depth = depth;
+        i = mStatements.insert(make_pair(fingerprint.fingerprint(), statement)).first;
+    }
+
+    mCursors[cursor] = &i->second;
+    return &i->second;
+}
+
+
+void tmSummary::onCursorParsed(const tmCursorParsedEvent &event)
+{
+    // Cursor ids are reused for different SQL. The new statement is
+    // looked up now, as its first WAITs come before its first call.
+    // Any STATs still being collected were for the old statement.
+    finishDump(event.cursor);
+    mCursors.erase(event.cursor);
+
+    if (event.depth <= mDepth) {
+        statement(event.cursor, event.depth);
+    }
+}
+
+
+void tmSummary::onParse(const tmCallEvent &event)
+{
+    if (event.stats.depth() > mDepth) {
+        return;
+    }
+
+    tmSqlSummary *s = statement(event.cursor, event.stats.depth());
+    s->parse.add(event.stats);
+    s->recursive.add(event.recursive);
+}
+
+
+void tmSummary::onExec(const tmCallEvent &event)
+{
+    tmSqlSummary *s = statement(event.cursor, event.stats.depth());
+    s->exec.add(event.stats);
+    s->recursive.add(event.recursive);
+    s->execLatency.record(event.stats.elapsed());
+}
+
+
+void tmSummary::onFetch(const tmCallEvent &event)
+{
+    // A FETCH for a cursor parsed before the trace started has no SQL.
+    if (!event.cursor) {
+        return;
+    }
+
+    tmSqlSummary *s = statement(event.cursor, event.stats.depth());
+    s->fetch.add(event.stats);
+    s->recursive.add(event.recursive);
+    s->fetchLatency.record(event.stats.elapsed());
+}
+
+
+void tmSummary::onWait(const tmWaitEvent &event)
+{
+    unsigned id = mWaitNames.intern(event.name);
+    if (id >= mWaits.size()) {
+        mWaits.resize(id + 1);
+    }
+
+    mWaits[id].add(event.elapsed);
+    mWaitLatency.record(event.elapsed);
+
+    // Waits on cursor #0, or a cursor deeper than we care about,
+    // are only in the overall totals.
+    if (!event.cursor) {
+        return;
+    }
+
+    unordered_map<tmCursor *, tmSqlSummary *>::iterator c = mCursors.find(event.cursor);
+    if (c != mCursors.end()) {
+        c->second->addWait(id, event.elapsed);
+        c->second->waitLatency.record(event.elapsed);
+    }
+}
+
+
+void tmSummary::onStat(const tmStatEvent &event)
+{
+    // Only the plans of statements being summarised are kept.
+    if (mCursors.find(event.cursor) == mCursors.end()) {
+        return;
+    }
+
+    // A STAT which doesn't follow on from the last starts the next dump.
+    tmPlan &dump = mDumps[event.cursor];
+    if (!dump.add(event)) {
+        finishDump(event.cursor);
+        dump.add(event);
+    }
+}
+
+
+/** @brief Adds a cursor's STAT dump to its statement's plans.
+ *
+ * @param cursor tmCursor*. The cursor.
+ *
+ * The dump is emptied, but kept, for the cursor's next one.
+ */
+void tmSummary::finishDump(tmCursor *cursor)
+{
+    unordered_map<tmCursor *, tmPlan>::iterator d = mDumps.find(cursor);
+    if (d == mDumps.end() || d->second.empty()) {
+        return;
+    }
+
+    unordered_map<tmCursor *, tmSqlSummary *>::iterator c = mCursors.find(cursor);
+    if (c != mCursors.end()) {
+        c->second->addPlan(d->second);
+    }
+
+    d->second.clear();
+}
+
+
+/** @brief Returns a copy of some waits, sorted.
+ *
+ * @param waits const tmWaitList&. The waits.
+ * @return tmWaitList. The waits, most time waited first, then most
+ * waits, then by name.
+ */
+tmWaitList tmSummary::sortedWaits(const tmWaitList &waits)
+{
+    tmWaitList sorted(waits);
+    const tmWaitNames &names = mWaitNames;
+    sort(sorted.begin(), sorted.end(), [&names](const pair<unsigned, tmWaitTotals> &a, const pair<unsigned, tmWaitTotals> &b) {
+        if (a.second.elapsed != b.second.elapsed) return a.second.elapsed > b.second.elapsed;
+        if (a.second.count != b.second.count) return a.second.count > b.second.count;
+        return names.name(a.first) < names.name(b.first);
+    });
+
+    return sorted;
+}
+
+
+/** @brief Writes the summary file.
+ *
+ * @param fileName const string&. The summary file name.
+ * @param html bool. True for an HTML summary, false for text.
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param version float. TraceCollier version, for the HTML footer.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * One row per statement, most elapsed time first, with its plans and waits, and
+ * the overall totals and every wait event's totals at the end. Times are
+ * in microseconds.
+ */
+bool tmSummary::write(const string &fileName, bool html, const string &traceFile, float version, ostream &diagnostics)
+{
+    ofstream ofs(fileName);
+
+    if (!ofs.good()) {
+        diagnostics << "TraceCollier: Cannot open summary file " << fileName << endl;
+        return false;
+    }
+
+    // The last STAT dump of each cursor has nothing after it to end it.
+    for (unordered_map<tmCursor *, tmPlan>::iterator i = mDumps.begin(); i != mDumps.end(); ++i) {
+        finishDump(i->first);
+    }
+
+    vector<tmSqlSummary *> sorted;
+    sorted.reserve(mStatements.size());
+    tmSqlSummary overall;
+    for (unordered_map<unsigned long long, tmSqlSummary>::iterator i = mStatements.begin();
+         i != mStatements.end();
+         ++i) {
+        sorted.push_back(&i->second);
+        overall.parse.add(i->second.parse);
+        overall.exec.add(i->second.exec);
+        overall.fetch.add(i->second.fetch);
+        overall.recursive.add(i->second.recursive);
+        overall.execLatency.merge(i->second.execLatency);
+        overall.fetchLatency.merge(i->second.fetchLatency);
+    }
+
+    overall.waitLatency = mWaitLatency;
+
+    tmWaitList waits;
+    for (unsigned id = 0; id < mWaits.size(); id++) {
+        waits.push_back(make_pair(id, mWaits[id]));
+    }
+
+    waits = sortedWaits(waits);
+
+    // Most elapsed time first, then most EXECs, then first seen.
+    sort(sorted.begin(), sorted.end(), [](const tmSqlSummary *a, const tmSqlSummary *b) {
+        unsigned long long aElapsed = a->parse.elapsed + a->exec.elapsed + a->fetch.elapsed;
+        unsigned long long bElapsed = b->parse.elapsed + b->exec.elapsed + b->fetch.elapsed;
+        if (aElapsed != bElapsed) return aElapsed > bElapsed;
+        if (a->exec.count != b->exec.count) return a->exec.count > b->exec.count;
+        return a->sqlLine < b->sqlLine;
+    });
+
+    if (html) {
+        writeHtml(ofs, traceFile, sorted, overall, waits, version);
+    } else {
+        writeText(ofs, traceFile, sorted, overall, waits);
+    }
+
+    ofs.close();
+    return ofs.good();
+}
+
+
+/** @brief Writes the summary as text.
+ *
+ * @param ofs ostream&. Where to write it.
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param sorted vector<tmSqlSummary *>&. The statements, in order.
+ * @param overall const tmSqlSummary&. Every statement's totals added together.
+ * @param waits const tmWaitList&. Every wait event's totals, in order.
+ *
+ * Each row of figures is followed by the statement's SQL, as it's usually
+ * too long to fit in a column, then its plans and waits.
+ */
+void tmSummary::writeText(ostream &ofs, const string &traceFile, vector<tmSqlSummary *> &sorted, const tmSqlSummary &overall, const tmWaitList &waits)
+{
+    ofs << "TraceCollier Summary" << endl
+        << "--------------------" << endl << endl
+        << "Processing Trace file: " << traceFile << endl << endl
+        << sorted.size() << " distinct statements. Times are in microseconds." << endl << endl;
+
+    ofs << right
+        << setw(SUMMARY_WIDTH) << "SQL Line" << ' '
+        << setw(5) << "DEP" << ' '
+        << setw(SUMMARY_WIDTH) << "Parse" << ' '
+        << setw(SUMMARY_WIDTH) << "Exec" << ' '
+        << setw(SUMMARY_WIDTH) << "Fetch" << ' '
+        << setw(SUMMARY_WIDTH) << "CPU" << ' '
+        << setw(SUMMARY_WIDTH) << "Elapsed" << ' '
+        << setw(SUMMARY_WIDTH) << "Disk" << ' '
+        << setw(SUMMARY_WIDTH) << "Query" << ' '
+        << setw(SUMMARY_WIDTH) << "Current" << ' '
+        << setw(SUMMARY_WIDTH) << "Rows" << ' '
+        << setw(SUMMARY_WIDTH) << "Misses" << endl
+        << setw(5 + 11 * (SUMMARY_WIDTH + 1)) << setfill('-') << '-'
+        << setfill(' ') << endl;
+
+    for (vector<tmSqlSummary *>::iterator i = sorted.begin(); i != sorted.end(); ++i) {
+        tmSqlSummary *s = *i;
+        tmCallTotals totals = s->total();
+
+        ofs << setw(SUMMARY_WIDTH) << s->sqlLine << ' '
+            << setw(5) << s->depth << ' '
+            << setw(SUMMARY_WIDTH) << s->parse.count << ' '
+            << setw(SUMMARY_WIDTH) << s->exec.count << ' '
+            << setw(SUMMARY_WIDTH) << s->fetch.count << ' '
+            << setw(SUMMARY_WIDTH) << totals.cpu << ' '
+            << setw(SUMMARY_WIDTH) << totals.elapsed << ' '
+            << setw(SUMMARY_WIDTH) << totals.disk << ' '
+            << setw(SUMMARY_WIDTH) << totals.query << ' '
+            << setw(SUMMARY_WIDTH) << totals.current << ' '
+            << setw(SUMMARY_WIDTH) << totals.rows << ' '
+            << setw(SUMMARY_WIDTH) << totals.misses << endl;
+
+        ofs << "sqlid='" << s->sqlId << "' fingerprint=" << hex << setfill('0')
+            << setw(16) << s->fingerprint << dec << setfill(' ') << endl;
+
+        ofs << s->sqlText << endl << endl;
+
+        writeTextRecursive(ofs, *s);
+        writeTextLatency(ofs, *s);
+
+        if (!s->plans.empty()) {
+            writeTextPlans(ofs, s->plans);
+        }
+
+        if (!s->waits.empty()) {
+            writeTextWaits(ofs, sortedWaits(s->waits));
+        }
+    }
+
+    tmCallTotals totals = overall.total();
+    ofs << setw(SUMMARY_WIDTH + 6) << left << "OVERALL TOTALS" << right << ' '
+        << setw(SUMMARY_WIDTH) << overall.parse.count << ' '
+        << setw(SUMMARY_WIDTH) << overall.exec.count << ' '
+        << setw(SUMMARY_WIDTH) << overall.fetch.count << ' '
+        << setw(SUMMARY_WIDTH) << totals.cpu << ' '
+        << setw(SUMMARY_WIDTH) << totals.elapsed << ' '
+        << setw(SUMMARY_WIDTH) << totals.disk << ' '
+        << setw(SUMMARY_WIDTH) << totals.query << ' '
+        << setw(SUMMARY_WIDTH) << totals.current << ' '
+        << setw(SUMMARY_WIDTH) << totals.rows << ' '
+        << setw(SUMMARY_WIDTH) << totals.misses << endl;
+
+    ofs << endl << endl
+        << "OVERALL LATENCY" << endl << endl;
+    writeTextLatency(ofs, overall);
+
+    if (overall.recursive.count) {
+        ofs << endl
+            << "OVERALL RECURSIVE CALLS" << endl << endl;
+        writeTextRecursive(ofs, overall);
+    }
+
+    if (!waits.empty()) {
+        ofs << endl
+            << "OVERALL WAITS" << endl << endl;
+        writeTextWaits(ofs, waits);
+    }
+}
+
+
+/** @brief Writes a list of waits as text.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param waits const tmWaitList&. The waits, in order.
+ */
+void tmSummary::writeTextWaits(ostream &ofs, const tmWaitList &waits)
+{
+    ofs << setw(WAIT_NAME_WIDTH) << left << "Event waited on" << right << ' '
+        << setw(SUMMARY_WIDTH) << "Times" << ' '
+        << setw(SUMMARY_WIDTH) << "Max. Wait" << ' '
+        << setw(SUMMARY_WIDTH) << "Total Waited" << endl
+        << setw(WAIT_NAME_WIDTH + 3 * (SUMMARY_WIDTH + 1)) << setfill('-') << '-'
+        << setfill(' ') << endl;
+
+    for (tmWaitList::const_iterator i = waits.begin(); i != waits.end(); ++i) {
+        ofs << setw(WAIT_NAME_WIDTH) << left << mWaitNames.name(i->first) << right << ' '
+            << setw(SUMMARY_WIDTH) << i->second.count << ' '
+            << setw(SUMMARY_WIDTH) << i->second.max << ' '
+            << setw(SUMMARY_WIDTH) << i->second.elapsed << endl;
+    }
+
+    ofs << endl;
+}
+
+
+/** @brief Returns a statement's figures without its recursive calls'.
+ *
+ * @param inclusive const tmCallTotals&. The statement's own figures.
+ * @param recursive const tmCallTotals&. Its recursive calls' figures.
+ * @return tmCallTotals. The difference, for the statement's calls. Never
+ *         below zero, as the figures are rounded separately.
+ */
+static tmCallTotals exclusiveTotals(const tmCallTotals &inclusive, const tmCallTotals &recursive)
+{
+    tmCallTotals exclusive = inclusive;
+    exclusive.cpu -= min(exclusive.cpu, recursive.cpu);
+    exclusive.elapsed -= min(exclusive.elapsed, recursive.elapsed);
+    exclusive.disk -= min(exclusive.disk, recursive.disk);
+    exclusive.query -= min(exclusive.query, recursive.query);
+    exclusive.current -= min(exclusive.current, recursive.current);
+    return exclusive;
+}
+
+
+/** @brief Writes a statement's inclusive, recursive and exclusive figures as text.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param s const tmSqlSummary&. The statement.
+ *
+ * Only if it made any recursive calls. Its figures include theirs, and
+ * the exclusive figures are what's left, the time spent in the statement
+ * itself.
+ */
+void tmSummary::writeTextRecursive(ostream &ofs, const tmSqlSummary &s)
+{
+    if (!s.recursive.count) {
+        return;
+    }
+
+    const char *names[] = {"Inclusive", "Recursive", "Exclusive"};
+    tmCallTotals rows[3];
+    rows[0] = s.total();
+    rows[1] = s.recursive;
+    rows[2] = exclusiveTotals(rows[0], rows[1]);
+
+    ofs << setw(SUMMARY_WIDTH) << left << "Calls" << right << ' '
+        << setw(SUMMARY_WIDTH) << "Count" << ' '
+        << setw(SUMMARY_WIDTH) << "CPU" << ' '
+        << setw(SUMMARY_WIDTH) << "Elapsed" << ' '
+        << setw(SUMMARY_WIDTH) << "Disk" << ' '
+        << setw(SUMMARY_WIDTH) << "Query" << ' '
+        << setw(SUMMARY_WIDTH) << "Current" << endl
+        << setw(7 * (SUMMARY_WIDTH + 1) - 1) << setfill('-') << '-'
+        << setfill(' ') << endl;
+
+    for (unsigned x = 0; x < 3; x++) {
+        ofs << setw(SUMMARY_WIDTH) << left << names[x] << right << ' '
+            << setw(SUMMARY_WIDTH) << rows[x].count << ' '
+            << setw(SUMMARY_WIDTH) << rows[x].cpu << ' '
+            << setw(SUMMARY_WIDTH) << rows[x].elapsed << ' '
+            << setw(SUMMARY_WIDTH) << rows[x].disk << ' '
+            << setw(SUMMARY_WIDTH) << rows[x].query << ' '
+            << setw(SUMMARY_WIDTH) << rows[x].current << endl;
+    }
+
+    ofs << endl;
+}
+
+
+/** @brief Writes a statement's inclusive, recursive and exclusive figures as HTML.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param s const tmSqlSummary&. The statement.
+ */
+void tmSummary::writeHtmlRecursive(ostream &ofs, const tmSqlSummary &s)
+{
+    if (!s.recursive.count) {
+        return;
+    }
+
+    const char *names[] = {"Inclusive", "Recursive", "Exclusive"};
+    tmCallTotals rows[3];
+    rows[0] = s.total();
+    rows[1] = s.recursive;
+    rows[2] = exclusiveTotals(rows[0], rows[1]);
+
+    ofs << "<table class=\"tm2table\">" << endl
+        << "<tr><th>Calls</th>"
+        << "<th>Count</th>"
+        << "<th>CPU</th>"
+        << "<th>Elapsed</th>"
+        << "<th>Disk</th>"
+        << "<th>Query</th>"
+        << "<th>Current</th></tr>"
+        << endl;
+
+    for (unsigned x = 0; x < 3; x++) {
+        ofs << "<tr><td class=\"text\">" << names[x] << "</td>"
+            << "<td class=\"number\">" << rows[x].count << "</td>"
+            << "<td class=\"number\">" << rows[x].cpu << "</td>"
+            << "<td class=\"number\">" << rows[x].elapsed << "</td>"
+            << "<td class=\"number\">" << rows[x].disk << "</td>"
+            << "<td class=\"number\">" << rows[x].query << "</td>"
+            << "<td class=\"number\">" << rows[x].current << "</td></tr>"
+            << endl;
+    }
+
+    ofs << "</table>" << endl;
+}
+
+
+/** @brief Writes a statement's latency percentiles as text.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param s const tmSqlSummary&. The statement.
+ *
+ * One row each for its EXECs, FETCHes and WAITs, if it had any.
+ */
+void tmSummary::writeTextLatency(ostream &ofs, const tmSqlSummary &s)
+{
+    const char *names[] = {"EXEC", "FETCH", "WAIT"};
+    const tmHistogram *histograms[] = {&s.execLatency, &s.fetchLatency, &s.waitLatency};
+
+    bool headings = false;
+    for (unsigned x = 0; x < 3; x++) {
+        const tmHistogram &h = *histograms[x];
+        if (h.empty()) {
+            continue;
+        }
+
+        if (!headings) {
+            ofs << setw(SUMMARY_WIDTH) << left << "Latency" << right << ' '
+                << setw(SUMMARY_WIDTH) << "Count" << ' ';
+
+            for (unsigned p = 0; p < PERCENTILE_COUNT; p++) {
+                ofs << setw(SUMMARY_WIDTH) << PERCENTILE_NAMES[p] << ' ';
+            }
+
+            ofs << setw(SUMMARY_WIDTH) << "Max" << endl
+                << setw((PERCENTILE_COUNT + 3) * (SUMMARY_WIDTH + 1) - 1) << setfill('-') << '-'
+                << setfill(' ') << endl;
+            headings = true;
+        }
+
+        ofs << setw(SUMMARY_WIDTH) << left << names[x] << right << ' '
+            << setw(SUMMARY_WIDTH) << h.count() << ' ';
+
+        for (unsigned p = 0; p < PERCENTILE_COUNT; p++) {
+            ofs << setw(SUMMARY_WIDTH) << h.percentile(PERCENTILES[p]) << ' ';
+        }
+
+        ofs << setw(SUMMARY_WIDTH) << h.max() << endl;
+    }
+
+    if (headings) {
+        ofs << endl;
+    }
+}
+
+
+/** @brief Writes a statement's latency percentiles and histograms as HTML.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param s const tmSqlSummary&. The statement.
+ */
+void tmSummary::writeHtmlLatency(ostream &ofs, const tmSqlSummary &s)
+{
+    const char *names[] = {"EXEC", "FETCH", "WAIT"};
+    const tmHistogram *histograms[] = {&s.execLatency, &s.fetchLatency, &s.waitLatency};
+
+    bool headings = false;
+    for (unsigned x = 0; x < 3; x++) {
+        const tmHistogram &h = *histograms[x];
+        if (h.empty()) {
+            continue;
+        }
+
+        if (!headings) {
+            ofs << "<table class=\"tm2table\">" << endl
+                << "<tr><th>Latency &micro;s</th>"
+                << "<th>Count</th>";
+
+            for (unsigned p = 0; p < PERCENTILE_COUNT; p++) {
+                ofs << "<th>" << PERCENTILE_NAMES[p] << "</th>";
+            }
+
+            ofs << "<th>Max</th>"
+                << "<th>Histogram</th></tr>"
+                << endl;
+            headings = true;
+        }
+
+        ofs << "<tr><td class=\"text\">" << names[x] << "</td>"
+            << "<td class=\"number\">" << h.count() << "</td>";
+
+        for (unsigned p = 0; p < PERCENTILE_COUNT; p++) {
+            ofs << "<td class=\"number\">" << h.percentile(PERCENTILES[p]) << "</td>";
+        }
+
+        ofs << "<td class=\"number\">" << h.max() << "</td>"
+            << "<td class=\"text\">";
+        writeHtmlHistogram(ofs, h);
+        ofs << "</td></tr>" << endl;
+    }
+
+    if (headings) {
+        ofs << "</table>" << endl;
+    }
+}
+
+
+/** @brief Writes a small histogram as inline SVG.
+ *
+ * @param ofs ostream&. Where to write it.
+ * @param histogram const tmHistogram&. The histogram. Not empty.
+ *
+ * There's a bar for each power of two, from the smallest value's to the
+ * largest's, as a bar for every bucket would be too many to see. Each
+ * bar's height is its share of the tallest, and hovering over it shows
+ * its range and count.
+ */
+void tmSummary::writeHtmlHistogram(ostream &ofs, const tmHistogram &histogram)
+{
+    // Add up the buckets of each power of two.
+    unsigned perBar = tmHistogram::bucketOf(32) - tmHistogram::bucketOf(16);
+    vector<unsigned long long> bars((histogram.buckets() + perBar - 1) / perBar, 0);
+    for (unsigned x = 0; x < histogram.buckets(); x++) {
+        bars[x / perBar] += histogram.bucketCount(x);
+    }
+
+    unsigned first = tmHistogram::bucketOf(histogram.min()) / perBar;
+    unsigned last = tmHistogram::bucketOf(histogram.max()) / perBar;
+
+    unsigned long long tallest = 1;
+    for (unsigned x = first; x <= last; x++) {
+        if (bars[x] > tallest) {
+            tallest = bars[x];
+        }
+    }
+
+    ofs << "<svg width=\"" << (last - first + 1) * HISTOGRAM_BAR_WIDTH
+        << "\" height=\"" << HISTOGRAM_HEIGHT << "\">";
+
+    for (unsigned x = first; x <= last; x++) {
+        if (!bars[x]) {
+            continue;
+        }
+
+        unsigned height = (unsigned)((bars[x] * HISTOGRAM_HEIGHT + tallest - 1) / tallest);
+        unsigned long long high = tmHistogram::bucketHigh(x * perBar + perBar - 1);
+
+        ofs << "<rect x=\"" << (x - first) * HISTOGRAM_BAR_WIDTH
+            << "\" y=\"" << HISTOGRAM_HEIGHT - height
+            << "\" width=\"" << HISTOGRAM_BAR_WIDTH - 1
+            << "\" height=\"" << height
+            << "\" fill=\"steelblue\"><title>" << tmHistogram::bucketLow(x * perBar) << '-';
+
+        if (high < histogram.max()) {
+            ofs << high;
+        } else {
+            ofs << histogram.max();
+        }
+
+        ofs << " &micro;s: " << bars[x] << "</title></rect>";
+    }
+
+    ofs << "</svg>";
+}
+
+
+/** @brief Writes a statement's plans as text.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param plans const vector<tmPlan>&. The plans, in the order first seen.
+ *
+ * Each step's figures are totals for all the plan's STAT dumps. The
+ * operations are indented to show the shape of the tree, as tkprof does.
+ */
+void tmSummary::writeTextPlans(ostream &ofs, const vector<tmPlan> &plans)
+{
+    if (plans.size() > 1) {
+        ofs << plans.size() << " different plans. The plan changed during the trace." << endl << endl;
+    }
+
+    for (vector<tmPlan>::const_iterator p = plans.begin(); p != plans.end(); ++p) {
+        ofs << "Plan hash value: " << p->planHash() << ", "
+            << p->dumps() << (p->dumps() == 1 ? " STAT dump" : " STAT dumps")
+            << ", first at line " << p->firstLine() << '.' << endl << endl;
+
+        ofs << setw(SUMMARY_WIDTH) << "Rows" << ' '
+            << setw(SUMMARY_WIDTH) << "CR" << ' '
+            << setw(SUMMARY_WIDTH) << "PR" << ' '
+            << setw(SUMMARY_WIDTH) << "PW" << ' '
+            << setw(SUMMARY_WIDTH) << "Time" << "  "
+            << "Row Source Operation" << endl
+            << setw(5 * (SUMMARY_WIDTH + 1) + 21) << setfill('-') << '-'
+            << setfill(' ') << endl;
+
+        const vector<tmPlanStep> &steps = p->steps();
+        for (vector<tmPlanStep>::const_iterator i = steps.begin(); i != steps.end(); ++i) {
+            ofs << setw(SUMMARY_WIDTH) << i->rows << ' '
+                << setw(SUMMARY_WIDTH) << i->consistentReads << ' '
+                << setw(SUMMARY_WIDTH) << i->physicalReads << ' '
+                << setw(SUMMARY_WIDTH) << i->physicalWrites << ' '
+                << setw(SUMMARY_WIDTH) << i->time << "  "
+                << string(i->depth * 2, ' ') << i->operation;
+
+            if (i->cost || i->size || i->cardinality) {
+                ofs << " (cost=" << i->cost << " size=" << i->size << " card=" << i->cardinality << ')';
+            }
+
+            ofs << endl;
+        }
+
+        ofs << endl;
+    }
+}
+
+
+/** @brief Writes a statement's plans as HTML tables.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param plans const vector<tmPlan>&. The plans, in the order first seen.
+ */
+void tmSummary::writeHtmlPlans(ostream &ofs, const vector<tmPlan> &plans)
+{
+    if (plans.size() > 1) {
+        ofs << "<p><strong>" << plans.size() << " different plans.</strong> The plan changed during the trace.</p>" << endl;
+    }
+
+    for (vector<tmPlan>::const_iterator p = plans.begin(); p != plans.end(); ++p) {
+        ofs << "<table class=\"tm2table\">" << endl
+            << "<tr><th colspan=\"6\">Plan hash value: " << p->planHash() << ", "
+            << p->dumps() << (p->dumps() == 1 ? " STAT dump" : " STAT dumps")
+            << ", first at line " << p->firstLine() << "</th></tr>" << endl
+            << "<tr><th>Rows</th>"
+            << "<th>CR</th>"
+            << "<th>PR</th>"
+            << "<th>PW</th>"
+            << "<th>Time</th>"
+            << "<th>Row Source Operation</th></tr>"
+            << endl;
+
+        const vector<tmPlanStep> &steps = p->steps();
+        for (vector<tmPlanStep>::const_iterator i = steps.begin(); i != steps.end(); ++i) {
+            ofs << "<tr><td class=\"number\">" << i->rows << "</td>"
+                << "<td class=\"number\">" << i->consistentReads << "</td>"
+                << "<td class=\"number\">" << i->physicalReads << "</td>"
+                << "<td class=\"number\">" << i->physicalWrites << "</td>"
+                << "<td class=\"number\">" << i->time << "</td>"
+                << "<td class=\"text\">";
+
+            for (unsigned x = 0; x < i->depth; x++) {
+                ofs << "&nbsp;&nbsp;";
+            }
+
+            ofs << htmlEscaped(i->operation);
+
+            if (i->cost || i->size || i->cardinality) {
+                ofs << " (cost=" << i->cost << " size=" << i->size << " card=" << i->cardinality << ')';
+            }
+
+            ofs << "</td></tr>" << endl;
+        }
+
+        ofs << "</table>" << endl;
+    }
+}
+
+
+/** @brief Writes the summary as HTML.
+ *
+ * @param ofs ostream&. Where to write it.
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param sorted vector<tmSqlSummary *>&. The statements, in order.
+ * @param overall const tmSqlSummary&. Every statement's totals added together.
+ * @param waits const tmWaitList&. Every wait event's totals, in order.
+ * @param version float. TraceCollier version, for the footer.
+ */
+void tmSummary::writeHtml(ostream &ofs, const string &traceFile, vector<tmSqlSummary *> &sorted, const tmSqlSummary &overall, const tmWaitList &waits, float version)
+{
+    ofs << "<html lang=\"en\"><head>" << endl
+        << "<title>Trace Collier Summary</title>" << endl
+        << "<meta charset=\"UTF-8\" />" << endl
+        << "<meta name=\"generator\" content=\"TraceCollier\" />" << endl
+        << "<link rel=\"stylesheet\" href=\"TraceCollier.css\" />" << endl
+        << "<link rel=\"icon\" href=\"favicon.ico\" type=\"image/x-icon\" />"
+        << "</head>" << endl
+        << "<body>" << endl
+        << "<H1>Trace Collier Summary</H1>" << endl
+        << "<p><strong>Processing Trace File:</strong> " << htmlEscaped(traceFile) << "</p>" << endl
+        << "<p>" << sorted.size() << " distinct statements. Times are in &micro;s.</p>" << endl << endl;
+
+    ofs << "<table class=\"tm2table\">" << endl
+        << "<tr><th>SQL Line</th>"
+        << "<th>DEP</th>"
+        << "<th>Parse</th>"
+        << "<th>Exec</th>"
+        << "<th>Fetch</th>"
+        << "<th>CPU</th>"
+        << "<th>Elapsed</th>"
+        << "<th>Disk</th>"
+        << "<th>Query</th>"
+        << "<th>Current</th>"
+        << "<th>Rows</th>"
+        << "<th>Misses</th>"
+        << "<th>SQL Text</th></tr>"
+        << endl;
+
+    for (vector<tmSqlSummary *>::iterator i = sorted.begin(); i != sorted.end(); ++i) {
+        tmSqlSummary *s = *i;
+        tmCallTotals totals = s->total();
+
+        ofs << "<tr><td class=\"number\">" << s->sqlLine << "</td>"
+            << "<td class=\"number\">" << s->depth << "</td>"
+            << "<td class=\"number\">" << s->parse.count << "</td>"
+            << "<td class=\"number\">" << s->exec.count << "</td>"
+            << "<td class=\"number\">" << s->fetch.count << "</td>"
+            << "<td class=\"number\">" << totals.cpu << "</td>"
+            << "<td class=\"number\">" << totals.elapsed << "</td>"
+            << "<td class=\"number\">" << totals.disk << "</td>"
+            << "<td class=\"number\">" << totals.query << "</td>"
+            << "<td class=\"number\">" << totals.current << "</td>"
+            << "<td class=\"number\">" << totals.rows << "</td>"
+            << "<td class=\"number\">" << totals.misses << "</td>"
+            << "<td class=\"text\"><pre>";
+
+        ofs << "sqlid='" << s->sqlId << "' fingerprint=" << hex << setfill('0')
+            << setw(16) << s->fingerprint << dec << setfill(' ') << endl;
+
+        ofs << htmlEscaped(s->sqlText) << "</pre>";
+
+        writeHtmlRecursive(ofs, *s);
+        writeHtmlLatency(ofs, *s);
+
+        if (!s->plans.empty()) {
+            writeHtmlPlans(ofs, s->plans);
+        }
+
+        if (!s->waits.empty()) {
+            writeHtmlWaits(ofs, sortedWaits(s->waits));
+        }
+
+        ofs << "</td></tr>" << endl;
+    }
+
+    tmCallTotals totals = overall.total();
+    ofs << "<tr><th colspan=\"2\">Overall Totals</th>"
+        << "<th>" << overall.parse.count << "</th>"
+        << "<th>" << overall.exec.count << "</th>"
+        << "<th>" << overall.fetch.count << "</th>"
+        << "<th>" << totals.cpu << "</th>"
+        << "<th>" << totals.elapsed << "</th>"
+        << "<th>" << totals.disk << "</th>"
+        << "<th>" << totals.query << "</th>"
+        << "<th>" << totals.current << "</th>"
+        << "<th>" << totals.rows << "</th>"
+        << "<th>" << totals.misses << "</th>"
+        << "<th>&nbsp;</th></tr>" << endl
+        << "</table>" << endl;
+
+    ofs << "<H2>Overall Latency</H2>" << endl;
+    writeHtmlLatency(ofs, overall);
+
+    if (overall.recursive.count) {
+        ofs << "<H2>Overall Recursive Calls</H2>" << endl;
+        writeHtmlRecursive(ofs, overall);
+    }
+
+    if (!waits.empty()) {
+        ofs << "<H2>Overall Waits</H2>" << endl;
+        writeHtmlWaits(ofs, waits);
+    }
+
+    ofs << htmlFooter(version);
+}
+
+
+/** @brief Writes a list of waits as an HTML table.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param waits const tmWaitList&. The waits, in order.
+ */
+void tmSummary::writeHtmlWaits(ostream &ofs, const tmWaitList &waits)
+{
+    ofs << "<table class=\"tm2table\">" << endl
+        << "<tr><th>Event waited on</th>"
+        << "<th>Times</th>"
+        << "<th>Max. Wait</th>"
+        << "<th>Total Waited</th></tr>"
+        << endl;
+
+    for (tmWaitList::const_iterator i = waits.begin(); i != waits.end(); ++i) {
+        ofs << "<tr><td class=\"text\">" << htmlEscaped(mWaitNames.name(i->first)) << "</td>"
+            << "<td class=\"number\">" << i->second.count << "</td>"
+            << "<td class=\"number\">" << i->second.max << "</td>"
+            << "<td class=\"number\">" << i->second.elapsed << "</td></tr>" << endl;
+    }
+
+    ofs << "</table>" << endl;
+}
@@ -0,0 +1,151 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMSUMMARY_H
+#define TMSUMMARY_H
+
+/** @file tmsummary.h
+ * @brief Header file for the tmSummary object.
+ */
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::unordered_map;
+using std::pair;
+
+#include "tmcursor.h"
+#include "tmcallstats.h"
+#include "tmevents.h"
+#include "tmwaits.h"
+#include "tmplan.h"
+#include "tmhistogram.h"
+
+// A wait event's number, from tmWaitNames, and its totals.
+typedef vector<pair<unsigned, tmWaitTotals> > tmWaitList;
+
+/** @brief Totals for all the calls of one SQL statement.
+ */
+struct tmSqlSummary
+{
+    string sqlText;                     /**< The normalised SQL, literals replaced by '?'. */
+    string sqlId;                       /**< Oracle's sqlid of the first statement seen. */
+    unsigned long long fingerprint;     /**< The normalised SQL's fingerprint. */
+    unsigned sqlLine;                   /**< First line where this SQL was parsed. */
+    unsigned depth;                     /**< Depth of the first call. */
+    tmCallTotals parse;                 /**< PARSE totals. */
+    tmCallTotals exec;                  /**< EXEC totals. */
+    tmCallTotals fetch;                 /**< FETCH totals. */
+    tmCallTotals recursive;             /**< Totals of the recursive calls its PARSEs, EXECs and FETCHes made. */
+    tmWaitList waits;                   /**< WAIT totals, by wait event. Only a few each. */
+    vector<tmPlan> plans;               /**< Each distinct execution plan, in the order first seen. Usually one. */
+    tmHistogram execLatency;            /**< EXEC e= values. */
+    tmHistogram fetchLatency;           /**< FETCH e= values. */
+    tmHistogram waitLatency;            /**< WAIT ela= values. */
+
+    tmCallTotals total() const;         /**< Returns the PARSE, EXEC and FETCH totals together. */
+    void addWait(unsigned event, unsigned long long ela);   /**< Adds a WAIT. */
+    void addPlan(const tmPlan &dump);   /**< Adds a STAT dump to its plan. */
+};
+
+/** @brief A tkprof style summary of a trace, one row per SQL statement.
+ *
+ * The PARSE, EXEC and FETCH figures are totalled for each distinct SQL
+ * fingerprint as the trace is parsed, so statements which only differ in
+ * their literals are one row, and memory use grows with the number of
+ * fingerprints, not with the size of the trace, however many literals an
+ * application uses. The text is fingerprinted once per cursor, not once
+ * per call, as each cursor remembers its statement.
+ *
+ * The WAITs are totalled too, by statement and wait event, and by wait
+ * event overall. The event names are interned, so a WAIT costs a hash of
+ * its name, and nothing is allocated unless the name is new.
+ *
+ * Each cursor's STAT lines are collected into a plan, and when the dump
+ * is complete, it's added to its statement's plan with the same plh=,
+ * so a statement which changed plans during the trace shows them all.
+ *
+ * Each call's figures include those of the recursive calls it made, at
+ * any depth, even beyond --depth, so their totals are kept as well, to
+ * split the statement's time into its own and its recursive SQL's.
+ *
+ * The EXEC and FETCH elapsed times, and the WAIT times, are counted in
+ * histograms too, for the percentiles. They're a fixed size, so memory
+ * is still by statement, not by call.
+ *
+ * It's a tmEventHandler, so it can be given to a parser which writes no
+ * report, for --summary, or to one that does, for --summary=both.
+ */
+class tmSummary : public tmEventHandler
+{
+    public:
+        tmSummary(unsigned depth);
+
+        // Getters.
+        unsigned statements() { return mStatements.size(); }    /**< Returns how many distinct statements. */
+
+        // Events.
+        void onCursorParsed(const tmCursorParsedEvent &event);  /**< Finds the cursor's new statement. */
+        void onParse(const tmCallEvent &event);     /**< Adds a PARSE to its statement. */
+        void onExec(const tmCallEvent &event);      /**< Adds an EXEC to its statement. */
+        void onFetch(const tmCallEvent &event);     /**< Adds a FETCH to its statement. */
+        void onWait(const tmWaitEvent &event);      /**< Adds a WAIT to its statement, and its wait event. */
+        void onStat(const tmStatEvent &event);      /**< Adds a STAT to its cursor's plan. */
+
+        // Other useful stuff.
+        bool write(const string &fileName, bool html, const string &traceFile, float version, ostream &diagnostics);   /**< Writes the summary file. */
+
+    protected:
+
+    private:
+        tmSqlSummary *statement(tmCursor *cursor, unsigned depth);      /**< Finds, or adds, a cursor's statement. */
+        tmWaitList sortedWaits(const tmWaitList &waits);                /**< Returns the waits, most time first. */
+        void finishDump(tmCursor *cursor);                              /**< Adds a cursor's STAT dump to its statement. */
+        void writeTextPlans(ostream &ofs, const vector<tmPlan> &plans); /**< Writes a statement's plans as text. */
+        void writeHtmlPlans(ostream &ofs, const vector<tmPlan> &plans); /**< Writes a statement's plans as HTML. */
+        void writeTextRecursive(ostream &ofs, const tmSqlSummary &s);   /**< Writes a statement's inclusive and exclusive figures as text. */
+        void writeHtmlRecursive(ostream &ofs, const tmSqlSummary &s);   /**< Writes a statement's inclusive and exclusive figures as HTML. */
+        void writeTextLatency(ostream &ofs, const tmSqlSummary &s);     /**< Writes a statement's latency percentiles as text. */
+        void writeHtmlLatency(ostream &ofs, const tmSqlSummary &s);     /**< Writes a statement's latency percentiles and histograms as HTML. */
+        void writeHtmlHistogram(ostream &ofs, const tmHistogram &histogram);    /**< Writes a small histogram as inline SVG. */
+        void writeTextWaits(ostream &ofs, const tmWaitList &waits);     /**< Writes a list of waits as text. */
+        void writeHtmlWaits(ostream &ofs, const tmWaitList &waits);     /**< Writes a list of waits as HTML. */
+        void writeText(ostream &ofs, const string &traceFile, vector<tmSqlSummary *> &sorted, const tmSqlSummary &overall, const tmWaitList &waits);  /**< Writes a text summary. */
+        void writeHtml(ostream &ofs, const string &traceFile, vector<tmSqlSummary *> &sorted, const tmSqlSummary &overall, const tmWaitList &waits, float version);  /**< Writes an HTML summary. */
+
+        unsigned mDepth;                    /**< Maximum depth which we care about. */
+        unordered_map<unsigned long long, tmSqlSummary> mStatements;    /**< Statements, by fingerprint. */
+        unordered_map<tmCursor *, tmSqlSummary *> mCursors;     /**< Each cursor's statement, once it has been looked up. */
+        tmWaitNames mWaitNames;             /**< Wait event names, by number. */
+        vector<tmWaitTotals> mWaits;        /**< WAIT totals of every wait event, by number. */
+        tmHistogram mWaitLatency;           /**< Every WAIT's ela=, cursor #0 too. */
+        unordered_map<tmCursor *, tmPlan> mDumps;   /**< Each cursor's STAT dump, while it's being collected. */
+};
+
+#endif // TMSUMMARY_H
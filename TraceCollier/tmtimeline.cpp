@@ -0,0 +1,297 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+
+#include "tmtimeline.h"
+#include "utilities.h"
+
+using std::endl;
+using std::to_string;
+
+/** @file tmtimeline.cpp
+ * @brief Implementation file for the tmTimeline object.
+ */
+
+/** @brief Constructor for a tmTimeline object.
+ *
+ * @param fileName const string&. The timeline file to be written.
+ * @param minDuration unsigned long long. Events shorter than this, in microseconds, aren't written.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ */
+tmTimeline::tmTimeline(const string &fileName, unsigned long long minDuration, ostream &diagnostics)
+{
+    mFileName = fileName;
+    mDiagnostics = &diagnostics;
+    mOfs = NULL;
+    mMinDuration = minDuration;
+    mEvents = 0;
+    mSkipped = 0;
+    mTrack = 1;
+}
+
+
+/** @brief Destructor for a tmTimeline object.
+ *
+ * Closes the file, if it's still open, unfinished.
+ */
+tmTimeline::~tmTimeline()
+{
+    if (mOfs) {
+        delete mOfs;
+    }
+}
+
+
+/** @brief Creates the timeline file and writes its header.
+ *
+ * @param traceFile const string&. The trace file, to name the process track.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmTimeline::open(const string &traceFile)
+{
+    mOfs = new ofstream(mFileName, std::ofstream::out|std::ofstream::binary);
+    if (!mOfs->good()) {
+        *mDiagnostics << "TraceCollier: Cannot open timeline file " << mFileName << endl;
+        return false;
+    }
+
+    // The header, and the process, which the viewers name after the trace.
+    // Every event after it starts with a comma.
+    mRow.clear();
+    mRow += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    mRow += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":";
+    appendJsonString(mRow, traceFile);
+    mRow += "}}";
+    writeEvent();
+
+    return mOfs->good();
+}
+
+
+/** @brief Finishes and closes the timeline file.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmTimeline::close()
+{
+    if (!mOfs) {
+        return false;
+    }
+
+    *mOfs << "\n]}\n";
+    mOfs->close();
+
+    bool ok = mOfs->good();
+    delete mOfs;
+    mOfs = NULL;
+
+    if (!ok) {
+        *mDiagnostics << "TraceCollier: Cannot write timeline file " << mFileName << endl;
+    }
+
+    return ok;
+}
+
+
+/** @brief Is an event long enough to write, and does it have a tim= to place it?
+ *
+ * @param duration unsigned long long. Its e= or ela=, in microseconds.
+ * @param tim unsigned long long. Its tim=, when it ended.
+ * @return bool. True if it's to be written. If not, it's counted as skipped.
+ */
+bool tmTimeline::keep(unsigned long long duration, unsigned long long tim)
+{
+    if (!mOfs || duration < mMinDuration || tim < duration) {
+        mSkipped++;
+        return false;
+    }
+
+    return true;
+}
+
+
+/** @brief Starts an event in mRow, with the fields every event has.
+ *
+ * @param name const string&. What the viewers show on the event.
+ * @param category const char*. The record type, EXEC, WAIT etc.
+ * @param phase char. 'X' for a complete event, 'i' for an instant one.
+ * @param ts unsigned long long. When it started, in microseconds.
+ */
+void tmTimeline::startEvent(const string &name, const char *category, char phase, unsigned long long ts)
+{
+    mRow.clear();
+    mRow += ",\n{\"name\":";
+    appendJsonString(mRow, name);
+    mRow += ",\"cat\":\"";
+    mRow += category;
+    mRow += "\",\"ph\":\"";
+    mRow += phase;
+    mRow += "\",\"ts\":";
+    mRow += to_string(ts);
+    mRow += ",\"pid\":1,\"tid\":";
+    mRow += to_string(mTrack);
+}
+
+
+/** @brief Appends a tmView to mRow as a quoted JSON string.
+ *
+ * @param text const tmView&. The text. Copied to mText, which is reused, to be escaped.
+ */
+void tmTimeline::appendView(const tmView &text)
+{
+    mText.assign(text.data(), text.length());
+    appendJsonString(mRow, mText);
+}
+
+
+/** @brief Writes mRow, a whole event, to the file.
+ */
+void tmTimeline::writeEvent()
+{
+    mOfs->write(mRow.data(), mRow.length());
+}
+
+
+void tmTimeline::onSession(const tmSessionEvent &event)
+{
+    mText.assign(event.sessionId.data(), event.sessionId.length());
+
+    unordered_map<string, unsigned>::iterator i = mTracks.find(mText);
+    if (i != mTracks.end()) {
+        mTrack = i->second;
+        return;
+    }
+
+    // A new session, a new track. The first session has the first track,
+    // along with anything before it.
+    mTrack = mTracks.size() + 1;
+    mTracks[mText] = mTrack;
+
+    if (!mOfs) {
+        return;
+    }
+
+    mRow.clear();
+    mRow += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+    mRow += to_string(mTrack);
+    mRow += ",\"args\":{\"name\":";
+    appendJsonString(mRow, "session " + mText);
+    mRow += "}}";
+    writeEvent();
+}
+
+
+void tmTimeline::onCall(const tmCallEvent &event)
+{
+    static const string unknown = "unknown cursor";
+    static const char *categories[] = {"PARSE", "EXEC", "FETCH", "CLOSE"};
+
+    if (event.type == CALL_CLOSE) {
+        return;
+    }
+
+    const tmCallStats &stats = event.stats;
+    if (!keep(stats.elapsed(), stats.tim())) {
+        return;
+    }
+
+    const string &name = (event.cursor && !event.cursor->fingerprint().label().empty())
+                       ? event.cursor->fingerprint().label() : unknown;
+
+    startEvent(name, categories[event.type], 'X', stats.tim() - stats.elapsed());
+    mRow += ",\"dur\":";
+    mRow += to_string(stats.elapsed());
+    mRow += ",\"args\":{\"line\":";
+    mRow += to_string(event.line);
+    mRow += ",\"cursor\":";
+    appendView(event.cursorId);
+    mRow += ",\"dep\":";
+    mRow += to_string(stats.depth());
+    mRow += ",\"c\":";
+    mRow += to_string(stats.cpu());
+    mRow += ",\"p\":";
+    mRow += to_string(stats.physicalReads());
+    mRow += ",\"cr\":";
+    mRow += to_string(stats.consistentReads());
+    mRow += ",\"cu\":";
+    mRow += to_string(stats.currentReads());
+    mRow += ",\"r\":";
+    mRow += to_string(stats.rows());
+    mRow += "}}";
+
+    writeEvent();
+    mEvents++;
+}
+
+
+void tmTimeline::onWait(const tmWaitEvent &event)
+{
+    if (!keep(event.elapsed, event.tim)) {
+        return;
+    }
+
+    // The parameters have a trailing space, before tim=.
+    tmView parameters = event.parameters;
+    while (!parameters.empty() && parameters.data()[parameters.length() - 1] == ' ') {
+        parameters = tmView(parameters.data(), parameters.length() - 1);
+    }
+
+    startEvent(mWaitNames.name(mWaitNames.intern(event.name)), "WAIT", 'X', event.tim - event.elapsed);
+    mRow += ",\"dur\":";
+    mRow += to_string(event.elapsed);
+    mRow += ",\"args\":{\"line\":";
+    mRow += to_string(event.line);
+    mRow += ",\"cursor\":";
+    appendView(event.cursorId);
+    mRow += ",\"parameters\":";
+    appendView(parameters);
+    mRow += "}}";
+
+    writeEvent();
+    mEvents++;
+}
+
+
+void tmTimeline::onXctend(const tmXctendEvent &event)
+{
+    static const string commit = "COMMIT";
+    static const string rollback = "ROLLBACK";
+
+    // No e=, so it's an instant event, on the session's track, when it ended.
+    if (!mOfs || !event.tim) {
+        mSkipped++;
+        return;
+    }
+
+    startEvent(event.rollback ? rollback : commit, "XCTEND", 'i', event.tim);
+    mRow += ",\"s\":\"t\",\"args\":{\"line\":";
+    mRow += to_string(event.line);
+    mRow += ",\"read_only\":";
+    mRow += event.readOnly ? "true" : "false";
+    mRow += "}}";
+
+    writeEvent();
+    mEvents++;
+}
@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMTIMELINE_H
+#define TMTIMELINE_H
+
+/** @file tmtimeline.h
+ * @brief Header file for the tmTimeline object.
+ */
+
+#include <string>
+#include <fstream>
+#include <unordered_map>
+
+using std::string;
+using std::ofstream;
+using std::ostream;
+using std::unordered_map;
+
+#include "tmcursor.h"
+#include "tmevents.h"
+#include "tmwaits.h"
+
+/** @brief The trace as a timeline, in Chrome's trace event format.
+ *
+ * chrome://tracing, Perfetto's UI and speedscope all read it. Each PARSE,
+ * EXEC, FETCH and WAIT is a complete event, from its tim= less its e= or
+ * ela=, to its tim=. The viewers put an event under any other on the same
+ * track which it fits inside, so recursive calls show under the call which
+ * made them, and WAITs under their call, just as dep= has them:
+ *
+ * @code
+ * {"name":"begin pkg.proc","cat":"EXEC","ph":"X","ts":2000,"dur":1500,"pid":1,"tid":1,
+ *  "args":{"line":30,"cursor":"#1","dep":0,"c":1000,"p":0,"cr":0,"cu":0,"r":1}}
+ * @endcode
+ *
+ * An XCTEND has no e=, so a COMMIT or ROLLBACK is an instant event at its
+ * tim=. CLOSEs are left out, they are a few microseconds at most.
+ *
+ * Each session in the trace, from its *** SESSION ID line, is a track of
+ * its own, so a trace put together by trcsess shows them one above the
+ * other. Records before the first *** SESSION ID go on the first track.
+ *
+ * The events are written as they are parsed, not kept, so memory use
+ * doesn't depend on the size of the trace. Those shorter than the minimum
+ * duration are counted, but not written, to keep the file small.
+ */
+class tmTimeline : public tmEventHandler
+{
+    public:
+        tmTimeline(const string &fileName, unsigned long long minDuration, ostream &diagnostics);
+        ~tmTimeline();
+
+        // Getters.
+        string fileName() const { return mFileName; }               /**< Returns the timeline file name. */
+        unsigned long long events() const { return mEvents; }       /**< Returns how many events have been written. */
+        unsigned long long skipped() const { return mSkipped; }     /**< Returns how many were too short to write. */
+
+        // Events.
+        void onSession(const tmSessionEvent &event);    /**< Moves to the session's track. */
+        void onCall(const tmCallEvent &event);          /**< Writes a PARSE, EXEC or FETCH. */
+        void onWait(const tmWaitEvent &event);          /**< Writes a WAIT. */
+        void onXctend(const tmXctendEvent &event);      /**< Writes a COMMIT or ROLLBACK. */
+
+        // Other useful stuff.
+        bool open(const string &traceFile);             /**< Creates the file and writes its header. */
+        bool close();                                   /**< Finishes and closes the file. */
+
+    protected:
+
+    private:
+        void startEvent(const string &name, const char *category, char phase, unsigned long long ts);  /**< Starts an event in mRow. */
+        void appendView(const tmView &text);            /**< Appends a tmView to mRow as a JSON string. */
+        void writeEvent();                              /**< Writes mRow to the file. */
+        bool keep(unsigned long long duration, unsigned long long tim);  /**< Is an event long enough, and placed, to write? */
+
+        string mFileName;                   /**< The timeline file. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+        ofstream *mOfs;                     /**< The timeline file, while it's open. */
+        unsigned long long mMinDuration;    /**< Events shorter than this, in microseconds, aren't written. */
+        unsigned long long mEvents;         /**< How many events have been written. */
+        unsigned long long mSkipped;        /**< How many were too short. */
+        unsigned mTrack;                    /**< The current session's track, tid. */
+        unordered_map<string, unsigned> mTracks;  /**< Each session's track, by session id. */
+        tmWaitNames mWaitNames;             /**< Wait event names, so each isn't copied per WAIT. */
+        string mRow;                        /**< The event being written, reused for every event. */
+        string mText;                       /**< A tmView being escaped, reused for every event. */
+};
+
+#endif // TMTIMELINE_H
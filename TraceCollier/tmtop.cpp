@@ -0,0 +1,378 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "tmtop.h"
+#include "utilities.h"
+
+using std::ofstream;
+using std::endl;
+using std::setw;
+using std::setfill;
+using std::sort;
+using std::push_heap;
+using std::pop_heap;
+
+/** @file tmtop.cpp
+ * @brief Implementation file for the tmTopExecutions object.
+ */
+
+// Width of the figures in the text file.
+const int TOP_WIDTH = 12;
+
+
+/** @brief Decides which of two executions is slower.
+ *
+ * @param a const tmExecutionTimes&. One execution.
+ * @param b const tmExecutionTimes&. The other.
+ * @return bool. True if a is slower, or as slow and earlier in the trace.
+ *
+ * With this as the heap's comparison, the first in the heap is the one
+ * which every other is slower than, the next to go.
+ */
+static bool slower(const tmExecutionTimes &a, const tmExecutionTimes &b)
+{
+    if (a.elapsed != b.elapsed) {
+        return a.elapsed > b.elapsed;
+    }
+
+    return a.execLine < b.execLine;
+}
+
+
+/** @brief Constructor for a tmTopExecutions object.
+ *
+ * @param top unsigned. How many of the slowest executions to keep.
+ */
+tmTopExecutions::tmTopExecutions(unsigned top)
+{
+    mTop = top;
+    mExecutions = 0;
+}
+
+
+/** @brief Returns a cursor's execution, adding one if need be.
+ *
+ * @param cursor tmCursor*. The cursor.
+ * @return tmOpenExecution&. Its execution, which may not be open.
+ */
+tmTopExecutions::tmOpenExecution &tmTopExecutions::execution(tmCursor *cursor)
+{
+    unordered_map<tmCursor *, tmOpenExecution>::iterator i = mOpen.find(cursor);
+    if (i != mOpen.end()) {
+        return i->second;
+    }
+
+    tmOpenExecution &e = mOpen[cursor];
+    e.open = false;
+    e.pendingWait = 0;
+    e.sqlLine = 0;
+    return e;
+}
+
+
+/** @brief Ends an execution, keeping it if it's one of the slowest.
+ *
+ * @param e tmOpenExecution&. The execution. It's closed afterwards.
+ *
+ * Only an execution which is kept has its SQL and bind values put
+ * together, as Oracle would, the same way as tmCursor::replaceBinds().
+ */
+void tmTopExecutions::finish(tmOpenExecution &e)
+{
+    if (!e.open) {
+        return;
+    }
+
+    e.open = false;
+    mExecutions++;
+
+    if (mHeap.size() == mTop && !slower(e.times, mHeap.front())) {
+        return;
+    }
+
+    tmExecutionTimes times = e.times;
+    times.sqlText = e.sqlText;
+    for (size_t x = 0; x < e.bindNames.size() && x < e.bindValues.size(); x++) {
+        string::size_type bindPos = times.sqlText.find(e.bindNames[x]);
+        if (bindPos == string::npos) {
+            break;
+        }
+
+        times.sqlText.replace(bindPos, e.bindNames[x].length(), e.bindValues[x]);
+    }
+
+    if (mHeap.size() == mTop) {
+        pop_heap(mHeap.begin(), mHeap.end(), slower);
+        mHeap.pop_back();
+    }
+
+    mHeap.push_back(times);
+    push_heap(mHeap.begin(), mHeap.end(), slower);
+}
+
+
+void tmTopExecutions::onCursorParsed(const tmCursorParsedEvent &event)
+{
+    // The cursor has new SQL already, but the copy is of the old.
+    unordered_map<tmCursor *, tmOpenExecution>::iterator i = mOpen.find(event.cursor);
+    if (i != mOpen.end()) {
+        finish(i->second);
+        i->second.pendingWait = 0;
+    }
+}
+
+
+void tmTopExecutions::onParse(const tmCallEvent &event)
+{
+    // The WAITs so far were the PARSE's.
+    tmOpenExecution &e = execution(event.cursor);
+    finish(e);
+    e.pendingWait = 0;
+}
+
+
+void tmTopExecutions::onExec(const tmCallEvent &event)
+{
+    tmCursor *cursor = event.cursor;
+    tmOpenExecution &e = execution(cursor);
+    finish(e);
+
+    // Copy the SQL and bind names only when they change.
+    if (e.sqlLine != cursor->sqlLineNumber()) {
+        e.sqlLine = cursor->sqlLineNumber();
+        e.sqlText = cursor->sqlText();
+        e.bindNames.clear();
+
+        map<unsigned, tmBind *> *binds = cursor->binds();
+        for (map<unsigned, tmBind *>::iterator i = binds->begin(); i != binds->end(); ++i) {
+            e.bindNames.push_back(i->second->bindName());
+        }
+    }
+
+    // The bind values change at the next BINDS, before this ends.
+    map<unsigned, tmBind *> *binds = cursor->binds();
+    e.bindValues.resize(binds->size());
+    size_t x = 0;
+    for (map<unsigned, tmBind *>::iterator i = binds->begin(); i != binds->end(); ++i, ++x) {
+        e.bindValues[x] = i->second->bindValue();
+    }
+
+    e.open = true;
+    e.times.execLine = event.line;
+    e.times.sqlLine = cursor->sqlLineNumber();
+    e.times.depth = event.stats.depth();
+    e.times.elapsed = event.stats.elapsed();
+    e.times.cpu = event.stats.cpu();
+    e.times.waitTime = e.pendingWait;
+    e.times.fetches = 0;
+    e.times.rows = event.stats.rows();
+    e.pendingWait = 0;
+}
+
+
+void tmTopExecutions::onFetch(const tmCallEvent &event)
+{
+    // A FETCH for a cursor parsed before the trace started has no SQL.
+    if (!event.cursor) {
+        return;
+    }
+
+    tmOpenExecution &e = execution(event.cursor);
+    if (!e.open) {
+        e.pendingWait = 0;
+        return;
+    }
+
+    e.times.elapsed += event.stats.elapsed();
+    e.times.cpu += event.stats.cpu();
+    e.times.waitTime += e.pendingWait;
+    e.times.fetches++;
+    e.times.rows += event.stats.rows();
+    e.pendingWait = 0;
+}
+
+
+void tmTopExecutions::onWait(const tmWaitEvent &event)
+{
+    if (event.cursor) {
+        execution(event.cursor).pendingWait += event.elapsed;
+    }
+}
+
+
+void tmTopExecutions::onClose(const tmCloseEvent &event)
+{
+    if (!event.cursor) {
+        return;
+    }
+
+    // The WAITs since the last FETCH were the CLOSE's.
+    unordered_map<tmCursor *, tmOpenExecution>::iterator i = mOpen.find(event.cursor);
+    if (i != mOpen.end()) {
+        finish(i->second);
+        i->second.pendingWait = 0;
+    }
+}
+
+
+/** @brief Writes the slowest executions file.
+ *
+ * @param fileName const string&. The file name.
+ * @param html bool. True for HTML, false for text.
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param version float. TraceCollier version, for the HTML footer.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * Executions still open at the end of the trace are finished first.
+ * They are listed slowest first.
+ */
+bool tmTopExecutions::write(const string &fileName, bool html, const string &traceFile, float version, ostream &diagnostics)
+{
+    for (unordered_map<tmCursor *, tmOpenExecution>::iterator i = mOpen.begin(); i != mOpen.end(); ++i) {
+        finish(i->second);
+    }
+
+    ofstream ofs(fileName);
+
+    if (!ofs.good()) {
+        diagnostics << "TraceCollier: Cannot open slowest executions file " << fileName << endl;
+        return false;
+    }
+
+    vector<tmExecutionTimes> sorted(mHeap);
+    sort(sorted.begin(), sorted.end(), slower);
+
+    if (html) {
+        writeHtml(ofs, traceFile, sorted, version);
+    } else {
+        writeText(ofs, traceFile, sorted);
+    }
+
+    ofs.close();
+    return ofs.good();
+}
+
+
+/** @brief Writes the slowest executions as text.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param sorted const vector<tmExecutionTimes>&. The executions, slowest first.
+ *
+ * Each row of figures is followed by the SQL, with its binds.
+ */
+void tmTopExecutions::writeText(ostream &ofs, const string &traceFile, const vector<tmExecutionTimes> &sorted)
+{
+    ofs << "TraceCollier Slowest Executions" << endl
+        << "-------------------------------" << endl << endl
+        << "Processing Trace file: " << traceFile << endl << endl
+        << "The " << sorted.size() << " slowest of " << mExecutions
+        << " executions, by EXEC and FETCH elapsed time. Times are in microseconds." << endl << endl;
+
+    ofs << setw(5) << "Rank" << ' '
+        << setw(TOP_WIDTH) << "EXEC Line" << ' '
+        << setw(TOP_WIDTH) << "SQL Line" << ' '
+        << setw(5) << "DEP" << ' '
+        << setw(TOP_WIDTH) << "Elapsed" << ' '
+        << setw(TOP_WIDTH) << "CPU" << ' '
+        << setw(TOP_WIDTH) << "Waits" << ' '
+        << setw(TOP_WIDTH) << "Fetches" << ' '
+        << setw(TOP_WIDTH) << "Rows" << endl
+        << setw(5 + 1 + 5 + 7 * (TOP_WIDTH + 1)) << setfill('-') << '-'
+        << setfill(' ') << endl;
+
+    unsigned rank = 0;
+    for (vector<tmExecutionTimes>::const_iterator i = sorted.begin(); i != sorted.end(); ++i) {
+        ofs << setw(5) << ++rank << ' '
+            << setw(TOP_WIDTH) << i->execLine << ' '
+            << setw(TOP_WIDTH) << i->sqlLine << ' '
+            << setw(5) << i->depth << ' '
+            << setw(TOP_WIDTH) << i->elapsed << ' '
+            << setw(TOP_WIDTH) << i->cpu << ' '
+            << setw(TOP_WIDTH) << i->waitTime << ' '
+            << setw(TOP_WIDTH) << i->fetches << ' '
+            << setw(TOP_WIDTH) << i->rows << endl
+            << i->sqlText << endl << endl;
+    }
+}
+
+
+/** @brief Writes the slowest executions as HTML.
+ *
+ * @param ofs ostream&. Where to write them.
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param sorted const vector<tmExecutionTimes>&. The executions, slowest first.
+ * @param version float. TraceCollier version, for the footer.
+ */
+void tmTopExecutions::writeHtml(ostream &ofs, const string &traceFile, const vector<tmExecutionTimes> &sorted, float version)
+{
+    ofs << "<html lang=\"en\"><head>" << endl
+        << "<title>Trace Collier Slowest Executions</title>" << endl
+        << "<meta charset=\"UTF-8\" />" << endl
+        << "<meta name=\"generator\" content=\"TraceCollier\" />" << endl
+        << "<link rel=\"stylesheet\" href=\"TraceCollier.css\" />" << endl
+        << "<link rel=\"icon\" href=\"favicon.ico\" type=\"image/x-icon\" />"
+        << "</head>" << endl
+        << "<body>" << endl
+        << "<H1>Trace Collier Slowest Executions</H1>" << endl
+        << "<p><strong>Processing Trace File:</strong> " << htmlEscaped(traceFile) << "</p>" << endl
+        << "<p>The " << sorted.size() << " slowest of " << mExecutions
+        << " executions, by EXEC and FETCH elapsed time. Times are in &micro;s.</p>" << endl << endl;
+
+    ofs << "<table class=\"tm2table\">" << endl
+        << "<tr><th>Rank</th>"
+        << "<th>EXEC Line</th>"
+        << "<th>SQL Line</th>"
+        << "<th>DEP</th>"
+        << "<th>Elapsed</th>"
+        << "<th>CPU</th>"
+        << "<th>Waits</th>"
+        << "<th>Fetches</th>"
+        << "<th>Rows</th>"
+        << "<th>SQL Text</th></tr>"
+        << endl;
+
+    unsigned rank = 0;
+    for (vector<tmExecutionTimes>::const_iterator i = sorted.begin(); i != sorted.end(); ++i) {
+        ofs << "<tr><td class=\"number\">" << ++rank << "</td>"
+            << "<td class=\"number\">" << i->execLine << "</td>"
+            << "<td class=\"number\">" << i->sqlLine << "</td>"
+            << "<td class=\"number\">" << i->depth << "</td>"
+            << "<td class=\"number\">" << i->elapsed << "</td>"
+            << "<td class=\"number\">" << i->cpu << "</td>"
+            << "<td class=\"number\">" << i->waitTime << "</td>"
+            << "<td class=\"number\">" << i->fetches << "</td>"
+            << "<td class=\"number\">" << i->rows << "</td>"
+            << "<td class=\"text\"><pre>" << htmlEscaped(i->sqlText) << "</pre></td></tr>" << endl;
+    }
+
+    ofs << "</table>" << endl
+        << htmlFooter(version);
+}
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMTOP_H
+#define TMTOP_H
+
+/** @file tmtop.h
+ * @brief Header file for the tmTopExecutions object.
+ */
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::unordered_map;
+
+#include "tmcursor.h"
+#include "tmevents.h"
+
+/** @brief One execution, an EXEC and the FETCHes which followed it.
+ */
+struct tmExecutionTimes
+{
+    unsigned execLine;                  /**< EXEC line number. */
+    unsigned sqlLine;                   /**< Line number of the SQL. */
+    unsigned depth;                     /**< Recursive depth, dep=. */
+    unsigned long long elapsed;         /**< EXEC and FETCH e= together, in microseconds. */
+    unsigned long long cpu;             /**< EXEC and FETCH c= together, in microseconds. */
+    unsigned long long waitTime;        /**< WAIT ela= before the EXEC and its FETCHes. Already in elapsed. */
+    unsigned long long fetches;         /**< How many FETCHes. */
+    unsigned long long rows;            /**< EXEC and FETCH r= together. */
+    string sqlText;                     /**< The SQL with its bind values. Only for the slowest. */
+};
+
+/** @brief Lists the slowest executions in a trace, with their binds.
+ *
+ * Each cursor's execution is totalled, EXEC, FETCHes and WAITs, until
+ * the cursor's next EXEC, PARSE or CLOSE ends it. The slowest are
+ * kept in a min-heap, bounded to the number wanted, so a finished
+ * execution is either thrown away after one comparison with the fastest
+ * of the slowest, or replaces it. Only then is its SQL, with its bind
+ * values, written out. So the memory used depends on the number of
+ * executions wanted, and on the number of cursors, not on the size of
+ * the trace.
+ *
+ * A cursor's bind values change at its next BINDS, and its SQL may
+ * change when a new PARSING IN CURSOR reuses its id, before the execution
+ * is known to be over. So each cursor keeps a copy of its bind names and
+ * SQL text, taken when the SQL changes, and of its bind values, taken
+ * at each EXEC.
+ */
+class tmTopExecutions : public tmEventHandler
+{
+    public:
+        tmTopExecutions(unsigned top);
+
+        // Getters.
+        unsigned size() { return mHeap.size(); }    /**< Returns how many executions are listed, so far. */
+
+        // Events.
+        void onCursorParsed(const tmCursorParsedEvent &event);  /**< Ends the execution of the old SQL. */
+        void onParse(const tmCallEvent &event);     /**< Ends the cursor's execution. */
+        void onExec(const tmCallEvent &event);      /**< Ends the cursor's execution, and starts the next. */
+        void onFetch(const tmCallEvent &event);     /**< Adds a FETCH to the cursor's execution. */
+        void onWait(const tmWaitEvent &event);      /**< Adds a WAIT to the cursor's next call. */
+        void onClose(const tmCloseEvent &event);    /**< Ends the cursor's execution. */
+
+        // Other useful stuff.
+        bool write(const string &fileName, bool html, const string &traceFile, float version, ostream &diagnostics);   /**< Writes the slowest executions file. */
+
+    protected:
+
+    private:
+        /** @brief A cursor's execution so far, and what's needed to write its SQL later.
+         */
+        struct tmOpenExecution {
+            bool open;                      /**< Is there an execution? */
+            tmExecutionTimes times;         /**< Its figures so far. Not its SQL. */
+            unsigned long long pendingWait; /**< WAITs since the cursor's last call. */
+            unsigned sqlLine;               /**< SQL line of sqlText, to tell when it changes. */
+            string sqlText;                 /**< The cursor's SQL, without binds. */
+            vector<string> bindNames;       /**< The SQL's bind names, in the order they are replaced. */
+            vector<string> bindValues;      /**< The bind values, as at the EXEC. */
+        };
+
+        tmOpenExecution &execution(tmCursor *cursor);   /**< Returns a cursor's execution. */
+        void finish(tmOpenExecution &execution);        /**< Ends an execution, keeping it if it's one of the slowest. */
+        void writeText(ostream &ofs, const string &traceFile, const vector<tmExecutionTimes> &sorted); /**< Writes the list as text. */
+        void writeHtml(ostream &ofs, const string &traceFile, const vector<tmExecutionTimes> &sorted, float version);    /**< Writes the list as HTML. */
+
+        unsigned mTop;                      /**< How many executions to keep. */
+        unsigned long long mExecutions;     /**< How many executions were seen. */
+        vector<tmExecutionTimes> mHeap;     /**< The slowest so far. The fastest of them is first. */
+        unordered_map<tmCursor *, tmOpenExecution> mOpen;   /**< Each cursor's execution. */
+};
+
+#endif // TMTOP_H
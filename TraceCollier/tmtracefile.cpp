@@ -32,13 +32,76 @@
  * @brief Implementation file for the tmTraceFile object.
  */
 
+/** @brief Creates a trace file parser for a given output format.
+ *
+ * @param options tmOptions*. The parsed command line options.
+ * @param handler tmEventHandler*. The event handler for tmEventOutput, otherwise NULL.
+ * @return tmTraceFile*. The parser, compiled for --verbose or not.
+ */
+template <typename Output>
+static tmTraceFile *createFor(tmOptions *options, tmEventHandler *handler = NULL)
+{
+    if (options->verbose()) {
+        tmTraceFileT<Output, tmVerbose> *traceFile = new tmTraceFileT<Output, tmVerbose>(options);
+        traceFile->setEventHandler(handler);
+        return traceFile;
+    }
+
+    tmTraceFileT<Output, tmTerse> *traceFile = new tmTraceFileT<Output, tmTerse>(options);
+    traceFile->setEventHandler(handler);
+    return traceFile;
+}
+
+
+/** @brief Creates a trace file parser to suit the command line options.
+ *
+ * @param options tmOptions*. The parsed command line options.
+ * @return tmTraceFile*. The parser. The caller must delete it.
+ *
+ * This is the only place that the report format and verbose options are
+ * checked. Everything else is compiled for one format and verbosity.
+ */
+tmTraceFile *tmTraceFile::create(tmOptions *options)
+{
+    if (options->sqlite()) {
+        return createFor<tmSQLiteOutput>(options);
+    }
+
+    if (options->viewer()) {
+        return createFor<tmViewerOutput>(options);
+    }
+
+    if (options->html()) {
+        return createFor<tmHtmlOutput>(options);
+    }
+
+    return createFor<tmTextOutput>(options);
+}
+
+
+/** @brief Creates a trace file parser which passes each record to a handler.
+ *
+ * @param options tmOptions*. The trace file name, depth etc.
+ * @param handler tmEventHandler*. Receives the records. Must outlive the parser.
+ * @return tmTraceFile*. The parser. The caller must delete it.
+ *
+ * This is for libtracecollier. No report, database or viewer is written,
+ * whatever the options say.
+ */
+tmTraceFile *tmTraceFile::create(tmOptions *options, tmEventHandler *handler)
+{
+    return createFor<tmEventOutput>(options, handler);
+}
+
+
 /** @brief Constructor for a tmTraceFile object.
  *
  * @param options *tmOptions.
  *
  * Constructs a new tmTraceFile class, using the parsed command line options.
  */
-tmTraceFile::tmTraceFile(tmOptions *options)
+template <typename Output, typename Verbosity>
+tmTraceFileT<Output, Verbosity>::tmTraceFileT(tmOptions *options)
 {
     mOriginalTraceFileName = "";
     mDatabaseVersion = "";
@@ -54,6 +117,13 @@ tmTraceFile::tmTraceFile(tmOptions *options)
     mIfs = NULL;
     mOfs = NULL;
     mDbg = NULL;
+    mStats = NULL;
+    mColumnar = NULL;
+    mSQLite = NULL;
+    mReportIndex = NULL;
+    mViewer = NULL;
+    mEvents = NULL;
+    mVersion = 0;
 
     mOptions = options;
 }
@@ -62,11 +132,24 @@ tmTraceFile::tmTraceFile(tmOptions *options)
 /** @brief Destructor for a tmTraceFile object.
  *
  */
-tmTraceFile::~tmTraceFile()
+template <typename Output, typename Verbosity>
+tmTraceFileT<Output, Verbosity>::~tmTraceFileT()
 {
     // Destructor.
     // If still open, close the trace file.
     cleanUp();
+
+    if (mStats) {
+        delete mStats;
+        mStats = NULL;
+    }
+
+    // We must do this last of all, as cleanUp() and the error
+    // handling which follows it, might write to the debug file.
+    if (mDbg) {
+        delete mDbg;
+        mDbg = NULL;
+    }
 }
 
 
@@ -80,28 +163,42 @@ tmTraceFile::~tmTraceFile()
  * considered.
  *
  * If the report file fails to open, consider that fatal. However, if the
- * debug file fails to open, just turn off verbose mode and try to carry on.
+ * debug file fails to open, just try to carry on without it.
  *
  * Returns true to indicate success or false for a failure of some kind.
  */
-bool tmTraceFile::parse(const float version)
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parse(const float version)
 {
+    mVersion = version;
+
+    // The clocks start here, if we want them.
+    if (mOptions->stats()) {
+        mStats = new tmStats(mOptions->diagnostics());
+
+        if (mOptions->counters()) {
+            mStats->useCounters();
+        }
+    }
+
     // We might need the debug file, but if we fail to open it, just carry on.
-    if (mOptions->verbose()) {
+    // Verbosity is compiled in, so we can't turn it off now, but writes
+    // to a debug file which didn't open are simply ignored.
+    if (Verbosity::enabled) {
         if (!openDebugFile()) {
-            cerr << "TraceCollier: Attempting to continue." << endl;
-            mOptions->setVerbose(false);
+            mOptions->diagnostics() << "TraceCollier: Attempting to continue." << endl;
         }
     }
 
-    if (mOptions->verbose()) {
-        *mDbg << "parse(" << mLineNumber << "): Entry." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE, mLineNumber, DBG_ENTRY);
     }
 
     // Ready to go, lets parse a trace file.
     if (!openTraceFile()) {
-        if (mOptions->verbose()) {
-            *mDbg << "parse(" << mLineNumber << "): Cannot open trace file. Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE, mLineNumber, DBG_MESSAGE).span("Cannot open trace file.");
+            mDbg->log(DBG_PARSE, mLineNumber, DBG_EXIT);
         }
 
         return false;
@@ -112,8 +209,9 @@ bool tmTraceFile::parse(const float version)
     if (!parseHeader()) {
         cleanUp();
 
-        if (mOptions->verbose()) {
-            *mDbg << "parse(" << mLineNumber << "): parseHeader() failed. Error exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE, mLineNumber, DBG_MESSAGE).span("parseHeader() failed.");
+            mDbg->log(DBG_PARSE, mLineNumber, DBG_ERROR_EXIT);
         }
 
         return false;
@@ -125,45 +223,245 @@ bool tmTraceFile::parse(const float version)
         return false;
     }
 
+    // And the columnar file, if requested.
+    if (Output::format != OUTPUT_EVENTS && mOptions->columnar()) {
+        if (!openColumnarFile()) {
+            return false;
+        }
+    }
+
     // Report file is open.
     // Reset the EXEC counter.
     mExecCount = 0;
 
     // Parse the trace, finally!
     if (!parseTraceFile()) {
-        if (mOptions->verbose()) {
-            *mDbg << "parse(" << mLineNumber << "): Cannot parse trace file. Exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE, mLineNumber, DBG_MESSAGE).span("Cannot parse trace file.");
+            mDbg->log(DBG_PARSE, mLineNumber, DBG_EXIT);
         }
 
         return false;
     }
 
     // It was a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parse(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE, mLineNumber, DBG_EXIT);
+    }
+
+    // Finish off whatever we were writing.
+    if (!finishReport()) {
+        return false;
+    }
+
+    // Statistics, if requested. Cursors are still in the table.
+    if (mStats) {
+        mStats->cursors(mCursors.size());
+        mStats->finish();
+        mStats->report(mOptions->diagnostics());
+
+        if (!mStats->writeJson(mOptions->statsFile(), mOptions->traceFile())) {
+            return false;
+        }
+
+        mOptions->messages() << "TraceCollier: Statistics file [" << mOptions->statsFile() << "] written." << endl;
     }
 
-    // Close the table if HTML requested.
-    if (mOptions->html()) {
+    return true;
+}
 
+/** @brief Finishes off the report, database etc, once the trace has been parsed.
+ *
+ * @return bool.
+ *
+ * Closes the HTML table, or the last part and the index of a split report,
+ * and closes the viewer data, database and columnar files.
+ *
+ * Returns true to indicate success or false for a failure of some kind.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::finishReport()
+{
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_WRITE);
+
+    // With --fetches, the last EXEC of each cursor is still waiting.
+    if (!mExecutions.empty() && !finishExecutions()) {
+        return false;
+    }
+
+    // Close the table if HTML requested. A split report has
+    // its last part to finish, and the index to write.
+    if (mReportIndex) {
+        closeReportPart(true);
+
+        if (!mReportIndex->write(mOptions->traceFile(), mIsTraceAdjusted, mVersion)) {
+            return false;
+        }
+
+        mOptions->messages() << "TraceCollier: Report index [" << mReportIndex->fileName() << "] written for "
+                             << mReportIndex->parts() << " parts." << endl;
+    } else if (Output::format == OUTPUT_HTML) {
         *mOfs << "</table>"
-              << "<p></p>\n<hr>\n"
-              << "<p class=\"footer\">\n\t"
-              << "Created with <strong>Trace Collier</strong> version <strong>" << version
-              << "</strong><br>Copyright &copy; Norman Dunbar 2016-2019<br>\n\t"
-              << "Released under the <a href=\"https://opensource.org/licenses/MIT\"><span class=\"url\">MIT Licence</span></a><br><br>\n\t"
-              << "Binary releases available from: "
-              << "<a href=\"https://github.com/NormanDunbar/TraceCollier/releases\">"
-              << "<span class=\"url\">https://github.com/NormanDunbar/TraceCollier/releases</span></a><br>\n\t"
-              << "Source code available from: "
-              << "<a href=\"https://github.com/NormanDunbar/TraceCollier\">"
-              << "<span class=\"url\">https://github.com/NormanDunbar/TraceCollier</span></a>\n</p>\n\n"
-              << "\n</body></html>" << endl;
+              << htmlFooter(mVersion);
     }
 
+    // Finish off the viewer data.
+    if (Output::format == OUTPUT_VIEWER) {
+        if (!mViewer->close()) {
+            mOptions->diagnostics() << "TraceCollier: Cannot write viewer data file " << mViewer->dataFileName() << endl;
+            return false;
+        }
+
+        mOptions->messages() << "TraceCollier: Viewer [" << mViewer->fileName() << "] written with "
+                             << mViewer->rows() << " rows in [" << mViewer->dataFileName() << "]." << endl;
+    }
+
+    // Finish off the database. This builds the indexes too.
+    if (Output::format == OUTPUT_SQLITE) {
+        mOptions->messages() << "TraceCollier: Building indexes..." << endl;
+
+        if (!mSQLite->close()) {
+            return false;
+        }
+
+        mOptions->messages() << "TraceCollier: SQLite database [" << mSQLite->fileName() << "] written with "
+                             << mSQLite->execRows() << " EXECs." << endl;
+    }
+
+    // Finish off the columnar file.
+    if (mColumnar) {
+        if (!mColumnar->close()) {
+            return false;
+        }
+
+        mOptions->messages() << "TraceCollier: Columnar file [" << mColumnar->fileName() << "] written with "
+                             << mColumnar->execRows() << " EXECs and "
+                             << mColumnar->bindRows() << " bind values." << endl;
+    }
+
+    TCPROBE_REPORT_FLUSH(mLineNumber, 0);
     return true;
 }
 
+
+/** @brief Decides what kind of record a trace line starts.
+ *
+ * @param traceLine const string&. The line.
+ * @return tmStage. The record type, STAGE_PARSING to STAGE_WAIT,
+ * or STAGE_OTHER for lines nobody wants. Timestamps etc.
+ *
+ * The regex version takes the words before the cursor ID, so XCTEND,
+ * which has no cursor, is looked for separately. Without regex, the
+ * first seven characters are used instead.
+ */
+tmStage classifyLine(const string &traceLine)
+{
+    // Strip out those damned timestamp lines!
+    if (traceLine.substr(0, 4) == "*** ") {
+        return STAGE_OTHER;
+    }
+
+    // DEADLOCK DETECTED lines don't have a cursor.
+    if (traceLine == "DEADLOCK DETECTED ( ORA-00060 )") {
+        return STAGE_DEADLOCK;
+    }
+
+    // XCTEND (COMMIT/ROLLBACK).
+    // Beware, there is no cursorID here, so no #.
+    // So no regex_match(), and it must be checked before the
+    // non-regex chunk tests below, which would otherwise ignore it.
+    if (traceLine.substr(0, 6) == "XCTEND") {
+        return STAGE_XCTEND;
+    }
+
+    string chunk;
+    bool matchOk;
+
+#ifdef USE_REGEX
+    // Regex to extract the first command on the line. Built once only.
+    static const regex reg("(.*?)\\s#\\d+.*");
+    smatch match;
+
+    matchOk = regex_match(traceLine, match, reg);
+    if (matchOk) {
+        // Extract the command from the first grouping.
+        chunk = match[1];
+    }
+#else
+    // We can't use REGEX, so we have to do this the hard way!
+    // Which means it complicates the order below!
+    matchOk = true;
+    chunk = traceLine.substr(0, 7);
+#endif // USE_REGEX
+
+    if (matchOk) {
+
+        // PARSING IN CURSOR #cursorID
+        if (chunk == "PARSING IN CURSOR" ||
+            chunk == "PARSING") {
+            return STAGE_PARSING;
+        }
+
+        // PARSE ERROR
+        if (chunk == "PARSE ERROR" ||
+            chunk == "PARSE E") {
+            return STAGE_PARSE_ERROR;
+        }
+
+        // PARSE #cursorID
+        if (chunk == "PARSE" ||
+            chunk == "PARSE #") {
+            return STAGE_PARSE;
+        }
+
+        // BINDS #cursorID
+        if (chunk == "BINDS" ||
+            chunk == "BINDS #") {
+            return STAGE_BINDS;
+        }
+
+        // CLOSE #cursorID
+        if (chunk == "CLOSE" ||
+            chunk == "CLOSE #") {
+            return STAGE_CLOSE;
+        }
+
+        // STAT #cursorID
+        if (chunk == "STAT" ||
+            chunk.substr(0, 6) == "STAT #") {
+            return STAGE_STAT;
+        }
+
+        // ERROR #cursorID
+        if (chunk == "ERROR" ||
+            chunk == "ERROR #") {
+            return STAGE_ERROR;
+        }
+
+        if (chunk == "EXEC" ||
+            chunk.substr(0, 6) == "EXEC #") {
+            return STAGE_EXEC;
+        }
+
+        // FETCH #cursorID
+        if (chunk == "FETCH" ||
+            chunk == "FETCH #") {
+            return STAGE_FETCH;
+        }
+
+        // WAIT #cursorID
+        if (chunk == "WAIT" ||
+            chunk.substr(0, 6) == "WAIT #") {
+            return STAGE_WAIT;
+        }
+    }
+
+    // Nobody wants this line.
+    return STAGE_OTHER;
+}
+
+
 /** @brief Parses a trace file.
  *
  * @return bool.
@@ -174,22 +472,19 @@ bool tmTraceFile::parse(const float version)
  *
  * Returns true to indicate success or false for a failure.
  */
-bool tmTraceFile::parseTraceFile()
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseTraceFile()
 {
     // Process a trace file.
     string traceLine;
-    string chunk;
-    bool matchOk = true;
+    bool ok = true;
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseTraceFile(" << mLineNumber << "): Entry." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_TRACE_FILE, mLineNumber, DBG_ENTRY);
     }
 
-#ifdef USE_REGEX
-    // Regex to extract the first command on the line.
-    regex reg("(.*?)\\s#\\d+.*");
-    smatch match;
-#endif // USE_REGEX
+    // Time spent deciding what each line is, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_CLASSIFY);
 
     // The main parsing loop. What kind of line have we
     // read? Deal with it accordingly. If a parseBINDS() call
@@ -203,133 +498,84 @@ bool tmTraceFile::parseTraceFile()
             mUnprocessedLine.clear();
         }
 
-        // Strip out those damned timestamp lines!
-        if (traceLine.substr(0, 4) == "*** ")
-        {
-            if (mOptions->verbose()) {
-                *mDbg << "parseTraceFile(" << mLineNumber << "): Ignoring timestamp line ["
-                      << traceLine << ']' << endl;
-            }
-
-            continue;
-        }
-
-        // DEADLOCK DETECTED lines don't have a cursor. Need to
-        // process them here.
-        if (traceLine == "DEADLOCK DETECTED ( ORA-00060 )") {
-            // Dump the deadlock graph stuff
-            // Then keep reading.
-            parseDEADLOCK();
-            continue;
-        }
-
-#ifdef USE_REGEX
-        matchOk = regex_match(traceLine, match, reg);
-        if (matchOk) {
-            // Extract the command from the first grouping.
-            chunk = match[1];
-        }
-#else
-        // We can't use REGEX, so we have to do this the hard way!
-        // Which means it complicates the order below!
-        matchOk = true;
-        chunk = traceLine.substr(0, 7);
-#endif // USE_REGEX
-
-        if (matchOk) {
-
-            // PARSING IN CURSOR #cursorID
-            if (chunk == "PARSING IN CURSOR" ||
-                chunk == "PARSING") {
-                if (!parsePARSING(traceLine)) {
-                    goto errorExit;;
+        switch (classifyLine(traceLine)) {
+            case STAGE_PARSING:
+                ok = parsePARSING(traceLine);
+                break;
+
+            case STAGE_PARSE_ERROR:
+                ok = parsePARSEERROR(traceLine);
+                break;
+
+            case STAGE_PARSE:
+                ok = parsePARSE(traceLine);
+                break;
+
+            case STAGE_BINDS:
+                ok = parseBINDS(traceLine);
+                break;
+
+            case STAGE_CLOSE:
+                ok = parseCLOSE(traceLine);
+                break;
+
+            case STAGE_STAT:
+                ok = parseSTAT(traceLine);
+                break;
+
+            case STAGE_ERROR:
+                ok = parseERROR(traceLine);
+                break;
+
+            case STAGE_EXEC:
+                ok = parseEXEC(traceLine);
+                break;
+
+            case STAGE_XCTEND:
+                ok = parseXCTEND(traceLine);
+                break;
+
+            case STAGE_FETCH:
+                ok = parseFETCH(traceLine);
+                break;
+
+            case STAGE_WAIT:
+                ok = parseWAIT(traceLine);
+                break;
+
+            case STAGE_DEADLOCK:
+                // Dump the deadlock graph stuff
+                // Then keep reading.
+                parseDEADLOCK();
+                break;
+
+            default:
+                // A new session's records follow.
+                if (mEvents && traceLine.compare(0, 15, "*** SESSION ID:") == 0) {
+                    parseSESSION(traceLine);
                 }
-                continue;
-            }
 
-            // PARSE ERROR
-            if (chunk == "PARSE ERROR" ||
-                chunk == "PARSE E") {
-                if (!parsePARSEERROR(traceLine)) {
-                    goto errorExit;;
+                // Nobody wanted this line. Timestamps etc.
+                if (Verbosity::enabled && traceLine.substr(0, 4) == "*** ") {
+                    mDbg->log(DBG_PARSE_TRACE_FILE, mLineNumber, DBG_IGNORE_LINE).span(traceLine);
                 }
-                continue;
-            }
 
-            // PARSE #cursorID
-            if (chunk == "PARSE" ||
-                chunk == "PARSE #") {
-                if (!parsePARSE(traceLine)) {
-                    goto errorExit;
+                if (mStats) {
+                    mStats->record(STAGE_OTHER);
                 }
-                continue;
-            }
 
-            // BINDS #cursorID
-            if (chunk == "BINDS" ||
-                chunk == "BINDS #") {
-                if (!parseBINDS(traceLine)) {
-                    goto errorExit;
-                }
-                continue;
-            }
-
-            // CLOSE #cursorID
-            if (chunk == "CLOSE" ||
-                chunk == "CLOSE #") {
-                if (!parseCLOSE(traceLine)) {
-                    goto errorExit;
-                }
-                continue;
-            }
-
-            // STAT #cursorID
-            if (chunk == "STAT" ||
-                chunk.substr(0, 6) == "STAT #") {
-                if (!parseSTAT(traceLine)) {
-                    goto errorExit;
-                }
-                continue;
-            }
-
-            // ERROR #cursorID
-            if (chunk == "ERROR" ||
-                chunk == "ERROR #") {
-                if (!parseERROR(traceLine)) {
-                    goto errorExit;
-                }
-                continue;
-            }
-
-            if (chunk == "EXEC" ||
-                chunk.substr(0, 6) == "EXEC #") {
-                if (!parseEXEC(traceLine)) {
-                    goto errorExit;
-                }
-                continue;
-            }
-
-            // We don't need the continue above, to be honest.
-            // But if I ever add another check here, I'll probably
-            // forget to add one in the check above. It's what I do! :(
-
-        } else {
+                TCPROBE_RECORD(mLineNumber, STAGE_OTHER);
+                break;
+        }
 
-            // XCTEND (COMMIT/ROLLBACK).
-            // Beware, there is no cursorID here, so no #.
-            // So no regex_match()!
-            if (traceLine.substr(0, 6) == "XCTEND") {
-                if (!parseXCTEND(traceLine)) {
-                    goto errorExit;
-                }
-                continue;
-            }
+        if (!ok) {
+            goto errorExit;
         }
     }
 
     // We have a good parse.
-    if (mOptions->verbose()) {
-        *mDbg << "parseTraceFile(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_TRACE_FILE, mLineNumber, DBG_EXIT);
     }
 
     return true;
@@ -337,8 +583,8 @@ bool tmTraceFile::parseTraceFile()
 // Exit here on any errors.
 errorExit:
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseTraceFile(" << mLineNumber << "): Error exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_TRACE_FILE, mLineNumber, DBG_ERROR_EXIT);
     }
 
     return false;
@@ -353,10 +599,14 @@ errorExit:
  * Validates that this looks to be an Oracle trace file, then
  * reads in a few details from the header.
  */
-bool tmTraceFile::parseHeader() {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::parseHeader() {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_HEADER);
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseHeader(" << mLineNumber << "): Entry." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_ENTRY);
     }
 
     string traceLine;
@@ -366,11 +616,11 @@ bool tmTraceFile::parseHeader() {
         stringstream s;
         s << "parseHeader(" << mLineNumber << "): Cannot read first line from "
           << mOptions->traceFile() << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "parseHeader(" << mLineNumber << "): Error exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_ERROR_EXIT);
         }
 
         return false;
@@ -384,11 +634,11 @@ bool tmTraceFile::parseHeader() {
             stringstream s;
             s << mOptions->traceFile() << " is not an Oracle trace file." << endl
               << "Missing 'Trace file' in header." << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "parseHeader(" << mLineNumber << "): Error exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_ERROR_EXIT);
             }
 
             return false;
@@ -397,11 +647,11 @@ bool tmTraceFile::parseHeader() {
         stringstream s;
         s << mOptions->traceFile() << " is not an Oracle trace file." << endl
           << "Missing 'Trace file' in header." << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "parseHeader(" << mLineNumber << "): Error exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_ERROR_EXIT);
             }
 
         return false;
@@ -416,11 +666,11 @@ bool tmTraceFile::parseHeader() {
             stringstream s;
             s << "parseHeader(" << mLineNumber << "): Cannot read header line(s) from "
               << mOptions->traceFile() << endl;
-            cerr << s.str();
+            mOptions->diagnostics() << s.str();
 
-            if (mOptions->verbose()) {
-                *mDbg << s.str()
-                      << "parseHeader(" << mLineNumber << "): Error exit." << endl;
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_MESSAGE).span(s.str());
+                mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_ERROR_EXIT);
             }
 
             break;
@@ -453,6 +703,12 @@ bool tmTraceFile::parseHeader() {
             continue;
         }
 
+        // The first session.
+        if (mEvents && traceLine.compare(0, 15, "*** SESSION ID:") == 0) {
+            parseSESSION(traceLine);
+            continue;
+        }
+
         // Has file been trace adjusted?
         if (chunk == "*** TraceA") {
             mIsTraceAdjusted = true;
@@ -464,14 +720,43 @@ bool tmTraceFile::parseHeader() {
         }
     }
 
-    if (mOptions->verbose()) {
-        *mDbg << "parseHeader(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_PARSE_HEADER, mLineNumber, DBG_EXIT);
     }
 
     return ok;
 }
 
 
+/** @brief Parses a "*** SESSION ID" line.
+ *
+ * @param thisLine const string&. The line, "*** SESSION ID:(42.4242) 2017-01-09 10:00:00.000".
+ *
+ * Only the event handler wants these. The session id is the bit in brackets.
+ */
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::parseSESSION(const string &thisLine) {
+
+    tmSessionEvent event;
+    event.line = mLineNumber;
+
+    string::size_type openPos = thisLine.find('(');
+    string::size_type closePos = thisLine.find(')', openPos);
+    if (openPos == string::npos || closePos == string::npos) {
+        return;
+    }
+
+    event.sessionId = tmView(thisLine.data() + openPos + 1, closePos - openPos - 1);
+
+    string::size_type timePos = thisLine.find_first_not_of(' ', closePos + 1);
+    if (timePos != string::npos) {
+        event.timestamp = tmView(thisLine.data() + timePos, thisLine.length() - timePos);
+    }
+
+    mEvents->onSession(event);
+}
+
+
 /** @brief Opens a trace file.
  *
  * @return bool.
@@ -480,13 +765,18 @@ bool tmTraceFile::parseHeader() {
  *
  * A return of true indicates success, false indicates some failure occurred.
  */
-bool tmTraceFile::openTraceFile()
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::openTraceFile()
 {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_HEADER);
+
     string traceFileName = mOptions->traceFile();
 
-    if (mOptions->verbose()) {
-        *mDbg << "openTraceFile(" << mLineNumber << "): Entry." << endl
-              << "openTraceFile(" << mLineNumber << "): Trace File: [" << traceFileName << ']' << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_TRACE_FILE, mLineNumber, DBG_ENTRY);
+        mDbg->log(DBG_OPEN_TRACE_FILE, mLineNumber, DBG_FILE_NAME).span(traceFileName);
     }
 
     mIfs = new ifstream(traceFileName);
@@ -495,20 +785,20 @@ bool tmTraceFile::openTraceFile()
         stringstream s;
         s << "openTraceFile(" << mLineNumber << "): Cannot open trace file "
           << traceFileName << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
         cleanUp();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "openTraceFile(" << mLineNumber << "): Error exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_TRACE_FILE, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_OPEN_TRACE_FILE, mLineNumber, DBG_ERROR_EXIT);
         }
 
         return false;
     }
 
     // Looks like a valid trace file.
-    if (mOptions->verbose()) {
-        *mDbg << "openTraceFile(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_TRACE_FILE, mLineNumber, DBG_EXIT);
     }
 
     return true;
@@ -524,40 +814,18 @@ bool tmTraceFile::openTraceFile()
  *
  * A return of true indicates success, false indicates some failure occurred.
  */
-bool tmTraceFile::openDebugFile()
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::openDebugFile()
 {
-    string debugFileName = mOptions->debugFile();
-
-    if (debugFileName.empty()) {
-        // Very unlikely.
-        return false;
-    }
-
-    mDbg = new ofstream(debugFileName);
+    // Events are buffered, not formatted, and written out in big blocks.
+    // If the file doesn't open, they are simply thrown away.
+    mDbg = new tmDebugLog(mOptions->debugFile(), DEBUGLOG_BUFFER_SIZE, mOptions->diagnostics());
 
-    if (!mDbg->good()) {
-        // Don't clean up if this fails to open. We ignore it later.
-        cerr << "TraceCollier: Cannot open debug file "
-             << debugFileName << endl;
+    if (mOptions->debugFile().empty() ||
+        !mDbg->open()) {
         return false;
     }
 
-    // Allow thousands separator.
-    // Affects *every* number >= 1000 sent to *mDbg.
-    // Not sure I need the ',' (or whatever else I've put there!
-    // Yup, the comma is not required now. Should be locale dependent.
-    mDbg->imbue(locale(mDbg->getloc(), new ThousandsSeparator<char>(',')));
-
-    // For my own benefit, note whether or not we are using REGEXes
-    // It helps when testing, to know what's what.
-    *mDbg << "TraceCollier - ";
-    #ifdef USE_REGEX
-       *mDbg << " with REGEX support.";
-    #else
-       *mDbg << " with no REGEX support.";
-    #endif // USE_REGEX
-    *mDbg << endl << endl;
-
     // Looks like a valid debug file.
     return true;
 }
@@ -571,13 +839,90 @@ bool tmTraceFile::openDebugFile()
  *
  * A return of true indicates success, false indicates some failure occurred.
  */
-bool tmTraceFile::openReportFile()
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::openReportFile()
 {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_WRITE);
+
     string reportFileName = mOptions->reportFile();
 
-    if (mOptions->verbose()) {
-        *mDbg << "openReportFile(): Entry." << endl
-              << "Report File: [" << reportFileName << ']' << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_ENTRY);
+        mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_FILE_NAME).span(reportFileName);
+    }
+
+    // An event handler gets everything instead, there's nothing to open.
+    if (Output::format == OUTPUT_EVENTS) {
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_EXIT);
+        }
+
+        return true;
+    }
+
+    // The viewer page and its data replace the report file.
+    if (Output::format == OUTPUT_VIEWER) {
+        mViewer = new tmViewer(reportFileName, mOptions->viewerDataFile(), mOptions->diagnostics());
+
+        if (!mViewer->open(mOptions->traceFile(), mIsTraceAdjusted)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_ERROR_EXIT);
+            }
+
+            cleanUp();
+            return false;
+        }
+
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_EXIT);
+        }
+
+        return true;
+    }
+
+    // The database replaces the report file.
+    if (Output::format == OUTPUT_SQLITE) {
+        mSQLite = new tmSQLite(reportFileName, mOptions->diagnostics());
+
+        if (!mSQLite->open() ||
+            !mSQLite->addTraceFile(mOptions->traceFile(), mOriginalTraceFileName,
+                                   mDatabaseVersion, mInstanceName, mNodeName,
+                                   mIsTraceAdjusted)) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_ERROR_EXIT);
+            }
+
+            cleanUp();
+            return false;
+        }
+
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_EXIT);
+        }
+
+        return true;
+    }
+
+    // A split report writes parts, and the index at the end.
+    if (mOptions->splitExecs() || mOptions->splitBytes()) {
+        mReportIndex = new tmReportIndex(reportFileName, mOptions->splitExecs(), mOptions->splitBytes(), mOptions->diagnostics());
+
+        if (!openReportPart()) {
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_ERROR_EXIT);
+            }
+
+            cleanUp();
+            return false;
+        }
+
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_EXIT);
+        }
+
+        return true;
     }
 
     mOfs = new ofstream(reportFileName);
@@ -586,12 +931,12 @@ bool tmTraceFile::openReportFile()
         stringstream s;
         s << "TraceCollier: Cannot open report file "
           << reportFileName << endl;
-        cerr << s.str();
+        mOptions->diagnostics() << s.str();
         cleanUp();
 
-        if (mOptions->verbose()) {
-            *mDbg << s.str()
-                  << "openReportFile(): Error exit." << endl;
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_ERROR_EXIT);
         }
 
         return false;
@@ -606,8 +951,151 @@ bool tmTraceFile::openReportFile()
     reportHeadings();
 
     // Looks like a valid report file.
-    if (mOptions->verbose()) {
-        *mDbg << "openReportFile(): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_REPORT_FILE, mLineNumber, DBG_EXIT);
+    }
+
+    return true;
+}
+
+
+/** @brief Opens the next part of a split report.
+ *
+ * @return bool.
+ *
+ * Creates the next part file, named by the report index, and
+ * writes the page and table headings to it. mOfs is the new part.
+ *
+ * A return of true indicates success, false indicates some failure occurred.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::openReportPart()
+{
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_WRITE);
+
+    string partFileName = mReportIndex->startPart(mLineNumber);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_REPORT_PART, mLineNumber, DBG_ENTRY);
+        mDbg->log(DBG_OPEN_REPORT_PART, mLineNumber, DBG_FILE_NAME).span(partFileName);
+    }
+
+    mOfs = new ofstream(partFileName);
+
+    if (!mOfs->good()) {
+        stringstream s;
+        s << "TraceCollier: Cannot open report part file "
+          << partFileName << endl;
+        mOptions->diagnostics() << s.str();
+
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_REPORT_PART, mLineNumber, DBG_MESSAGE).span(s.str());
+            mDbg->log(DBG_OPEN_REPORT_PART, mLineNumber, DBG_ERROR_EXIT);
+        }
+
+        return false;
+    }
+
+    mOfs->imbue(locale(mOfs->getloc(), new ThousandsSeparator<char>(',')));
+
+    // Every part gets the full page headings.
+    mExecCount = -1;
+    reportHeadings();
+    mExecCount = 0;
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_REPORT_PART, mLineNumber, DBG_EXIT);
+    }
+
+    return true;
+}
+
+
+/** @brief Finishes off the current part of a split report.
+ *
+ * @param lastPart bool. True if there will be no more parts.
+ *
+ * Closes the table, writes the navigation links and the footer,
+ * then closes the part file and tells the index it is done.
+ */
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::closeReportPart(bool lastPart)
+{
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_WRITE);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_CLOSE_REPORT_PART, mLineNumber, DBG_ENTRY);
+    }
+
+    unsigned part = mReportIndex->parts();
+
+    *mOfs << "</table>" << endl
+          << "<p class=\"text\"><a href=\"" << fileName(mReportIndex->fileName()) << "\">Index</a>";
+
+    if (part > 1) {
+        *mOfs << " | <a href=\"" << mReportIndex->partFileName(part - 1) << "\">Previous</a>";
+    }
+
+    if (!lastPart) {
+        *mOfs << " | <a href=\"" << mReportIndex->partFileName(part + 1) << "\">Next</a>";
+    }
+
+    *mOfs << "</p>" << endl
+          << htmlFooter(mVersion);
+
+    mOfs->close();
+    delete mOfs;
+    mOfs = NULL;
+
+    // The EXEC that triggered a new part belongs to the new part.
+    mReportIndex->endPart(lastPart ? mLineNumber : mLineNumber - 1);
+    TCPROBE_REPORT_FLUSH(mLineNumber, part);
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_CLOSE_REPORT_PART, mLineNumber, DBG_EXIT);
+    }
+}
+
+
+/** @brief Opens the columnar export file.
+ *
+ * @return bool.
+ *
+ * Creates the columnar file and writes the schema to it.
+ *
+ * A return of true indicates success, false indicates some failure occurred.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::openColumnarFile()
+{
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_WRITE);
+
+    string columnarFileName = mOptions->columnarFile();
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_COLUMNAR_FILE, mLineNumber, DBG_ENTRY);
+        mDbg->log(DBG_OPEN_COLUMNAR_FILE, mLineNumber, DBG_FILE_NAME).span(columnarFileName);
+    }
+
+    mColumnar = new tmColumnar(columnarFileName, COLUMNAR_BATCH_SIZE, mOptions->diagnostics());
+
+    if (!mColumnar->open()) {
+        if (Verbosity::enabled) {
+            mDbg->log(DBG_OPEN_COLUMNAR_FILE, mLineNumber, DBG_ERROR_EXIT);
+        }
+
+        cleanUp();
+        return false;
+    }
+
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_OPEN_COLUMNAR_FILE, mLineNumber, DBG_EXIT);
     }
 
     return true;
@@ -622,13 +1110,14 @@ bool tmTraceFile::openReportFile()
  * determine what the numbers in the report lines actually  are!
  *
  */
-void tmTraceFile::reportHeadings() {
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::reportHeadings() {
 
-    if (mOptions->verbose()) {
-        *mDbg << "reportHeadings(" << mLineNumber << "): EXEC count: " << mExecCount << " Entry." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_REPORT_HEADINGS, mLineNumber, DBG_ENTRY);
     }
 
-    if (!mOptions->html()) {
+    if (Output::format == OUTPUT_TEXT) {
         // Headings. (TEXT)
 
         // Once per report file headings.
@@ -655,6 +1144,17 @@ void tmTraceFile::reportHeadings() {
               << setw(MAXLINENUMBER) << "SQL Line" << ' '
               << setw(MAXLINENUMBER) << "DEP" << ' ';
 
+        if (mOptions->waits()) {
+            *mOfs << setw(MAXLINENUMBER) << "WAIT (us)" << ' ';
+        }
+
+        if (mOptions->fetches()) {
+            *mOfs << setw(MAXLINENUMBER) << "FETCHES" << ' '
+                  << setw(MAXLINENUMBER) << "FETCH ROWS" << ' '
+                  << setw(MAXLINENUMBER) << "FETCH ELA" << ' '
+                  << setw(MAXLINENUMBER) << "FETCH CPU" << ' ';
+        }
+
         if (mIsTraceAdjusted) {
             *mOfs << setw(28) << left << "EXEC Date/Time";
         }
@@ -679,13 +1179,27 @@ void tmTraceFile::reportHeadings() {
                   << "<body>" << endl
                   << "<H1>Trace Collier</H1>" << endl
                   << "<p><strong>Processing Trace File:</strong> "
-                  << mOptions->traceFile();
+                  << htmlEscaped(mOptions->traceFile());
 
                   if (mIsTraceAdjusted) {
                       *mOfs << " (Preprocessed by '<strong>TraceAdjust</strong>') ";
                   }
 
                   *mOfs << "</p>" << endl;
+
+            // Split reports link back to the index, and the previous part.
+            if (mReportIndex) {
+                unsigned part = mReportIndex->parts();
+
+                *mOfs << "<p><strong>Part " << part << "</strong> | "
+                      << "<a href=\"" << fileName(mReportIndex->fileName()) << "\">Index</a>";
+
+                if (part > 1) {
+                    *mOfs << " | <a href=\"" << mReportIndex->partFileName(part - 1) << "\">Previous</a>";
+                }
+
+                *mOfs << "</p>" << endl;
+            }
         }
 
         // Are we in the middle of a trace? Start a new table if necessary.
@@ -702,6 +1216,17 @@ void tmTraceFile::reportHeadings() {
               << "<th class=\"sqlline\";>SQL Line</th>"
               << "<th class=\"depline\";>DEP</th>";
 
+        if (mOptions->waits()) {
+            *mOfs << "<th class=\"waittime\";>WAIT &micro;s</th>";
+        }
+
+        if (mOptions->fetches()) {
+            *mOfs << "<th class=\"fetches\";>FETCHES</th>"
+                  << "<th class=\"fetches\";>FETCH Rows</th>"
+                  << "<th class=\"fetches\";>FETCH ELA &micro;s</th>"
+                  << "<th class=\"fetches\";>FETCH CPU &micro;s</th>";
+        }
+
         if (mIsTraceAdjusted) {
             *mOfs << "<th class=\"exectime\";>EXEC Date/Time</th>";
         }
@@ -710,10 +1235,110 @@ void tmTraceFile::reportHeadings() {
               << endl;
     }
 
-    if (mOptions->verbose()) {
-        *mDbg << "reportHeadings(" << mLineNumber << "): EXEC count: " << mExecCount << " Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_REPORT_HEADINGS, mLineNumber, DBG_EXIT);
+    }
+
+}
+
+
+/** @brief Writes empty --waits and --fetches columns.
+ *
+ * @param out ostream&. Where the row is being written, from reportRowStream().
+ *
+ * ERROR, XCTEND and the like have no wait time or FETCHes of their
+ * own, but their rows still need the columns to line up with the
+ * EXEC rows.
+ */
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::reportBlankColumns(ostream &out) {
+
+    unsigned columns = (mOptions->waits() ? 1 : 0) + (mOptions->fetches() ? 4 : 0);
+
+    for (unsigned i = 0; i < columns; i++) {
+        if (Output::format == OUTPUT_TEXT) {
+            out << setw(MAXLINENUMBER) << ' ' << ' ';
+        } else {
+            out << "<td>&nbsp;</td>";
+        }
+    }
+}
+
+
+/** @brief Returns where an ERROR, COMMIT etc row is to be written.
+ *
+ * @return ostream&. The report, or if rows are waiting for their
+ * FETCHes, mRowText, so that the row can wait behind them.
+ *
+ * Call reportRowDone() once the row is written.
+ */
+template <typename Output, typename Verbosity>
+ostream &tmTraceFileT<Output, Verbosity>::reportRowStream() {
+
+    if (mReportRows.empty()) {
+        return *mOfs;
     }
 
+    // Numbers have the report's thousands separators.
+    mRowText.str("");
+    mRowText.imbue(mOfs->getloc());
+    return mRowText;
+}
+
+
+/** @brief Finishes an ERROR, COMMIT etc row, from reportRowStream().
+ *
+ * @param counted bool. True if the row counts towards the next set of
+ * headings, as a COMMIT or ROLLBACK does.
+ * @return bool. Returns true if all ok. False otherwise.
+ *
+ * If rows are waiting, this one joins the end of the queue, which might
+ * mean the row at the front has waited long enough.
+ */
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::reportRowDone(bool counted) {
+
+    if (mReportRows.empty()) {
+        if (counted) {
+            mExecCount++;
+        }
+
+        return true;
+    }
+
+    mReportRows.push_back(tmReportRow());
+    tmReportRow &row = mReportRows.back();
+    row.isExecution = false;
+    row.waiting = false;
+    row.counted = counted;
+    row.text = mRowText.str();
+
+    return writeOverdueRows();
+}
+
+
+/** @brief Adds a PARSE, EXEC, FETCH or CLOSE, of any depth, to the call tree.
+ *
+ * @param event tmCallEvent&. The call, with its type, line, cursor id and
+ *        figures. Its recursive calls' totals, and its cursor, if it has
+ *        one, are filled in.
+ *
+ * The event is then passed to the handler's onCall(). Only called if
+ * there's a handler, as nothing else wants it.
+ */
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::addCall(tmCallEvent &event) {
+
+    mCallTree.call(event.stats, event.recursive);
+
+    event.cursor = NULL;
+    mLookupCursorId.assign(event.cursorId.data(), event.cursorId.length());
+    map<string, tmCursor *>::iterator i = findCursor(mLookupCursorId);
+    if (i != mCursors.end()) {
+        event.cursor = i->second;
+    }
+
+    mEvents->onCall(event);
 }
 
 
@@ -726,24 +1351,34 @@ void tmTraceFile::reportHeadings() {
  * line number within the trace file.
  * Returns true if we are still good for more reading, false otherwise.
  */
-bool tmTraceFile::readTraceLine(string *aLine) {
+template <typename Output, typename Verbosity>
+bool tmTraceFileT<Output, Verbosity>::readTraceLine(string *aLine) {
+
+    // Time spent here, for --stats.
+    tmStageTimer stageTimer(mStats, STAGE_READ);
 
     while (true && mIfs->good()) {
         getline(*mIfs, *aLine);
         mLineNumber++;
         mBatchCount++;
 
+        if (mStats) {
+            mStats->readLine(aLine->length() + 1);
+        }
+
+        TCPROBE_LINE_READ(mLineNumber, aLine->length() + 1);
+
         // Give some feedback on big trace files.
         if (mBatchCount == mOptions->feedBack()) {
-            cerr << "readTraceLine(): " << mLineNumber << " lines read so far..."
-                 << endl;
+            mOptions->diagnostics() << "readTraceLine(): " << mLineNumber << " lines read so far..."
+                                    << endl;
             mBatchCount = 0;
         }
 
         // Update for DEADLOCK handling.
         if (*aLine == " ") {
             if (!mOptions->quiet()) {
-                cerr << "readTraceLine(): ONE SPACE at line: " << mLineNumber << endl;
+                mOptions->diagnostics() << "readTraceLine(): ONE SPACE at line: " << mLineNumber << endl;
             }
             continue;
         }
@@ -762,8 +1397,8 @@ bool tmTraceFile::readTraceLine(string *aLine) {
     }
 
     // Verbose?
-    if (mOptions->verbose()) {
-        *mDbg << "readTraceLine(" << mLineNumber << "): [" << *aLine << "]" << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_READ_TRACE_LINE, mLineNumber, DBG_LINE).span(*aLine);
     }
 
     return mIfs->good();
@@ -778,32 +1413,29 @@ bool tmTraceFile::readTraceLine(string *aLine) {
  * Searches the mCursors map for a given key.
  * Returns a valid iterator if all ok, otherwise returns mCursors.end().
  */
-map<string, tmCursor *>::iterator tmTraceFile::findCursor(const string &cursorID) {
+template <typename Output, typename Verbosity>
+map<string, tmCursor *>::iterator tmTraceFileT<Output, Verbosity>::findCursor(const string &cursorID) {
 
     // Find an existing cursor in the map.
 
-    if (mOptions->verbose()) {
-        *mDbg << "findCursor(" << mLineNumber << "): Entry." << endl
-              << "findCursor(" << mLineNumber << "): Looking for cursor: " << cursorID << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_FIND_CURSOR, mLineNumber, DBG_ENTRY);
     }
 
     map<string, tmCursor *>::iterator i = mCursors.find(cursorID);
 
-    if (mOptions->verbose()) {
+    if (Verbosity::enabled) {
         if (i != mCursors.end()) {
             // Not found.
-            *mDbg << "findCursor(" << mLineNumber << "): Cursor: " << cursorID
-                  << " found. (SQL on line: " << i->second->sqlLineNumber()
-                  << ')' << endl;
+            mDbg->log(DBG_FIND_CURSOR, mLineNumber, DBG_CURSOR_FOUND, i->second->sqlLineNumber()).span(cursorID);
         } else {
             // Not found.
-            *mDbg << "findCursor(" << mLineNumber << "): Cursor: " << cursorID
-                  << " not found." << endl;
+            mDbg->log(DBG_FIND_CURSOR, mLineNumber, DBG_CURSOR_NOT_FOUND).span(cursorID);
         }
     }
 
-    if (mOptions->verbose()) {
-        *mDbg << "findCursor(" << mLineNumber << "): Exit." << endl;
+    if (Verbosity::enabled) {
+        mDbg->log(DBG_FIND_CURSOR, mLineNumber, DBG_EXIT);
     }
 
     return i;
@@ -816,7 +1448,8 @@ map<string, tmCursor *>::iterator tmTraceFile::findCursor(const string &cursorID
  * to clean up whatever mess there is, lying around in the tmTraceFile
  * object.
  */
-void tmTraceFile::cleanUp() {
+template <typename Output, typename Verbosity>
+void tmTraceFileT<Output, Verbosity>::cleanUp() {
     // If still open, close the trace/output/debug files.
     if (mIfs) {
         if (mIfs->is_open()) {
@@ -836,13 +1469,32 @@ void tmTraceFile::cleanUp() {
         mOfs = NULL;
     }
 
+    if (mColumnar) {
+        delete mColumnar;
+        mColumnar = NULL;
+    }
+
+    if (mSQLite) {
+        delete mSQLite;
+        mSQLite = NULL;
+    }
+
+    if (mViewer) {
+        delete mViewer;
+        mViewer = NULL;
+    }
+
+    if (mReportIndex) {
+        delete mReportIndex;
+        mReportIndex = NULL;
+    }
+
     // If we have any cursors, clean them out.
     //Beware, clear() doesn't destruct classes!
     if (mCursors.size()) {
         for (map<string, tmCursor *>::iterator i = mCursors.begin(); i != mCursors.end(); ++i) {
-            if (mOptions->verbose()) {
-                *mDbg << endl << "cleanUP(): Freeing cursor: " << i->second->cursorId() << endl;
-                *mDbg << *(i->second);
+            if (Verbosity::enabled) {
+                mDbg->log(DBG_CLEANUP, mLineNumber, DBG_CURSOR_FREED, i->second->bindCount()).span(i->second->cursorId());
             }
 
             // Destruct the tmCursor.
@@ -852,17 +1504,28 @@ void tmTraceFile::cleanUp() {
         // Finally, clear the map.
         mCursors.clear();
     }
-
-    // we must do this last of all, or the above might blow up!
-    if (mDbg) {
-        if (mDbg->is_open()) {
-            mDbg->close();
-        }
-
-        delete mDbg;
-        mDbg = NULL;
-    }
-
 }
 
 
+// Instantiate for every output format and verbosity.
+TMTRACEFILE_INSTANTIATE(, tmTraceFileT(tmOptions *));
+TMTRACEFILE_INSTANTIATE(, ~tmTraceFileT());
+TMTRACEFILE_INSTANTIATE(bool, parse(const float));
+TMTRACEFILE_INSTANTIATE(bool, finishReport());
+TMTRACEFILE_INSTANTIATE(bool, parseTraceFile());
+TMTRACEFILE_INSTANTIATE(bool, parseHeader());
+TMTRACEFILE_INSTANTIATE(bool, openTraceFile());
+TMTRACEFILE_INSTANTIATE(bool, openDebugFile());
+TMTRACEFILE_INSTANTIATE(bool, openReportFile());
+TMTRACEFILE_INSTANTIATE(bool, openReportPart());
+TMTRACEFILE_INSTANTIATE(void, closeReportPart(bool));
+TMTRACEFILE_INSTANTIATE(bool, openColumnarFile());
+TMTRACEFILE_INSTANTIATE(void, reportHeadings());
+TMTRACEFILE_INSTANTIATE(void, reportBlankColumns(ostream &));
+TMTRACEFILE_INSTANTIATE(ostream &, reportRowStream());
+TMTRACEFILE_INSTANTIATE(bool, reportRowDone(bool));
+TMTRACEFILE_INSTANTIATE(void, addCall(tmCallEvent &));
+TMTRACEFILE_INSTANTIATE(void, parseSESSION(const string &));
+TMTRACEFILE_INSTANTIATE(bool, readTraceLine(string *));
+TMTRACEFILE_INSTANTIATE(tmCursorMap::iterator, findCursor(const string &));
+TMTRACEFILE_INSTANTIATE(void, cleanUp());
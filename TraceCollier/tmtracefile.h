@@ -42,6 +42,7 @@
 
 #include <sstream>
 #include <vector>
+#include <deque>
 
 using std::string;
 using std::map;
@@ -54,6 +55,9 @@ using std::endl;
 using std::getline;
 using std::exception;
 using std::vector;
+using std::deque;
+using std::ostream;
+using std::ostringstream;
 
 #if defined (USE_REGEX)
     using std::regex;
@@ -69,6 +73,16 @@ using std::setfill;
 
 #include "tmcursor.h"
 #include "tmoptions.h"
+#include "tmcallstats.h"
+#include "tmcolumnar.h"
+#include "tmsqlite.h"
+#include "tmreportindex.h"
+#include "tmviewer.h"
+#include "tmdebuglog.h"
+#include "tmstats.h"
+#include "tmprobes.h"
+#include "tmevents.h"
+#include "tmcalltree.h"
 
 // Some constants used to format the (text) report.
 // Maximum of 9,999,999 for a line number.
@@ -78,13 +92,116 @@ const int MAXCURSORWIDTH=11+1;
 // Oracle Command codes. We only use COMMAND_PLSQL at the moment.
 const int COMMAND_PLSQL = 47;
 
+// Report formats. See the output policies below.
+enum tmOutputFormat {
+    OUTPUT_HTML,
+    OUTPUT_TEXT,
+    OUTPUT_VIEWER,
+    OUTPUT_SQLITE,
+    OUTPUT_EVENTS
+};
+
+/** @brief Output policy for an HTML report. */
+struct tmHtmlOutput { static const tmOutputFormat format = OUTPUT_HTML; };
+
+/** @brief Output policy for a text report. */
+struct tmTextOutput { static const tmOutputFormat format = OUTPUT_TEXT; };
+
+/** @brief Output policy for the viewer page and its data file. */
+struct tmViewerOutput { static const tmOutputFormat format = OUTPUT_VIEWER; };
+
+/** @brief Output policy for an SQLite database. */
+struct tmSQLiteOutput { static const tmOutputFormat format = OUTPUT_SQLITE; };
+
+/** @brief Output policy for libtracecollier. No report, a tmEventHandler gets the records. */
+struct tmEventOutput { static const tmOutputFormat format = OUTPUT_EVENTS; };
+
+/** @brief Verbosity policy for --verbose. Everything goes to the debug file. */
+struct tmVerbose { static const bool enabled = true; };
+
+/** @brief Verbosity policy without --verbose. Debug statements compile away. */
+struct tmTerse { static const bool enabled = false; };
+
+// Cursors, by cursor id.
+typedef map<string, tmCursor *> tmCursorMap;
+
+/** @brief An EXEC's row in the HTML or TEXT report.
+ *
+ * With --fetches, the row isn't written until the FETCHes which follow
+ * the EXEC are in, when the cursor's next PARSE, EXEC, ERROR or CLOSE,
+ * or the end of the trace, finishes the execution. If that takes too
+ * long, the row is written with the FETCHes so far.
+ */
+struct tmExecution {
+    unsigned line;                  /**< EXEC line number. */
+    unsigned parseLine;             /**< The cursor's PARSE line, or 0 if it came from the cache. */
+    unsigned bindsLine;             /**< The cursor's BINDS line, or 0 if there were no binds. */
+    unsigned sqlLine;               /**< The cursor's SQL line. */
+    unsigned depth;                 /**< Recursive depth, dep=. */
+    string local;                   /**< Local date/time if the trace was TraceAdjusted. */
+    string sqlText;                 /**< The SQL, with the bind values in it. */
+    unsigned long long waitTime;    /**< WAIT time before the EXEC, and with --fetches, its FETCHes too, for --waits. */
+    tmCallStats stats;              /**< The EXEC's figures, for a split report's index. */
+    tmCursor *cursor;               /**< The cursor. */
+    tmCallTotals fetches;           /**< The FETCHes which followed, for --fetches. */
+};
+
+// With --fetches, a cursor which is never closed would hold up the rest
+// of the report, in memory. Once this many rows are waiting, or the EXEC
+// at the front is this many lines back, it's written with the FETCHes
+// so far. A waiting row is a few hundred bytes, plus its SQL text.
+const unsigned FETCHES_MAX_WAITING_ROWS = 1000;
+const unsigned FETCHES_MAX_WAITING_LINES = 100000;
+
+/** @brief A row of the HTML or TEXT report, waiting to be written.
+ *
+ * With --fetches, an EXEC's row waits for its FETCHes. The rows after it,
+ * EXECs on other cursors, ERRORs, COMMITs and the like, wait behind it,
+ * so that the report stays in trace line order. They're written from the
+ * front of the queue, as soon as the row at the front is complete, or
+ * has waited too long. See FETCHES_MAX_WAITING_ROWS.
+ */
+struct tmReportRow {
+    bool isExecution;               /**< An EXEC's row, or some other row, already formatted? */
+    bool waiting;                   /**< An EXEC still waiting for its FETCHes? */
+    bool counted;                   /**< Does it count towards the next set of headings, as EXECs and COMMITs do? */
+    tmExecution execution;          /**< The EXEC, if it is one. */
+    string text;                    /**< The formatted row, if it isn't. */
+};
+
+tmStage classifyLine(const string &traceLine);     /**< Decides which record type a trace line starts. */
+
 /** @brief A class representing an Oracle trace file.
+ *
+ * This is what the rest of TraceCollier sees. create() picks the parser
+ * compiled for the requested report format and verbosity, once, at startup.
  */
 class tmTraceFile
 {
     public:
-        tmTraceFile(tmOptions *options);
-        ~tmTraceFile();
+        virtual ~tmTraceFile() {}
+
+        static tmTraceFile *create(tmOptions *options);     /**< Creates the right tmTraceFileT for the options. */
+        static tmTraceFile *create(tmOptions *options, tmEventHandler *handler);  /**< Creates a tmTraceFileT which only calls the handler. */
+        virtual bool parse(const float version) = 0;        /**< Parses the trace file. */
+        virtual void setEventHandler(tmEventHandler *handler) = 0;  /**< Sets a handler to be called alongside the report. */
+};
+
+/** @brief The trace file parser, compiled for one output format and verbosity.
+ *
+ * Output is one of the tmXxxOutput policies, and decides what is written for
+ * each EXEC, ERROR etc. Verbosity is tmVerbose or tmTerse. With tmTerse, every
+ * "if (Verbosity::enabled)" debug statement is compiled away.
+ *
+ * The members are defined in tmtracefile.cpp and the various parseXxxx.cpp
+ * files, each of which instantiates its own with TMTRACEFILE_INSTANTIATE.
+ */
+template <typename Output, typename Verbosity>
+class tmTraceFileT : public tmTraceFile
+{
+    public:
+        tmTraceFileT(tmOptions *options);
+        ~tmTraceFileT();
 
         // Getters.
         unsigned lineNumber() { return mLineNumber; }               /**< Returns the current line number being parsed. */
@@ -97,9 +214,13 @@ class tmTraceFile
 
         // Setters.
         void setOptions(tmOptions *opt) { mOptions = opt; }   /**< Sets the options pointer. */
+        void setEventHandler(tmEventHandler *handler) { mEvents = handler; }  /**< Sets the handler, if any. Required for tmEventOutput. */
 
         // Other useful stuff.
-        bool parse(const float varsion);               /**< Parses the trace file. */
+        bool parse(const float version);               /**< Parses the trace file. */
+
+        // The microbenchmarks in TraceBench time extractHex() etc directly.
+        friend class tmMicroBench;
 
     protected:
 
@@ -119,7 +240,14 @@ class tmTraceFile
         string mNodeName;                   /**< File header information - Database server name. */
         ifstream *mIfs;                     /**< Std::ifstream used to read the trace file. */
         ofstream *mOfs;                     /**< Std::ofstream used to write the report file. */
-        ofstream *mDbg;                     /**< Std::ofstream used to write the debug file. */
+        tmDebugLog *mDbg;                   /**< Binary event log used for the debug file. */
+        tmStats *mStats;                    /**< Stage timings etc, if --stats requested. Otherwise NULL. */
+        tmColumnar *mColumnar;              /**< Columnar export file, if --columnar requested. */
+        tmSQLite *mSQLite;                  /**< SQLite database, used instead of mOfs for --format=sqlite. */
+        tmViewer *mViewer;                  /**< Viewer page and data file, used instead of mOfs for --format=viewer. */
+        tmReportIndex *mReportIndex;        /**< Split report index, if --split requested. mOfs is the current part. */
+        tmEventHandler *mEvents;            /**< Receives the records. Instead of mOfs for tmEventOutput, else as well as it. NULL if none. */
+        float mVersion;                     /**< TraceCollier version, for report footers. */
         bool mIsTraceAdjusted;              /**< True if the trace file has been TraceAdjusted. */
 
         // Internal stuff.
@@ -129,11 +257,31 @@ class tmTraceFile
         bool openTraceFile();               /**< Opens the trace file and parses the headings. */
         bool openDebugFile();               /**< Opens the debug file. */
         bool openReportFile();              /**< Opens the debug file. */
+        bool openColumnarFile();            /**< Opens the columnar export file. */
+        bool openReportPart();              /**< Opens the next part of a split report. */
+        void closeReportPart(bool lastPart);    /**< Finishes off the current part of a split report. */
+        bool finishReport();                /**< Finishes off the report etc after parsing. */
         void reportHeadings();              /**< Prints HTML headings. */
         bool parseTraceFile();              /**< Parses the trace file body. */
         bool readTraceLine(string *aLine);  /**< Read one line from the trace, update the current line number. */
-        map<string, tmCursor *>::iterator findCursor(const string &cursorID);   /**< Finds a cursor id in the cursor list. */
+        tmCursorMap::iterator findCursor(const string &cursorID);   /**< Finds a cursor id in the cursor list. */
         string mUnprocessedLine;            /**< ParseBINDS() read ahead line. */
+        string mLookupCursorId;             /**< ParseWAIT() and parseFETCH()'s cursor id, reused for every line. */
+        deque<tmReportRow> mReportRows;     /**< Report rows waiting to be written, in line order, with --fetches. */
+        map<tmCursor *, tmReportRow *> mExecutions;  /**< Each cursor's EXEC row waiting for its FETCHes. */
+        ostringstream mRowText;             /**< A row being formatted while others wait, reused for every row. */
+        tmCallTree mCallTree;               /**< The calls at every depth, for the recursive calls of each event. */
+        void addCall(tmCallEvent &event);   /**< Adds a call, of any depth, to mCallTree, and passes it to onCall(). */
+
+        // Writing the EXEC rows.
+        bool reportExecution(tmExecution &execution);  /**< Writes an EXEC's row to the HTML or TEXT report. */
+        bool finishExecution(tmCursor *cursor);     /**< Writes a cursor's EXEC row, if it was waiting for its FETCHes. */
+        bool finishExecutions();                    /**< Writes every EXEC row still waiting for its FETCHes. */
+        bool writeReportRows();                     /**< Writes the waiting rows, up to the first still waiting for its FETCHes. */
+        bool writeOverdueRows();                    /**< Writes the EXEC rows which have waited too long for their FETCHes. */
+        ostream &reportRowStream();                 /**< Where an ERROR, COMMIT etc row is formatted. */
+        bool reportRowDone(bool counted);           /**< Finishes an ERROR, COMMIT etc row. */
+        void reportBlankColumns(ostream &out);      /**< Writes empty --waits and --fetches columns for ERRORs etc. */
 
         // Parsing stuff.
         bool parsePARSING(const string &thisLine);  /**< Parses a PARSING IN CURSOR line. */
@@ -146,7 +294,10 @@ class tmTraceFile
         bool parseBindData(tmBind *thisBind, vector<string>::iterator i);       /**< Parses a bind's data lines. */
         bool parseCLOSE(const string &thisLine);    /**< Parses a CLOSE line. */
         bool parseSTAT(const string &thisLine);     /**< Parses a STAT line. */
+        bool parseFETCH(const string &thisLine);    /**< Parses a FETCH line. */
+        bool parseWAIT(const string &thisLine);     /**< Parses a WAIT line. */
         void parseDEADLOCK();                       /**< Parses a deadlock graph */
+        void parseSESSION(const string &thisLine);  /**< Parses a *** SESSION ID line. */
 
         // Data extraction from a vector of bind lines.
         bool extractBindData(const vector<string>::iterator start, const vector<string>::iterator stop, tmCursor *thisCursor, tmBind *thisBind, unsigned firstLineNumber);    /**< Extracts the bind data from a vector. */
@@ -155,6 +306,21 @@ class tmTraceFile
         bool extractBindValue(vector<string>::const_iterator i, tmBind *thisBind, unsigned currentLine);  /**< Extracts a string representing a bind's actual value. */
 };
 
+// Explicitly instantiates a tmTraceFileT member for every output format and
+// verbosity. Used at the end of each source file which defines members, as:
+// TMTRACEFILE_INSTANTIATE(bool, parseEXEC(const string &));
+#define TMTRACEFILE_INSTANTIATE(Return, Member) \
+    template Return tmTraceFileT<tmHtmlOutput, tmVerbose>::Member; \
+    template Return tmTraceFileT<tmHtmlOutput, tmTerse>::Member; \
+    template Return tmTraceFileT<tmTextOutput, tmVerbose>::Member; \
+    template Return tmTraceFileT<tmTextOutput, tmTerse>::Member; \
+    template Return tmTraceFileT<tmViewerOutput, tmVerbose>::Member; \
+    template Return tmTraceFileT<tmViewerOutput, tmTerse>::Member; \
+    template Return tmTraceFileT<tmSQLiteOutput, tmVerbose>::Member; \
+    template Return tmTraceFileT<tmSQLiteOutput, tmTerse>::Member; \
+    template Return tmTraceFileT<tmEventOutput, tmVerbose>::Member; \
+    template Return tmTraceFileT<tmEventOutput, tmTerse>::Member
+
 // Stolen from http://stackoverflow.com/questions/4728155/how-do-you-set-the-cout-locale-to-insert-commas-as-thousands-separators
 // to allow me to automagically insert ',' (or '.' depending on the locale) into big numbers.
 // I'll be using this on the report and debug files.
@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tmviewer.h"
+#include "utilities.h"
+#include "viewer.h"
+
+/** @file tmviewer.cpp
+ * @brief Implementation file for the tmViewer object.
+ */
+
+/** @brief Constructor for a tmViewer object.
+ *
+ * @param pageFileName const string&. The HTML page to be written.
+ * @param dataFileName const string&. The data file to be written.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
+ */
+tmViewer::tmViewer(const string &pageFileName, const string &dataFileName, ostream &diagnostics)
+{
+    mPageFileName = pageFileName;
+    mDataFileName = dataFileName;
+    mDiagnostics = &diagnostics;
+    mOfs = NULL;
+    mRows = 0;
+}
+
+
+/** @brief Destructor for a tmViewer object.
+ */
+tmViewer::~tmViewer()
+{
+    if (mOfs) {
+        if (mOfs->is_open()) {
+            mOfs->close();
+        }
+
+        delete mOfs;
+        mOfs = NULL;
+    }
+}
+
+
+/** @brief Writes the HTML page and starts the data file.
+ *
+ * @param traceFile const string&. The trace file name, for the heading.
+ * @param adjusted bool. True if the trace was processed by TraceAdjust.
+ * @return bool. True if all ok, false otherwise.
+ *
+ * The page never changes, apart from the name of its data file, which
+ * is relative, so the two files can be moved around together.
+ */
+bool tmViewer::open(const string &traceFile, bool adjusted) {
+
+    ofstream page(mPageFileName);
+    if (!page.good()) {
+        *mDiagnostics << "TraceCollier: Cannot open viewer page " << mPageFileName << endl;
+        return false;
+    }
+
+    string html = viewerPage;
+    string dataName = ::fileName(mDataFileName);
+    string placeHolder = "VIEWER_DATA_FILE";
+
+    for (string::size_type pos = html.find(placeHolder);
+         pos != string::npos;
+         pos = html.find(placeHolder, pos + dataName.length())) {
+        html.replace(pos, placeHolder.length(), dataName);
+    }
+
+    page << html;
+    page.close();
+
+    if (!page.good()) {
+        *mDiagnostics << "TraceCollier: Cannot write viewer page " << mPageFileName << endl;
+        return false;
+    }
+
+    mOfs = new ofstream(mDataFileName, std::ofstream::out|std::ofstream::binary);
+    if (!mOfs->good()) {
+        *mDiagnostics << "TraceCollier: Cannot open viewer data file " << mDataFileName << endl;
+        return false;
+    }
+
+    mRow.clear();
+    mRow += "tcData = {\"trace\":";
+    appendString(traceFile);
+    mRow += ",\"adjusted\":";
+    mRow += adjusted ? "true" : "false";
+    mRow += ",\"rows\":[\n";
+    *mOfs << mRow;
+
+    return mOfs->good();
+}
+
+
+/** @brief Writes one row to the data file.
+ *
+ * @param kind unsigned. One of the VIEWER_xxx constants.
+ * @param line unsigned. Trace line number for this row.
+ * @param parseLine unsigned. PARSE line number, or zero.
+ * @param bindsLine unsigned. BINDS line number, or zero.
+ * @param sqlLine unsigned. SQL text line number, or zero.
+ * @param depth int. Recursive depth, or -1.
+ * @param cursorId const string&. Cursor id, or "".
+ * @param local const string&. Local date/time if trace adjusted, or "".
+ * @param text const string&. What to display.
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmViewer::addRow(unsigned kind, unsigned line, unsigned parseLine, unsigned bindsLine,
+                      unsigned sqlLine, int depth, const string &cursorId,
+                      const string &local, const string &text) {
+
+    int cursor = -1;
+    if (!cursorId.empty()) {
+        unordered_map<string, unsigned>::iterator i = mCursorIndex.find(cursorId);
+        if (i == mCursorIndex.end()) {
+            i = mCursorIndex.insert(make_pair(cursorId, (unsigned)mCursorIds.size())).first;
+            mCursorIds.push_back(cursorId);
+        }
+
+        cursor = i->second;
+    }
+
+    mRow.clear();
+    mRow += mRows ? ",\n[" : "[";
+    mRow += std::to_string(kind) + ',';
+    mRow += std::to_string(line) + ',';
+    mRow += std::to_string(parseLine) + ',';
+    mRow += std::to_string(bindsLine) + ',';
+    mRow += std::to_string(sqlLine) + ',';
+    mRow += std::to_string(depth) + ',';
+    mRow += std::to_string(cursor) + ',';
+    appendString(local);
+    mRow += ',';
+    appendString(text);
+    mRow += ']';
+
+    mOfs->write(mRow.data(), mRow.length());
+    mRows++;
+
+    return mOfs->good();
+}
+
+
+/** @brief Writes the cursor list and closes the data file.
+ *
+ * @return bool. True if all ok, false otherwise.
+ */
+bool tmViewer::close() {
+
+    if (!mOfs) {
+        return false;
+    }
+
+    mRow.clear();
+    mRow += "\n],\"cursors\":[";
+    for (unsigned i = 0; i < mCursorIds.size(); i++) {
+        if (i) {
+            mRow += ',';
+        }
+
+        appendString(mCursorIds[i]);
+    }
+
+    mRow += "]};\n";
+    *mOfs << mRow;
+    mOfs->close();
+
+    bool ok = mOfs->good();
+    delete mOfs;
+    mOfs = NULL;
+
+    return ok;
+}
+
+
+/** @brief Appends a string, quoted and escaped for JSON, to the row buffer.
+ *
+ * @param text const string&. The text to be appended.
+ */
+void tmViewer::appendString(const string &text) {
+    appendJsonString(mRow, text);
+}
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMVIEWER_H
+#define TMVIEWER_H
+
+/** @file tmviewer.h
+ * @brief Header file for the tmViewer object.
+ */
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+
+using std::string;
+using std::ostream;
+using std::ofstream;
+using std::vector;
+using std::unordered_map;
+
+// Row kinds in the viewer data file.
+const unsigned VIEWER_EXEC = 0;             /**< An EXEC, with binds substituted. */
+const unsigned VIEWER_ERROR = 1;            /**< An ERROR on a cursor. */
+const unsigned VIEWER_PARSE_ERROR = 2;      /**< A PARSE ERROR. */
+const unsigned VIEWER_XCTEND = 3;           /**< A COMMIT or ROLLBACK. */
+const unsigned VIEWER_DEADLOCK = 4;         /**< A deadlock graph. */
+
+/** @brief A class which writes the report as a static HTML page and a
+ *         compact data file, for --format=viewer.
+ *
+ * No HTML is written per row. Each row is a small JSON array in the data
+ * file, which is a JavaScript file so that it loads from a local folder:
+ *
+ * tcData = {"trace":"...","adjusted":false,"rows":[
+ * [kind, line, parse line, binds line, sql line, depth, cursor, "local", "text"],
+ * ...
+ * ],"cursors":["#140",...]};
+ *
+ * A zero parse or binds line means "From cache" or "No binds" on an EXEC.
+ * Depth and cursor are -1 when they don't apply. The cursor is an index
+ * into the cursors array, which is written last.
+ */
+class tmViewer
+{
+    public:
+        tmViewer(const string &pageFileName, const string &dataFileName, ostream &diagnostics);
+        ~tmViewer();
+
+        // Getters.
+        string fileName() { return mPageFileName; }             /**< Returns the HTML page file name. */
+        string dataFileName() { return mDataFileName; }         /**< Returns the data file name. */
+        unsigned long long rows() { return mRows; }             /**< Returns how many rows have been written. */
+
+        // Other useful stuff.
+        bool open(const string &traceFile, bool adjusted);      /**< Writes the page and starts the data file. */
+        bool addRow(unsigned kind, unsigned line, unsigned parseLine, unsigned bindsLine,
+                    unsigned sqlLine, int depth, const string &cursorId,
+                    const string &local, const string &text);   /**< Writes one row to the data file. */
+        bool close();                                           /**< Writes the cursor list and closes the data file. */
+
+    protected:
+
+    private:
+        string mPageFileName;               /**< The HTML page. */
+        ostream *mDiagnostics;              /**< Where warnings and errors go. */
+        string mDataFileName;               /**< The data file. */
+        ofstream *mOfs;                     /**< The data file itself. */
+        unsigned long long mRows;           /**< Rows written so far. */
+        string mRow;                        /**< Reusable buffer for one row. */
+        unordered_map<string, unsigned> mCursorIndex;   /**< Cursor id to index lookup. */
+        vector<string> mCursorIds;          /**< Cursor ids, in index order. */
+
+        void appendString(const string &text);          /**< Appends a JSON string to mRow. */
+};
+
+#endif // TMVIEWER_H
@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+
+#include "tmwaits.h"
+
+/** @file tmwaits.cpp
+ * @brief Implementation file for the tmWaitNames object.
+ */
+
+// Starting size of the hash table. Must be a power of 2.
+const unsigned WAIT_SLOTS = 64;
+
+
+/** @brief Hashes a wait event name, FNV-1a.
+ *
+ * @param name const tmView&. The name.
+ * @return unsigned long long. The hash.
+ */
+static unsigned long long hashName(const tmView &name)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    const char *p = name.data();
+    for (size_t x = 0; x < name.length(); x++) {
+        hash = (hash ^ (unsigned char)p[x]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+/** @brief Constructor for a tmWaitNames object.
+ */
+tmWaitNames::tmWaitNames()
+{
+    mSlots.assign(WAIT_SLOTS, -1);
+}
+
+
+/** @brief Returns the number of a wait event name.
+ *
+ * @param name const tmView&. The name, from a WAIT line's nam=.
+ * @return unsigned. The name's number. New names are copied, and get
+ * the next number.
+ */
+unsigned tmWaitNames::intern(const tmView &name)
+{
+    unsigned long long hash = hashName(name);
+    size_t mask = mSlots.size() - 1;
+
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        int id = mSlots[slot];
+
+        if (id < 0) {
+            // A new one. Keep the table no more than half full.
+            id = mNames.size();
+            mNames.push_back(name.str());
+            mHashes.push_back(hash);
+            mSlots[slot] = id;
+
+            if (mNames.size() * 2 > mSlots.size()) {
+                grow();
+            }
+
+            return id;
+        }
+
+        if (mHashes[id] == hash &&
+            mNames[id].length() == name.length() &&
+            memcmp(mNames[id].data(), name.data(), name.length()) == 0) {
+            return id;
+        }
+    }
+}
+
+
+/** @brief Doubles the size of the hash table.
+ */
+void tmWaitNames::grow()
+{
+    mSlots.assign(mSlots.size() * 2, -1);
+    size_t mask = mSlots.size() - 1;
+
+    for (unsigned id = 0; id < mNames.size(); id++) {
+        size_t slot = mHashes[id] & mask;
+        while (mSlots[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+
+        mSlots[slot] = id;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TMWAITS_H
+#define TMWAITS_H
+
+/** @file tmwaits.h
+ * @brief Header file for the tmWaitTotals and tmWaitNames objects.
+ */
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#include "tmevents.h"
+
+/** @brief Totals for one wait event, for one statement or overall.
+ */
+struct tmWaitTotals
+{
+    unsigned long long count;           /**< How many waits. */
+    unsigned long long elapsed;         /**< Total ela=, in microseconds. */
+    unsigned long long max;             /**< Longest ela=, in microseconds. */
+
+    tmWaitTotals() : count(0), elapsed(0), max(0) {}
+
+    /** @brief Adds one wait.
+     *
+     * @param ela unsigned long long. The wait's ela=.
+     */
+    void add(unsigned long long ela) {
+        count++;
+        elapsed += ela;
+        if (ela > max) {
+            max = ela;
+        }
+    }
+
+    /** @brief Adds another set of totals.
+     *
+     * @param totals const tmWaitTotals&. The totals to add.
+     */
+    void add(const tmWaitTotals &totals) {
+        count += totals.count;
+        elapsed += totals.elapsed;
+        if (totals.max > max) {
+            max = totals.max;
+        }
+    }
+};
+
+/** @brief Wait event names, each stored once, and numbered.
+ *
+ * A level 8 or 12 trace has millions of WAIT lines, but only a few dozen
+ * different event names. intern() finds a name's number straight from the
+ * trace line, with an open addressing hash table, so only the first of
+ * each name is ever copied. The numbers start at zero, and go up by one
+ * for each new name, so they can index a vector of totals.
+ */
+class tmWaitNames
+{
+    public:
+        tmWaitNames();
+
+        // Getters.
+        unsigned size() const { return mNames.size(); }                     /**< Returns how many names. */
+        const string &name(unsigned id) const { return mNames[id]; }        /**< Returns the name with this number. */
+
+        // Other useful stuff.
+        unsigned intern(const tmView &name);    /**< Returns a name's number, adding it if it's new. */
+
+    protected:
+
+    private:
+        void grow();                            /**< Doubles the hash table, and rehashes the names. */
+
+        vector<string> mNames;                  /**< The names, by number. */
+        vector<unsigned long long> mHashes;     /**< Each name's hash, by number. */
+        vector<int> mSlots;                     /**< The hash table. Name numbers, or -1 if empty. */
+};
+
+#endif // TMWAITS_H
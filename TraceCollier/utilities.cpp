@@ -22,10 +22,18 @@
  * SOFTWARE.
  */
 
+#include <sstream>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+    #include <emmintrin.h>
+    #define USE_SSE2_ESCAPE
+#endif // __SSE2__
+
 #include "utilities.h"
 #include "css.h"
+#include "favicon.h"
 
-extern string favIcon;
+using std::stringstream;
 
 // NOTE: None of these are case insensitive, it's up to the caller to
 //       ensure correct case is used. Just a thought!
@@ -146,7 +154,7 @@ string replaceFileExtension(const string &fullPath, const string &newExtension)
    string result;
 
    if (dot != string::npos) {
-      result = string(fullPath).replace(dot + 1, newExtension.length(), newExtension);
+      result = string(fullPath).replace(dot + 1, string::npos, newExtension);
    }
 
     return result;
@@ -176,19 +184,21 @@ bool fileExists(const string &fullPath) {
 /** @brief Creates a new 'TraceCollier.css' file, in the same folder as the trace file.
  *
  * @param fullPath const string&. The full path of the CSS filename.
+ * @param messages ostream&. Where to say it was created. Usually cout.
+ * @param diagnostics ostream&. Where to say it wasn't. Usually cerr.
  * @return bool. Returns true if the file was created, false otherwise.
  */
-bool createCSSFile(const string &fullPath) {
+bool createCSSFile(const string &fullPath, ostream &messages, ostream &diagnostics) {
 
     ofstream *oCss = new ofstream(fullPath);
     if (oCss->good()) {
         *oCss << cssText << endl;
         oCss->close();
         delete oCss;
-        cout << "TraceCollier: CSS file [" << fullPath << "] created ok." << endl;
+        messages << "TraceCollier: CSS file [" << fullPath << "] created ok." << endl;
         return true;
     } else {
-        cerr << "TraceCollier: CSS file [" << fullPath << "] failed to create." << endl;
+        diagnostics << "TraceCollier: CSS file [" << fullPath << "] failed to create." << endl;
         return false;
     }
 }
@@ -197,9 +207,11 @@ bool createCSSFile(const string &fullPath) {
 /** @brief Creates a new 'favicon.ico' file, in the same folder as the trace file.
  *
  * @param fullPath const string&. The full path of the favicon.ico file.
+ * @param messages ostream&. Where to say it was created. Usually cout.
+ * @param diagnostics ostream&. Where to say it wasn't. Usually cerr.
  * @return bool. Returns true if the file was created, false otherwise.
  */
-bool createFaviconFile(const string &fullPath) {
+bool createFaviconFile(const string &fullPath, ostream &messages, ostream &diagnostics) {
 
     ofstream *oFav = new ofstream(fullPath, std::ofstream::out|std::ofstream::binary);
     if (oFav->good()) {
@@ -215,10 +227,10 @@ bool createFaviconFile(const string &fullPath) {
         }
         oFav->close();
         delete oFav;
-        cout << "TraceCollier: Icon file [" << fullPath << "] created ok." << endl;
+        messages << "TraceCollier: Icon file [" << fullPath << "] created ok." << endl;
         return true;
     } else {
-        cerr << "TraceCollier: Icon file [" << fullPath << "] failed to create." << endl;
+        diagnostics << "TraceCollier: Icon file [" << fullPath << "] failed to create." << endl;
         return false;
     }
 }
@@ -288,16 +300,17 @@ unsigned getDigits(const string &thisLine, const string &lookFor, bool *ok) {
  * @param thisSQL const string&. The text of the SQL Statement.
  * @param colonPos const string::size_type&. Where to start extracting.
  * @param bindName string&. Somewhere to receive the extracted bind name.
+ * @param diagnostics ostream&. Where to write warnings and errors. Usually cerr.
  * @return bool. returns true if all ok, false otherwise.
  *
  */
-bool extractBindName(const string &thisSQL, const string::size_type &colonPos, string &bindName) {
+bool extractBindName(const string &thisSQL, const string::size_type &colonPos, string &bindName, ostream &diagnostics) {
 
     bindName = "";
 
     // We must be looking at a colon.
     if (thisSQL.at(colonPos) != ':') {
-        cerr << "extractBindName(): Not looking at a colon. Cannot extract bind name." << endl;
+        diagnostics << "extractBindName(): Not looking at a colon. Cannot extract bind name." << endl;
         return false;
     }
 
@@ -309,7 +322,7 @@ bool extractBindName(const string &thisSQL, const string::size_type &colonPos, s
             bindName = thisSQL.substr(colonPos, closeQuote - colonPos + 1);
             return true;
         } else {
-            cerr << "extractBindName(): Malformed SQL. Missing \" in [" << thisSQL << "]." << endl;
+            diagnostics << "extractBindName(): Malformed SQL. Missing \" in [" << thisSQL << "]." << endl;
             return false;
         }
     }
@@ -358,3 +371,215 @@ string getLocal(const string &thisLine) {
 
     return thisLine.substr(pos + 7, endPos - (pos + 6));
 }
+
+
+/** @brief Extracts Oracle's sqlid from a PARSING IN CURSOR line.
+ *
+ * @param thisLine const string&. The PARSING IN CURSOR line.
+ * @return string. The sqlid, if found, "" otherwise.
+ *
+ * Only 11g onwards writes the sqlid='...' to the trace file.
+ */
+string getSqlId(const string &thisLine) {
+    string::size_type pos = thisLine.find("sqlid='");
+    if (pos == string::npos)
+        return "";
+
+    pos += 7;
+    string::size_type endPos = thisLine.find('\'', pos);
+    if (endPos == string::npos)
+        return "";
+
+    return thisLine.substr(pos, endPos - pos);
+}
+
+
+/** @brief Finds the next character which needs escaping in HTML.
+ *
+ * @param text const char*. The text being escaped.
+ * @param start size_t. Where to start looking.
+ * @param length size_t. Length of the text.
+ * @return size_t. Offset of the next '&', '<', '>' or '"', or length if none.
+ *
+ * Most SQL and bind values have nothing to escape, so where SSE2 is
+ * available, 16 bytes are checked at a time. The tail, or everything
+ * when there's no SSE2, is checked a byte at a time.
+ */
+static size_t findHtmlSpecial(const char *text, size_t start, size_t length) {
+
+#ifdef USE_SSE2_ESCAPE
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i quot = _mm_set1_epi8('"');
+
+    while (start + 16 <= length) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + start));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, amp),
+                                                 _mm_cmpeq_epi8(chunk, lt)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, gt),
+                                                 _mm_cmpeq_epi8(chunk, quot)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask) {
+            return start + __builtin_ctz(mask);
+        }
+
+        start += 16;
+    }
+#endif // USE_SSE2_ESCAPE
+
+    for (; start < length; start++) {
+        switch (text[start]) {
+            case '&':
+            case '<':
+            case '>':
+            case '"':
+                return start;
+        }
+    }
+
+    return length;
+}
+
+
+/** @brief Returns the HTML entity for a special character.
+ *
+ * @param c char. One of '&', '<', '>' or '"'.
+ * @return const char*. The entity.
+ */
+static const char *htmlEntity(char c) {
+    switch (c) {
+        case '&': return "&amp;";
+        case '<': return "&lt;";
+        case '>': return "&gt;";
+        default: return "&quot;";
+    }
+}
+
+
+/** @brief Escapes a string for use as HTML text.
+ *
+ * @param text const string&. The text to be escaped.
+ * @return string. The text with '&', '<', '>' and '"' replaced by entities.
+ */
+string htmlEscape(const string &text) {
+    string result;
+    result.reserve(text.length());
+
+    const char *data = text.data();
+    size_t length = text.length();
+    size_t start = 0;
+
+    while (start < length) {
+        size_t special = findHtmlSpecial(data, start, length);
+        result.append(data + start, special - start);
+
+        if (special == length) {
+            break;
+        }
+
+        result += htmlEntity(data[special]);
+        start = special + 1;
+    }
+
+    return result;
+}
+
+
+/** @brief Writes a string, escaped for HTML, to a stream.
+ *
+ * @param os ostream&. Where to write to. Usually the report file.
+ * @param text const htmlEscapedText&. What to write. See htmlEscaped().
+ * @return ostream&. The stream.
+ *
+ * Clean runs of text are written straight to the stream, in one go, so
+ * there are no temporary strings.
+ */
+ostream &operator<<(ostream &os, const htmlEscapedText &text) {
+
+    const char *data = text.text.data();
+    size_t length = text.text.length();
+    size_t start = 0;
+
+    while (start < length) {
+        size_t special = findHtmlSpecial(data, start, length);
+        os.write(data + start, special - start);
+
+        if (special == length) {
+            break;
+        }
+
+        os << htmlEntity(data[special]);
+        start = special + 1;
+    }
+
+    return os;
+}
+
+
+/** @brief Returns the footer for an HTML report page.
+ *
+ * @param version const float. TraceCollier version.
+ * @return string. The footer, including the closing body and html tags.
+ */
+string htmlFooter(const float version) {
+    stringstream s;
+
+    s << "<p></p>\n<hr>\n"
+      << "<p class=\"footer\">\n\t"
+      << "Created with <strong>Trace Collier</strong> version <strong>" << version
+      << "</strong><br>Copyright &copy; Norman Dunbar 2016-2019<br>\n\t"
+      << "Released under the <a href=\"https://opensource.org/licenses/MIT\"><span class=\"url\">MIT Licence</span></a><br><br>\n\t"
+      << "Binary releases available from: "
+      << "<a href=\"https://github.com/NormanDunbar/TraceCollier/releases\">"
+      << "<span class=\"url\">https://github.com/NormanDunbar/TraceCollier/releases</span></a><br>\n\t"
+      << "Source code available from: "
+      << "<a href=\"https://github.com/NormanDunbar/TraceCollier\">"
+      << "<span class=\"url\">https://github.com/NormanDunbar/TraceCollier</span></a>\n</p>\n\n"
+      << "\n</body></html>" << endl;
+
+    return s.str();
+}
+
+
+/** @brief Appends a string, quoted and escaped for JSON, to a buffer.
+ *
+ * @param buffer string&. Where to append it.
+ * @param text const string&. The text to be appended.
+ *
+ * Trace files are mostly plain ASCII, so clean runs are appended in one go.
+ * Anything above 0x7f is passed through untouched, as UTF-8.
+ */
+void appendJsonString(string &buffer, const string &text) {
+
+    static const char hexDigits[] = "0123456789abcdef";
+
+    buffer += '"';
+
+    string::size_type start = 0;
+    for (string::size_type i = 0; i < text.length(); i++) {
+        unsigned char c = text[i];
+
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        buffer.append(text, start, i - start);
+        start = i + 1;
+
+        switch (c) {
+            case '"':  buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            default:
+                buffer += "\\u00";
+                buffer += hexDigits[c >> 4];
+                buffer += hexDigits[c & 0x0f];
+        }
+    }
+
+    buffer.append(text, start, string::npos);
+    buffer += '"';
+}
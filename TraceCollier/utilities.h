@@ -34,6 +34,7 @@
 #include <iostream>
 
 using std::string;
+using std::ostream;
 using std::ifstream;
 using std::ofstream;
 using std::endl;
@@ -58,13 +59,28 @@ string filePath(const string &fullPath);        /**< Return the file path for a
 string fileNameOnly(const string &fullPath);    /**< Return the file's name, not including the extension, or the dot.  */
 string replaceFileExtension(const string &fullPath, const string &newExtension);    /**< Return a string with the file name extension changed. */
 bool fileExists(const string &fullPath);        /**< Returns true if a given file path exists, false if not. */
-bool createCSSFile(const string &fullPath);     /**< Creates the default CSS file. Returns true if ok, False otherwise. */
-bool createFaviconFile(const string &fullPath); /**< Creates the favicon.ico file. Returns true if ok, False otherwise. */
+bool createCSSFile(const string &fullPath, ostream &messages, ostream &diagnostics);     /**< Creates the default CSS file. Returns true if ok, False otherwise. */
+bool createFaviconFile(const string &fullPath, ostream &messages, ostream &diagnostics); /**< Creates the favicon.ico file. Returns true if ok, False otherwise. */
 
 string getCursor(const string &thisLine, bool *ok); /**< Extract a cursor id from a trace line. */
 unsigned getDigits(const string &thisLine, const string &lookFor, bool *ok); /**< Extract a number from a trace line. */
-bool extractBindName(const string &thisSQL, const string::size_type &colonPos, string &bindName);   /**< Extract the bind variable name from a SQL Statement. */
+bool extractBindName(const string &thisSQL, const string::size_type &colonPos, string &bindName, ostream &diagnostics);   /**< Extract the bind variable name from a SQL Statement. */
 string getLocal(const string &thisLine);        /**< Return the local date/time from a trace line, if trace adjusted.  */
+string getSqlId(const string &thisLine);        /**< Return the sqlid from a PARSING IN CURSOR line, if present. */
+string htmlEscape(const string &text);          /**< Return text with HTML special characters escaped. */
+void appendJsonString(string &buffer, const string &text);  /**< Append text to a buffer as a quoted JSON string. */
+
+/** @brief Wraps a string so that writing it to a stream escapes it for HTML.
+ *
+ * Use as "*mOfs << htmlEscaped(sqlText);" to avoid building an escaped copy.
+ */
+struct htmlEscapedText {
+    const string &text;                         /**< The text to be escaped. */
+};
+
+inline htmlEscapedText htmlEscaped(const string &text) { return htmlEscapedText{text}; }  /**< Wraps text to be escaped when written. */
+ostream &operator<<(ostream &os, const htmlEscapedText &text);     /**< Writes text, escaped for HTML. */
+string htmlFooter(const float version);         /**< Return the footer for an HTML report page. */
 
 
 #endif // UTILITIES_H
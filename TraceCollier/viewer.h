@@ -0,0 +1,213 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VIEWER_H
+#define VIEWER_H
+
+/** @file viewer.h
+ * @brief Header file for the static HTML page used by the viewer report format.
+ *
+ * The page loads the rows from the ".data.js" file written alongside it, then
+ * only creates elements for the rows which are visible. Filtering is done in
+ * the browser. The data file name is substituted for VIEWER_DATA_FILE.
+ */
+
+#include <string>
+
+using std::string;
+
+const string viewerPage = R"TCVIEWER(<!DOCTYPE html>
+<html lang="en"><head>
+<meta charset="UTF-8" />
+<meta name="generator" content="TraceCollier" />
+<title>Trace Collier</title>
+<style>
+body { background: ivory; color: maroon; margin: 0; font-family: sans-serif; }
+#top { padding: 0.5em 1em; border-bottom: 1px solid maroon; }
+#top h1 { margin: 0 0 0.25em 0; font-size: 1.4em; }
+#top input { margin-right: 1em; }
+#grid { position: absolute; top: 8.5em; bottom: 10em; left: 0; right: 0; overflow-y: auto;
+        background: beige; font-family: "courier new","lucida console",monospace; font-size: 13px; }
+#spacer { position: relative; overflow: hidden; }
+.row { position: absolute; left: 0; right: 0; height: 20px; line-height: 20px;
+       white-space: nowrap; overflow: hidden; cursor: pointer; border-bottom: 1px solid #e8e0c8; }
+.row:hover, .row.selected { background: #f0e6c8; }
+.row span { display: inline-block; overflow: hidden; text-overflow: ellipsis; vertical-align: top; padding: 0 4px; }
+.row .n { width: 7em; text-align: right; }
+.row .d { width: 3em; text-align: right; }
+.row .l { width: 14em; }
+.row .c { width: 9em; }
+.row .t { position: absolute; right: 0; }
+.k1, .k2, .k4 { color: red; }
+.k3 { color: green; }
+#head { font-weight: bold; background: maroon; color: ivory; position: absolute; top: 7.2em; left: 0; right: 0; height: 20px;
+        line-height: 20px; font-family: "courier new","lucida console",monospace; font-size: 13px; white-space: nowrap; }
+#head span { display: inline-block; padding: 0 4px; }
+#detail { position: absolute; bottom: 0; height: 10em; left: 0; right: 0; overflow: auto; margin: 0;
+          border-top: 1px solid maroon; padding: 0.25em 1em; white-space: pre-wrap; font-size: 13px; }
+</style>
+</head>
+<body>
+<div id="top">
+<h1>Trace Collier</h1>
+<div><strong>Processing Trace File:</strong> <span id="trace"></span> <span id="count"></span></div>
+<div>
+Cursor <input id="fCursor" size="14" placeholder="#140" />
+SQL Text <input id="fText" size="30" placeholder="contains..." />
+Lines <input id="fFrom" size="8" placeholder="from" /> to <input id="fTo" size="8" placeholder="to" />
+</div>
+</div>
+<div id="head"></div>
+<div id="grid"><div id="spacer"></div></div>
+<pre id="detail">Click a row to see it in full.</pre>
+<script>
+var tcData = null;
+</script>
+<script src="VIEWER_DATA_FILE"></script>
+<script>
+(function () {
+    // Browsers won't make an element taller than about 17 million pixels,
+    // in Firefox, or 33 million, in Chrome. So the spacer is never taller
+    // than MAX, and once there are too many rows for that, the scroll bar's
+    // position picks the first row shown, rather than being it, in pixels.
+    var ROW = 21, EXTRA = 20, MAX = 8000000;
+    var KIND = ["EXEC", "ERROR", "PARSE ERROR", "XCTEND", "DEADLOCK"];
+    var grid = document.getElementById("grid");
+    var spacer = document.getElementById("spacer");
+    var detail = document.getElementById("detail");
+    var shown = [], selected = -1, height = 0;
+
+    if (!tcData) {
+        detail.textContent = "Cannot load VIEWER_DATA_FILE. It must be in the same folder as this page.";
+        return;
+    }
+
+    // Rows are [kind, line, parse line, binds line, sql line, depth, cursor index, local, text].
+    var rows = tcData.rows, cursors = tcData.cursors;
+    document.getElementById("trace").textContent = tcData.trace + (tcData.adjusted ? " (Preprocessed by 'TraceAdjust')" : "");
+
+    function cell(cls, text) {
+        var s = document.createElement("span");
+        s.className = cls;
+        s.textContent = text;
+        return s;
+    }
+
+    function lineText(r, i) {
+        if (r[i]) return r[i];
+        if (r[0] != 0) return "";
+        return (i == 2) ? "From cache" : (i == 3) ? "No binds" : "";
+    }
+
+    var head = document.getElementById("head");
+    var titles = [["n", "Line"], ["n", "PARSE Line"], ["n", "BINDS Line"], ["n", "SQL Line"], ["d", "DEP"]];
+    if (tcData.adjusted) titles.push(["l", "EXEC Date/Time"]);
+    titles.push(["c", "Cursor"], ["", "SQL Text"]);
+    titles.forEach(function (t) { head.appendChild(cell(t[0], t[1])); });
+    var textLeft = 0;
+    for (var i = 0; i < head.childNodes.length - 1; i++) textLeft += head.childNodes[i].offsetWidth;
+
+    function render() {
+        var visible = grid.clientHeight / ROW;
+        var range = height - grid.clientHeight;
+        var top = (range > 0) ? grid.scrollTop / range * Math.max(0, shown.length - visible) : 0;
+        var first = Math.max(0, Math.floor(top) - EXTRA);
+        var last = Math.min(shown.length, Math.ceil(top + visible) + EXTRA);
+        var frag = document.createDocumentFragment();
+
+        for (var i = first; i < last; i++) {
+            var r = rows[shown[i]];
+            var div = document.createElement("div");
+            div.className = "row k" + r[0] + (shown[i] == selected ? " selected" : "");
+            div.style.top = (grid.scrollTop + (i - top) * ROW) + "px";
+            div.dataset.row = shown[i];
+            div.appendChild(cell("n", r[1]));
+            div.appendChild(cell("n", lineText(r, 2)));
+            div.appendChild(cell("n", lineText(r, 3)));
+            div.appendChild(cell("n", lineText(r, 4)));
+            div.appendChild(cell("d", r[5] < 0 ? "" : r[5]));
+            if (tcData.adjusted) div.appendChild(cell("l", r[7]));
+            div.appendChild(cell("c", r[6] < 0 ? "" : cursors[r[6]]));
+            var t = cell("t", (r[0] ? KIND[r[0]] + ": " : "") + r[8].replace(/\s+/g, " "));
+            t.style.left = textLeft + "px";
+            div.appendChild(t);
+            frag.appendChild(div);
+        }
+
+        spacer.textContent = "";
+        spacer.appendChild(frag);
+    }
+
+    function filter() {
+        var cursor = document.getElementById("fCursor").value.trim();
+        var text = document.getElementById("fText").value.trim().toLowerCase();
+        var from = parseInt(document.getElementById("fFrom").value, 10) || 0;
+        var to = parseInt(document.getElementById("fTo").value, 10) || Infinity;
+        var cursorIndex = cursor ? cursors.indexOf(cursor.charAt(0) == "#" ? cursor : "#" + cursor) : -1;
+
+        shown = [];
+        for (var i = 0; i < rows.length; i++) {
+            var r = rows[i];
+            if (r[1] < from || r[1] > to) continue;
+            if (cursor && r[6] != cursorIndex) continue;
+            if (text && r[8].toLowerCase().indexOf(text) < 0) continue;
+            shown.push(i);
+        }
+
+        document.getElementById("count").textContent = "(" + shown.length + " of " + rows.length + " rows)";
+        height = Math.min(shown.length * ROW, MAX);
+        spacer.style.height = height + "px";
+        grid.scrollTop = 0;
+        render();
+    }
+
+    var timer = null;
+    ["fCursor", "fText", "fFrom", "fTo"].forEach(function (id) {
+        document.getElementById(id).addEventListener("input", function () {
+            clearTimeout(timer);
+            timer = setTimeout(filter, 200);
+        });
+    });
+
+    grid.addEventListener("scroll", function () { window.requestAnimationFrame(render); });
+    window.addEventListener("resize", render);
+
+    spacer.addEventListener("click", function (e) {
+        var div = e.target.closest(".row");
+        if (!div) return;
+        selected = parseInt(div.dataset.row, 10);
+        var r = rows[selected];
+        detail.textContent = KIND[r[0]] + " at line " + r[1] +
+            (r[6] < 0 ? "" : ", cursor " + cursors[r[6]]) +
+            (r[7] ? ", " + r[7] : "") + "\n\n" + r[8];
+        render();
+    });
+
+    filter();
+})();
+</script>
+</body></html>
+)TCVIEWER";
+
+#endif // VIEWER_H
@@ -0,0 +1,224 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file traceevents.cpp
+ * @brief TraceEvents is an example libtracecollier program.
+ *
+ * It counts the records of each type in a trace file, totals the CPU and
+ * elapsed time of the EXECs and FETCHes, and the time waited on each wait
+ * event. No report is written. It is built, with the library, by:
+ *
+ * @code
+ * make -f makefile.gnu traceevents
+ * bin/TraceEvents --depth=1 orcl_ora_1234.trc
+ * @endcode
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+
+#include "tmtracefile.h"
+#include "tmoptions.h"
+#include "tmevents.h"
+
+using std::string;
+using std::vector;
+using std::map;
+using std::pair;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::setw;
+using std::left;
+using std::right;
+
+
+/** @brief Totals for one wait event name. */
+struct tmWaitTotal {
+    unsigned long long count;       /**< How many waits. */
+    unsigned long long elapsed;     /**< Total ela=, in microseconds. */
+};
+
+
+/** @brief A tmEventHandler which totals everything it sees. */
+class tmEventTotals : public tmEventHandler
+{
+    public:
+        tmEventTotals() : mParsing(0), mParse(0), mBinds(0), mExec(0), mFetch(0),
+                          mWait(0), mClose(0), mStat(0), mXctend(0), mError(0),
+                          mParseError(0), mDeadlock(0), mRollbacks(0),
+                          mExecCpu(0), mExecElapsed(0), mFetchCpu(0), mFetchElapsed(0),
+                          mFetchRows(0) {}
+
+        void onCursorParsed(const tmCursorParsedEvent &) { mParsing++; }
+        void onParse(const tmCallEvent &) { mParse++; }
+        void onBinds(const tmBindsEvent &) { mBinds++; }
+        void onClose(const tmCloseEvent &) { mClose++; }
+        void onStat(const tmStatEvent &) { mStat++; }
+        void onError(const tmErrorEvent &) { mError++; }
+        void onParseError(const tmParseErrorEvent &) { mParseError++; }
+        void onDeadlock(const tmDeadlockEvent &) { mDeadlock++; }
+
+        void onExec(const tmCallEvent &event) {
+            mExec++;
+            mExecCpu += event.stats.cpu();
+            mExecElapsed += event.stats.elapsed();
+        }
+
+        void onFetch(const tmCallEvent &event) {
+            mFetch++;
+            mFetchCpu += event.stats.cpu();
+            mFetchElapsed += event.stats.elapsed();
+            mFetchRows += event.stats.rows();
+        }
+
+        void onXctend(const tmXctendEvent &event) {
+            mXctend++;
+            if (event.rollback) {
+                mRollbacks++;
+            }
+        }
+
+        // The name is only valid during the call, so it's copied here.
+        void onWait(const tmWaitEvent &event) {
+            mWait++;
+            tmWaitTotal &total = mWaits[event.name.str()];
+            total.count++;
+            total.elapsed += event.elapsed;
+        }
+
+        void report();      /**< Writes the totals to cout. */
+
+    private:
+        unsigned long long mParsing;        /**< PARSING IN CURSOR records. */
+        unsigned long long mParse;          /**< PARSE records. */
+        unsigned long long mBinds;          /**< BINDS records. */
+        unsigned long long mExec;           /**< EXEC records. */
+        unsigned long long mFetch;          /**< FETCH records. */
+        unsigned long long mWait;           /**< WAIT records. */
+        unsigned long long mClose;          /**< CLOSE records. */
+        unsigned long long mStat;           /**< STAT records. */
+        unsigned long long mXctend;         /**< XCTEND records. */
+        unsigned long long mError;          /**< ERROR records. */
+        unsigned long long mParseError;     /**< PARSE ERROR records. */
+        unsigned long long mDeadlock;       /**< DEADLOCK DETECTED records. */
+        unsigned long long mRollbacks;      /**< XCTENDs which rolled back. */
+        unsigned long long mExecCpu;        /**< Total EXEC c=. */
+        unsigned long long mExecElapsed;    /**< Total EXEC e=. */
+        unsigned long long mFetchCpu;       /**< Total FETCH c=. */
+        unsigned long long mFetchElapsed;   /**< Total FETCH e=. */
+        unsigned long long mFetchRows;      /**< Total FETCH r=. */
+        map<string, tmWaitTotal> mWaits;    /**< Wait totals, by event name. */
+};
+
+
+/** @brief Orders waits by total elapsed time, longest first. */
+static bool longestWait(const pair<string, tmWaitTotal> &a, const pair<string, tmWaitTotal> &b)
+{
+    return a.second.elapsed > b.second.elapsed;
+}
+
+
+void tmEventTotals::report()
+{
+    cout << left << setw(24) << "Record" << right << setw(14) << "Count" << endl
+         << left << setw(24) << "PARSING IN CURSOR" << right << setw(14) << mParsing << endl
+         << left << setw(24) << "PARSE" << right << setw(14) << mParse << endl
+         << left << setw(24) << "BINDS" << right << setw(14) << mBinds << endl
+         << left << setw(24) << "EXEC" << right << setw(14) << mExec << endl
+         << left << setw(24) << "FETCH" << right << setw(14) << mFetch << endl
+         << left << setw(24) << "WAIT" << right << setw(14) << mWait << endl
+         << left << setw(24) << "CLOSE" << right << setw(14) << mClose << endl
+         << left << setw(24) << "STAT" << right << setw(14) << mStat << endl
+         << left << setw(24) << "XCTEND" << right << setw(14) << mXctend << endl
+         << left << setw(24) << "  of which ROLLBACK" << right << setw(14) << mRollbacks << endl
+         << left << setw(24) << "ERROR" << right << setw(14) << mError << endl
+         << left << setw(24) << "PARSE ERROR" << right << setw(14) << mParseError << endl
+         << left << setw(24) << "DEADLOCK" << right << setw(14) << mDeadlock << endl
+         << endl
+         << "EXEC  c=" << mExecCpu << " e=" << mExecElapsed << endl
+         << "FETCH c=" << mFetchCpu << " e=" << mFetchElapsed << " r=" << mFetchRows << endl;
+
+    if (mWaits.empty()) {
+        return;
+    }
+
+    vector<pair<string, tmWaitTotal> > waits(mWaits.begin(), mWaits.end());
+    std::sort(waits.begin(), waits.end(), longestWait);
+
+    cout << endl
+         << left << setw(40) << "Wait event" << right << setw(12) << "Waits"
+         << setw(16) << "Elapsed (us)" << endl;
+
+    for (vector<pair<string, tmWaitTotal> >::iterator i = waits.begin(); i != waits.end(); ++i) {
+        cout << left << setw(40) << i->first << right << setw(12) << i->second.count
+             << setw(16) << i->second.elapsed << endl;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    tmOptions options;
+    options.setQuiet(true);
+    options.setFeedBack(0);
+
+    string traceFile;
+    for (int arg = 1; arg < argc; arg++) {
+        string thisArg = argv[arg];
+        if (thisArg.substr(0, 8) == "--depth=") {
+            options.setDepth(strtoul(thisArg.c_str() + 8, NULL, 10));
+        } else if (thisArg[0] != '-' && traceFile.empty()) {
+            traceFile = thisArg;
+        } else {
+            cerr << "Usage: TraceEvents [--depth=N] trace_file" << endl;
+            return 1;
+        }
+    }
+
+    if (traceFile.empty()) {
+        cerr << "Usage: TraceEvents [--depth=N] trace_file" << endl;
+        return 1;
+    }
+
+    options.setTraceFile(traceFile);
+
+    tmEventTotals totals;
+    tmTraceFile *trace = tmTraceFile::create(&options, &totals);
+    bool ok = trace->parse(0);
+    delete trace;
+
+    if (!ok) {
+        cerr << "TraceEvents: Cannot parse " << traceFile << endl;
+        return 1;
+    }
+
+    totals.report();
+    return 0;
+}
@@ -0,0 +1,774 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Norman Dunbar
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file tracegen.cpp
+ * @brief TraceGen writes synthetic Oracle 10046 trace files, for benchmarking TraceCollier.
+ *
+ * The traces look like those from a busy application session with binds
+ * and waits on, level 12. There's a header, then PARSING IN CURSOR,
+ * PARSE, BINDS, EXEC, WAIT, FETCH, STAT, CLOSE, ERROR, PARSE ERROR and
+ * XCTEND lines, with the occasional timestamp and deadlock graph.
+ * Recursive SQL is nested inside its parent's PARSE and EXEC, as Oracle does.
+ *
+ * The times add up, as they do in a real trace. A call's WAITs, and its
+ * recursive calls, are written before it and end inside its e=, which
+ * covers them and its own CPU time. Between dep=0 calls, the session
+ * waits on the client, on SQL*Net message from client, which is in no
+ * call at all. Each wait event has its own parameters, as Oracle's do.
+ *
+ * The same options, and seed, always give the same trace.
+ *
+ * @code
+ * make -f makefile.gnu tracegen
+ * bin/TraceGen --size=100 --cursors=500 --binds=20 my.trc
+ * @endcode
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ofstream;
+using std::ostream;
+using std::string;
+using std::stringstream;
+using std::vector;
+
+
+// Bind variable types we generate.
+enum genBindType {
+    BIND_NUMBER,
+    BIND_VARCHAR,
+    BIND_DATE,
+    BIND_NCHAR
+};
+
+
+// One SQL statement, and the cursor it's open in, if any.
+struct genStatement {
+    string sql;                     // The text, maybe over several lines.
+    unsigned length;                // Its len=.
+    unsigned commandType;           // oct= 3 SELECT, 2 INSERT, 6 UPDATE, 47 PL/SQL.
+    string sqlId;                   // sqlid=
+    unsigned long hashValue;        // hv=
+    unsigned long planHash;         // plh=, zero for all but SELECT.
+    vector<genBindType> binds;      // The type of each bind.
+    unsigned long long cursor;      // Cursor number while open, zero when not.
+    bool statsWritten;              // Have its STAT lines been written?
+};
+
+
+/** @brief The settings, from the command line.
+ */
+struct genOptions {
+    unsigned long long size = 100;  // Megabytes to write.
+    unsigned cursors = 200;         // Distinct statements.
+    unsigned reuse = 80;            // Percent of executions using a cached cursor.
+    unsigned binds = 8;             // Most binds in a statement.
+    unsigned nchar = 10;            // Percent of character binds which are NCHAR, in hex.
+    unsigned waits = 3;             // Average WAITs inside a call.
+    unsigned depth = 2;             // Deepest recursive SQL.
+    unsigned recursion = 20;        // Percent of calls with recursive SQL inside.
+    unsigned deadlocks = 1;         // Deadlock graphs in the whole trace.
+    unsigned errors = 5;            // ERRORs per thousand EXECs.
+    unsigned parseErrors = 2;       // PARSE ERRORs per thousand EXECs.
+    unsigned seed = 1;              // Random number seed.
+    string traceFile;               // Where to write it.
+};
+
+
+/** @brief Writes one synthetic trace file.
+ */
+class genTrace
+{
+    public:
+        genTrace(const genOptions &options, ostream &out);
+        void write();
+
+        unsigned long long lines() { return mLines; }   // Lines written.
+        unsigned long long bytes() { return mBytes; }   // Bytes written.
+        unsigned long long execs() { return mExecs; }   // EXECs written.
+
+    private:
+        const genOptions &mOptions;
+        ostream &mOut;
+        std::mt19937_64 mRandom;
+        vector<genStatement> mStatements;
+        vector<unsigned long long> mClosed; // Hard closed cursor numbers, free for reuse.
+        unsigned long long mTim;            // Trace clock, microseconds.
+        unsigned long long mWaited;         // Microseconds of WAITs inside calls, so far.
+        unsigned long long mNextCursor;     // Next new cursor number.
+        unsigned long long mLines;
+        unsigned long long mBytes;
+        unsigned long long mExecs;
+        unsigned long long mSeconds;        // For the timestamp lines.
+
+        unsigned number(unsigned low, unsigned high);
+        bool percent(unsigned chance);
+        bool perThousand(unsigned chance);
+        void line(const string &text);
+        string word();
+        string sqlId();
+        void makeStatements();
+        unsigned long long openCursor(genStatement &statement);
+        void header();
+        void timestamp();
+        void call(const char *type, unsigned long long cursor, unsigned depth,
+                  const genStatement &statement, bool miss, unsigned rows,
+                  unsigned long long started, unsigned long long waited);
+        void bindsBlock(unsigned long long cursor, const genStatement &statement);
+        void wait(unsigned long long cursor, const char *name, unsigned elapsed, const string &parameters);
+        void waits(unsigned long long cursor);
+        void client(unsigned long long cursor);
+        void execute(genStatement &statement, unsigned depth);
+        void parseError();
+        void deadlock();
+};
+
+
+genTrace::genTrace(const genOptions &options, ostream &out) :
+    mOptions(options), mOut(out), mRandom(options.seed)
+{
+    mTim = 1000000000ULL;
+    mWaited = 0;
+    mNextCursor = 140000000000000ULL;
+    mLines = 0;
+    mBytes = 0;
+    mExecs = 0;
+    mSeconds = 0;
+}
+
+
+// A random number from low to high, inclusive.
+unsigned genTrace::number(unsigned low, unsigned high) {
+    return std::uniform_int_distribution<unsigned>(low, high)(mRandom);
+}
+
+
+// True, chance percent of the time.
+bool genTrace::percent(unsigned chance) {
+    return number(1, 100) <= chance;
+}
+
+
+// True, chance times in a thousand.
+bool genTrace::perThousand(unsigned chance) {
+    return number(1, 1000) <= chance;
+}
+
+
+// Writes a line, and counts it.
+void genTrace::line(const string &text) {
+    mOut << text << '\n';
+    mLines++;
+    mBytes += text.length() + 1;
+}
+
+
+// A random lower case word, for names and values.
+string genTrace::word() {
+    static const char *words[] = {
+        "order", "customer", "item", "price", "status", "account", "region",
+        "product", "invoice", "address", "payment", "ledger", "branch", "stock"
+    };
+
+    return words[number(0, sizeof(words) / sizeof(words[0]) - 1)];
+}
+
+
+// A random 13 character sqlid.
+string genTrace::sqlId() {
+    static const char *alphabet = "0123456789abcdfghjkmnpqrstuvwxyz";
+    string id;
+
+    for (int i = 0; i < 13; i++) {
+        id += alphabet[number(0, 31)];
+    }
+
+    return id;
+}
+
+
+// Builds the pool of statements.
+void genTrace::makeStatements() {
+    for (unsigned s = 0; s < mOptions.cursors; s++) {
+        genStatement statement;
+        stringstream sql;
+        unsigned bindCount = number(0, mOptions.binds);
+        unsigned kind = number(1, 100);
+
+        for (unsigned b = 0; b < bindCount; b++) {
+            unsigned type = number(1, 100);
+            if (type <= 45) {
+                statement.binds.push_back(BIND_NUMBER);
+            } else if (type <= 85) {
+                statement.binds.push_back(percent(mOptions.nchar) ? BIND_NCHAR : BIND_VARCHAR);
+            } else {
+                statement.binds.push_back(BIND_DATE);
+            }
+        }
+
+        string table = word() + "s_" + std::to_string(s);
+
+        if (kind <= 60) {
+            statement.commandType = 3;
+            sql << "SELECT " << word() << "_id, " << word() << "_name FROM " << table;
+            for (unsigned b = 0; b < bindCount; b++) {
+                sql << (b ? (b % 8 ? " AND " : "\nAND ") : " WHERE ")
+                    << word() << "_" << b << " = :b" << b + 1;
+            }
+        } else if (kind <= 75) {
+            statement.commandType = 2;
+            sql << "INSERT INTO " << table << " VALUES (";
+            for (unsigned b = 0; b < bindCount; b++) {
+                sql << (b ? (b % 8 ? ", " : ",\n") : "") << ":b" << b + 1;
+            }
+            sql << ")";
+        } else if (kind <= 90) {
+            statement.commandType = 6;
+            sql << "UPDATE " << table << " SET " << word() << "_status = 'X'";
+            for (unsigned b = 0; b < bindCount; b++) {
+                sql << (b ? (b % 8 ? " AND " : "\nAND ") : " WHERE ")
+                    << word() << "_" << b << " = :b" << b + 1;
+            }
+        } else {
+            statement.commandType = 47;
+            sql << "BEGIN " << word() << "_pkg.process_" << word() << "(";
+            for (unsigned b = 0; b < bindCount; b++) {
+                sql << (b ? (b % 8 ? ", " : ",\n") : "") << ":b" << b + 1;
+            }
+            sql << "); END;";
+        }
+
+        statement.sql = sql.str();
+        statement.length = statement.sql.length();
+        statement.sqlId = sqlId();
+        statement.hashValue = number(1, 4000000000U);
+        statement.planHash = (statement.commandType == 3) ? number(1, 4000000000U) : 0;
+        statement.cursor = 0;
+        statement.statsWritten = false;
+        mStatements.push_back(statement);
+    }
+}
+
+
+// A cursor number for a statement being parsed. Sometimes it's one
+// which was hard closed, so the same cursor ID turns up with new SQL.
+unsigned long long genTrace::openCursor(genStatement &statement) {
+    if (!mClosed.empty() && percent(30)) {
+        unsigned slot = number(0, mClosed.size() - 1);
+        statement.cursor = mClosed[slot];
+        mClosed[slot] = mClosed.back();
+        mClosed.pop_back();
+    } else {
+        statement.cursor = mNextCursor;
+        mNextCursor += 8;
+    }
+
+    return statement.cursor;
+}
+
+
+// The trace file header.
+void genTrace::header() {
+    line("Trace file /u01/app/oracle/diag/rdbms/orcl/orcl/trace/orcl_ora_4242.trc");
+    line("Oracle Database 12c Enterprise Edition Release 12.1.0.2.0 - 64bit Production");
+    line("ORACLE_HOME = /u01/app/oracle/product/12.1.0/dbhome_1");
+    line("System name:\tLinux");
+    line("Node name:\tdbserver");
+    line("Release:\t3.8.13-118.el7uek.x86_64");
+    line("Instance name: orcl");
+    line("Redo thread mounted by this instance: 1");
+    line("Oracle process number: 42");
+    line("Unix process pid: 4242, image: oracle@dbserver");
+    line("");
+    line("");
+    timestamp();
+    line("*** SESSION ID:(42.4242) 2017-01-09 10:00:00.000");
+    line("*** MODULE NAME:(TraceGen) 2017-01-09 10:00:00.000");
+    line("");
+}
+
+
+// A timestamp line. They come every so often in real traces.
+void genTrace::timestamp() {
+    char buffer[64];
+    unsigned long long s = mSeconds++;
+    snprintf(buffer, sizeof(buffer), "*** 2017-01-%02llu %02llu:%02llu:%02llu.000",
+             9 + (s / 86400) % 20, (s / 3600) % 24, (s / 60) % 60, s % 60);
+    line(buffer);
+}
+
+
+// A PARSE, EXEC or FETCH line. The call started at started, when mWaited
+// was waited, so its e= covers everything written since, its recursive
+// calls and WAITs, as well as its own time. Its c= is what wasn't WAITs.
+void genTrace::call(const char *type, unsigned long long cursor, unsigned depth,
+                    const genStatement &statement, bool miss, unsigned rows,
+                    unsigned long long started, unsigned long long waited) {
+    mTim += number(5, 5000);
+    unsigned long long elapsed = mTim - started;
+    unsigned long long cpu = elapsed - (mWaited - waited);
+
+    stringstream s;
+    s << type << " #" << cursor << ":c=" << cpu << ",e=" << elapsed
+      << ",p=" << number(0, 3) << ",cr=" << number(0, 50) << ",cu=" << number(0, 5)
+      << ",mis=" << (miss ? 1 : 0) << ",r=" << rows << ",dep=" << depth
+      << ",og=1,plh=" << statement.planHash << ",tim=" << mTim;
+    line(s.str());
+
+    // A moment before the next call starts.
+    mTim += number(1, 50);
+}
+
+
+// A BINDS block, with the value of each bind.
+void genTrace::bindsBlock(unsigned long long cursor, const genStatement &statement) {
+    stringstream s;
+    s << "BINDS #" << cursor << ":";
+    line(s.str());
+
+    for (unsigned b = 0; b < statement.binds.size(); b++) {
+        s.str("");
+        s << " Bind#" << b;
+        line(s.str());
+
+        switch (statement.binds[b]) {
+            case BIND_NUMBER: {
+                string value = std::to_string(number(0, 999999));
+                line("  oacdty=02 mxl=22(22) mxlc=00 mal=00 scl=00 pre=00");
+                line("  oacflg=00 fl2=1000000 frm=01 csi=178 siz=24 off=0");
+                line("  kxsbbbfp=7f2a3b4c5d68  bln=22  avl=0" + std::to_string(value.length() / 2 + 1) + "  flg=05");
+                line("  value=" + value);
+                break;
+            }
+
+            case BIND_VARCHAR: {
+                string value = word() + "_" + std::to_string(number(1, 9999));
+                char lengths[32];
+                snprintf(lengths, sizeof(lengths), "mxl=32(%02u)", unsigned(value.length()));
+                line(string("  oacdty=01 ") + lengths + " mxlc=00 mal=00 scl=00 pre=00");
+                line("  oacflg=00 fl2=1000000 frm=01 csi=178 siz=32 off=0");
+                line("  kxsbbbfp=7f2a3b4c5d70  bln=32  avl=" + std::to_string(value.length()) + "  flg=05");
+                line("  value=\"" + value + "\"");
+                break;
+            }
+
+            case BIND_DATE: {
+                char value[64];
+                snprintf(value, sizeof(value), "  value=\"%u/%u/2017 %u:%u:%u\"",
+                         number(1, 12), number(1, 28), number(0, 23), number(0, 59), number(0, 59));
+                line("  oacdty=12 mxl=07(07) mxlc=00 mal=00 scl=00 pre=00");
+                line("  oacflg=10 fl2=0001 frm=00 csi=00 siz=8 off=0");
+                line("  kxsbbbfp=7f2a3b4c5d78  bln=07  avl=07  flg=09");
+                line(value);
+                break;
+            }
+
+            case BIND_NCHAR: {
+                // UTF-16, so each character is "0 hh ". Mostly short, but
+                // now and then a long one, up to 4KB of hex.
+                unsigned characters = percent(2) ? number(500, 800) : number(3, 20);
+                string value = "  value=";
+                char hex[8];
+                for (unsigned c = 0; c < characters; c++) {
+                    snprintf(hex, sizeof(hex), "0 %x ", number('a', 'z'));
+                    value += hex;
+                }
+                line("  oacdty=96 mxl=2000(" + std::to_string(characters * 2) + ") mxlc=00 mal=00 scl=00 pre=00");
+                line("  oacflg=00 fl2=1000000 frm=02 csi=2000 siz=2000 off=0");
+                line("  kxsbbbfp=7f2a3b4c5d80  bln=2000  avl=" + std::to_string(characters * 2) + "  flg=05");
+                line(value);
+                break;
+            }
+        }
+    }
+}
+
+
+// A WAIT line, for one which has just ended.
+void genTrace::wait(unsigned long long cursor, const char *name, unsigned elapsed, const string &parameters) {
+    mTim += elapsed;
+
+    stringstream s;
+    s << "WAIT #" << cursor << ": nam='" << name << "' ela= " << elapsed << ' ' << parameters << " tim=" << mTim;
+    line(s.str());
+}
+
+
+// The WAITs inside a call, written before it. Reads, and the odd latch.
+void genTrace::waits(unsigned long long cursor) {
+    unsigned count = mOptions.waits ? number(0, 2 * mOptions.waits) : 0;
+    for (unsigned w = 0; w < count; w++) {
+        stringstream p;
+        unsigned kind = number(1, 100);
+        unsigned elapsed;
+        const char *name;
+
+        if (kind <= 70) {
+            name = "db file sequential read";
+            elapsed = number(50, 8000);
+            p << "file#=" << number(1, 12) << " block#=" << number(1, 999999)
+              << " blocks=1 obj#=" << number(1000, 99999);
+        } else if (kind <= 90) {
+            name = "db file scattered read";
+            elapsed = number(200, 20000);
+            p << "file#=" << number(1, 12) << " block#=" << number(1, 999999)
+              << " blocks=" << number(2, 16) * 8 << " obj#=" << number(1000, 99999);
+        } else {
+            name = "latch: cache buffers chains";
+            elapsed = number(1, 500);
+            p << "address=" << number(100000000, 999999999) << " number=" << number(150, 250)
+              << " tries=0 obj#=" << number(1000, 99999);
+        }
+
+        wait(cursor, name, elapsed, p.str());
+        mWaited += elapsed;
+    }
+}
+
+
+// The round trip to the client after a dep=0 call. The answer goes out,
+// and the session waits, idle, for the next call, between calls.
+void genTrace::client(unsigned long long cursor) {
+    static const string parameters = "driver id=1650815232 #bytes=1 p3=0 obj#=-1";
+
+    wait(cursor, "SQL*Net message to client", number(1, 10), parameters);
+    wait(cursor, "SQL*Net message from client", number(100, 20000), parameters);
+}
+
+
+// Runs a statement. Parses it if its cursor isn't open, or sometimes even
+// if it is. Recursive SQL may run inside the parse or the execute.
+void genTrace::execute(genStatement &statement, unsigned depth) {
+    bool reuse = statement.cursor && percent(mOptions.reuse);
+    unsigned long long cursor = reuse ? statement.cursor : openCursor(statement);
+    stringstream s;
+
+    if (!reuse) {
+        s << "PARSING IN CURSOR #" << cursor << " len=" << statement.length << " dep=" << depth
+          << " uid=104 oct=" << statement.commandType << " lid=104 tim=" << mTim
+          << " hv=" << statement.hashValue << " ad='7f3c2a10' sqlid='" << statement.sqlId << "'";
+        line("=====================");
+        line(s.str());
+        line(statement.sql);
+        line("END OF STMT");
+
+        // Recursive SQL during the hard parse.
+        unsigned long long started = mTim;
+        unsigned long long waited = mWaited;
+        if (depth < mOptions.depth && percent(mOptions.recursion)) {
+            execute(mStatements[number(0, mStatements.size() - 1)], depth + 1);
+        }
+
+        call("PARSE", cursor, depth, statement, true, 0, started, waited);
+    }
+
+    if (!statement.binds.empty()) {
+        bindsBlock(cursor, statement);
+    }
+
+    // Recursive SQL during the execute, triggers and the like.
+    unsigned long long started = mTim;
+    unsigned long long waited = mWaited;
+    if (depth < mOptions.depth && percent(mOptions.recursion)) {
+        execute(mStatements[number(0, mStatements.size() - 1)], depth + 1);
+    }
+
+    waits(cursor);
+    unsigned rows = (statement.commandType == 3) ? 0 : number(0, 5);
+    call("EXEC", cursor, depth, statement, false, rows, started, waited);
+    mExecs++;
+
+    if (perThousand(mOptions.errors)) {
+        s.str("");
+        s << "ERROR #" << cursor << ":err=" << (percent(50) ? 1 : 1400) << " tim=" << mTim;
+        line(s.str());
+    } else if (statement.commandType == 3) {
+        unsigned fetches = number(1, 3);
+        for (unsigned f = 0; f < fetches; f++) {
+            // A dep=0 FETCH is the client asking for the next rows.
+            if (depth == 0) {
+                client(cursor);
+            }
+
+            started = mTim;
+            waited = mWaited;
+            waits(cursor);
+            call("FETCH", cursor, depth, statement, false, number(0, 100), started, waited);
+        }
+    }
+
+    if (statement.commandType == 3 && !statement.statsWritten) {
+        s.str("");
+        s << "STAT #" << cursor << " id=1 cnt=" << number(1, 100) << " pid=0 pos=1 obj=" << number(1000, 99999)
+          << " op='TABLE ACCESS BY INDEX ROWID " << word() << "S (cr=" << number(1, 50) << " pr=0 pw=0 time=120 us cost=2 size=20 card=1)'";
+        line(s.str());
+        s.str("");
+        s << "STAT #" << cursor << " id=2 cnt=" << number(1, 100) << " pid=1 pos=1 obj=" << number(1000, 99999)
+          << " op='INDEX RANGE SCAN " << word() << "_IX (cr=" << number(1, 20) << " pr=0 pw=0 time=60 us cost=1 size=0 card=1)'";
+        line(s.str());
+        statement.statsWritten = true;
+    }
+
+    // Type 0 is a hard close, the others leave the cursor cached.
+    unsigned type = percent(30) ? 0 : number(1, 3);
+    s.str("");
+    unsigned closeElapsed = number(1, 20);
+    mTim += closeElapsed;
+    s << "CLOSE #" << cursor << ":c=0,e=" << closeElapsed << ",dep=" << depth << ",type=" << type << ",tim=" << mTim;
+    line(s.str());
+
+    if (type == 0) {
+        mClosed.push_back(cursor);
+        if (statement.cursor == cursor) {
+            statement.cursor = 0;
+        }
+    }
+
+    if (depth == 0 && (statement.commandType == 2 || statement.commandType == 6) && percent(50)) {
+        bool rollback = percent(10);
+        s.str("");
+        s << "XCTEND rlbk=" << (rollback ? 1 : 0) << ", rd_only=0, tim=" << mTim;
+        line(s.str());
+
+        // A COMMIT waits for LGWR to write the redo.
+        if (!rollback) {
+            s.str("");
+            s << "buffer#=" << number(100, 99999) << " sync scn=" << number(1000000, 99999999) << " p3=0 obj#=-1";
+            wait(0, "log file sync", number(200, 5000), s.str());
+        }
+    }
+
+    // The session waits for the client's next call.
+    if (depth == 0) {
+        client(cursor);
+    }
+}
+
+
+// A statement which doesn't parse. The SQL follows on the next line.
+void genTrace::parseError() {
+    string sql = "select * frm " + word() + "s";
+    stringstream s;
+    s << "PARSE ERROR #" << mNextCursor << ":len=" << sql.length() + 1
+      << " dep=0 uid=104 oct=3 lid=104 tim=" << mTim << " err=923";
+    mNextCursor += 8;
+    line("=====================");
+    line(s.str());
+    line(sql);
+}
+
+
+// A deadlock graph, and the process state dump which follows it.
+void genTrace::deadlock() {
+    line("DEADLOCK DETECTED ( ORA-00060 )");
+    line(" ");
+    line("[Transaction Deadlock]");
+    line(" ");
+    line("The following deadlock is not an ORACLE error. It is a");
+    line("deadlock due to user error in the design of an application");
+    line("or from issuing incorrect ad-hoc SQL.");
+    line(" ");
+    line("Deadlock graph:");
+    line("                       ---------Blocker(s)--------  ---------Waiter(s)---------");
+    line("Resource Name          process session holds waits  process session holds waits");
+    line("TX-00090004-00026f9c        42     141     X             43      11           X");
+    line("TX-0003000a-0002750b        43      11     X             42     141           X");
+    line(" ");
+    line("session 141: DID 0001-002A-00000075\tsession 11: DID 0001-002B-0000002E");
+    line("session 11: DID 0001-002B-0000002E\tsession 141: DID 0001-002A-00000075");
+    line(" ");
+    line("Rows waited on:");
+    line("  Session 141: obj - rowid = 0001D2C5 - AAAdLFAAEAAAAIXAAA");
+    line("  Session 11: obj - rowid = 0001D2C5 - AAAdLFAAEAAAAIXAAB");
+    line(" ");
+    line("----- Information for the OTHER waiting sessions -----");
+    line("Session 11:");
+    line("  sid: 11 ser: 4243 audsid: 420001 user: 104/APP");
+    line("----- End of information for the OTHER waiting sessions -----");
+    line(" ");
+    line("END OF PROCESS STATE");
+}
+
+
+/** @brief Writes the whole trace.
+ *
+ * Statements are picked with a bias to the first few, as real
+ * applications have a handful of hot statements.
+ */
+void genTrace::write() {
+    makeStatements();
+    header();
+
+    unsigned long long target = mOptions.size * 1024ULL * 1024ULL;
+    unsigned deadlocksDone = 0;
+    unsigned long long calls = 0;
+
+    while (mBytes < target) {
+        // Pick a statement, the first ones more often.
+        unsigned hot = number(0, mStatements.size() - 1);
+        unsigned pick = percent(50) ? number(0, hot) : hot;
+        execute(mStatements[pick], 0);
+
+        if (perThousand(mOptions.parseErrors)) {
+            parseError();
+        }
+
+        if (++calls % 1000 == 0) {
+            timestamp();
+        }
+
+        // Deadlocks are spread evenly through the trace.
+        if (deadlocksDone < mOptions.deadlocks &&
+            mBytes >= target / (mOptions.deadlocks + 1) * (deadlocksDone + 1)) {
+            deadlock();
+            deadlocksDone++;
+        }
+    }
+
+    mOut.flush();
+}
+
+
+// Reads "--name=nn", returns true if it was that option.
+static bool numberOption(const string &arg, const string &name, unsigned long long *value, bool *ok) {
+    if (arg.compare(0, name.length(), name) != 0) {
+        return false;
+    }
+
+    char *end = NULL;
+    string digits = arg.substr(name.length());
+    *value = strtoull(digits.c_str(), &end, 10);
+    if (digits.empty() || *end) {
+        cerr << "TraceGen: Invalid number in '" << arg << "'." << endl;
+        *ok = false;
+    }
+
+    return true;
+}
+
+
+static void usage() {
+    cerr << endl << "USAGE:" << endl << endl
+         << "TraceGen [options] trace_file" << endl << endl
+         << "Writes a synthetic Oracle 10046 trace file, for benchmarking TraceCollier." << endl << endl
+         << "OPTIONS:" << endl << endl
+         << "'--size=nn'         Megabytes to write. Default 100." << endl
+         << "'--cursors=nn'      Distinct SQL statements. Default 200." << endl
+         << "'--reuse=nn'        Percent of executions which reuse a cached cursor. Default 80." << endl
+         << "'--binds=nn'        Most binds in any statement. Default 8." << endl
+         << "'--nchar=nn'        Percent of character binds which are NCHAR, in hex. Default 10." << endl
+         << "'--waits=nn'        Average WAITs inside each call, besides the client's. Default 3." << endl
+         << "'--depth=nn'        Deepest recursive SQL. Default 2." << endl
+         << "'--recursion=nn'    Percent of calls with recursive SQL inside. Default 20." << endl
+         << "'--deadlocks=nn'    Deadlock graphs in the whole trace. Default 1." << endl
+         << "'--errors=nn'       ERROR lines per thousand EXECs. Default 5." << endl
+         << "'--parse-errors=nn' PARSE ERRORs per thousand EXECs. Default 2." << endl
+         << "'--seed=nn'         Random number seed. The same seed gives the same trace. Default 1." << endl
+         << endl;
+}
+
+
+int main(int argc, char *argv[]) {
+    genOptions options;
+    bool ok = true;
+
+    for (int arg = 1; arg < argc; arg++) {
+        string thisArg = argv[arg];
+        unsigned long long value = 0;
+
+        if (numberOption(thisArg, "--size=", &value, &ok)) {
+            options.size = value;
+        } else if (numberOption(thisArg, "--cursors=", &value, &ok)) {
+            options.cursors = value;
+        } else if (numberOption(thisArg, "--reuse=", &value, &ok)) {
+            options.reuse = value;
+        } else if (numberOption(thisArg, "--binds=", &value, &ok)) {
+            options.binds = value;
+        } else if (numberOption(thisArg, "--nchar=", &value, &ok)) {
+            options.nchar = value;
+        } else if (numberOption(thisArg, "--waits=", &value, &ok)) {
+            options.waits = value;
+        } else if (numberOption(thisArg, "--depth=", &value, &ok)) {
+            options.depth = value;
+        } else if (numberOption(thisArg, "--recursion=", &value, &ok)) {
+            options.recursion = value;
+        } else if (numberOption(thisArg, "--deadlocks=", &value, &ok)) {
+            options.deadlocks = value;
+        } else if (numberOption(thisArg, "--errors=", &value, &ok)) {
+            options.errors = value;
+        } else if (numberOption(thisArg, "--parse-errors=", &value, &ok)) {
+            options.parseErrors = value;
+        } else if (numberOption(thisArg, "--seed=", &value, &ok)) {
+            options.seed = value;
+        } else if (thisArg[0] != '-' && options.traceFile.empty()) {
+            options.traceFile = thisArg;
+        } else {
+            cerr << "TraceGen: Unknown option '" << thisArg << "'." << endl;
+            ok = false;
+        }
+    }
+
+    if (!options.cursors) {
+        cerr << "TraceGen: There must be at least one cursor." << endl;
+        ok = false;
+    }
+
+    if (options.traceFile.empty()) {
+        cerr << "TraceGen: No trace file name supplied." << endl;
+        ok = false;
+    }
+
+    if (!ok) {
+        usage();
+        return 1;
+    }
+
+    ofstream ofs(options.traceFile);
+    if (!ofs.good()) {
+        cerr << "TraceGen: Cannot create " << options.traceFile << endl;
+        return 1;
+    }
+
+    genTrace trace(options, ofs);
+    trace.write();
+
+    if (!ofs.good()) {
+        cerr << "TraceGen: Error writing " << options.traceFile << endl;
+        return 1;
+    }
+
+    cout << "TraceGen: [" << options.traceFile << "] written with " << trace.lines() << " lines, "
+         << trace.bytes() << " bytes and " << trace.execs() << " EXECs." << endl;
+    return 0;
+}
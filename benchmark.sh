@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Benchmark TraceCollier against a synthetic trace file.
+#
+# Usage: ./benchmark.sh [megabytes [TraceCollier options ...]]
+#
+# Generates bench/bench_NNmb.trc with TraceGen, unless it's already
+# there, then parses it with --stats and reports the lines/sec, MB/sec
+# and peak memory. The default is a 1024MB trace. Any other arguments
+# are passed to TraceCollier, '-t' for a text report, for example.
+#
+# Run 'make -f makefile.gnu benchmark' to build everything first.
+# Norman Dunbar.
+
+MB=${1:-1024}
+shift
+
+BIN=./bin
+DIR=./bench
+TRACE=${DIR}/bench_${MB}mb.trc
+STATS=${DIR}/bench_${MB}mb.stats.json
+LOG=${DIR}/bench_${MB}mb.log
+
+mkdir -p ${DIR}
+
+# The same seed every time, so results can be compared.
+if [ ! -f ${TRACE} ]; then
+    ${BIN}/TraceGen --size=${MB} --seed=1 ${TRACE} || exit 1
+fi
+
+echo Parsing ${TRACE} ....
+if ! ${BIN}/TraceCollier -q -f=0 --stats "$@" ${TRACE} > ${LOG} 2>&1; then
+    echo TraceCollier failed. See ${LOG} for details.
+    exit 1
+fi
+
+# Pull the figures out of the statistics file.
+figure() {
+    sed -n "s/^  \"$1\": \([0-9.-]*\),*$/\1/p" ${STATS}
+}
+
+WALL=$(figure wall_ms)
+LINES=$(figure lines_per_sec)
+BYTES=$(figure bytes_per_sec)
+RSS=$(figure peak_rss_kb)
+
+echo
+awk -v wall="${WALL}" -v lines="${LINES}" -v bytes="${BYTES}" -v rss="${RSS}" 'BEGIN {
+    printf "Elapsed:    %.1f seconds\n", wall / 1000
+    printf "Lines/sec:  %.0f\n", lines
+    printf "MB/sec:     %.2f\n", bytes / 1048576
+    printf "Peak RSS:   %.1f MB\n", rss / 1024
+}'
+echo
+echo The per stage figures are in ${LOG} and ${STATS}.
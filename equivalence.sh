@@ -0,0 +1,123 @@
+#!/bin/bash
+
+# Check that the regex and non-regex builds of TraceCollier agree.
+#
+# Usage: ./equivalence.sh [megabytes [trace files or directories ...]]
+#
+# Generates a few synthetic traces with TraceGen, each of the given size,
+# default 20MB, in equiv/ unless they are already there. Any other .trc
+# files named, or found in named directories, are added to the corpus.
+# Each trace is parsed by bin/TraceCollier and bin/TraceCollier.noregex,
+# as HTML, text and viewer reports, and the reports, messages and exit
+# statuses are compared. A table of the throughput of each build follows,
+# and is left in equiv/throughput.txt. The banner line, which names the
+# build, is left out of the comparison.
+#
+# The exit status is the number of traces and formats that differ.
+#
+# Run 'make -f makefile.gnu equivalence' to build everything first.
+# Norman Dunbar.
+
+MB=${1:-20}
+shift
+
+BIN=./bin
+DIR=./equiv
+REGEX=${BIN}/TraceCollier
+NOREGEX=${BIN}/TraceCollier.noregex
+
+mkdir -p ${DIR}
+
+for exe in ${REGEX} ${NOREGEX} ${BIN}/TraceGen; do
+    if [ ! -x ${exe} ]; then
+        echo ${exe} is missing. Run 'make -f makefile.gnu equivalence'.
+        exit 1
+    fi
+done
+
+# The synthetic corpus. Each stresses a different parser.
+CORPUS=()
+generate() {
+    local name=${DIR}/$1_${MB}mb.trc
+    shift
+    if [ ! -f ${name} ]; then
+        ${BIN}/TraceGen --size=${MB} "$@" ${name} > /dev/null || exit 1
+    fi
+    CORPUS+=(${name})
+}
+
+generate default --seed=1
+generate binds --seed=2 --binds=60 --nchar=50 --reuse=90
+generate recursive --seed=3 --depth=6 --recursion=60
+generate errors --seed=4 --errors=50 --parse-errors=20 --deadlocks=10
+
+# Real traces, if any.
+for arg in "$@"; do
+    if [ -d "${arg}" ]; then
+        while IFS= read -r trc; do
+            CORPUS+=("${trc}")
+        done < <(find "${arg}" -name '*.trc' | sort)
+    else
+        CORPUS+=("${arg}")
+    fi
+done
+
+# Parse one trace with one build, in its own directory, so that the
+# reports don't overwrite each other. The trace is linked, not copied,
+# and always called trace.trc, as its name is in the reports. The
+# elapsed milliseconds go in elapsed_ms.
+run() {
+    local exe=$(cd "$(dirname "$1")" && pwd)/$(basename "$1") trace=$2 out=$3
+    shift 3
+    rm -rf ${out}
+    mkdir -p ${out}
+    ln -s "$(cd "$(dirname "${trace}")" && pwd)/$(basename "${trace}")" ${out}/trace.trc
+    local start=$(date +%s%N)
+    (cd ${out} && ${exe} -q -f=0 "$@" trace.trc > stdout.txt 2>&1; echo $? > exit_status)
+    echo $(( ($(date +%s%N) - start) / 1000000 )) > ${out}/elapsed_ms
+
+    # The banner says which build this is, so it's bound to differ.
+    sed -i '/^TraceCollier version /d' ${out}/stdout.txt
+}
+
+DIFFERENT=0
+TABLE=${DIR}/throughput.txt
+printf "%-28s %-7s %-6s %12s %12s %8s\n" Trace Format Result "REGEX MB/s" "NOREGEX MB/s" Speedup > ${TABLE}
+
+for trace in "${CORPUS[@]}"; do
+    name=$(basename "${trace}" .trc)
+    for format in html:"" text:"-t" viewer:"--format=viewer"; do
+        fmt=${format%%:*}
+        opts=${format#*:}
+
+        echo Parsing ${name} as ${fmt} ....
+        run ${REGEX} "${trace}" ${DIR}/${name}/${fmt}/regex ${opts}
+        run ${NOREGEX} "${trace}" ${DIR}/${name}/${fmt}/noregex ${opts}
+
+        # The timings differ every run, and aren't part of the report.
+        if diff -r -q -x 'elapsed_ms' -x 'trace.trc' \
+                ${DIR}/${name}/${fmt}/regex ${DIR}/${name}/${fmt}/noregex > ${DIR}/${name}/${fmt}/diff.txt; then
+            result=SAME
+        else
+            result=DIFFER
+            DIFFERENT=$((DIFFERENT + 1))
+            cat ${DIR}/${name}/${fmt}/diff.txt
+        fi
+
+        bytes=$(wc -c < "${trace}")
+        r=$(cat ${DIR}/${name}/${fmt}/regex/elapsed_ms)
+        n=$(cat ${DIR}/${name}/${fmt}/noregex/elapsed_ms)
+        awk -v t="${name}" -v f="${fmt}" -v res="${result}" -v b="${bytes}" -v r="${r}" -v n="${n}" 'BEGIN {
+            mb = b / 1048576
+            if (r < 1) r = 1
+            if (n < 1) n = 1
+            printf "%-28s %-7s %-6s %12.2f %12.2f %7.2fx\n", t, f, res, mb * 1000 / r, mb * 1000 / n, r / n
+        }' >> ${TABLE}
+    done
+done
+
+echo
+cat ${TABLE}
+echo
+echo The reports are in ${DIR}/trace_name/format/regex and noregex.
+exit ${DIFFERENT}
@@ -0,0 +1,103 @@
+#!/bin/bash
+
+# Check that --fetches doesn't hold up the report behind a cursor which
+# is never closed.
+#
+# Usage: ./fetches.sh
+#
+# Writes two small traces to fetches/. In each, cursor #1 is executed,
+# fetched once, and then left open while other rows go by, more rows in
+# the first trace, and more lines in the second, than an EXEC's row is
+# allowed to wait for. A second FETCH on #1 comes after that. Its row
+# must be written with only the first FETCH, and the report must still be
+# in line order. Without the limits, the second FETCH would be counted,
+# and every row after #1's would have waited in memory until the end.
+#
+# The exit status is the number of checks that failed.
+#
+# Run 'make -f makefile.gnu fetches' to build TraceCollier first.
+# Norman Dunbar.
+
+BIN=./bin/TraceCollier
+DIR=./fetches
+
+if [ ! -x ${BIN} ]; then
+    echo ${BIN} is missing. Run 'make -f makefile.gnu fetches'.
+    exit 1
+fi
+
+rm -rf ${DIR}
+mkdir -p ${DIR}
+
+# A trace with cursor #1 left open. $1 is the trace, $2 the number of
+# other cursor's EXECs which follow, and $3 the number of WAITs.
+unclosed() {
+    {
+        echo "Trace file /u01/app/oracle/diag/rdbms/orcl/orcl/trace/orcl_ora_4242.trc"
+        echo "Oracle Database 12c Enterprise Edition Release 12.1.0.2.0 - 64bit Production"
+        echo "ORACLE_HOME = /u01/app/oracle/product/12.1.0/dbhome_1"
+        echo "System name:	Linux"
+        echo "Node name:	dbserver"
+        echo "Release:	3.8.13-118.el7uek.x86_64"
+        echo "Instance name: orcl"
+        echo "Redo thread mounted by this instance: 1"
+        echo "Oracle process number: 42"
+        echo "Unix process pid: 4242, image: oracle@dbserver"
+        echo
+        echo
+        echo "*** 2017-01-09 00:00:00.000"
+        echo "*** SESSION ID:(42.4242) 2017-01-09 10:00:00.000"
+        echo
+        echo "====================="
+        echo "PARSING IN CURSOR #1 len=22 dep=0 uid=104 oct=3 lid=104 tim=1000 hv=1 ad='7b' sqlid='unclosed1'"
+        echo "select 1 from unclosed"
+        echo "END OF STMT"
+        echo "EXEC #1:c=10,e=20,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=1,plh=7,tim=2000"
+        echo "FETCH #1:c=10,e=20,p=0,cr=1,cu=0,mis=0,r=10,dep=0,og=1,plh=7,tim=2100"
+        echo "====================="
+        echo "PARSING IN CURSOR #2 len=19 dep=0 uid=104 oct=3 lid=104 tim=3000 hv=2 ad='7c' sqlid='others01'"
+        echo "select 2 from other"
+        echo "END OF STMT"
+        awk -v n=$2 'BEGIN { for (i = 0; i < n; i++) printf "EXEC #2:c=1,e=2,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=1,plh=8,tim=%d\n", 4000 + i }'
+        awk -v n=$3 'BEGIN { for (i = 0; i < n; i++) printf "WAIT #2: nam=\047SQL*Net message from client\047 ela= 5 driver id=1 #bytes=1 p3=0 obj#=-1 tim=%d\n", 5000000 + i }'
+        echo "EXEC #2:c=1,e=2,p=0,cr=0,cu=0,mis=0,r=0,dep=0,og=1,plh=8,tim=9000000"
+        echo "FETCH #1:c=10,e=20,p=0,cr=1,cu=0,mis=0,r=5,dep=0,og=1,plh=7,tim=9000100"
+        echo "CLOSE #1:c=0,e=5,dep=0,type=0,tim=9000200"
+        echo "CLOSE #2:c=0,e=5,dep=0,type=0,tim=9000300"
+    } > $1
+}
+
+FAILED=0
+
+# $1 is the check's name, $2 the trace.
+check() {
+    local name=$1 trace=$2
+    local report=${trace%.trc}.txt
+
+    (cd ${DIR} && ../${BIN} -q -t --fetches $(basename ${trace}) > /dev/null 2>&1)
+
+    # #1's row: FETCHES and FETCH ROWS are the 4th and 3rd fields from the end, before the SQL.
+    local fetches=$(grep ' select 1 from unclosed *$' ${report} | sed 's/ select 1 from unclosed *$//' | awk '{ print $(NF - 3), $(NF - 2) }')
+    if [ "${fetches}" == "1 10" ]; then
+        echo "${name}: ok  (#1 written with its first FETCH only)"
+    else
+        echo "${name}: FAILED  (#1's FETCHES and FETCH ROWS are '${fetches}', expected '1 10')"
+        FAILED=$((FAILED + 1))
+    fi
+
+    # Every EXEC row, in line order.
+    if awk '/^ *[0-9]+ / { if ($1 + 0 < last) exit 1; last = $1 + 0 }' ${report}; then
+        echo "${name}: ok  (rows in line order)"
+    else
+        echo "${name}: FAILED  (rows out of line order)"
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+unclosed ${DIR}/rows.trc 1500 0
+check "1,500 rows behind #1" ${DIR}/rows.trc
+
+unclosed ${DIR}/lines.trc 0 100500
+check "100,500 lines behind #1" ${DIR}/lines.trc
+
+exit ${FAILED}
@@ -9,11 +9,17 @@
 #
 
 CPP=g++
-CPPFLAGS=-std=c++11 
+CPPFLAGS=-std=c++11 -O2
+LIBS=
 TARGET=$(BIN)/TraceCollier
 RM=rm
 BIN=./bin
 STRIP=strip
+TRACEGEN=$(BIN)/TraceGen
+BENCH_MB=1024
+TRACEBENCH=$(BIN)/TraceBench
+LIBRARY=$(BIN)/libtracecollier.a
+TRACEEVENTS=$(BIN)/TraceEvents
 
 SOURCES=TraceCollier/TraceCollier.cpp \
         TraceCollier/tmoptions.cpp \
@@ -30,22 +36,127 @@ SOURCES=TraceCollier/TraceCollier.cpp \
         TraceCollier/parseParseError.cpp \
         TraceCollier/parseXctend.cpp \
         TraceCollier/parseDeadlock.cpp \
-        TraceCollier/parseError.cpp
+        TraceCollier/parseError.cpp \
+        TraceCollier/tmcallstats.cpp \
+        TraceCollier/tmcolumnar.cpp \
+        TraceCollier/tmsqlite.cpp \
+        TraceCollier/tmreportindex.cpp \
+        TraceCollier/tmviewer.cpp \
+        TraceCollier/tmdebuglog.cpp \
+        TraceCollier/tmstats.cpp \
+        TraceCollier/tmallocstats.cpp \
+        TraceCollier/tmcounters.cpp \
+        TraceCollier/parseFetch.cpp \
+        TraceCollier/parseWait.cpp \
+        TraceCollier/tmevents.cpp \
+        TraceCollier/tmsummary.cpp \
+        TraceCollier/tmfingerprint.cpp \
+        TraceCollier/tmwaits.cpp \
+        TraceCollier/tmplan.cpp \
+        TraceCollier/tmhistogram.cpp \
+        TraceCollier/tmtop.cpp \
+        TraceCollier/tmcalltree.cpp \
+        TraceCollier/tmflamegraph.cpp \
+        TraceCollier/tmtimeline.cpp
 
 OBJECTS=$(SOURCES:.cpp=.o)
 
+# The library, and the microbenchmarks, are everything but main() and
+# the allocation counter, which replaces the global operator new. The
+# microbenchmarks count allocations themselves. They are built a second
+# time, with NO_REGEX, so the two versions can be compared.
+LIB_OBJECTS=$(filter-out TraceCollier/TraceCollier.o TraceCollier/tmallocstats.o,$(OBJECTS))
+NOREGEX_OBJECTS=$(LIB_OBJECTS:.o=.noregex.o)
+
+# SQLite output (--format=sqlite) is optional, as it needs the
+# SQLite development files. To build it in:
+# make -f makefile.gnu SQLITE=1
+ifdef SQLITE
+CPPFLAGS+=-DUSE_SQLITE
+LIBS+=-lsqlite3
+endif
+
+# Heap allocation counting, per parser stage, is an instrumentation
+# build only, as it replaces the global operator new and delete. To
+# build it in:
+# make -f makefile.gnu ALLOCSTATS=1
+ifdef ALLOCSTATS
+CPPFLAGS+=-DUSE_ALLOC_STATS
+endif
+
+# The hand written line scanning, rather than std::regex, is used
+# on compilers that don't have a working <regex>. To force it:
+# make -f makefile.gnu NOREGEX=1
+ifdef NOREGEX
+CPPFLAGS+=-DNO_REGEX
+endif
+
 all:	TraceCollier $(BIN)
 
 TraceCollier:	$(OBJECTS) $(BIN)
-	$(CPP) -o $(TARGET) $(OBJECTS)
+	$(CPP) -o $(TARGET) $(OBJECTS) $(LIBS)
 	$(STRIP) $(TARGET)
 
 
 $(BIN):
 	mkdir $(BIN)
 
+# The synthetic trace generator, and a benchmark run over a
+# BENCH_MB megabyte trace from it. For a quicker run:
+# make -f makefile.gnu benchmark BENCH_MB=100
+tracegen:	$(BIN)
+	$(CPP) $(CPPFLAGS) -o $(TRACEGEN) TraceGen/tracegen.cpp
+
+benchmark:	TraceCollier tracegen
+	./benchmark.sh $(BENCH_MB)
+
+# Microbenchmarks of the per line parsing functions, both with
+# and without regex. For one function only, and more samples:
+# bin/TraceBench --filter=extractHex --samples=11
+%.noregex.o:	%.cpp
+	$(CPP) $(CPPFLAGS) -DNO_REGEX -c $< -o $@
+
+$(TRACEBENCH):	$(LIB_OBJECTS) TraceBench/tracebench.cpp $(BIN)
+	$(CPP) $(CPPFLAGS) -ITraceCollier -o $(TRACEBENCH) TraceBench/tracebench.cpp $(LIB_OBJECTS) $(LIBS)
+
+$(TRACEBENCH).noregex:	$(NOREGEX_OBJECTS) TraceBench/tracebench.cpp $(BIN)
+	$(CPP) $(CPPFLAGS) -DNO_REGEX -ITraceCollier -o $(TRACEBENCH).noregex TraceBench/tracebench.cpp $(NOREGEX_OBJECTS) $(LIBS)
+
+microbench:	$(TRACEBENCH) $(TRACEBENCH).noregex
+	$(TRACEBENCH)
+	$(TRACEBENCH).noregex
+
+# TraceCollier built both ways, with the reports compared over TraceGen
+# traces, and any real ones in EQUIV_TRACES, files or directories.
+# make -f makefile.gnu equivalence EQUIV_MB=50 EQUIV_TRACES=~/traces
+EQUIV_MB=20
+EQUIV_TRACES=
+
+$(TARGET).noregex:	$(NOREGEX_OBJECTS) TraceCollier/TraceCollier.noregex.o $(BIN)
+	$(CPP) -o $(TARGET).noregex TraceCollier/TraceCollier.noregex.o $(NOREGEX_OBJECTS) $(LIBS)
+	$(STRIP) $(TARGET).noregex
+
+equivalence:	TraceCollier $(TARGET).noregex tracegen
+	./equivalence.sh $(EQUIV_MB) $(EQUIV_TRACES)
+
+# --fetches, with a cursor that's never closed, mustn't hold up the report.
+fetches:	TraceCollier
+	./fetches.sh
+
+# The parser as a static library, for programs that want the trace
+# events, through a tmEventHandler, rather than a report. TraceEvents
+# is an example, which totals the events in a trace file.
+library:	$(LIB_OBJECTS) $(BIN)
+	$(RM) -f $(LIBRARY)
+	ar rcs $(LIBRARY) $(LIB_OBJECTS)
+
+$(TRACEEVENTS):	library TraceEvents/traceevents.cpp
+	$(CPP) $(CPPFLAGS) -ITraceCollier -o $(TRACEEVENTS) TraceEvents/traceevents.cpp $(LIBRARY) $(LIBS)
+
+traceevents:	$(TRACEEVENTS)
+
 clean:
-	$(RM) $(OBJECTS)
+	$(RM) -f $(OBJECTS) $(NOREGEX_OBJECTS) TraceCollier/TraceCollier.noregex.o
 
 distclean: clean
 	$(RM) -r $(BIN)